@@ -54,9 +54,13 @@ void resumeLoop(void);
   #include "Tone.h"
   #include "WMath.h"
   #include "HardwareSerial.h"
+  #include "BufferedPrint.h"
   #include "pulse.h"
   #include "HardwarePWM.h"
+  #include "HardwareTimer.h"
+  #include "PulseCapture.h"
   #include "utility/SoftwareTimer.h"
+  #include "utility/TimerWheel.h"
   #include "Uart.h"
 #endif
 
@@ -71,6 +75,8 @@ void resumeLoop(void);
 #include "utility/debug.h"
 #include "utility/utilities.h"
 #include "utility/AdaCallback.h"
+#include "utility/systrace.h"
+#include "utility/ppi.h"
 
 
 // Include board variant
@@ -0,0 +1,119 @@
+/**************************************************************************/
+/*!
+    @file     BufferedPrint.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "BufferedPrint.h"
+
+BufferedPrint::BufferedPrint(Print& out, uint8_t* buffer, size_t bufsize)
+  : _out(out), _buffer(buffer), _bufsize(bufsize), _count(0)
+{
+
+}
+
+BufferedPrint::~BufferedPrint()
+{
+  flush();
+}
+
+/**
+ * Write buffered data to the underlying Print
+ */
+void BufferedPrint::flush(void)
+{
+  if ( _count == 0 ) return;
+
+  if ( _out.write(_buffer, _count) != _count ) setWriteError();
+  _count = 0;
+}
+
+size_t BufferedPrint::write(uint8_t c)
+{
+  if ( _count == _bufsize ) flush();
+  if ( _bufsize == 0 ) return _out.write(c);
+
+  _buffer[_count++] = c;
+  return 1;
+}
+
+size_t BufferedPrint::write(const uint8_t *buffer, size_t size)
+{
+  if ( size > _bufsize - _count ) flush();
+
+  // Larger than whole buffer, pass through
+  if ( size > _bufsize ) return _out.write(buffer, size);
+
+  memcpy(_buffer + _count, buffer, size);
+  _count += size;
+
+  return size;
+}
+
+size_t BufferedPrint::vprintf(const char * format, va_list ap)
+{
+  va_list ap2;
+  va_copy(ap2, ap);
+
+  // vsnprintf() also needs room for null terminator
+  size_t const room = _bufsize - _count;
+  int len = vsnprintf((char*) _buffer + _count, room, format, ap);
+
+  if ( len < 0 )
+  {
+    len = 0;
+  }
+  else if ( (size_t) len < room )
+  {
+    _count += len;
+  }
+  else
+  {
+    flush();
+
+    if ( (size_t) len < _bufsize )
+    {
+      vsnprintf((char*) _buffer, _bufsize, format, ap2);
+      _count = len;
+    }else
+    {
+      // Larger than whole buffer
+      len = Print::vprintf(format, ap2);
+    }
+  }
+
+  va_end(ap2);
+  return len;
+}
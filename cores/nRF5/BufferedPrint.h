@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*!
+    @file     BufferedPrint.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef BUFFEREDPRINT_H_
+#define BUFFEREDPRINT_H_
+
+#include "Print.h"
+
+/* Print adapter that collects output in a buffer and passes it to the
+ * underlying Print in bulk with write(buffer, size). Useful for formatted
+ * output to Serial, BLEUart or files where each write() is expensive.
+ * Buffered data is written out by flush(), when the buffer is full or when
+ * the adapter goes out of scope.
+ *
+ *   BufferedPrintN<128> bp(Serial);
+ *   bp.printf("%d: ", count);
+ *   bp.println(value, 3);
+ */
+class BufferedPrint : public Print
+{
+  public:
+    BufferedPrint(Print& out, uint8_t* buffer, size_t bufsize);
+    virtual ~BufferedPrint();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    // format directly into buffer instead of stack
+    virtual size_t vprintf(const char * format, va_list ap);
+
+    virtual int availableForWrite(void) { return _bufsize - _count; }
+
+    void   flush(void);
+    size_t buffered(void) { return _count; }
+
+  private:
+    Print&   _out;
+    uint8_t* _buffer;
+    size_t   _bufsize;
+    size_t   _count;
+};
+
+// BufferedPrint with its own buffer e.g on the stack
+template <size_t N>
+class BufferedPrintN : public BufferedPrint
+{
+  public:
+    BufferedPrintN(Print& out) : BufferedPrint(out, _storage, N) { }
+
+  private:
+    uint8_t _storage[N];
+};
+
+#endif /* BUFFEREDPRINT_H_ */
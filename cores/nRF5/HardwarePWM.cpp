@@ -27,14 +27,25 @@
 #include "Arduino.h"
 #include "HardwarePWM.h"
 
-HardwarePWM HwPWM0(NRF_PWM0);
-HardwarePWM HwPWM1(NRF_PWM1);
-HardwarePWM HwPWM2(NRF_PWM2);
+HardwarePWM HwPWM0(NRF_PWM0, PWM0_IRQn);
+HardwarePWM HwPWM1(NRF_PWM1, PWM1_IRQn);
+HardwarePWM HwPWM2(NRF_PWM2, PWM2_IRQn);
 
 #ifdef NRF_PWM3
-HardwarePWM HwPWM3(NRF_PWM3);
+HardwarePWM HwPWM3(NRF_PWM3, PWM3_IRQn);
 #endif
 
+extern "C"
+{
+  void PWM0_IRQHandler(void) { dbgIsrEnter(); HwPWM0._irq_handler(); dbgIsrExit(); }
+  void PWM1_IRQHandler(void) { dbgIsrEnter(); HwPWM1._irq_handler(); dbgIsrExit(); }
+  void PWM2_IRQHandler(void) { dbgIsrEnter(); HwPWM2._irq_handler(); dbgIsrExit(); }
+
+#ifdef NRF_PWM3
+  void PWM3_IRQHandler(void) { dbgIsrEnter(); HwPWM3._irq_handler(); dbgIsrExit(); }
+#endif
+}
+
 HardwarePWM* HwPWMx[] =
 {
   &HwPWM0, &HwPWM1, &HwPWM2
@@ -84,12 +95,16 @@ void HardwarePWM::DebugOutput(Stream& logger)
 void HardwarePWM::DebugOutput(Stream& logger) {}
 #endif // CFG_DEBUG
 
-HardwarePWM::HardwarePWM(NRF_PWM_Type* pwm) :
-  _pwm(pwm)
+HardwarePWM::HardwarePWM(NRF_PWM_Type* pwm, IRQn_Type irqn) :
+  _pwm(pwm), _irqn(irqn)
 {
   _owner_token = 0U;
   arrclr(_seq0);
 
+  _seq_cb      = NULL;
+  _seq_dual    = false;
+  _seq_playing = false;
+
   _max_value = 255;
   _clock_div = PWM_PRESCALER_PRESCALER_DIV_1; // 16 Mhz
 
@@ -116,11 +131,14 @@ void HardwarePWM::begin(void)
   _pwm->SEQ[1].REFRESH  = 0;
   _pwm->SEQ[1].ENDDELAY = 0;
 
+  _seq_dual = false;
+
   _pwm->ENABLE = 1;
 }
 
 void HardwarePWM::stop(void)
 {
+  if ( _seq_playing ) stopSequence();
   _pwm->ENABLE = 0;
 }
 
@@ -214,6 +232,9 @@ bool HardwarePWM::writeChannel(uint8_t ch, uint16_t value, bool inverted)
   // Initialize PWM if not already
   if ( !enabled() ) begin();
 
+  // leave sequence playback
+  if ( _pwm->SEQ[0].PTR != (uint32_t) _seq0 ) stopSequence();
+
   // start sequence
   _pwm->TASKS_SEQSTART[0] = 1;
 
@@ -242,6 +263,206 @@ uint16_t HardwarePWM::readChannel(uint8_t ch) const
   return (_seq0[ch] & 0x7FFF);
 }
 
+//--------------------------------------------------------------------+
+// Sequence playback
+//--------------------------------------------------------------------+
+bool HardwarePWM::setDecoder(uint8_t load, bool next_step)
+{
+  VERIFY( load <= PWM_DECODER_LOAD_WaveForm );
+
+  if ( !enabled() ) begin();
+
+  _pwm->DECODER = (load << PWM_DECODER_LOAD_Pos) |
+                  ((next_step ? PWM_DECODER_MODE_NextStep : PWM_DECODER_MODE_RefreshCount) << PWM_DECODER_MODE_Pos);
+  return true;
+}
+
+bool HardwarePWM::setSequence(uint8_t seq, uint16_t const* values, uint16_t count, uint32_t refresh, uint32_t enddelay)
+{
+  VERIFY( seq < 2 && count <= PWM_SEQ_CNT_CNT_Msk );
+
+  // Sequence 1 can be cleared with count = 0
+  VERIFY( count || seq == 1 );
+  VERIFY( values || !count );
+
+  // Step must be complete for Individual and WaveForm
+  uint32_t const load = (_pwm->DECODER & PWM_DECODER_LOAD_Msk) >> PWM_DECODER_LOAD_Pos;
+  uint8_t const step = (load == PWM_DECODER_LOAD_Individual || load == PWM_DECODER_LOAD_WaveForm) ? 4 :
+                       (load == PWM_DECODER_LOAD_Grouped) ? 2 : 1;
+  VERIFY( (count % step) == 0 );
+
+  if ( !enabled() ) begin();
+
+  _pwm->SEQ[seq].PTR      = (uint32_t) values;
+  _pwm->SEQ[seq].CNT      = count;
+  _pwm->SEQ[seq].REFRESH  = refresh;
+  _pwm->SEQ[seq].ENDDELAY = enddelay;
+
+  if ( seq == 1 ) _seq_dual = (count > 0);
+
+  return true;
+}
+
+void HardwarePWM::setSequenceCallback(sequence_cb_t fp)
+{
+  _seq_cb = fp;
+
+  // Can be changed while playing e.g to only wake up CPU when there is data to refill
+  if ( _seq_playing )
+  {
+    if ( fp )
+    {
+      NVIC_SetPriority(_irqn, 3);
+      NVIC_EnableIRQ(_irqn);
+      _pwm->INTENSET = PWM_INTENSET_SEQEND0_Msk | PWM_INTENSET_SEQEND1_Msk;
+    }else
+    {
+      // SEQEND0 is still needed to track completion of single playback
+      _pwm->INTENCLR = PWM_INTENCLR_SEQEND1_Msk | (_pwm->LOOP ? PWM_INTENCLR_SEQEND0_Msk : 0);
+    }
+  }
+}
+
+bool HardwarePWM::playSequence(uint16_t loops)
+{
+  // Sequence 0 must be set
+  VERIFY( enabled() && _pwm->SEQ[0].PTR != (uint32_t) _seq0 );
+
+  _pwm->INTENCLR = 0xFFFFFFFFUL;
+  _pwm->SHORTS   = 0;
+
+  uint32_t start = 0;
+  uint32_t loop  = loops;
+
+  if ( !_seq_dual )
+  {
+    // Sequence 1 mirrors sequence 0, starting from sequence 1 plays sequence 0 one fewer time
+    _pwm->SEQ[1].PTR      = _pwm->SEQ[0].PTR;
+    _pwm->SEQ[1].CNT      = _pwm->SEQ[0].CNT;
+    _pwm->SEQ[1].REFRESH  = _pwm->SEQ[0].REFRESH;
+    _pwm->SEQ[1].ENDDELAY = _pwm->SEQ[0].ENDDELAY;
+
+    if ( loops == 1 )
+    {
+      loop = 0;
+    }else if ( loops )
+    {
+      loop  = (loops + 1) / 2;
+      start = (loops & 1);
+    }
+  }
+
+  if ( loops == 0 )
+  {
+    loop = 1;
+    _pwm->SHORTS = PWM_SHORTS_LOOPSDONE_SEQSTART0_Msk;
+  }
+
+  _pwm->LOOP = loop;
+
+  _pwm->EVENTS_SEQEND[0]   = 0;
+  _pwm->EVENTS_SEQEND[1]   = 0;
+  _pwm->EVENTS_LOOPSDONE   = 0;
+
+  // Interrupt on each sequence end to refill, and on the last one to track completion
+  uint32_t inten = 0;
+  if ( _seq_cb ) inten |= PWM_INTENSET_SEQEND0_Msk | PWM_INTENSET_SEQEND1_Msk;
+  if ( loops ) inten |= (loop ? PWM_INTENSET_LOOPSDONE_Msk : PWM_INTENSET_SEQEND0_Msk);
+
+  _seq_playing = true;
+
+  if ( inten )
+  {
+    NVIC_ClearPendingIRQ(_irqn);
+    NVIC_SetPriority(_irqn, 3);
+    NVIC_EnableIRQ(_irqn);
+
+    _pwm->INTENSET = inten;
+  }
+
+  _pwm->TASKS_SEQSTART[start] = 1;
+
+  return true;
+}
+
+void HardwarePWM::stopSequence(void)
+{
+  _pwm->INTENCLR = 0xFFFFFFFFUL;
+  _pwm->SHORTS   = 0;
+
+  if ( enabled() && _seq_playing )
+  {
+    _pwm->EVENTS_STOPPED = 0;
+    _pwm->TASKS_STOP = 1;
+
+    // Stop takes effect at end of current PWM period, which can be long (e.g 20 ms
+    // servo frame). Registers must not be rewritten while EasyDMA still plays them,
+    // so allow a full period times refresh count, plus a tick of margin for millis()
+    uint32_t period_us = (_pwm->COUNTERTOP << _pwm->PRESCALER) / 16;
+    if ( _pwm->MODE == PWM_MODE_UPDOWN_UpAndDown ) period_us *= 2;
+
+    uint32_t const refresh    = maxof(_pwm->SEQ[0].REFRESH, _pwm->SEQ[1].REFRESH) + 1;
+    uint32_t const timeout_ms = (uint32_t) ((((uint64_t) period_us)*refresh + 999)/1000) + 2;
+
+    uint32_t const start_ms = millis();
+    while ( !_pwm->EVENTS_STOPPED && (millis() - start_ms) < timeout_ms ) { }
+  }
+
+  _seq_playing = false;
+  _restore_static();
+}
+
+void HardwarePWM::_restore_static(void)
+{
+  _pwm->DECODER = PWM_DECODER_LOAD_Individual;
+  _pwm->LOOP    = 0;
+
+  _pwm->SEQ[0].PTR      = (uint32_t) _seq0;
+  _pwm->SEQ[0].CNT      = MAX_CHANNELS;
+  _pwm->SEQ[0].REFRESH  = 0;
+  _pwm->SEQ[0].ENDDELAY = 0;
+
+  _pwm->SEQ[1].PTR      = 0;
+  _pwm->SEQ[1].CNT      = 0;
+  _pwm->SEQ[1].REFRESH  = 0;
+  _pwm->SEQ[1].ENDDELAY = 0;
+
+  _seq_dual = false;
+
+  if ( enabled() && usedChannelCount() ) _pwm->TASKS_SEQSTART[0] = 1;
+}
+
+void HardwarePWM::_irq_handler(void)
+{
+  for(uint8_t seq=0; seq<2; seq++)
+  {
+    if ( !_pwm->EVENTS_SEQEND[seq] ) continue;
+    _pwm->EVENTS_SEQEND[seq] = 0;
+
+    // single playback (LOOP = 0) is done with sequence 0
+    if ( seq == 0 && _pwm->LOOP == 0 )
+    {
+      _seq_playing = false;
+      _pwm->INTENCLR = 0xFFFFFFFFUL;
+    }
+
+    if ( _seq_cb ) _seq_cb(seq);
+  }
+
+  if ( _pwm->EVENTS_LOOPSDONE )
+  {
+    _pwm->EVENTS_LOOPSDONE = 0;
+
+    if ( !(_pwm->SHORTS & PWM_SHORTS_LOOPSDONE_SEQSTART0_Msk) )
+    {
+      _seq_playing = false;
+      _pwm->INTENCLR = 0xFFFFFFFFUL;
+    }
+  }
+
+  (void) _pwm->EVENTS_LOOPSDONE; // read back to make sure event is cleared before exit
+}
+
 uint8_t HardwarePWM::usedChannelCount(void) const
 {
   uint8_t usedChannels = 0;
@@ -49,9 +49,15 @@
 
 class HardwarePWM
 {
+  public:
+    // Invoked in ISR when sequence 0 or 1 ends, the other sequence is playing
+    // meanwhile, therefore it is safe to load next buffer with setSequence(seq, ...)
+    typedef void (*sequence_cb_t) (uint8_t seq);
+
   private:
     enum { MAX_CHANNELS = 4 }; // Max channel per group
     NRF_PWM_Type * const _pwm;
+    IRQn_Type const _irqn;
     std::atomic<std::uint32_t> _owner_token;
 
     uint16_t _seq0[MAX_CHANNELS];
@@ -59,8 +65,12 @@ class HardwarePWM
     uint16_t  _max_value;
     uint8_t  _clock_div;
 
+    sequence_cb_t _seq_cb;
+    bool _seq_dual; // sequence 1 is set
+    volatile bool _seq_playing;
+
   public:
-    HardwarePWM(NRF_PWM_Type* pwm);
+    HardwarePWM(NRF_PWM_Type* pwm, IRQn_Type irqn);
 
     // Configure
     void setResolution(uint8_t bitnum); // set max value by 2^bitnum - 1
@@ -121,10 +131,35 @@ class HardwarePWM
     uint8_t usedChannelCount(void) const;
     uint8_t freeChannelCount(void) const;
 
+    //------------- Sequence playback -------------//
+    // Duty arrays are played from RAM by EasyDMA without CPU. Values are raw i.e bit 15
+    // is polarity (set for non-inverted), layout of each step depends on decoder load:
+    // - PWM_DECODER_LOAD_Common     : 1 value for all channels
+    // - PWM_DECODER_LOAD_Grouped    : 2 values for channel 0-1 and 2-3
+    // - PWM_DECODER_LOAD_Individual : 4 values, one per channel
+    // - PWM_DECODER_LOAD_WaveForm   : 3 values for channel 0-2 and COUNTERTOP of the step
+    bool setDecoder  (uint8_t load, bool next_step = false);
+
+    // refresh: extra PWM periods each step is repeated, enddelay: periods after sequence
+    // Values must stay valid (and in RAM) until the sequence ends.
+    bool setSequence (uint8_t seq, uint16_t const* values, uint16_t count, uint32_t refresh = 0, uint32_t enddelay = 0);
+    void setSequenceCallback(sequence_cb_t fp); // can be changed while playing
+
+    // Play sequence 0 (then sequence 1 if set) loops times, 0 for forever.
+    // Without sequence 1, sequence 0 is played loops times.
+    // writeChannel()/writePin() stop sequence playback and resume static duty.
+    bool playSequence(uint16_t loops = 1);
+    void stopSequence(void);
+    bool isSequencePlaying(void) { return _seq_playing; }
+
     static void DebugOutput(Stream& logger);
 
+    // Internal use only
+    void _irq_handler(void);
+
   private:
     void _set_psel(int ch, uint32_t value);
+    void _restore_static(void);
 };
 
 extern HardwarePWM HwPWM0;
@@ -0,0 +1,181 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Arduino.h"
+#include "HardwareTimer.h"
+
+HardwareTimer HwTimer1(NRF_TIMER1, TIMER1_IRQn);
+HardwareTimer HwTimer3(NRF_TIMER3, TIMER3_IRQn);
+HardwareTimer HwTimer4(NRF_TIMER4, TIMER4_IRQn);
+
+extern "C"
+{
+  void TIMER1_IRQHandler(void) { dbgIsrEnter(); HwTimer1._irq_handler(); dbgIsrExit(); }
+  void TIMER3_IRQHandler(void) { dbgIsrEnter(); HwTimer3._irq_handler(); dbgIsrExit(); }
+  void TIMER4_IRQHandler(void) { dbgIsrEnter(); HwTimer4._irq_handler(); dbgIsrExit(); }
+}
+
+HardwareTimer::HardwareTimer(NRF_TIMER_Type* timer, IRQn_Type irqn)
+  : _timer(timer), _irqn(irqn)
+{
+  _owner_token = 0U;
+  _cb          = NULL;
+  _handler     = NULL;
+  _handler_arg = NULL;
+  _periodic    = false;
+  _running     = false;
+}
+
+bool HardwareTimer::takeOwnership(uint32_t token)
+{
+  if ( token == 0 || _owner_token != 0 ) return false;
+
+  uint32_t expectedValue = 0U;
+  return _owner_token.compare_exchange_strong(expectedValue, token);
+}
+
+bool HardwareTimer::releaseOwnership(uint32_t token)
+{
+  if ( token == 0 || !isOwner(token) ) return false;
+  if ( _running ) return false;
+
+  return _owner_token.compare_exchange_strong(token, 0U);
+}
+
+bool HardwareTimer::begin(callback_t callback, uint8_t irq_priority)
+{
+  VERIFY(callback);
+
+  stop();
+  _cb = callback;
+
+  _timer->MODE      = TIMER_MODE_MODE_Timer;
+  _timer->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+  _timer->PRESCALER = 4; // 16 Mhz / 2^4 = 1 Mhz
+  _timer->INTENCLR  = 0xFFFFFFFFUL;
+  _timer->INTENSET  = TIMER_INTENSET_COMPARE0_Msk;
+
+  NVIC_ClearPendingIRQ(_irqn);
+  NVIC_SetPriority(_irqn, irq_priority);
+  NVIC_EnableIRQ(_irqn);
+
+  return true;
+}
+
+void HardwareTimer::end(void)
+{
+  stop();
+
+  NVIC_DisableIRQ(_irqn);
+  _timer->INTENCLR = 0xFFFFFFFFUL;
+  _cb = NULL;
+}
+
+bool HardwareTimer::attachHandler(irq_handler_t handler, void* arg, uint8_t irq_priority)
+{
+  VERIFY(handler);
+
+  NVIC_DisableIRQ(_irqn);
+  _handler_arg = arg;
+  _handler     = handler;
+
+  NVIC_ClearPendingIRQ(_irqn);
+  NVIC_SetPriority(_irqn, irq_priority);
+  NVIC_EnableIRQ(_irqn);
+
+  return true;
+}
+
+void HardwareTimer::detachHandler(void)
+{
+  NVIC_DisableIRQ(_irqn);
+  _timer->INTENCLR = 0xFFFFFFFFUL;
+  _handler     = NULL;
+  _handler_arg = NULL;
+}
+
+bool HardwareTimer::_start(uint32_t us, bool periodic)
+{
+  VERIFY(_cb && us);
+
+  _timer->TASKS_STOP  = 1;
+  _timer->TASKS_CLEAR = 1;
+
+  _periodic = periodic;
+  _running  = true;
+
+  _timer->EVENTS_COMPARE[0] = 0;
+  _timer->CC[0]  = us;
+
+  // Clear on compare to keep period exact regardless of interrupt latency
+  _timer->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk | (periodic ? 0 : TIMER_SHORTS_COMPARE0_STOP_Msk);
+
+  _timer->TASKS_START = 1;
+
+  return true;
+}
+
+bool HardwareTimer::startOnce(uint32_t us)
+{
+  return _start(us, false);
+}
+
+bool HardwareTimer::startPeriodic(uint32_t us)
+{
+  return _start(us, true);
+}
+
+void HardwareTimer::stop(void)
+{
+  _timer->TASKS_STOP  = 1;
+  _timer->TASKS_CLEAR = 1;
+  _timer->SHORTS      = 0;
+  _timer->EVENTS_COMPARE[0] = 0;
+
+  _running = false;
+}
+
+uint32_t HardwareTimer::elapsed(void)
+{
+  _timer->TASKS_CAPTURE[1] = 1;
+  return _timer->CC[1];
+}
+
+void HardwareTimer::_irq_handler(void)
+{
+  if ( _handler )
+  {
+    _handler(_handler_arg);
+    return;
+  }
+
+  if ( !_timer->EVENTS_COMPARE[0] ) return;
+
+  _timer->EVENTS_COMPARE[0] = 0;
+  (void) _timer->EVENTS_COMPARE[0]; // read back to make sure event is cleared before exit
+
+  if ( !_periodic ) _running = false;
+  if ( _cb ) _cb();
+}
@@ -0,0 +1,93 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HARDWARETIMER_H_
+#define HARDWARETIMER_H_
+
+#include "common_inc.h"
+#include "nrf.h"
+#include <atomic>
+#include <cstdint>
+
+/* One-shot and periodic callbacks with 1 us resolution using a TIMER
+ * peripheral. Callback is invoked in interrupt context.
+ * - TIMER0 is used by SoftDevice, TIMER2 CC[0] holds the bootloader version
+ *   therefore only TIMER1, TIMER3 and TIMER4 are available.
+ * - TIMER is clocked by HFCLK, which runs from the internal RC oscillator
+ *   (~1.5%) unless the crystal is requested e.g with sd_clock_hfclk_request().
+ */
+class HardwareTimer
+{
+  public:
+    typedef void (*callback_t) (void);
+    typedef void (*irq_handler_t) (void* arg);
+
+    HardwareTimer(NRF_TIMER_Type* timer, IRQn_Type irqn);
+
+    // Cooperative ownership sharing, same as HardwarePWM
+    bool takeOwnership   (uint32_t token);
+    bool releaseOwnership(uint32_t token);
+    bool isOwner(uint32_t token) const { return _owner_token == token; }
+
+    // Interrupt priority must be one not used by SoftDevice: 2, 3, 5, 6, 7
+    bool begin(callback_t callback, uint8_t irq_priority = 3);
+    void end  (void);
+
+    bool startOnce    (uint32_t us);
+    bool startPeriodic(uint32_t us);
+    void stop         (void);
+    bool isRunning    (void) { return _running; }
+
+    // microseconds since last (re)start or period
+    uint32_t elapsed(void);
+
+    NRF_TIMER_Type* getTimer(void) { return _timer; }
+
+    // For owner driving the TIMER registers directly (e.g with PPI): interrupt is
+    // forwarded to handler instead of begin()'s callback, owner manages INTEN and events
+    bool attachHandler(irq_handler_t handler, void* arg, uint8_t irq_priority = 3);
+    void detachHandler(void);
+
+    // Internal use only
+    void _irq_handler(void);
+
+  private:
+    NRF_TIMER_Type* const _timer;
+    IRQn_Type const _irqn;
+    std::atomic<std::uint32_t> _owner_token;
+
+    callback_t _cb;
+    irq_handler_t _handler;
+    void* _handler_arg;
+    bool _periodic;
+    volatile bool _running;
+
+    bool _start(uint32_t us, bool periodic);
+};
+
+extern HardwareTimer HwTimer1;
+extern HardwareTimer HwTimer3;
+extern HardwareTimer HwTimer4;
+
+#endif /* HARDWARETIMER_H_ */
@@ -78,11 +78,7 @@ size_t Print::print(long n, int base)
   if (base == 0) {
     return write(n);
   } else if (base == 10) {
-    if (n < 0) {
-      int t = print('-');
-      n = -n;
-      return printNumber(n, 10) + t;
-    }
+    if (n < 0) return printNumber(0UL - (unsigned long) n, 10, true);
     return printNumber(n, 10);
   } else {
     return printNumber(n, base);
@@ -189,48 +185,177 @@ size_t Print::println(const Printable& x)
 
 size_t Print::printf(const char * format, ...)
 {
-  char buf[256];
-  int len;
-
   va_list ap;
   va_start(ap, format);
 
-  len = vsnprintf(buf, 256, format, ap);
-  this->write(buf, len);
+  size_t len = this->vprintf(format, ap);
 
   va_end(ap);
   return len;
 }
 
+/* default implementation: format on stack, may be overridden to format
+ * directly into a buffer (e.g BufferedPrint) */
+size_t Print::vprintf(const char * format, va_list ap)
+{
+  char buf[256];
+
+  va_list ap2;
+  va_copy(ap2, ap);
+
+  int len = vsnprintf(buf, sizeof(buf), format, ap);
+
+  if ( len < 0 )
+  {
+    len = 0;
+  }
+  else if ( (size_t) len < sizeof(buf) )
+  {
+    len = this->write(buf, len);
+  }
+  else
+  {
+    // Output is truncated, format again with large enough buffer
+    char* lbuf = (char*) malloc(len+1);
+    if ( lbuf )
+    {
+      vsnprintf(lbuf, len+1, format, ap2);
+      len = this->write(lbuf, len);
+      free(lbuf);
+    }else
+    {
+      len = this->write(buf, sizeof(buf)-1);
+    }
+  }
+
+  va_end(ap2);
+  return len;
+}
+
 // Private Methods /////////////////////////////////////////////////////////////
 
-size_t Print::printNumber(unsigned long n, uint8_t base)
+static const char _dec_lut[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// Convert to decimal backward from end, two digits at a time. Division by constant
+// is compiled into multiply and shift. Return pointer to the first digit.
+static char* utoa10_rev(uint32_t n, char* end)
 {
-  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+  while ( n >= 100 )
+  {
+    uint32_t const q = n / 100;
+    uint32_t const r = n - q*100;
 
-  *str = '\0';
+    end -= 2;
+    memcpy(end, &_dec_lut[2*r], 2);
+    n = q;
+  }
+
+  if ( n >= 10 )
+  {
+    end -= 2;
+    memcpy(end, &_dec_lut[2*n], 2);
+  }else
+  {
+    *--end = '0' + n;
+  }
+
+  return end;
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base, bool negative)
+{
+  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus sign.
+  char* const end = &buf[sizeof(buf)];
+  char *str;
 
   // prevent crash if called with base == 1
   if (base < 2) base = 10;
 
-  do {
-    char c = n % base;
-    n /= base;
+  if ( base == 10 )
+  {
+    str = utoa10_rev(n, end);
+  }
+  else if ( (base & (base-1)) == 0 )
+  {
+    // power of 2: shift and mask
+    uint8_t const shift = __builtin_ctz(base);
+    str = end;
+    do {
+      char c = n & (base-1);
+      n >>= shift;
+
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+  }
+  else
+  {
+    str = end;
+    do {
+      char c = n % base;
+      n /= base;
 
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+  }
 
-  return write(str);
+  if ( negative ) *--str = '-';
+
+  return write(str, end - str);
 }
 
 size_t Print::printFloat(double number, uint8_t digits)
 {
+  static const uint32_t _pow10[] =
+  {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+  };
+
+  // Fixed-point: integer part fits in 32-bit and fraction is scaled to integer
+  if ( digits < arrcount(_pow10) && isfinite(number) && fabs(number) < 4294967295.0 )
+  {
+    char buf[24]; // sign + 10 digits + '.' + 9 digits
+    char* const end = &buf[sizeof(buf)];
+    char* str = end;
+
+    double const x = fabs(number);
+    uint32_t ipart = (uint32_t) x;
+    uint32_t fpart = (uint32_t) ((x - ipart)*_pow10[digits] + 0.5);
+
+    // rounding carries into integer part
+    if ( fpart >= _pow10[digits] )
+    {
+      fpart -= _pow10[digits];
+      ipart++;
+    }
+
+    if ( digits )
+    {
+      str = utoa10_rev(fpart, end);
+      while ( str > end - digits ) *--str = '0';
+      *--str = '.';
+    }
+
+    str = utoa10_rev(ipart, str);
+    if ( signbit(number) ) *--str = '-';
+
+    return write(str, end - str);
+  }
+
   char buf[256];
   size_t s=0;
 
   s = snprintf(buf, 256, "%.*f", digits, number);
-  s = write(buf, s);
+  s = write(buf, minof(s, sizeof(buf)-1));
   return s;
 }
 
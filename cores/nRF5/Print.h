@@ -35,7 +35,7 @@ class Print
 {
   private:
     int write_error;
-    size_t printNumber(unsigned long, uint8_t);
+    size_t printNumber(unsigned long, uint8_t, bool negative = false);
     size_t printFloat(double, uint8_t);
   protected:
     void setWriteError(int err = 1) { write_error = err; }
@@ -86,6 +86,7 @@ class Print
     size_t println(void);
 
     size_t printf(const char * format, ...);
+    virtual size_t vprintf(const char * format, va_list ap);
 
     size_t printBuffer(uint8_t const buffer[], int len, char delim=' ', int byteline = 0);
     size_t printBuffer(char const buffer[], int size, char delim=' ', int byteline = 0)
@@ -0,0 +1,347 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Arduino.h"
+#include "PulseCapture.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+enum { CAPTURE_TOKEN = 0x736c7550 }; // 'P' 'u' 'l' 's'
+
+#define TICKS_PER_US      16
+#define PULSEIN_MAX_US    (200UL*1000000UL) // 32-bit counter at 16 MHz wraps after 268 seconds
+
+static PulseCapture* _capture[8]; // indexed by GPIOTE channel
+
+static HardwareTimer* take_timer(void)
+{
+  HardwareTimer* const timers[] = { &HwTimer4, &HwTimer3, &HwTimer1 };
+
+  for(uint8_t i=0; i<arrcount(timers); i++)
+  {
+    if ( timers[i]->takeOwnership(CAPTURE_TOKEN) ) return timers[i];
+  }
+
+  return NULL;
+}
+
+// Free running 32-bit counter at 16 MHz, no interrupt
+static void timer_start(NRF_TIMER_Type* timer)
+{
+  timer->TASKS_STOP  = 1;
+  timer->MODE        = TIMER_MODE_MODE_Timer;
+  timer->BITMODE     = TIMER_BITMODE_BITMODE_32Bit;
+  timer->PRESCALER   = 0;
+  timer->SHORTS      = 0;
+  timer->INTENCLR    = 0xFFFFFFFFUL;
+  timer->TASKS_CLEAR = 1;
+  timer->TASKS_START = 1;
+}
+
+static void timer_release(HardwareTimer* hwtimer)
+{
+  NRF_TIMER_Type* timer = hwtimer->getTimer();
+  timer->TASKS_STOP  = 1;
+  timer->TASKS_CLEAR = 1;
+
+  hwtimer->releaseOwnership(CAPTURE_TOKEN);
+}
+
+//--------------------------------------------------------------------+
+// PulseCapture
+//--------------------------------------------------------------------+
+static void capture_gpiote_handler(uint8_t ch)
+{
+  if ( _capture[ch] ) _capture[ch]->_handler();
+}
+
+PulseCapture::PulseCapture(void)
+{
+  _hwtimer   = NULL;
+  _gpiote_ch = -1;
+  _ppi_ch    = -1;
+  _pin       = 0;
+
+  _buf       = NULL;
+  _depth     = 0;
+  _wr_idx    = _rd_idx = 0;
+
+  _last       = 0;
+  _first_edge = true;
+  _overflow   = 0;
+
+  _cb        = NULL;
+  _deferred  = false;
+}
+
+bool PulseCapture::begin(uint32_t pin, uint16_t depth)
+{
+  VERIFY(pin < PINS_COUNT && depth);
+  end();
+
+  _pin   = g_ADigitalPinMap[pin];
+  _depth = depth + 1; // one slot is kept empty
+  _buf   = (pulse_capture_t*) rtos_malloc(_depth*sizeof(pulse_capture_t));
+  VERIFY(_buf);
+
+  _wr_idx = _rd_idx = 0;
+  _first_edge = true;
+  _overflow = 0;
+
+  _hwtimer = take_timer();
+
+  if ( _hwtimer ) _gpiote_ch = gpioteChannelAlloc(_pin, GPIOTE_CONFIG_POLARITY_Toggle, capture_gpiote_handler);
+
+  if ( _gpiote_ch >= 0 )
+  {
+    _capture[_gpiote_ch] = this;
+    _ppi_ch = ppi_channel_alloc(&NRF_GPIOTE->EVENTS_IN[_gpiote_ch], &_hwtimer->getTimer()->TASKS_CAPTURE[0]);
+  }
+
+  if ( _ppi_ch < 0 )
+  {
+    end();
+    return false;
+  }
+
+  timer_start(_hwtimer->getTimer());
+  ppi_channel_enable(_ppi_ch);
+
+  return true;
+}
+
+void PulseCapture::end(void)
+{
+  if ( _ppi_ch >= 0 ) ppi_channel_free(_ppi_ch);
+  _ppi_ch = -1;
+
+  if ( _gpiote_ch >= 0 )
+  {
+    gpioteChannelFree(_gpiote_ch);
+    _capture[_gpiote_ch] = NULL;
+  }
+  _gpiote_ch = -1;
+
+  if ( _hwtimer ) timer_release(_hwtimer);
+  _hwtimer = NULL;
+
+  rtos_free(_buf);
+  _buf = NULL;
+  _depth = 0;
+}
+
+void PulseCapture::setCallback(callback_t fp, bool deferred)
+{
+  _cb = fp;
+  _deferred = deferred;
+}
+
+uint16_t PulseCapture::available(void)
+{
+  uint16_t const wr = _wr_idx;
+  uint16_t const rd = _rd_idx;
+  return (wr >= rd) ? (wr - rd) : (_depth - rd + wr);
+}
+
+bool PulseCapture::read(pulse_capture_t* pulse)
+{
+  uint16_t const rd = _rd_idx;
+  if ( !_buf || rd == _wr_idx ) return false;
+
+  *pulse = _buf[rd];
+  _rd_idx = (rd + 1 == _depth) ? 0 : (rd + 1);
+
+  return true;
+}
+
+void PulseCapture::clear(void)
+{
+  _rd_idx = _wr_idx;
+}
+
+void PulseCapture::_handler(void)
+{
+  uint32_t const now = _hwtimer->getTimer()->CC[0];
+
+  // level of the pulse that just ended is opposite of current one
+  uint8_t const level = nrf_gpio_pin_read(_pin) ? LOW : HIGH;
+
+  if ( _first_edge )
+  {
+    _first_edge = false;
+    _last = now;
+    return;
+  }
+
+  uint32_t const ticks = now - _last;
+  _last = now;
+
+  // same level twice: an edge pair happened within interrupt latency
+  if ( _wr_idx != _rd_idx )
+  {
+    uint16_t const prev = (_wr_idx == 0) ? (_depth - 1) : (_wr_idx - 1);
+    if ( _buf[prev].level == level ) _overflow++;
+  }
+
+  uint16_t const wr   = _wr_idx;
+  uint16_t const next = (wr + 1 == _depth) ? 0 : (wr + 1);
+
+  if ( next == _rd_idx )
+  {
+    _overflow++;
+  }else
+  {
+    _buf[wr].ticks = ticks;
+    _buf[wr].level = level;
+    _wr_idx = next;
+  }
+
+  if ( _cb )
+  {
+    if ( _deferred )
+    {
+      ada_callback(NULL, 0, _cb, ticks, level);
+    }else
+    {
+      _cb(ticks, level);
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// pulseIn()
+// nRF52 allows a single GPIOTE channel per pin: it is armed on the start edge
+// capturing into CC[0], its interrupt re-arms it on the end edge capturing into
+// CC[1]. Both timestamps are latched by hardware.
+//--------------------------------------------------------------------+
+static NRF_TIMER_Type* volatile _pulse_timer = NULL;
+static volatile uint32_t _pulse_ticks;
+static volatile bool _pulse_started;
+static SemaphoreHandle_t _pulse_sem = NULL;
+static StaticSemaphore_t _pulse_sem_def;
+static volatile bool _pulse_busy = false;
+
+static uint32_t _pulse_pin; // nrf pin
+static uint32_t _pulse_state;
+static int8_t   _pulse_ppi;
+
+static void pulse_arm(uint8_t ch, bool end_edge)
+{
+  NRF_TIMER_Type* timer = _pulse_timer;
+  bool const rising = (_pulse_state != 0) ^ end_edge;
+
+  ppi_channel_task(_pulse_ppi, &timer->TASKS_CAPTURE[end_edge ? 1 : 0]);
+  gpioteChannelPolarity(ch, rising ? GPIOTE_CONFIG_POLARITY_LoToHi : GPIOTE_CONFIG_POLARITY_HiToLo);
+  _pulse_started = end_edge;
+}
+
+static void pulse_edge_handler(uint8_t ch)
+{
+  NRF_TIMER_Type* timer = _pulse_timer;
+  if ( !timer || _pulse_ticks ) return;
+
+  if ( !_pulse_started )
+  {
+    pulse_arm(ch, true);
+
+    // pulse shorter than interrupt latency ended before re-arm: wait for next one.
+    // Event set means it ended after, CC[1] holds it and handler runs again
+    if ( (nrf_gpio_pin_read(_pulse_pin) ? HIGH : LOW) != _pulse_state && !NRF_GPIOTE->EVENTS_IN[ch] )
+    {
+      pulse_arm(ch, false);
+    }
+    return;
+  }
+
+  int32_t const ticks = (int32_t) (timer->CC[1] - timer->CC[0]);
+  if ( ticks <= 0 ) return;
+
+  _pulse_ticks = (uint32_t) ticks;
+  xSemaphoreGiveFromISR(_pulse_sem, NULL);
+}
+
+extern "C" bool pulseInCapture(uint32_t pin, uint32_t state, uint32_t timeout, uint32_t* width_us)
+{
+  // blocking wait requires a task
+  if ( isInISR() || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) return false;
+  if ( pin >= PINS_COUNT ) return false;
+
+  if ( __atomic_test_and_set((void*) &_pulse_busy, __ATOMIC_ACQUIRE) ) return false;
+
+  if ( _pulse_sem == NULL ) _pulse_sem = xSemaphoreCreateBinaryStatic(&_pulse_sem_def);
+
+  _pulse_pin   = g_ADigitalPinMap[pin];
+  _pulse_state = state ? HIGH : LOW;
+
+  uint32_t const start_pol = state ? GPIOTE_CONFIG_POLARITY_LoToHi : GPIOTE_CONFIG_POLARITY_HiToLo;
+
+  bool ok = false;
+  int8_t ppi_ch = -1;
+  int gpiote_ch = -1;
+
+  HardwareTimer* hwtimer = take_timer();
+
+  if ( hwtimer )
+  {
+    NRF_TIMER_Type* timer = hwtimer->getTimer();
+
+    // fails if the pin already has a GPIOTE channel, pulseIn() then polls
+    gpiote_ch = gpioteChannelAlloc(_pulse_pin, start_pol, pulse_edge_handler);
+    if ( gpiote_ch >= 0 ) ppi_ch = ppi_channel_alloc(&NRF_GPIOTE->EVENTS_IN[gpiote_ch], &timer->TASKS_CAPTURE[0]);
+
+    if ( ppi_ch >= 0 )
+    {
+      ok = true;
+
+      xSemaphoreTake(_pulse_sem, 0); // drop stale give
+      _pulse_ticks   = 0;
+      _pulse_started = false;
+      _pulse_ppi     = ppi_ch;
+
+      timer_start(timer);
+      _pulse_timer = timer;
+
+      ppi_channel_enable(ppi_ch);
+
+      // calling task sleeps until pulse ends or timeout
+      timeout = minof(timeout, PULSEIN_MAX_US);
+      xSemaphoreTake(_pulse_sem, ms2tick((timeout + 999) / 1000));
+
+      ppi_channel_disable(ppi_ch);
+      _pulse_timer = NULL;
+
+      *width_us = (_pulse_ticks + TICKS_PER_US/2) / TICKS_PER_US;
+    }
+  }
+
+  ppi_channel_free(ppi_ch);
+  gpioteChannelFree(gpiote_ch);
+  if ( hwtimer ) timer_release(hwtimer);
+
+  __atomic_clear((void*) &_pulse_busy, __ATOMIC_RELEASE);
+
+  return ok;
+}
@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef PULSECAPTURE_H_
+#define PULSECAPTURE_H_
+
+#include "common_inc.h"
+#include "HardwareTimer.h"
+
+typedef struct
+{
+  uint32_t ticks; // width in 1/16 us (62.5 ns)
+  uint8_t  level; // HIGH or LOW pulse
+} pulse_capture_t;
+
+/* Record a stream of pulse widths (IR remote, PWM decoding, ultrasonic ranger)
+ * - Every edge of the pin triggers a TIMER capture through GPIOTE and PPI, widths
+ *   are therefore not affected by interrupt latency or SoftDevice activity.
+ * - Uses one GPIOTE channel, one PPI channel and one of the HardwareTimer
+ *   (taken with ownership token for as long as the capture is running).
+ * - Edges closer than the interrupt latency are merged and counted as overflows.
+ * - TIMER runs on HFCLK, width is only as accurate as the clock source (~1.5% for
+ *   internal RC), request the crystal e.g with sd_clock_hfclk_request() if needed.
+ */
+class PulseCapture
+{
+  public:
+    typedef void (*callback_t) (uint32_t ticks, uint8_t level);
+
+    PulseCapture(void);
+
+    bool begin(uint32_t pin, uint16_t depth = 64);
+    void end  (void);
+
+    // Invoked for each pulse in ISR, or by callback task if deferred
+    void setCallback(callback_t fp, bool deferred = false);
+
+    uint16_t available(void);
+    bool     read     (pulse_capture_t* pulse);
+    void     clear    (void);
+    uint32_t overflows(void) { return _overflow; }
+
+    static uint32_t ticksToMicros(uint32_t ticks) { return (ticks + 8) / 16; }
+
+    // Internal use only
+    void _handler(void);
+
+  private:
+    HardwareTimer* _hwtimer;
+    int8_t   _gpiote_ch;
+    int8_t   _ppi_ch;
+    uint32_t _pin; // nrf pin
+
+    pulse_capture_t* _buf;
+    uint16_t _depth;
+    volatile uint16_t _wr_idx;
+    volatile uint16_t _rd_idx;
+
+    uint32_t _last;
+    bool     _first_edge;
+    volatile uint32_t _overflow;
+
+    callback_t _cb;
+    bool       _deferred;
+};
+
+#endif /* PULSECAPTURE_H_ */
@@ -197,6 +197,7 @@ void Uart::IrqHandler()
     nrfUart->EVENTS_ENDRX = 0x0UL;
     if (nrfUart->RXD.AMOUNT)
     {
+      SYSTRACE_MARK(SYSTRACE_UART_RX, rxRcv);
       rxBuffer.store_char(rxRcv);
     }
     nrfUart->TASKS_STARTRX = 0x1UL;
@@ -205,6 +206,7 @@ void Uart::IrqHandler()
   if (nrfUart->EVENTS_ENDTX)
   {
     nrfUart->EVENTS_ENDTX = 0x0UL;
+    SYSTRACE_STOP(SYSTRACE_UART_TX, nrfUart->TXD.AMOUNT);
     xSemaphoreGiveFromISR(_end_tx_sem, NULL);
   }
 }
@@ -245,6 +247,7 @@ size_t Uart::write(const uint8_t *buffer, size_t size)
     memcpy(txBuffer, buffer + sent, txSize);
 
     nrfUart->TXD.MAXCNT = txSize;
+    SYSTRACE_START(SYSTRACE_UART_TX, txSize);
     nrfUart->TASKS_STARTTX = 0x1UL;
     sent += txSize;
 
@@ -264,7 +267,9 @@ extern "C"
 {
   void UARTE0_UART0_IRQHandler()
   {
+    dbgIsrEnter();
     SERIAL_PORT_HARDWARE.IrqHandler();
+    dbgIsrExit();
   }
 }
 
@@ -276,7 +281,9 @@ extern "C"
 {
   void UARTE1_IRQHandler()
   {
+    dbgIsrEnter();
     Serial2.IrqHandler();
+    dbgIsrExit();
   }
 }
 #endif
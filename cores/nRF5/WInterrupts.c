@@ -40,14 +40,36 @@
 static voidFuncPtr callbacksInt[NUMBER_OF_GPIO_TE];
 static bool callbackDeferred[NUMBER_OF_GPIO_TE];
 static int8_t channelMap[NUMBER_OF_GPIO_TE];
+static gpioteHandler_t channelHandler[NUMBER_OF_GPIO_TE];
 static int enabled = 0;
 
+// channel allocated with gpioteChannelAlloc()
+#define CHANNEL_RESERVED  (-2)
+
+// PORT event mode: per pin SENSE with DETECT in latched mode (LDETECT)
+static NRF_GPIO_Type* const portReg[GPIO_COUNT] = {
+  NRF_P0,
+#if GPIO_COUNT > 1
+  NRF_P1,
+#endif
+};
+
+static voidFuncPtr portCallbacks[GPIO_COUNT*32];
+static uint32_t portPinMask[GPIO_COUNT];
+static uint32_t portRisingMask[GPIO_COUNT];
+static uint32_t portFallingMask[GPIO_COUNT];
+static uint32_t portDeferredMask[GPIO_COUNT];
+
 /* Configure I/O interrupt sources */
 static void __initialize()
 {
   memset(callbacksInt, 0, sizeof(callbacksInt));
   memset(channelMap, -1, sizeof(channelMap));
   memset(callbackDeferred, 0, sizeof(callbackDeferred));
+  memset(channelHandler, 0, sizeof(channelHandler));
+
+  memset(portCallbacks, 0, sizeof(portCallbacks));
+  memset(portPinMask, 0, sizeof(portPinMask));
 
   NVIC_DisableIRQ(GPIOTE_IRQn);
   NVIC_ClearPendingIRQ(GPIOTE_IRQn);
@@ -55,6 +77,79 @@ static void __initialize()
   NVIC_EnableIRQ(GPIOTE_IRQn);
 }
 
+static void __detachChannel(uint32_t pin)
+{
+  for (int ch = 0; ch < NUMBER_OF_GPIO_TE; ch++) {
+    if ((uint32_t)channelMap[ch] == pin) {
+      NRF_GPIOTE->INTENCLR = (1 << ch);
+      NRF_GPIOTE->CONFIG[ch] = 0;
+      NRF_GPIOTE->EVENTS_IN[ch] = 0; // clear any final events
+
+      // now cleanup the rest of the use of the channel
+      channelMap[ch] = -1;
+      callbacksInt[ch] = NULL;
+      callbackDeferred[ch] = false;
+      break;
+    }
+  }
+}
+
+static void __detachPort(uint32_t pin)
+{
+  uint32_t const p   = pin >> 5;
+  uint32_t const bit = 1UL << (pin & 0x1F);
+
+  if (p >= GPIO_COUNT || !(portPinMask[p] & bit)) return;
+
+  NVIC_DisableIRQ(GPIOTE_IRQn);
+
+  portPinMask[p]      &= ~bit;
+  portRisingMask[p]   &= ~bit;
+  portFallingMask[p]  &= ~bit;
+  portDeferredMask[p] &= ~bit;
+  portCallbacks[pin]   = NULL;
+
+  nrf_gpio_cfg_sense_set(pin, NRF_GPIO_PIN_NOSENSE);
+  portReg[p]->LATCH = bit;
+
+  bool inUse = false;
+  for (int i = 0; i < GPIO_COUNT; i++) inUse = inUse || portPinMask[i];
+  if (!inUse) NRF_GPIOTE->INTENCLR = GPIOTE_INTENCLR_PORT_Msk;
+
+  NVIC_EnableIRQ(GPIOTE_IRQn);
+}
+
+static int __attachPort(uint32_t pin, voidFuncPtr callback, uint32_t mode, bool deferred)
+{
+  uint32_t const p   = pin >> 5;
+  uint32_t const bit = 1UL << (pin & 0x1F);
+  NRF_GPIO_Type* port = portReg[p];
+
+  NVIC_DisableIRQ(GPIOTE_IRQn);
+
+  portCallbacks[pin] = callback;
+  portPinMask[p] |= bit;
+
+  if (mode != FALLING) portRisingMask[p]   |= bit; else portRisingMask[p]   &= ~bit;
+  if (mode != RISING ) portFallingMask[p]  |= bit; else portFallingMask[p]  &= ~bit;
+  if (deferred       ) portDeferredMask[p] |= bit; else portDeferredMask[p] &= ~bit;
+
+  // Arm for the edge leaving current level, then clear stale latch
+  nrf_gpio_cfg_sense_set(pin, nrf_gpio_pin_read(pin) ? NRF_GPIO_PIN_SENSE_LOW : NRF_GPIO_PIN_SENSE_HIGH);
+  port->LATCH = bit;
+  port->DETECTMODE = GPIO_DETECTMODE_DETECTMODE_LDETECT;
+
+  NRF_GPIOTE->INTENSET = GPIOTE_INTENSET_PORT_Msk;
+
+  NVIC_ClearPendingIRQ(GPIOTE_IRQn);
+  NVIC_EnableIRQ(GPIOTE_IRQn);
+
+  // DETECT may have been asserted already by other pins before PORT event is enabled
+  if (port->LATCH & portPinMask[p]) NVIC_SetPendingIRQ(GPIOTE_IRQn);
+
+  return GPIOTE_INTENSET_PORT_Msk;
+}
+
 /*
  * \brief Specifies a named Interrupt Service Routine (ISR) to call when an interrupt occurs.
  *        Replaces any previous function that was attached to the interrupt.
@@ -75,7 +170,8 @@ int attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
   pin = g_ADigitalPinMap[pin];
 
   bool deferred = (mode & ISR_DEFERRED) ? true : false;
-  mode &= ~ISR_DEFERRED;
+  bool portMode = (mode & ISR_PORT) ? true : false;
+  mode &= ~(ISR_DEFERRED | ISR_PORT);
 
   uint32_t polarity;
 
@@ -96,6 +192,11 @@ int attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
       return 0;
   }
 
+  if (portMode) {
+    __detachChannel(pin);
+    return __attachPort(pin, callback, mode, deferred);
+  }
+
   // All information for the configuration is known, except the prior values
   // of the config register.  Pre-compute the mask and new bits for later use.
   //     CONFIG[n] = (CONFIG[n] & oldRegMask) | newRegBits;
@@ -127,11 +228,13 @@ int attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
       break;
     }
   }
-  // if no channel found, exit
+  // if no channel found, fall back to PORT event
   if (ch == -1) {
-    return 0; // no channel available
+    return __attachPort(pin, callback, mode, deferred);
   }
 
+  __detachPort(pin);
+
   channelMap[ch]         = pin;      // harmless for existing channel
   callbacksInt[ch]       = callback; // caller might be updating this for existing channel
   callbackDeferred[ch]   = deferred; // caller might be updating this for existing channel
@@ -162,17 +265,141 @@ void detachInterrupt(uint32_t pin)
 
   pin = g_ADigitalPinMap[pin];
 
+  __detachChannel(pin);
+  __detachPort(pin);
+}
+
+// nRF52 allows only one GPIOTE channel per pin
+static bool __pinHasChannel(uint32_t pin)
+{
   for (int ch = 0; ch < NUMBER_OF_GPIO_TE; ch++) {
-    if ((uint32_t)channelMap[ch] == pin) {
-      NRF_GPIOTE->INTENCLR = (1 << ch);
-      NRF_GPIOTE->CONFIG[ch] = 0;
-      NRF_GPIOTE->EVENTS_IN[ch] = 0; // clear any final events
+    uint32_t const config = NRF_GPIOTE->CONFIG[ch];
+    if ((config & GPIOTE_CONFIG_MODE_Msk) == (GPIOTE_CONFIG_MODE_Disabled << GPIOTE_CONFIG_MODE_Pos)) continue;
+    if (((config & GPIOTE_CONFIG_PORT_PIN_Msk) >> GPIOTE_CONFIG_PSEL_Pos) == pin) return true;
+  }
 
-      // now cleanup the rest of the use of the channel
-      channelMap[ch] = -1;
-      callbacksInt[ch] = NULL;
-      callbackDeferred[ch] = false;
-      break;
+  return false;
+}
+
+int gpioteChannelAlloc(uint32_t pin, uint32_t polarity, gpioteHandler_t handler)
+{
+  if (!enabled) {
+    __initialize();
+    enabled = 1;
+  }
+
+  if (__pinHasChannel(pin)) {
+    return -1;
+  }
+
+  int ch = -1;
+  for (int i = 0; i < NUMBER_OF_GPIO_TE; i++) {
+    if (channelMap[i] != -1) continue;
+    if (nrf_gpiote_te_is_enabled(NRF_GPIOTE, i)) continue;
+
+    ch = i;
+    break;
+  }
+  if (ch == -1) {
+    return -1;
+  }
+
+  channelMap[ch]     = CHANNEL_RESERVED;
+  channelHandler[ch] = handler;
+
+  NRF_GPIOTE->CONFIG[ch] =
+    ((pin                      << GPIOTE_CONFIG_PSEL_Pos    ) & GPIOTE_CONFIG_PORT_PIN_Msk) |
+    ((polarity                 << GPIOTE_CONFIG_POLARITY_Pos) & GPIOTE_CONFIG_POLARITY_Msk) |
+    ((GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos    ) & GPIOTE_CONFIG_MODE_Msk    ) ;
+  NRF_GPIOTE->EVENTS_IN[ch] = 0;
+
+  if (handler) {
+    NRF_GPIOTE->INTENSET = (1 << ch);
+  }
+
+  return ch;
+}
+
+int gpioteTaskChannelAlloc(uint32_t pin, uint32_t init_high)
+{
+  if (!enabled) {
+    __initialize();
+    enabled = 1;
+  }
+
+  for (int ch = 0; ch < NUMBER_OF_GPIO_TE; ch++) {
+    if (channelMap[ch] != -1) continue;
+    if (nrf_gpiote_te_is_enabled(NRF_GPIOTE, ch)) continue;
+
+    channelMap[ch]     = CHANNEL_RESERVED;
+    channelHandler[ch] = NULL;
+
+    NRF_GPIOTE->CONFIG[ch] =
+      ((pin                      << GPIOTE_CONFIG_PSEL_Pos    ) & GPIOTE_CONFIG_PORT_PIN_Msk) |
+      ((GPIOTE_CONFIG_POLARITY_None << GPIOTE_CONFIG_POLARITY_Pos) & GPIOTE_CONFIG_POLARITY_Msk) |
+      ((init_high ? GPIOTE_CONFIG_OUTINIT_High : GPIOTE_CONFIG_OUTINIT_Low) << GPIOTE_CONFIG_OUTINIT_Pos) |
+      ((GPIOTE_CONFIG_MODE_Task  << GPIOTE_CONFIG_MODE_Pos    ) & GPIOTE_CONFIG_MODE_Msk    ) ;
+
+    return ch;
+  }
+
+  return -1;
+}
+
+void gpioteChannelPolarity(int ch, uint32_t polarity)
+{
+  NRF_GPIOTE->CONFIG[ch] = (NRF_GPIOTE->CONFIG[ch] & ~GPIOTE_CONFIG_POLARITY_Msk) |
+                           ((polarity << GPIOTE_CONFIG_POLARITY_Pos) & GPIOTE_CONFIG_POLARITY_Msk);
+}
+
+void gpioteChannelFree(int ch)
+{
+  if (ch < 0 || ch >= NUMBER_OF_GPIO_TE || channelMap[ch] != CHANNEL_RESERVED) {
+    return;
+  }
+
+  NRF_GPIOTE->INTENCLR = (1 << ch);
+  NRF_GPIOTE->CONFIG[ch] = 0;
+  NRF_GPIOTE->EVENTS_IN[ch] = 0;
+
+  channelHandler[ch] = NULL;
+  channelMap[ch] = -1;
+}
+
+static void __handlePortEvent(void)
+{
+  for (int p = 0; p < GPIO_COUNT; p++) {
+    NRF_GPIO_Type* port = portReg[p];
+    uint32_t latch;
+
+    // Clearing a LATCH bit has no effect while its SENSE condition is still met,
+    // re-read until all latches settle so that DETECT can generate next PORT event.
+    while ( 0 != (latch = port->LATCH & portPinMask[p]) ) {
+      while (latch) {
+        uint32_t const i   = __builtin_ctz(latch);
+        uint32_t const bit = 1UL << i;
+        latch &= ~bit;
+
+        // Edge is known from armed SENSE, re-arm for the opposite one before
+        // clearing latch: a short pulse is still reported as both edges.
+        uint32_t const cnf = port->PIN_CNF[i];
+        bool const rising = ((cnf & GPIO_PIN_CNF_SENSE_Msk) >> GPIO_PIN_CNF_SENSE_Pos) == GPIO_PIN_CNF_SENSE_High;
+        uint32_t const sense = rising ? GPIO_PIN_CNF_SENSE_Low : GPIO_PIN_CNF_SENSE_High;
+
+        port->PIN_CNF[i] = (cnf & ~GPIO_PIN_CNF_SENSE_Msk) | (sense << GPIO_PIN_CNF_SENSE_Pos);
+        port->LATCH = bit;
+
+        if ( 0 == ((rising ? portRisingMask[p] : portFallingMask[p]) & bit) ) continue;
+
+        voidFuncPtr const callback = portCallbacks[p*32 + i];
+        if (callback) {
+          if (portDeferredMask[p] & bit) {
+            ada_callback(NULL, 0, callback);
+          } else {
+            callback();
+          }
+        }
+      }
     }
   }
 }
@@ -182,17 +409,29 @@ void GPIOTE_IRQHandler()
 #if CFG_SYSVIEW
   SEGGER_SYSVIEW_RecordEnterISR();
 #endif
+  dbgIsrEnter();
 
   // Read this once (not 8x), as it's a volatile read
   // across the AHB, which adds up to 3 cycles.
   uint32_t const enabledInterruptMask = NRF_GPIOTE->INTENSET;
-  for (int ch = 0; ch < NUMBER_OF_GPIO_TE; ch++) {
-    // only process where the interrupt is enabled and the event register is set
-    // check interrupt enabled mask first, as already read that IOM value, to
-    // reduce delays from AHB (16MHz) reads.
-    if ( 0 == (enabledInterruptMask & (1 << ch))) continue;
+
+  // only visit channels whose interrupt is enabled, to reduce delays from AHB (16MHz) reads
+  uint32_t chMask = enabledInterruptMask & ((1UL << NUMBER_OF_GPIO_TE) - 1);
+  while (chMask) {
+    int const ch = __builtin_ctz(chMask);
+    chMask &= chMask - 1;
+
     if ( 0 == NRF_GPIOTE->EVENTS_IN[ch]) continue;
 
+    if (channelMap[ch] == CHANNEL_RESERVED) {
+      // clear first: handler may also poll and clear other reserved channels
+      NRF_GPIOTE->EVENTS_IN[ch] = 0;
+      if (channelHandler[ch]) {
+        channelHandler[ch](ch);
+      }
+      continue;
+    }
+
     // If the event was set and interrupts are enabled,
     // call the callback function only if it exists,
     // but ALWAYS clear the event to prevent an interrupt storm.
@@ -208,6 +447,11 @@ void GPIOTE_IRQHandler()
     // clear the event
     NRF_GPIOTE->EVENTS_IN[ch] = 0;
   }
+
+  if ( (enabledInterruptMask & GPIOTE_INTENSET_PORT_Msk) && NRF_GPIOTE->EVENTS_PORT ) {
+    NRF_GPIOTE->EVENTS_PORT = 0;
+    __handlePortEvent();
+  }
 #if __CORTEX_M == 0x04
   // See note at nRF52840_PS_v1.1.pdf section 6.1.8 ("interrupt clearing")
   // See also https://gcc.gnu.org/onlinedocs/gcc/Volatiles.html for why
@@ -215,6 +459,7 @@ void GPIOTE_IRQHandler()
   __DSB(); __NOP();__NOP();__NOP();__NOP();
 #endif
 
+  dbgIsrExit();
 #if CFG_SYSVIEW
   SEGGER_SYSVIEW_RecordExitISR();
 #endif
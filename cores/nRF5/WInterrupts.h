@@ -33,6 +33,13 @@ extern "C" {
 
 #define ISR_DEFERRED  0x0100
 
+// Use GPIOTE PORT event with per pin SENSE instead of a GPIOTE IN channel.
+// Available on all pins and does not keep HFCLK running in sleep, but edges
+// closer together than the ISR latency are merged. Also used automatically
+// when all 8 IN channels are taken. Pins configured with one of
+// the *_SENSE pinMode for System OFF wakeup should not be mixed with it.
+#define ISR_PORT      0x0200
+
 //#define DEFAULT 1
 #define EXTERNAL 0
 
@@ -51,6 +58,31 @@ int attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode);
  */
 void detachInterrupt(uint32_t pin);
 
+/*
+ * Internal: GPIOTE IN channel on a nRF pin (not Arduino pin) to drive PPI, e.g TIMER capture.
+ * polarity is GPIOTE_CONFIG_POLARITY_*, optional handler is invoked in ISR on each event.
+ * nRF52 allows only one channel per pin, use Toggle or re-arm with gpioteChannelPolarity()
+ * to get both edges.
+ * \return channel number, or -1 if all are in use or pin already has a channel
+ */
+typedef void (*gpioteHandler_t)(uint8_t ch);
+
+int  gpioteChannelAlloc(uint32_t pin, uint32_t polarity, gpioteHandler_t handler);
+
+/*
+ * Internal: change the edge of an IN channel from gpioteChannelAlloc(), e.g from its handler
+ */
+void gpioteChannelPolarity(int ch, uint32_t polarity);
+
+/*
+ * Internal: GPIOTE task channel driving a nRF pin, e.g by TIMER compare through PPI
+ * on its TASKS_SET/TASKS_CLR/TASKS_OUT. Pin starts at init_high level.
+ * \return channel number, or -1 if all are in use
+ */
+int  gpioteTaskChannelAlloc(uint32_t pin, uint32_t init_high);
+
+void gpioteChannelFree(int ch);
+
 #ifdef __cplusplus
 }
 #endif
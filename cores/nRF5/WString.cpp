@@ -22,6 +22,13 @@
 #include "WString.h"
 #include "itoa.h"
 #include "avr/dtostrf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_heap.h"
+
+#define STRING_ARENA_TLS_INDEX	0
+
+static StringAllocStats _alloc_stats;
 
 /*********************************************/
 /*  Constructors                             */
@@ -123,7 +130,7 @@ String::String(double value, unsigned char decimalPlaces)
 
 String::~String()
 {
-	free(buffer);
+	freeBuffer();
 }
 
 /*********************************************/
@@ -135,11 +142,34 @@ inline void String::init(void)
 	buffer = NULL;
 	capacity = 0;
 	len = 0;
+	arena = StringArena::current();
+}
+
+StringAllocStats String::getAllocStats(void)
+{
+	return _alloc_stats;
+}
+
+void String::resetAllocStats(void)
+{
+	memset(&_alloc_stats, 0, sizeof(_alloc_stats));
+}
+
+void String::freeBuffer(void)
+{
+	if (!buffer || buffer == sso) return;
+
+	if (arena && arena->contains(buffer)) {
+		arena->release(buffer, capacity + 1);
+	} else {
+		rtos_free(buffer);
+		_alloc_stats.heap_free++;
+	}
 }
 
 void String::invalidate(void)
 {
-	if (buffer) free(buffer);
+	freeBuffer();
 	buffer = NULL;
 	capacity = len = 0;
 }
@@ -156,13 +186,69 @@ unsigned char String::reserve(unsigned int size)
 
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-	char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
-	if (newbuffer) {
+	// Short string: inline storage, only reached when buffer is not allocated yet
+	// since allocated buffers are always larger than inline one
+	if (maxStrLen < sizeof(sso) && (!buffer || buffer == sso)) {
+		buffer = sso;
+		capacity = sizeof(sso) - 1;
+		_alloc_stats.inline_use++;
+		return 1;
+	}
+
+	// Growing non-empty string (e.g concatenation): double capacity to amortize copies
+	unsigned int newcap = maxStrLen;
+	if (len && newcap < 2*capacity) newcap = 2*capacity;
+
+	char *newbuffer = NULL;
+
+	if (arena) {
+		if (buffer && arena->contains(buffer)) {
+			newbuffer = (char*) arena->grow(buffer, capacity + 1, newcap + 1);
+			if (newbuffer) {
+				_alloc_stats.arena_alloc++;
+				capacity = newcap;
+				return 1;
+			}
+		}
+
+		newbuffer = (char*) arena->alloc(newcap + 1);
+		if (newbuffer) _alloc_stats.arena_alloc++;
+	}
+
+	if (!newbuffer && buffer && buffer != sso && !(arena && arena->contains(buffer))) {
+		// heap buffer: resize in place if possible
+		newbuffer = (char *)rtos_realloc_tag(buffer, newcap + 1, HEAP_TAG_STRING);
+		if (!newbuffer && newcap != maxStrLen) {
+			newcap = maxStrLen;
+			newbuffer = (char *)rtos_realloc_tag(buffer, newcap + 1, HEAP_TAG_STRING);
+		}
+		if (!newbuffer) return 0;
+
+		_alloc_stats.heap_alloc++;
 		buffer = newbuffer;
-		capacity = maxStrLen;
+		capacity = newcap;
 		return 1;
 	}
-	return 0;
+
+	if (!newbuffer) {
+		newbuffer = (char *)rtos_malloc_tag(newcap + 1, HEAP_TAG_STRING);
+		if (!newbuffer && newcap != maxStrLen) {
+			newcap = maxStrLen;
+			newbuffer = (char *)rtos_malloc_tag(newcap + 1, HEAP_TAG_STRING);
+		}
+		if (!newbuffer) return 0;
+		_alloc_stats.heap_alloc++;
+	}
+
+	// move content from inline storage or arena
+	if (buffer) {
+		memcpy(newbuffer, buffer, len + 1);
+		freeBuffer();
+	}
+
+	buffer = newbuffer;
+	capacity = newcap;
+	return 1;
 }
 
 /*********************************************/
@@ -176,7 +262,8 @@ String & String::copy(const char *cstr, unsigned int length)
 		return *this;
 	}
 	len = length;
-	strcpy(buffer, cstr);
+	memcpy(buffer, cstr, length);
+	buffer[len] = 0;
 	return *this;
 }
 
@@ -194,16 +281,25 @@ String & String::copy(const __FlashStringHelper *pstr, unsigned int length)
 #if __cplusplus >= 201103L || defined(__GXX_EXPERIMENTAL_CXX0X__)
 void String::move(String &rhs)
 {
-	if (buffer) {
-		if (capacity >= rhs.len) {
-			strcpy(buffer, rhs.buffer);
-			len = rhs.len;
-			rhs.len = 0;
-			return;
-		} else {
-			free(buffer);
-		}
+	if (!rhs.buffer) {
+		invalidate();
+		return;
+	}
+
+	// Only a heap buffer can be taken over. Arena buffers are always copied:
+	// even with the same arena, this string may outlive its scope
+	bool const rhs_in_arena = rhs.arena && rhs.arena->contains(rhs.buffer);
+	bool const stealable = (rhs.buffer != rhs.sso) && !rhs_in_arena;
+
+	if ((buffer && capacity >= rhs.len) || !stealable) {
+		copy(rhs.buffer, rhs.len);
+		rhs.len = 0;
+		rhs.buffer[0] = 0;
+		return;
 	}
+
+	freeBuffer();
+
 	buffer = rhs.buffer;
 	capacity = rhs.capacity;
 	len = rhs.len;
@@ -268,8 +364,9 @@ unsigned char String::concat(const char *cstr, unsigned int length)
 	if (!cstr) return 0;
 	if (length == 0) return 1;
 	if (!reserve(newlen)) return 0;
-	strcpy(buffer + len, cstr);
+	memcpy(buffer + len, cstr, length);
 	len = newlen;
+	buffer[len] = 0;
 	return 1;
 }
 
@@ -754,3 +851,64 @@ float String::toFloat(void) const
 	if (buffer) return float(atof(buffer));
 	return 0;
 }
+
+/*********************************************/
+/*  Arena                                    */
+/*********************************************/
+
+// Arena is kept per task in thread local storage, outside of any task
+// (scheduler not started) a single global one is used
+static StringArena *_arena_no_task = NULL;
+
+static inline bool arena_in_task(void)
+{
+	return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+StringArena* StringArena::current(void)
+{
+	if (!arena_in_task()) return _arena_no_task;
+	return (StringArena*) pvTaskGetThreadLocalStoragePointer(NULL, STRING_ARENA_TLS_INDEX);
+}
+
+StringArena::StringArena(void *buf, size_t size)
+{
+	_buf = (char*) buf;
+	_size = size;
+	_used = 0;
+	_prev = current();
+
+	if (arena_in_task()) vTaskSetThreadLocalStoragePointer(NULL, STRING_ARENA_TLS_INDEX, this);
+	else _arena_no_task = this;
+}
+
+StringArena::~StringArena()
+{
+	if (arena_in_task()) vTaskSetThreadLocalStoragePointer(NULL, STRING_ARENA_TLS_INDEX, _prev);
+	else _arena_no_task = _prev;
+}
+
+void* StringArena::alloc(size_t size)
+{
+	if (size > _size - _used) return NULL;
+
+	void *ptr = _buf + _used;
+	_used += size;
+	return ptr;
+}
+
+void* StringArena::grow(void *ptr, size_t oldsize, size_t newsize)
+{
+	// only the last allocation can be extended
+	if ((char*) ptr + oldsize != _buf + _used) return NULL;
+	if (newsize - oldsize > _size - _used) return NULL;
+
+	_used += newsize - oldsize;
+	return ptr;
+}
+
+void StringArena::release(void *ptr, size_t size)
+{
+	// only the last allocation can be given back, the rest is freed with the arena
+	if ((char*) ptr + size == _buf + _used) _used -= size;
+}
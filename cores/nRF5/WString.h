@@ -41,6 +41,23 @@ class __FlashStringHelper;
 // result objects are assumed to be writable by subsequent concatenations.
 class StringSumHelper;
 
+// Scoped allocator for temporary strings, see below
+class StringArena;
+
+// Strings shorter than this (including the '\0') are stored inside the
+// object itself without any heap allocation
+#ifndef STRING_SSO_SIZE
+#define STRING_SSO_SIZE		16
+#endif
+
+// Allocation counters of all String objects
+struct StringAllocStats {
+	unsigned long heap_alloc;	// malloc() + realloc() calls
+	unsigned long heap_free;
+	unsigned long arena_alloc;	// allocations served by a StringArena
+	unsigned long inline_use;	// buffer requests served by inline storage
+};
+
 // The string class
 class String
 {
@@ -80,6 +97,9 @@ public:
 	unsigned char reserve(unsigned int size);
 	inline unsigned int length(void) const {return len;}
 
+	static StringAllocStats getAllocStats(void);
+	static void resetAllocStats(void);
+
 	// creates a copy of the assigned value.  if the value is null or
 	// invalid, or if the memory allocation fails, the string will be
 	// marked as invalid ("if (s)" will be false).
@@ -191,9 +211,12 @@ protected:
 	char *buffer;	        // the actual char array
 	unsigned int capacity;  // the array length minus one (for the '\0')
 	unsigned int len;       // the String length (not counting the '\0')
+	StringArena *arena;     // arena active when constructed, NULL for heap
+	char sso[STRING_SSO_SIZE]; // inline storage for short strings
 protected:
 	void init(void);
 	void invalidate(void);
+	void freeBuffer(void);
 	unsigned char changeBuffer(unsigned int maxStrLen);
 	unsigned char concat(const char *cstr, unsigned int length);
 
@@ -220,5 +243,55 @@ public:
 	StringSumHelper(double num) : String(num) {}
 };
 
+// Bump allocator for temporary strings. While an arena is in scope, Strings
+// constructed by the same task allocate from it instead of the heap, and all
+// of it is released at once when the arena goes out of scope. Strings created
+// within the scope must not outlive it; arena buffers are always copied when
+// moved or assigned, never taken over. Falls back to heap when full.
+//
+// Returning a String from the function that owns the arena is not safe: with
+// NRVO the returned String is the one built in the arena. Keep the arena in
+// an inner block and copy the result out to a String declared before it.
+//
+//   String line;
+//   {
+//     char mem[256];
+//     StringArena arena(mem, sizeof(mem));
+//     line = "t=" + String(millis()) + ",v=" + String(v, 2);
+//   }
+//   return line;
+class StringArena
+{
+public:
+	StringArena(void *buf, size_t size);
+	~StringArena();
+
+	void* alloc(size_t size);
+	void* grow(void *ptr, size_t oldsize, size_t newsize); // NULL if not possible
+	void  release(void *ptr, size_t size);
+	bool  contains(const void *ptr) const { return (const char*) ptr >= _buf && (const char*) ptr < _buf + _size; }
+
+	size_t used(void) const { return _used; }
+	size_t size(void) const { return _size; }
+
+	static StringArena* current(void);
+
+private:
+	char *_buf;
+	size_t _size;
+	size_t _used;
+	StringArena *_prev;	// outer arena of the same task
+};
+
+template <size_t N>
+class StringArenaN : public StringArena
+{
+public:
+	StringArenaN(void) : StringArena(_storage, N) {}
+
+private:
+	char _storage[N];
+};
+
 #endif  // __cplusplus
 #endif  // String_class_h
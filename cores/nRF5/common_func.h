@@ -151,6 +151,8 @@
 //--------------------------------------------------------------------+
 const char* dbg_err_str(int32_t err_id); // TODO move to other place
 
+#include "utility/adalog.h"
+
 #if __cplusplus
   #define PRINTF    ::printf
 #else
@@ -202,12 +204,17 @@ const char* dbg_err_str(int32_t err_id); // TODO move to other place
     PRINTF("\r\n");\
   }while(0)
 
+#if CFG_ADALOG_DEFERRED
+// record into RAM ring, formatted later by drain task or host decoder
+#define ADALOG(tag, ...)      ADALOG_DEFERRED(tag, __VA_ARGS__)
+#else
 #define ADALOG(tag, ...) \
   do { \
     if ( tag ) PRINTF("[%-6s] ", tag);\
     PRINTF(__VA_ARGS__);\
     PRINTF("\r\n");\
   }while(0)
+#endif
 
 #define ADALOG_BUFFER(_tag, _buf, _n) \
   do {\
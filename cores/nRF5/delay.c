@@ -48,6 +48,122 @@ void delay( uint32_t ms )
   vTaskDelay(ticks);
 }
 
+//--------------------------------------------------------------------+
+// 64-bit clock
+//--------------------------------------------------------------------+
+#define HRCLOCK_RTC             NRF_RTC2
+#define HRCLOCK_IRQn            RTC2_IRQn
+#define HRCLOCK_HZ              32768UL
+#define HRCLOCK_CYCLES_MAX      (F_CPU/HRCLOCK_HZ - 1) // cycles within one RTC period
+
+static volatile uint32_t _hrclock_overflow = 0;
+
+// RTC count and DWT cycles when RTC count was first seen changing, used for interpolation.
+// This lags the actual RTC tick by however long no one read the clock, up to one RTC period
+static uint64_t _hrclock_sync_count = 0;
+static uint32_t _hrclock_sync_cycle = 0;
+
+void hrclock_init(void)
+{
+  HRCLOCK_RTC->TASKS_STOP  = 1;
+  HRCLOCK_RTC->TASKS_CLEAR = 1;
+  HRCLOCK_RTC->PRESCALER   = 0;
+  HRCLOCK_RTC->EVENTS_OVRFLW = 0;
+  HRCLOCK_RTC->INTENSET    = RTC_INTENSET_OVRFLW_Msk;
+
+  NVIC_ClearPendingIRQ(HRCLOCK_IRQn);
+  NVIC_SetPriority(HRCLOCK_IRQn, 3);
+  NVIC_EnableIRQ(HRCLOCK_IRQn);
+
+  HRCLOCK_RTC->TASKS_START = 1;
+}
+
+void RTC2_IRQHandler(void)
+{
+  if ( HRCLOCK_RTC->EVENTS_OVRFLW )
+  {
+    HRCLOCK_RTC->EVENTS_OVRFLW = 0;
+    (void) HRCLOCK_RTC->EVENTS_OVRFLW; // read back to make sure event is cleared before exit
+
+    _hrclock_overflow++;
+  }
+}
+
+// 64-bit RTC count, must be called with interrupt masked
+static inline uint64_t hrclock_count64(void)
+{
+  uint32_t ovf = _hrclock_overflow;
+  uint32_t cnt = HRCLOCK_RTC->COUNTER;
+
+  // overflow is pending but not yet handled by ISR, counter could be read before or after wrapping
+  if ( HRCLOCK_RTC->EVENTS_OVRFLW )
+  {
+    cnt = HRCLOCK_RTC->COUNTER;
+    ovf++;
+  }
+
+  return (((uint64_t) ovf) << 24) | cnt;
+}
+
+uint32_t hrclock_count(void)
+{
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint32_t const count = (uint32_t) hrclock_count64();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  return count;
+}
+
+// Get 64-bit RTC count and cycles elapsed within current RTC period (0 if DWT is disabled)
+static void hrclock_read(uint64_t* count, uint32_t* cycles)
+{
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  uint64_t const cnt64 = hrclock_count64();
+  uint32_t sub = 0;
+
+  if ( dwt_enabled() )
+  {
+    uint32_t const cyc = DWT->CYCCNT;
+
+    if ( cnt64 != _hrclock_sync_count )
+    {
+      _hrclock_sync_count = cnt64;
+      _hrclock_sync_cycle = cyc;
+    }else
+    {
+      // capped to stay monotonic when RTC count moves on
+      sub = cyc - _hrclock_sync_cycle;
+      if ( sub > HRCLOCK_CYCLES_MAX ) sub = HRCLOCK_CYCLES_MAX;
+    }
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  *count  = cnt64;
+  *cycles = sub;
+}
+
+uint64_t micros64( void )
+{
+  uint64_t count;
+  uint32_t cycles;
+  hrclock_read(&count, &cycles);
+
+  // 1000000/32768 = 15625/512
+  return ((count * 15625) >> 9) + cycles / (F_CPU/1000000);
+}
+
+uint64_t nanos( void )
+{
+  uint64_t count;
+  uint32_t cycles;
+  hrclock_read(&count, &cycles);
+
+  // 1000000000/32768 = 1953125/64
+  return ((count * 1953125) >> 6) + (cycles * 1000UL) / (F_CPU/1000000);
+}
+
 void dwt_enable(void)
 {
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; /* Global Enable for DWT */
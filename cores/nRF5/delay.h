@@ -43,23 +43,45 @@ static inline bool dwt_enabled(void)
  */
 extern uint32_t millis( void ) ;
 
+/**
+ * \brief Returns the number of microseconds since the board began running, as 64-bit value.
+ *
+ * Based on RTC2 clocked by LFCLK (32768 Hz), it keeps counting while the CPU sleeps in
+ * tickless idle. Resolution is 30.5 us. If DWT is enabled with dwt_enable(), time within
+ * an RTC period is interpolated with the cycle counter: consecutive reads then differ by
+ * ~1 us, but interpolation starts when a read first sees the RTC count change rather than
+ * at the RTC tick itself, so absolute accuracy stays within one RTC period (30.5 us).
+ * Monotonic and safe to call from ISR, e.g to timestamp events.
+ *
+ * \note RTC2 and RTC2_IRQHandler() are owned by the core, sketches can't use them.
+ */
+extern uint64_t micros64( void );
+
+/**
+ * \brief Same as micros64() in nanoseconds.
+ */
+extern uint64_t nanos( void );
+
 /**
  * \brief Returns the number of microseconds since the Arduino board began running the current program.
  *
- * This number will overflow (go back to zero), after approximately 70 minutes. On 16 MHz Arduino boards
- * (e.g. Duemilanove and Nano), this function has a resolution of four microseconds (i.e. the value returned is
- * always a multiple of four). On 8 MHz Arduino boards (e.g. the LilyPad), this function has a resolution
- * of eight microseconds.
+ * This number will overflow (go back to zero), after approximately 70 minutes.
+ * See micros64() for resolution.
  *
  * \note There are 1,000 microseconds in a millisecond and 1,000,000 microseconds in a second.
  */
 static inline uint32_t micros( void ) __attribute__((always_inline));
 static inline uint32_t micros( void )
 {
-  // Use DWT cycle count if it is enabled, otherwise use rtos tick
-  return dwt_enabled() ? (DWT->CYCCNT / 64) : tick2us(xTaskGetTickCount());
+  return (uint32_t) micros64();
 }
 
+// Internal: start RTC2 used by micros64(), called by init()
+void hrclock_init(void);
+
+// Raw 32768 Hz count of micros64() clock (wraps every ~36 hours), used for rtos run time stats
+uint32_t hrclock_count(void);
+
 /**
  * \brief Pauses the program for the amount of time (in miliseconds) specified as parameter.
  * (There are 1000 milliseconds in a second.)
@@ -38,6 +38,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 /* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
 all the API functions to use the MPU wrappers.  That should only be done when
@@ -49,37 +50,50 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#include "rtos_heap.h"
+
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
 	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
 /*-----------------------------------------------------------*/
 
-// link to libnano's malloc
-// require "-Wl,--wrap=malloc -Wl,--wrap=free" linker option
-extern void *__real_malloc(size_t size);
-extern void __real_free(void *ptr);
-
+// malloc() family of application and libraries goes to the rtos heap, which picks
+// pool or newlib (_malloc_r, not wrapped) itself and frees each pointer where it belongs.
+// require "-Wl,--wrap=malloc -Wl,--wrap=free -Wl,--wrap=realloc -Wl,--wrap=calloc"
+// linker option (platform.txt)
 void* __wrap_malloc (size_t c)
 {
-  return (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ? pvPortMalloc(c) : __real_malloc(c);
+  return rtos_malloc(c);
 }
 
 void __wrap_free (void *ptr)
 {
-  return (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ? vPortFree(ptr) : __real_free(ptr);
+  rtos_free(ptr);
+}
+
+void* __wrap_realloc (void *ptr, size_t c)
+{
+  return rtos_realloc_tag(ptr, c, HEAP_TAG_APP);
+}
+
+void* __wrap_calloc (size_t n, size_t c)
+{
+  if ( c && n > ((size_t) -1) / c ) return NULL;
+
+  void* ptr = rtos_malloc(n*c);
+  if ( ptr ) memset(ptr, 0, n*c);
+
+  return ptr;
 }
 
 void *pvPortMalloc( size_t xWantedSize )
 {
 void *pvReturn;
 
-	vTaskSuspendAll();
-	{
-		pvReturn = __real_malloc( xWantedSize );
-		traceMALLOC( pvReturn, xWantedSize );
-	}
-	( void ) xTaskResumeAll();
+	/* rtos heap does its own locking, kernel objects are tagged for statistics */
+	pvReturn = rtos_malloc_tag( xWantedSize, HEAP_TAG_RTOS );
+	traceMALLOC( pvReturn, xWantedSize );
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
 	{
@@ -99,11 +113,7 @@ void vPortFree( void *pv )
 {
 	if( pv )
 	{
-		vTaskSuspendAll();
-		{
-			__real_free( pv );
-			traceFREE( pv, 0 );
-		}
-		( void ) xTaskResumeAll();
+		rtos_free( pv );
+		traceFREE( pv, 0 );
 	}
 }
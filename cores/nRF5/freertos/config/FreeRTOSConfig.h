@@ -72,14 +72,23 @@
 #define configSUPPORT_STATIC_ALLOCATION                          1
 #define configSUPPORT_DYNAMIC_ALLOCATION                         1
 
+/* Thread local storage
+ * - 0: task's active StringArena
+ * - 1: context switch count for run time stats */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS                  2
+#define configSTATS_SWITCH_TLS_INDEX                             1
+
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                                      1
 #define configUSE_TICK_HOOK                                      0
 #define configCHECK_FOR_STACK_OVERFLOW                           1
 #define configUSE_MALLOC_FAILED_HOOK                             1
 
-/* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS                            0
+/* Run time and task stats gathering related definitions.
+ * Run time counter is RTC2 at 32768 Hz (see micros64()), it keeps running in tickless idle */
+#define configGENERATE_RUN_TIME_STATS                            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                 /* RTC2 is started by init() */
+#define portGET_RUN_TIME_COUNTER_VALUE()                         hrclock_count()
 #define configUSE_TRACE_FACILITY                                 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS                     1
 
@@ -95,6 +104,8 @@
 
 /* Tickless Idle configuration. */
 #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP                    2
+#define configPRE_SLEEP_PROCESSING( x )                          dbgSleepEnter()
+#define configPOST_SLEEP_PROCESSING( x )                         dbgSleepExit()
 
 /* Tickless idle/low power functionality. */
 
@@ -137,6 +148,17 @@
     #else
         #error "This port requires __NVIC_PRIO_BITS to be defined"
     #endif
+
+    /* Run time stats hooks, implemented in delay.c and utility/debug.cpp */
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+    uint32_t hrclock_count(void);
+    void dbgSleepEnter(void);
+    void dbgSleepExit(void);
+    #ifdef __cplusplus
+    }
+    #endif
 #endif /* !assembler */
 
 /* The lowest interrupt priority that can be used in a call to a "set priority" function. */
@@ -200,4 +222,13 @@ standard names - or at least those used in the unmodified vector table. */
 #include "sysview/SEGGER_SYSVIEW_FreeRTOS.h"
 #endif
 
+// Count context switches per task (not available when Sysview takes over the trace hook)
+#ifndef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN() \
+  do { \
+    pxCurrentTCB->pvThreadLocalStoragePointers[configSTATS_SWITCH_TLS_INDEX] = \
+      (void*) (((uintptr_t) pxCurrentTCB->pvThreadLocalStoragePointers[configSTATS_SWITCH_TLS_INDEX]) + 1); \
+  } while(0)
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
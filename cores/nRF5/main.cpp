@@ -84,12 +84,21 @@ int main( void )
   SEGGER_SYSVIEW_Conf();
 #endif
 
+#if CFG_SYSTRACE
+  systrace_init();
+#endif
+
   // Create a task for loop()
   xTaskCreate(loop_task, "loop", LOOP_STACK_SZ, NULL, TASK_PRIO_LOW, &_loopHandle);
 
   // Initialize callback task
   ada_callback_init(CALLBACK_STACK_SZ);
 
+#if CFG_DEBUG && CFG_ADALOG_DEFERRED
+  // Initialize deferred log drain task
+  adalog_init();
+#endif
+
   // Start FreeRTOS scheduler.
   vTaskStartScheduler();
 
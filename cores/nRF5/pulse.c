@@ -19,6 +19,7 @@
 #include "nrf.h"
 
 #include <Arduino.h>
+#include "pulse.h"
 
 // See pulse_asm.S
 extern unsigned long countPulseASM(const volatile uint32_t *port, uint32_t bit, uint32_t stateMask, unsigned long maxloops);
@@ -48,9 +49,16 @@ unsigned long countPulseASM(const volatile uint32_t *port, uint32_t bit, uint32_
 /* Measures the length (in microseconds) of a pulse on the pin; state is HIGH
  * or LOW, the type of pulse to measure.  Works on pulses from 2-3 microseconds
  * to 3 minutes in length, but must be called at least a few dozen microseconds
- * before the start of the pulse. */
+ * before the start of the pulse.
+ *
+ * Edges are timestamped by TIMER capture through PPI while the calling task
+ * sleeps. The busy loop below is only used in ISR, before the scheduler starts
+ * or when no TIMER/GPIOTE/PPI channel is free. */
 uint32_t pulseIn(uint32_t pin, uint32_t state, uint32_t timeout)
 {
+  uint32_t width_us = 0;
+  if ( pulseInCapture(pin, state, timeout, &width_us) ) return width_us;
+
   // cache the port and bit of the pin in order to speed up the
   // pulse width measuring loop and achieve finer resolution.  calling
   // digitalRead() instead yields much coarser resolution.
@@ -27,9 +27,15 @@ extern "C" {
  * or LOW, the type of pulse to measure.  Works on pulses from 2-3 microseconds
  * to 3 minutes in length, but must be called at least a few dozen microseconds
  * before the start of the pulse.
+ * The pulse is timestamped by hardware (62.5 ns resolution) while the calling
+ * task sleeps, unless called from ISR or TIMER/GPIOTE/PPI channels are all in use.
  */
 uint32_t pulseIn(uint32_t pin, uint32_t state, uint32_t timeout);
 
+// Internal: hardware-timed measurement used by pulseIn(), see PulseCapture.cpp.
+// Return false if TIMER/GPIOTE/PPI are not available, pulseIn() then polls the pin.
+bool pulseInCapture(uint32_t pin, uint32_t state, uint32_t timeout, uint32_t* width_us);
+
 #ifdef __cplusplus
 // Provides a version of pulseIn with a default argument (C++ only)
 uint32_t pulseIn(uint32_t pin, uint32_t state, uint32_t timeout = 1000000L);
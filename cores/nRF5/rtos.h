@@ -65,9 +65,8 @@ enum
 #define tick2ms(tck)  ( ( ((uint64_t)(tck)) * 1000) / configTICK_RATE_HZ )
 #define tick2us(tck)  ( ( ((uint64_t)(tck)) * 1000000) / configTICK_RATE_HZ )
 
-// legacy thread-safe malloc/free
-#define rtos_malloc   malloc
-#define rtos_free     free
+// thread-safe and ISR-safe malloc/free, see rtos_heap.h
+#include "rtos_heap.h"
 
 // Visible only with C++
 #ifdef __cplusplus
@@ -0,0 +1,568 @@
+/**************************************************************************/
+/*!
+    @file     rtos_heap.c
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <reent.h>
+#include "nrf.h"
+#include "common_inc.h"
+#include "rtos.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define ALIGN_LOG2        3
+#define ALIGN_SIZE        (1UL << ALIGN_LOG2)
+
+#define SL_LOG2           4                             // number of second level lists per first level (log2)
+#define SL_COUNT          (1UL << SL_LOG2)
+#define FL_SHIFT          (SL_LOG2 + ALIGN_LOG2)        // block smaller than 128 bytes are all in first level 0
+#define FL_MAX            18                            // block must be smaller than 256 KB
+#define FL_COUNT          (FL_MAX - FL_SHIFT + 1)
+#define SMALL_BLOCK       (1UL << FL_SHIFT)
+
+#define BLOCK_FREE        0x01UL
+#define BLOCK_SIZE_MASK   0x00FFFFF8UL
+#define BLOCK_TAG_SHIFT   24
+
+typedef struct heap_block
+{
+  struct heap_block* prev_phys; // previous block in memory, NULL for first block
+  uint32_t info;                // payload size | tag << 24 | BLOCK_FREE
+
+  // free list links, only valid when block is free (overlap payload)
+  struct heap_block* next_free;
+  struct heap_block* prev_free;
+} heap_block_t;
+
+#define BLOCK_HDR_SIZE    offsetof(heap_block_t, next_free)
+#define BLOCK_MIN_SIZE    (sizeof(heap_block_t) - BLOCK_HDR_SIZE)
+
+VERIFY_STATIC(CFG_RTOS_HEAP_SIZE < (1UL << FL_MAX));
+VERIFY_STATIC((BLOCK_HDR_SIZE % ALIGN_SIZE) == 0);
+
+// first block header and payload, excluding sentinel header
+#define POOL_USABLE       ((CFG_RTOS_HEAP_SIZE - BLOCK_HDR_SIZE) & ~(ALIGN_SIZE - 1))
+
+#if CFG_RTOS_HEAP_SIZE
+static uint8_t _pool[CFG_RTOS_HEAP_SIZE] __attribute__((aligned(ALIGN_SIZE)));
+#endif
+
+static struct
+{
+  bool inited;
+
+  uint32_t fl_bitmap;
+  uint32_t sl_bitmap[FL_COUNT];
+  heap_block_t* blocks[FL_COUNT][SL_COUNT];
+
+  // newlib blocks freed in ISR, released later in task context
+  void* deferred;
+
+  uint32_t used;
+  uint32_t used_peak;
+  uint32_t alloc_count;
+  uint32_t fail_count;
+  uint32_t fallback_count;
+  uint32_t tag_used[HEAP_TAG_COUNT];
+  uint16_t tag_blocks[HEAP_TAG_COUNT];
+} _heap;
+
+static const char* const _tag_str[HEAP_TAG_COUNT] =
+{
+  [HEAP_TAG_APP     ] = "App",
+  [HEAP_TAG_RTOS    ] = "RTOS",
+  [HEAP_TAG_BLE     ] = "BLE",
+  [HEAP_TAG_CALLBACK] = "Callback",
+  [HEAP_TAG_STRING  ] = "String",
+  [HEAP_TAG_FIFO    ] = "FIFO",
+  [HEAP_TAG_FS      ] = "FS",
+};
+
+static inline bool in_isr(void)
+{
+  return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
+}
+
+//--------------------------------------------------------------------+
+// Block helpers
+//--------------------------------------------------------------------+
+static inline uint32_t fls32(uint32_t x)
+{
+  return 31 - __builtin_clz(x);
+}
+
+static inline uint32_t block_size(heap_block_t const* blk)
+{
+  return blk->info & BLOCK_SIZE_MASK;
+}
+
+static inline uint8_t block_tag(heap_block_t const* blk)
+{
+  return (uint8_t) (blk->info >> BLOCK_TAG_SHIFT);
+}
+
+static inline bool block_is_free(heap_block_t const* blk)
+{
+  return blk->info & BLOCK_FREE;
+}
+
+static inline heap_block_t* block_next(heap_block_t const* blk)
+{
+  return (heap_block_t*) (((uint8_t*) blk) + BLOCK_HDR_SIZE + block_size(blk));
+}
+
+static inline heap_block_t* block_from_ptr(void const* ptr)
+{
+  return (heap_block_t*) (((uint8_t*) ptr) - BLOCK_HDR_SIZE);
+}
+
+static inline void* block_to_ptr(heap_block_t* blk)
+{
+  return ((uint8_t*) blk) + BLOCK_HDR_SIZE;
+}
+
+static inline uint32_t adjust_size(size_t size)
+{
+  if ( size < BLOCK_MIN_SIZE ) size = BLOCK_MIN_SIZE;
+  return (size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+}
+
+static inline bool in_pool(void const* ptr)
+{
+#if CFG_RTOS_HEAP_SIZE
+  return (((uint8_t const*) ptr) >= _pool) && (((uint8_t const*) ptr) < _pool + CFG_RTOS_HEAP_SIZE);
+#else
+  (void) ptr;
+  return false;
+#endif
+}
+
+//--------------------------------------------------------------------+
+// Two Level Segregated Fit
+//--------------------------------------------------------------------+
+static void mapping_insert(uint32_t size, uint32_t* fl, uint32_t* sl)
+{
+  if ( size < SMALL_BLOCK )
+  {
+    *fl = 0;
+    *sl = size >> ALIGN_LOG2;
+  }else
+  {
+    uint32_t const f = fls32(size);
+    *sl = (size >> (f - SL_LOG2)) ^ SL_COUNT;
+    *fl = f - FL_SHIFT + 1;
+  }
+}
+
+// round up to next list so that any block found there is large enough
+static void mapping_search(uint32_t size, uint32_t* fl, uint32_t* sl)
+{
+  if ( size >= SMALL_BLOCK ) size += (1UL << (fls32(size) - SL_LOG2)) - 1;
+  mapping_insert(size, fl, sl);
+}
+
+static void insert_free(heap_block_t* blk)
+{
+  uint32_t fl, sl;
+  mapping_insert(block_size(blk), &fl, &sl);
+
+  heap_block_t* head = _heap.blocks[fl][sl];
+  blk->info     = block_size(blk) | BLOCK_FREE;
+  blk->next_free = head;
+  blk->prev_free = NULL;
+  if ( head ) head->prev_free = blk;
+
+  _heap.blocks[fl][sl] = blk;
+  _heap.fl_bitmap     |= (1UL << fl);
+  _heap.sl_bitmap[fl] |= (1UL << sl);
+}
+
+static void remove_free(heap_block_t* blk)
+{
+  uint32_t fl, sl;
+  mapping_insert(block_size(blk), &fl, &sl);
+
+  if ( blk->prev_free ) blk->prev_free->next_free = blk->next_free;
+  if ( blk->next_free ) blk->next_free->prev_free = blk->prev_free;
+
+  if ( _heap.blocks[fl][sl] == blk )
+  {
+    _heap.blocks[fl][sl] = blk->next_free;
+    if ( blk->next_free == NULL )
+    {
+      _heap.sl_bitmap[fl] &= ~(1UL << sl);
+      if ( _heap.sl_bitmap[fl] == 0 ) _heap.fl_bitmap &= ~(1UL << fl);
+    }
+  }
+
+  blk->info &= ~BLOCK_FREE;
+}
+
+static heap_block_t* find_suitable(uint32_t fl, uint32_t sl)
+{
+  uint32_t sl_map = _heap.sl_bitmap[fl] & (~0UL << sl);
+
+  if ( sl_map == 0 )
+  {
+    uint32_t const fl_map = (fl + 1 < FL_COUNT) ? (_heap.fl_bitmap & (~0UL << (fl + 1))) : 0;
+    if ( fl_map == 0 ) return NULL;
+
+    fl     = __builtin_ctz(fl_map);
+    sl_map = _heap.sl_bitmap[fl];
+  }
+
+  return _heap.blocks[fl][__builtin_ctz(sl_map)];
+}
+
+// Merge with free neighbors then put into free lists
+static void block_release(heap_block_t* blk)
+{
+  heap_block_t* prev = blk->prev_phys;
+  if ( prev && block_is_free(prev) )
+  {
+    remove_free(prev);
+    prev->info = block_size(prev) + BLOCK_HDR_SIZE + block_size(blk);
+    blk = prev;
+    block_next(blk)->prev_phys = blk;
+  }
+
+  heap_block_t* next = block_next(blk);
+  if ( block_is_free(next) )
+  {
+    remove_free(next);
+    blk->info = block_size(blk) + BLOCK_HDR_SIZE + block_size(next);
+    block_next(blk)->prev_phys = blk;
+  }
+
+  insert_free(blk);
+}
+
+// Shrink a used block to size, return the remainder to free lists if it is usable
+static void block_trim(heap_block_t* blk, uint32_t size)
+{
+  uint32_t const cur = block_size(blk);
+  if ( cur < size + BLOCK_HDR_SIZE + BLOCK_MIN_SIZE ) return;
+
+  heap_block_t* rest = (heap_block_t*) (((uint8_t*) blk) + BLOCK_HDR_SIZE + size);
+  rest->prev_phys = blk;
+  rest->info      = cur - size - BLOCK_HDR_SIZE;
+  block_next(rest)->prev_phys = rest;
+
+  blk->info = size | (blk->info & ~BLOCK_SIZE_MASK);
+  block_release(rest);
+}
+
+static void pool_init(void)
+{
+#if CFG_RTOS_HEAP_SIZE
+  // a single free block followed by a zero-size sentinel which is never free
+  heap_block_t* blk = (heap_block_t*) _pool;
+  blk->prev_phys = NULL;
+  blk->info      = POOL_USABLE - BLOCK_HDR_SIZE;
+
+  heap_block_t* sentinel = block_next(blk);
+  sentinel->prev_phys = blk;
+  sentinel->info      = 0;
+
+  insert_free(blk);
+#endif
+
+  _heap.inited = true;
+}
+
+static void stats_add(heap_block_t const* blk, int32_t sign)
+{
+  uint8_t const tag = block_tag(blk);
+  uint32_t const sz = block_size(blk) + BLOCK_HDR_SIZE;
+
+  if ( sign > 0 )
+  {
+    _heap.used += sz;
+    _heap.tag_used[tag] += sz;
+    _heap.tag_blocks[tag]++;
+    if ( _heap.used > _heap.used_peak ) _heap.used_peak = _heap.used;
+  }else
+  {
+    _heap.used -= sz;
+    _heap.tag_used[tag] -= sz;
+    _heap.tag_blocks[tag]--;
+  }
+}
+
+// must be called with interrupt masked
+static void* pool_alloc(size_t size, uint8_t tag)
+{
+  if ( !_heap.inited ) pool_init();
+  if ( size >= (1UL << FL_MAX) ) return NULL;
+
+  uint32_t const adjusted = adjust_size(size);
+
+  uint32_t fl, sl;
+  mapping_search(adjusted, &fl, &sl);
+  if ( fl >= FL_COUNT ) return NULL;
+
+  heap_block_t* blk = find_suitable(fl, sl);
+  if ( blk == NULL ) return NULL;
+
+  remove_free(blk);
+  blk->info = block_size(blk) | (((uint32_t) tag) << BLOCK_TAG_SHIFT);
+  block_trim(blk, adjusted);
+
+  stats_add(blk, 1);
+  _heap.alloc_count++;
+
+  return block_to_ptr(blk);
+}
+
+// must be called with interrupt masked
+static void pool_free(void* ptr)
+{
+  heap_block_t* blk = block_from_ptr(ptr);
+
+  stats_add(blk, -1);
+  block_release(blk);
+}
+
+// grow or shrink in place, must be called with interrupt masked
+static bool pool_resize(void* ptr, size_t size)
+{
+  if ( size >= (1UL << FL_MAX) ) return false;
+
+  heap_block_t* blk = block_from_ptr(ptr);
+  uint32_t const adjusted = adjust_size(size);
+
+  stats_add(blk, -1);
+
+  if ( adjusted > block_size(blk) )
+  {
+    heap_block_t* next = block_next(blk);
+    if ( !(block_is_free(next) && block_size(blk) + BLOCK_HDR_SIZE + block_size(next) >= adjusted) )
+    {
+      stats_add(blk, 1);
+      return false;
+    }
+
+    remove_free(next);
+    blk->info = (block_size(blk) + BLOCK_HDR_SIZE + block_size(next)) | (blk->info & ~BLOCK_SIZE_MASK);
+    block_next(blk)->prev_phys = blk;
+  }
+
+  block_trim(blk, adjusted);
+  stats_add(blk, 1);
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Newlib fallback, task context only
+//--------------------------------------------------------------------+
+static bool newlib_lock(void)
+{
+  bool const started = (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+  if ( started ) vTaskSuspendAll();
+  return started;
+}
+
+static void newlib_unlock(bool locked)
+{
+  if ( locked ) (void) xTaskResumeAll();
+}
+
+// must be called with newlib locked
+static void newlib_drain(void)
+{
+  while ( _heap.deferred )
+  {
+    UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    void* ptr = _heap.deferred;
+    _heap.deferred = *((void**) ptr);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    _free_r(_REENT, ptr);
+  }
+}
+
+static void newlib_free(void* ptr)
+{
+  if ( in_isr() )
+  {
+    // block is reused as link
+    UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    *((void**) ptr) = _heap.deferred;
+    _heap.deferred = ptr;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return;
+  }
+
+  bool const locked = newlib_lock();
+  newlib_drain();
+  _free_r(_REENT, ptr);
+  newlib_unlock(locked);
+}
+
+//--------------------------------------------------------------------+
+// API
+//--------------------------------------------------------------------+
+void* rtos_malloc_tag(size_t size, uint8_t tag)
+{
+  if ( tag >= HEAP_TAG_COUNT ) tag = HEAP_TAG_APP;
+
+  void* ptr = NULL;
+
+  if ( CFG_RTOS_HEAP_SIZE )
+  {
+    UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    ptr = pool_alloc(size, tag);
+    if ( ptr == NULL ) _heap.fail_count++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  }
+
+  if ( ptr || in_isr() ) return ptr;
+
+  bool const locked = newlib_lock();
+  newlib_drain();
+  ptr = _malloc_r(_REENT, size);
+  if ( ptr && CFG_RTOS_HEAP_SIZE ) _heap.fallback_count++;
+  newlib_unlock(locked);
+
+  return ptr;
+}
+
+void* rtos_malloc(size_t size)
+{
+  return rtos_malloc_tag(size, HEAP_TAG_APP);
+}
+
+void rtos_free(void* ptr)
+{
+  if ( ptr == NULL ) return;
+
+  if ( in_pool(ptr) )
+  {
+    UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    pool_free(ptr);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  }else
+  {
+    newlib_free(ptr);
+  }
+}
+
+void* rtos_realloc_tag(void* ptr, size_t size, uint8_t tag)
+{
+  if ( ptr == NULL ) return rtos_malloc_tag(size, tag);
+
+  if ( size == 0 )
+  {
+    rtos_free(ptr);
+    return NULL;
+  }
+
+  if ( !in_pool(ptr) )
+  {
+    if ( in_isr() ) return NULL;
+
+    bool const locked = newlib_lock();
+    newlib_drain();
+    void* new_ptr = _realloc_r(_REENT, ptr, size);
+    newlib_unlock(locked);
+
+    return new_ptr;
+  }
+
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint32_t const cur = block_size(block_from_ptr(ptr));
+  bool const resized = pool_resize(ptr, size);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  if ( resized ) return ptr;
+
+  // move to a new block
+  void* new_ptr = rtos_malloc_tag(size, tag);
+  if ( new_ptr )
+  {
+    memcpy(new_ptr, ptr, (cur < size) ? cur : size);
+    rtos_free(ptr);
+  }
+
+  return new_ptr;
+}
+
+bool rtos_heap_stats(rtos_heap_stats_t* stats)
+{
+  VERIFY(stats);
+
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if ( !_heap.inited ) pool_init();
+
+  // largest free block is in the highest non-empty list
+  uint32_t largest = 0;
+  if ( _heap.fl_bitmap )
+  {
+    uint32_t const fl = fls32(_heap.fl_bitmap);
+    uint32_t const sl = fls32(_heap.sl_bitmap[fl]);
+
+    for(heap_block_t* blk = _heap.blocks[fl][sl]; blk; blk = blk->next_free)
+    {
+      if ( block_size(blk) > largest ) largest = block_size(blk);
+    }
+  }
+
+  stats->size           = CFG_RTOS_HEAP_SIZE;
+  stats->used           = _heap.used;
+  stats->used_peak      = _heap.used_peak;
+  stats->largest_free   = largest;
+  stats->alloc_count    = _heap.alloc_count;
+  stats->fail_count     = _heap.fail_count;
+  stats->fallback_count = _heap.fallback_count;
+
+  memcpy(stats->tag_used, _heap.tag_used, sizeof(stats->tag_used));
+  memcpy(stats->tag_blocks, _heap.tag_blocks, sizeof(stats->tag_blocks));
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  // pool is made of used and free blocks (with their headers) plus the sentinel header
+  stats->free = CFG_RTOS_HEAP_SIZE ? (POOL_USABLE - stats->used) : 0;
+  stats->frag_permille = stats->free ? (uint16_t) (1000 - (((uint64_t) (largest + BLOCK_HDR_SIZE)) * 1000) / stats->free) : 0;
+
+  return true;
+}
+
+const char* rtos_heap_tag_str(uint8_t tag)
+{
+  return (tag < HEAP_TAG_COUNT) ? _tag_str[tag] : "?";
+}
@@ -0,0 +1,106 @@
+/**************************************************************************/
+/*!
+    @file     rtos_heap.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef RTOS_HEAP_H_
+#define RTOS_HEAP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pool heap used by rtos_malloc() family, operator new and, through the
+ * --wrap linker options of platform.txt, malloc()/free()/realloc()/calloc().
+ * Two Level Segregated Fit allocator: malloc/free are O(1) with bounded
+ * latency and run with interrupts masked up to configMAX_SYSCALL_INTERRUPT_PRIORITY,
+ * therefore can be used in ISR. When the pool is exhausted, allocation from task
+ * context falls back to newlib heap. Set CFG_RTOS_HEAP_SIZE to 0 to use newlib
+ * heap only (legacy behavior).
+ */
+#ifndef CFG_RTOS_HEAP_SIZE
+  #ifdef NRF52840_XXAA
+    #define CFG_RTOS_HEAP_SIZE    (40*1024)
+  #else
+    #define CFG_RTOS_HEAP_SIZE    (8*1024)
+  #endif
+#endif
+
+// Subsystem owning an allocation, for usage statistics
+enum
+{
+  HEAP_TAG_APP = 0,  // rtos_malloc(), new
+  HEAP_TAG_RTOS,     // FreeRTOS kernel objects and task stacks
+  HEAP_TAG_BLE,
+  HEAP_TAG_CALLBACK,
+  HEAP_TAG_STRING,
+  HEAP_TAG_FIFO,
+  HEAP_TAG_FS,
+  HEAP_TAG_COUNT
+};
+
+typedef struct
+{
+  uint32_t size;            // pool size
+  uint32_t used;            // including block headers
+  uint32_t used_peak;
+  uint32_t free;
+  uint32_t largest_free;
+  uint16_t frag_permille;   // 1000 * (1 - largest_free/free)
+
+  uint32_t alloc_count;
+  uint32_t fail_count;      // pool could not satisfy request
+  uint32_t fallback_count;  // served by newlib heap instead
+
+  uint32_t tag_used[HEAP_TAG_COUNT];
+  uint16_t tag_blocks[HEAP_TAG_COUNT];
+} rtos_heap_stats_t;
+
+void* rtos_malloc(size_t size);
+void  rtos_free(void* ptr);
+
+void* rtos_malloc_tag(size_t size, uint8_t tag);
+void* rtos_realloc_tag(void* ptr, size_t size, uint8_t tag);
+
+bool        rtos_heap_stats(rtos_heap_stats_t* stats);
+const char* rtos_heap_tag_str(uint8_t tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_HEAP_H_ */
@@ -54,6 +54,8 @@ void adafruit_callback_task(void* arg)
       const void* func = cb_data->callback_func;
       uint32_t* args = cb_data->arguments;
 
+      SYSTRACE_START(SYSTRACE_CALLBACK, func);
+
       switch (cb_data->arg_count)
       {
         case 0: ((adacb_0arg_t) func)();                                            break;
@@ -66,6 +68,8 @@ void adafruit_callback_task(void* arg)
         default: VERIFY_MESS(NRF_ERROR_INVALID_PARAM, dbg_err_str); break;
       }
 
+      SYSTRACE_STOP(SYSTRACE_CALLBACK, func);
+
       // free up resource
       if (cb_data->malloced_data) rtos_free(cb_data->malloced_data);
       rtos_free(cb_data);
@@ -101,7 +105,7 @@ void ada_callback_queue(ada_callback_t* cb_item)
 
 bool ada_callback_invoke(const void* malloc_data, uint32_t malloc_len, const void* func, uint32_t arguments[], uint8_t argcount)
 {
-  ada_callback_t* cb_data = (ada_callback_t*) rtos_malloc( sizeof(ada_callback_t) + (argcount ? (argcount-1)*4 : 0) );
+  ada_callback_t* cb_data = (ada_callback_t*) rtos_malloc_tag( sizeof(ada_callback_t) + (argcount ? (argcount-1)*4 : 0), HEAP_TAG_CALLBACK );
   VERIFY(cb_data);
 
   cb_data->malloced_data = NULL;
@@ -110,7 +114,7 @@ bool ada_callback_invoke(const void* malloc_data, uint32_t malloc_len, const voi
 
   if ( malloc_data && malloc_len )
   {
-    cb_data->malloced_data = rtos_malloc(malloc_len);
+    cb_data->malloced_data = rtos_malloc_tag(malloc_len, HEAP_TAG_CALLBACK);
     if ( !cb_data->malloced_data )
     {
       rtos_free(cb_data);
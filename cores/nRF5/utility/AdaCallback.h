@@ -57,7 +57,7 @@ typedef struct
   uint32_t arguments[1]; // flexible array holder
 }ada_callback_t;
 
-VERIFY_STATIC( sizeof(ada_callback_t) == 16 );
+VERIFY_STATIC( sizeof(ada_callback_t) == 2*sizeof(void*) + 8 ); // 16 on target
 
 /*------------- Defer callback type, determined by number of arguments -------------*/
 typedef void (*adacb_0arg_t) (void);
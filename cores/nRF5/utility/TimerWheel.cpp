@@ -0,0 +1,417 @@
+/**************************************************************************/
+/*!
+    @file     TimerWheel.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "TimerWheel.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+/* 4 levels of 64 slots, level n has a granularity of 64^n ticks.
+ * Timers further than 64^4 ticks (~4.5 hours at 1024 Hz) are parked in the
+ * last level and cascaded again when their slot comes around.
+ */
+#define TIMER_WHEEL_LEVELS      4
+#define TIMER_WHEEL_SLOT_BITS   6
+#define TIMER_WHEEL_SLOTS       (1UL << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK   (TIMER_WHEEL_SLOTS-1)
+#define TIMER_WHEEL_RANGE       (1UL << (TIMER_WHEEL_SLOT_BITS*TIMER_WHEEL_LEVELS))
+#define TIMER_WHEEL_NO_SLOT     0xff
+
+class TimerWheel
+{
+  public:
+    static void     insert(WheelTimer* t);
+    static void     unlink(WheelTimer* t);
+    static bool     next(uint32_t* tick);
+    static WheelTimer* advance(uint32_t target);
+    static void     arm(bool from_timer_task);
+
+    static void     kernel_cb(TimerHandle_t xTimer);
+
+    static uint32_t lock(void);
+    static void     unlock(uint32_t mask);
+
+    static WheelTimer*   _slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    static uint64_t      _bitmap[TIMER_WHEEL_LEVELS];
+    static uint32_t      _now; // wheel time, everything up to it is processed
+    static TimerHandle_t _kernel_timer;
+    static bool          _armed;
+    static uint32_t      _armed_at;
+};
+
+WheelTimer*   TimerWheel::_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+uint64_t      TimerWheel::_bitmap[TIMER_WHEEL_LEVELS];
+uint32_t      TimerWheel::_now;
+TimerHandle_t TimerWheel::_kernel_timer = NULL;
+bool          TimerWheel::_armed = false;
+uint32_t      TimerWheel::_armed_at;
+
+static inline uint32_t current_tick(void)
+{
+  return isInISR() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+}
+
+//--------------------------------------------------------------------+
+// Wheel
+//--------------------------------------------------------------------+
+uint32_t TimerWheel::lock(void)
+{
+  if ( isInISR() ) return taskENTER_CRITICAL_FROM_ISR();
+
+  taskENTER_CRITICAL();
+  return 0;
+}
+
+void TimerWheel::unlock(uint32_t mask)
+{
+  if ( isInISR() )
+  {
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+  }else
+  {
+    taskEXIT_CRITICAL();
+  }
+}
+
+void TimerWheel::insert(WheelTimer* t)
+{
+  // expiry is never behind wheel time except when cascading to current tick
+  int32_t const diff  = (int32_t) (t->_expiry - _now);
+  uint32_t const delta = (diff > 0) ? diff : 0;
+
+  uint8_t level = 0;
+  while ( (level < TIMER_WHEEL_LEVELS-1) && (delta >> (TIMER_WHEEL_SLOT_BITS*(level+1))) ) level++;
+
+  uint32_t const pos  = (delta < TIMER_WHEEL_RANGE) ? (_now + delta) : (_now + TIMER_WHEEL_RANGE - 1);
+  uint8_t  const slot = (pos >> (TIMER_WHEEL_SLOT_BITS*level)) & TIMER_WHEEL_SLOT_MASK;
+
+  WheelTimer** head = &_slots[level][slot];
+
+  t->_level = level;
+  t->_slot  = slot;
+  t->_prev  = NULL;
+  t->_next  = *head;
+  if ( *head ) (*head)->_prev = t;
+  *head = t;
+
+  _bitmap[level] |= (1ULL << slot);
+}
+
+void TimerWheel::unlink(WheelTimer* t)
+{
+  if ( t->_slot == TIMER_WHEEL_NO_SLOT ) return;
+
+  WheelTimer** head = &_slots[t->_level][t->_slot];
+
+  if ( t->_prev ) t->_prev->_next = t->_next;
+  else            *head = t->_next;
+
+  if ( t->_next ) t->_next->_prev = t->_prev;
+
+  if ( *head == NULL ) _bitmap[t->_level] &= ~(1ULL << t->_slot);
+
+  t->_next = t->_prev = NULL;
+  t->_slot = TIMER_WHEEL_NO_SLOT;
+}
+
+/**
+ * Find the next tick where the wheel has something to do: a level 0 slot
+ * expiring or a higher level slot cascading down.
+ * @return false if wheel is empty
+ */
+bool TimerWheel::next(uint32_t* tick)
+{
+  bool found = false;
+
+  for(uint8_t level=0; level<TIMER_WHEEL_LEVELS; level++)
+  {
+    uint64_t const bitmap = _bitmap[level];
+    if ( !bitmap ) continue;
+
+    uint8_t  const shift = TIMER_WHEEL_SLOT_BITS*level;
+    uint32_t const cur   = _now >> shift;
+
+    // distance in slots (1-64) from current slot to next occupied one
+    uint8_t  const rot = (cur + 1) & TIMER_WHEEL_SLOT_MASK;
+    uint64_t const rotated = rot ? ((bitmap >> rot) | (bitmap << (64 - rot))) : bitmap;
+    uint32_t const dist = __builtin_ctzll(rotated) + 1;
+
+    uint32_t const t = (cur + dist) << shift;
+
+    if ( !found || (int32_t) (t - *tick) < 0 ) *tick = t;
+    found = true;
+  }
+
+  return found;
+}
+
+/**
+ * Process wheel up to target tick
+ * @return list of expired timers (linked by _due_next), in expiry order
+ */
+WheelTimer* TimerWheel::advance(uint32_t target)
+{
+  WheelTimer*  due_head = NULL;
+  WheelTimer** due_tail = &due_head;
+
+  uint32_t tick;
+  while ( next(&tick) && (int32_t) (tick - target) <= 0 )
+  {
+    _now = tick;
+
+    // Cascade higher level slots whose time has come, highest first
+    for(uint8_t level=TIMER_WHEEL_LEVELS-1; level>0; level--)
+    {
+      uint8_t const shift = TIMER_WHEEL_SLOT_BITS*level;
+      if ( _now & ((1UL << shift) - 1) ) continue;
+
+      uint8_t const slot = (_now >> shift) & TIMER_WHEEL_SLOT_MASK;
+      WheelTimer* t = _slots[level][slot];
+
+      _slots[level][slot] = NULL;
+      _bitmap[level] &= ~(1ULL << slot);
+
+      while ( t )
+      {
+        WheelTimer* next_t = t->_next;
+        insert(t);
+        t = next_t;
+      }
+    }
+
+    // Expire current level 0 slot
+    uint8_t const slot = _now & TIMER_WHEEL_SLOT_MASK;
+    WheelTimer* t = _slots[0][slot];
+
+    _slots[0][slot] = NULL;
+    _bitmap[0] &= ~(1ULL << slot);
+
+    while ( t )
+    {
+      WheelTimer* next_t = t->_next;
+
+      t->_next = t->_prev = NULL;
+      t->_slot = TIMER_WHEEL_NO_SLOT;
+      t->_due_next = NULL;
+
+      *due_tail = t;
+      due_tail = &t->_due_next;
+
+      t = next_t;
+    }
+  }
+
+  _now = target;
+
+  return due_head;
+}
+
+/**
+ * (Re)arm the kernel timer to the next wheel event if it is earlier than
+ * what is currently armed. Timer command is sent while locked so that a
+ * later arming from another context cannot overtake an earlier one.
+ *
+ * The command can't block here, if the timer queue is full the wheel is left
+ * unarmed and the next start()/stop() or kernel timer expiry tries again.
+ */
+void TimerWheel::arm(bool from_timer_task)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t const mask = lock();
+
+  uint32_t tick;
+  if ( next(&tick) && (from_timer_task || !_armed || (int32_t) (tick - _armed_at) < 0) )
+  {
+    int32_t period = (int32_t) (tick - current_tick());
+    if ( period < 1 ) period = 1;
+
+    BaseType_t sent;
+    if ( isInISR() )
+    {
+      sent = xTimerChangePeriodFromISR(_kernel_timer, period, &xHigherPriorityTaskWoken);
+    }
+    else
+    {
+      sent = xTimerChangePeriod(_kernel_timer, period, 0);
+    }
+
+    // a failed re-arm must not leave an earlier command counted as armed
+    if ( sent == pdPASS )
+    {
+      _armed    = true;
+      _armed_at = tick;
+    }
+    else
+    {
+      _armed = false;
+    }
+  }
+
+  unlock(mask);
+
+  if ( isInISR() ) portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void TimerWheel::kernel_cb(TimerHandle_t xTimer)
+{
+  (void) xTimer;
+
+  uint32_t mask = lock();
+  _armed = false;
+  WheelTimer* due = advance(xTaskGetTickCount());
+  unlock(mask);
+
+  while ( due )
+  {
+    WheelTimer* t = due;
+    due = t->_due_next;
+
+    mask = lock();
+
+    // stopped or restarted after being taken out of the wheel
+    bool const fire = t->_active && (t->_slot == TIMER_WHEEL_NO_SLOT);
+
+    if ( fire )
+    {
+      if ( t->_repeating )
+      {
+        // re-insert before callback so that it can stop or change the timer
+        t->_expiry += t->_period;
+        if ( (int32_t) (t->_expiry - _now) <= 0 ) t->_expiry = _now + t->_period;
+        insert(t);
+      }else
+      {
+        t->_active = false;
+      }
+    }
+
+    unlock(mask);
+
+    if ( fire ) t->_cb(t);
+  }
+
+  arm(true);
+}
+
+//--------------------------------------------------------------------+
+// WheelTimer
+//--------------------------------------------------------------------+
+WheelTimer::WheelTimer()
+{
+  _next = _prev = _due_next = NULL;
+  _expiry    = 0;
+  _period    = 0;
+  _cb        = NULL;
+  _id        = NULL;
+  _level     = 0;
+  _slot      = TIMER_WHEEL_NO_SLOT;
+  _repeating = false;
+  _active    = false;
+}
+
+WheelTimer::~WheelTimer()
+{
+  stop();
+}
+
+void WheelTimer::begin(uint32_t ms, callback_t callback, void* timerID, bool repeating)
+{
+  if ( TimerWheel::_kernel_timer == NULL )
+  {
+    TimerWheel::_kernel_timer = xTimerCreate("wheel", 1, false, NULL, TimerWheel::kernel_cb);
+  }
+
+  _period    = maxof(ms2tick(ms), (TickType_t) 1);
+  _cb        = callback;
+  _id        = timerID;
+  _repeating = repeating;
+}
+
+bool WheelTimer::start(void)
+{
+  VERIFY(_cb && TimerWheel::_kernel_timer);
+
+  uint32_t const mask = TimerWheel::lock();
+
+  TimerWheel::unlink(this);
+
+  // Empty wheel may lag behind, there is nothing to process so catch up
+  bool empty = true;
+  for(uint8_t i=0; i<TIMER_WHEEL_LEVELS; i++) if ( TimerWheel::_bitmap[i] ) empty = false;
+  if ( empty ) TimerWheel::_now = current_tick();
+
+  _expiry = current_tick() + _period;
+  _active = true;
+  TimerWheel::insert(this);
+
+  TimerWheel::unlock(mask);
+
+  TimerWheel::arm(false);
+
+  return true;
+}
+
+bool WheelTimer::stop(void)
+{
+  uint32_t const mask = TimerWheel::lock();
+
+  TimerWheel::unlink(this);
+  _active = false;
+
+  bool const retry = !TimerWheel::_armed;
+
+  TimerWheel::unlock(mask);
+
+  // kernel timer may wake up for nothing, cheaper than re-arming.
+  // Only retry if a previous arming could not be sent.
+  if ( retry ) TimerWheel::arm(false);
+
+  return true;
+}
+
+bool WheelTimer::reset(void)
+{
+  return start();
+}
+
+bool WheelTimer::setPeriod(uint32_t ms)
+{
+  _period = maxof(ms2tick(ms), (TickType_t) 1);
+
+  // same as SoftwareTimer: active timer restarts with new period
+  return _active ? start() : true;
+}
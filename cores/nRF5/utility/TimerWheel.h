@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*!
+    @file     TimerWheel.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "Arduino.h"
+
+/* Lightweight software timer. All WheelTimers share a single FreeRTOS timer
+ * through a hierarchical timer wheel: start/stop are O(1) and do not post
+ * to the timer command queue (except when the new timer becomes the earliest
+ * one). Callbacks are invoked from the FreeRTOS timer task, same as
+ * SoftwareTimer. Resolution is one RTOS tick.
+ */
+class WheelTimer
+{
+  public:
+    typedef void (*callback_t) (WheelTimer* timer);
+
+    WheelTimer();
+    virtual ~WheelTimer();
+
+    void begin(uint32_t ms, callback_t callback, void* timerID = NULL, bool repeating = true);
+
+    void  setID(void* id) { _id = id;   }
+    void* getID(void)     { return _id; }
+
+    bool start(void);
+    bool stop (void);
+    bool reset (void);
+    bool setPeriod(uint32_t ms);
+    bool isActive(void) { return _active; }
+
+  private:
+    WheelTimer* _next;
+    WheelTimer* _prev;
+    WheelTimer* _due_next;
+
+    uint32_t   _expiry; // in ticks
+    uint32_t   _period; // in ticks
+    callback_t _cb;
+    void*      _id;
+
+    uint8_t    _level;
+    uint8_t    _slot;   // TIMER_WHEEL_NO_SLOT if not linked
+    bool       _repeating;
+    volatile bool _active;
+
+    friend class TimerWheel;
+};
+
+#endif /* TIMERWHEEL_H_ */
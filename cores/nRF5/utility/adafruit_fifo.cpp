@@ -42,7 +42,7 @@
     @brief  Constructor
 
     @param[in] depth
-               Maximum number of items can be hold in buffer
+               Maximum number of items can be hold in buffer (up to 32767)
     @param[in] item_size
                Number of bytes of each item
 */
@@ -55,13 +55,12 @@ Adafruit_FIFO::Adafruit_FIFO(uint8_t item_size, uint16_t depth)
   _depth        = depth;
   _overwritable = false;
 
-  _count = _wr_idx = _rd_idx = 0;
+  _wr_idx = _rd_idx = 0;
 }
 
 void Adafruit_FIFO::begin(void)
 {
-  _buffer = (uint8_t*) rtos_malloc(_item_size*_depth);
-  _mutex = xSemaphoreCreateMutex();
+  _buffer = (uint8_t*) rtos_malloc_tag(_item_size*_depth, HEAP_TAG_FIFO);
 }
 
 void Adafruit_FIFO::begin(uint16_t depth)
@@ -72,6 +71,8 @@ void Adafruit_FIFO::begin(uint16_t depth)
 
 void Adafruit_FIFO::overwriteIfFull(bool enable)
 {
+  // Writer moves read pointer when overwriting, mutex is required
+  if ( enable && !_mutex ) _mutex = xSemaphoreCreateMutex();
   _overwritable = enable;
 }
 
@@ -88,32 +89,41 @@ Adafruit_FIFO::~Adafruit_FIFO()
 
 /******************************************************************************/
 /*!
-    @brief  Clear the FIFO
+    @brief  Clear the FIFO, must be called from the consumer side
 */
 /******************************************************************************/
 void Adafruit_FIFO::clear(void)
 {
   _mutex_lock();
-  _rd_idx = _wr_idx = _count = 0;
+  _rd_idx = _wr_idx;
   _mutex_unlock();
 }
 
-
-void Adafruit_FIFO::_push(void const* item)
+// Copy n items to buffer starting at write index, wrap around at most once
+void Adafruit_FIFO::_copy_in(uint16_t wr, void const* data, uint16_t n)
 {
-  memcpy( _buffer + (_wr_idx * _item_size),
-          item,
-          _item_size);
+  uint16_t const pos   = _pos(wr);
+  uint16_t const first = min(n, (uint16_t) (_depth - pos));
 
-  _wr_idx = (_wr_idx + 1) % _depth;
+  memcpy(_buffer + pos*_item_size, data, first*_item_size);
 
-  if ( full() )
+  if ( n > first )
   {
-    _rd_idx = _wr_idx; // keep the full state (rd == wr && len = size)
+    memcpy(_buffer, ((uint8_t const*) data) + first*_item_size, (n - first)*_item_size);
   }
-  else
+}
+
+// Copy n items from buffer starting at read index, wrap around at most once
+void Adafruit_FIFO::_copy_out(uint16_t rd, void* buffer, uint16_t n) const
+{
+  uint16_t const pos   = _pos(rd);
+  uint16_t const first = min(n, (uint16_t) (_depth - pos));
+
+  memcpy(buffer, _buffer + pos*_item_size, first*_item_size);
+
+  if ( n > first )
   {
-    _count++;
+    memcpy(((uint8_t*) buffer) + first*_item_size, _buffer, (n - first)*_item_size);
   }
 }
 
@@ -127,15 +137,7 @@ void Adafruit_FIFO::_push(void const* item)
 /******************************************************************************/
 uint16_t Adafruit_FIFO::write(void const* item)
 {
-  if ( full() && !_overwritable ) return 0;
-
-  _mutex_lock();
-
-  _push(item);
-
-  _mutex_unlock();
-
-  return 1;
+  return write(item, 1);
 }
 
 /******************************************************************************/
@@ -152,36 +154,45 @@ uint16_t Adafruit_FIFO::write(void const* item)
 /******************************************************************************/
 uint16_t Adafruit_FIFO::write(void const * data, uint16_t count)
 {
-  if ( count == 0 ) return 0;
-
-  _mutex_lock();
-
-  // Not overwritable limit up to full
-  if (!_overwritable) count = min(count, remaining());
+  if ( count == 0 || _depth == 0 ) return 0;
 
   uint8_t const* buf8 = (uint8_t const*) data;
-  uint16_t n = 0;
 
-  while (n < count)
+  if ( _overwritable )
   {
-    _push(buf8);
+    _mutex_lock();
 
-    n++;
-    buf8 += _item_size;
+    // Only the last depth items will remain
+    uint16_t const skip = (count > _depth) ? (count - _depth) : 0;
+    uint16_t const n    = count - skip;
+
+    uint16_t const wr     = _wr_idx;
+    uint16_t const new_wr = _advance(wr, n);
+    bool const overflow   = (_count(wr, _rd_idx) + n > _depth);
+
+    _copy_in(wr, buf8 + skip*_item_size, n);
+
+    // Drop the oldest items: rd = wr - depth
+    if ( overflow ) _rd_idx = _advance(new_wr, _depth);
+    _wr_idx = new_wr;
+
+    _mutex_unlock();
+
+    return count;
   }
 
-  _mutex_unlock();
+  // Lock-free: only the producer modifies _wr_idx
+  uint16_t const wr = _wr_idx;
+  count = min(count, (uint16_t) (_depth - _count(wr, _rd_idx)));
+  if ( count == 0 ) return 0;
 
-  return n;
-}
+  _copy_in(wr, buf8, count);
 
-void Adafruit_FIFO::_pull(void * buffer)
-{
-  memcpy(buffer,
-         _buffer + (_rd_idx * _item_size),
-         _item_size);
-  _rd_idx = (_rd_idx + 1) % _depth;
-  _count--;
+  // Items must be in memory before consumer can see the new index
+  __DMB();
+  _wr_idx = _advance(wr, count);
+
+  return count;
 }
 
 /******************************************************************************/
@@ -194,15 +205,7 @@ void Adafruit_FIFO::_pull(void * buffer)
 /******************************************************************************/
 uint16_t Adafruit_FIFO::read(void* buffer)
 {
-  if( empty() ) return 0;
-
-  _mutex_lock();
-
-  _pull(buffer);
-
-  _mutex_unlock();
-
-  return 1;
+  return read(buffer, 1);
 }
 
 /******************************************************************************/
@@ -223,23 +226,25 @@ uint16_t Adafruit_FIFO::read(void * buffer, uint16_t count)
 
   _mutex_lock();
 
-  /* Limit up to fifo's count */
-  if ( count > _count ) count = _count;
+  // Lock-free (unless overwritable): only the consumer modifies _rd_idx
+  uint16_t const rd = _rd_idx;
 
-  uint8_t* buf8 = (uint8_t*) buffer;
-  uint16_t n = 0;
+  /* Limit up to fifo's count */
+  count = min(count, _count(_wr_idx, rd));
 
-  while (n < count)
+  if ( count )
   {
-    _pull(buf8);
+    __DMB();
+    _copy_out(rd, buffer, count);
 
-    n++;
-    buf8 += _item_size;
+    // Items must be copied out before producer can reuse their slots
+    __DMB();
+    _rd_idx = _advance(rd, count);
   }
 
   _mutex_unlock();
 
-  return n;
+  return count;
 }
 
 /******************************************************************************/
@@ -255,13 +260,74 @@ uint16_t Adafruit_FIFO::read(void * buffer, uint16_t count)
 /******************************************************************************/
 bool Adafruit_FIFO::peekAt(uint16_t position, void * p_buffer)
 {
-  if( empty() || (position >= _count) ) return false;
+  uint16_t const rd = _rd_idx;
+  if( position >= _count(_wr_idx, rd) ) return false;
 
-  uint16_t index = (_rd_idx + position) % _depth; // rd_idx is position=0
-  memcpy(p_buffer,
-         _buffer + (index * _item_size),
-         _item_size);
+  __DMB();
+  _copy_out(_advance(rd, position), p_buffer, 1); // rd_idx is position=0
 
   return true;
 }
 
+/******************************************************************************/
+/*!
+    @brief  Get contiguous items available for reading without copying e.g
+            to pass directly to DMA or sd_ble_gatts_hvx(). Items are released
+            with advanceRead().
+
+    @param[out] ptr
+               Address of the first item
+
+    @return    Number of contiguous items, may be less than count() when data
+               wraps around the end of the buffer
+*/
+/******************************************************************************/
+uint16_t Adafruit_FIFO::getReadSpan(void** ptr)
+{
+  uint16_t const rd  = _rd_idx;
+  uint16_t const pos = _pos(rd);
+
+  __DMB();
+  *ptr = _buffer + pos*_item_size;
+
+  return min(_count(_wr_idx, rd), (uint16_t) (_depth - pos));
+}
+
+void Adafruit_FIFO::advanceRead(uint16_t n)
+{
+  uint16_t const rd = _rd_idx;
+  n = min(n, _count(_wr_idx, rd));
+
+  __DMB();
+  _rd_idx = _advance(rd, n);
+}
+
+/******************************************************************************/
+/*!
+    @brief  Get contiguous free slots for writing without copying e.g as
+            DMA destination. Items are committed with advanceWrite().
+
+    @param[out] ptr
+               Address of the first free slot
+
+    @return    Number of contiguous free slots
+*/
+/******************************************************************************/
+uint16_t Adafruit_FIFO::getWriteSpan(void** ptr)
+{
+  uint16_t const wr  = _wr_idx;
+  uint16_t const pos = _pos(wr);
+
+  *ptr = _buffer + pos*_item_size;
+
+  return min((uint16_t) (_depth - _count(wr, _rd_idx)), (uint16_t) (_depth - pos));
+}
+
+void Adafruit_FIFO::advanceWrite(uint16_t n)
+{
+  uint16_t const wr = _wr_idx;
+  n = min(n, (uint16_t) (_depth - _count(wr, _rd_idx)));
+
+  __DMB();
+  _wr_idx = _advance(wr, n);
+}
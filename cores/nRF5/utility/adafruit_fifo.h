@@ -41,6 +41,14 @@
 #include <stdbool.h>
 #include <Arduino.h>
 
+/* Single producer / single consumer FIFO
+ * - Producer only modifies _wr_idx, consumer only modifies _rd_idx, therefore
+ *   write() and read() are lock-free and can be called from ISR or SoftDevice
+ *   event context as long as there is one writer and one reader.
+ * - Indices run from 0 to 2*depth-1 to tell full from empty without a counter
+ * - Overwritable mode moves the read index from the writer and falls back to a
+ *   mutex, it is not ISR-safe.
+ */
 class Adafruit_FIFO
 {
   private:
@@ -48,17 +56,31 @@ class Adafruit_FIFO
              uint16_t _depth        ; ///< max items
     const    uint8_t  _item_size    ; ///< size of each item
              bool     _overwritable ; ///< Overwrite when full
-    volatile uint16_t _count        ; ///< number of items in queue
     volatile uint16_t _wr_idx       ; ///< write pointer
     volatile uint16_t _rd_idx       ; ///< read pointer
 
     SemaphoreHandle_t _mutex;
 
-    bool _mutex_lock  (void) { return xSemaphoreTake(_mutex, portMAX_DELAY); }
-    bool _mutex_unlock(void) { return xSemaphoreGive(_mutex); }
+    // mutex is only used in overwritable mode
+    bool _mutex_lock  (void) { return _overwritable ? xSemaphoreTake(_mutex, portMAX_DELAY) : true; }
+    bool _mutex_unlock(void) { return _overwritable ? xSemaphoreGive(_mutex) : true; }
 
-    void _pull(void * buffer);
-    void _push(void const* item);
+    uint16_t _advance(uint16_t idx, uint16_t n) const
+    {
+      uint32_t next = idx + n;
+      if ( next >= 2u*_depth ) next -= 2u*_depth;
+      return (uint16_t) next;
+    }
+
+    uint16_t _pos(uint16_t idx) const { return (idx >= _depth) ? (idx - _depth) : idx; }
+
+    uint16_t _count(uint16_t wr, uint16_t rd) const
+    {
+      return (wr >= rd) ? (wr - rd) : (uint16_t) (2u*_depth - rd + wr);
+    }
+
+    void _copy_in (uint16_t wr, void const* data, uint16_t n);
+    void _copy_out(uint16_t rd, void* buffer, uint16_t n) const;
 
   public:
     // Constructor
@@ -81,10 +103,18 @@ class Adafruit_FIFO
     bool peekAt(uint16_t position, void * buffer);
     bool peek(void* buffer) { return peekAt(0, buffer); }
 
-    inline bool     empty(void)     { return _count == 0;      }
-    inline bool     full(void)      { return _count == _depth; }
-    inline uint16_t count(void)     { return _count;           }
-    inline uint16_t remaining(void) { return _depth - _count;  }
+    // Zero-copy access: return number of contiguous items (and their address)
+    // available for reading/writing, then commit them with advance*()
+    uint16_t getReadSpan (void** ptr);
+    void     advanceRead (uint16_t n);
+
+    uint16_t getWriteSpan(void** ptr);
+    void     advanceWrite(uint16_t n);
+
+    inline uint16_t count(void)     { return _count(_wr_idx, _rd_idx); }
+    inline bool     empty(void)     { return _wr_idx == _rd_idx;       }
+    inline bool     full(void)      { return count() == _depth;        }
+    inline uint16_t remaining(void) { return _depth - count();         }
 };
 
 #endif /* _Adafruit_FIFO_H_ */
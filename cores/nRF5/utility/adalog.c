@@ -0,0 +1,352 @@
+/**************************************************************************/
+/*!
+    @file     adalog.c
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "Arduino.h"
+#include <stdarg.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#if CFG_DEBUG && CFG_ADALOG_DEFERRED
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define RING_WORDS        (CFG_ADALOG_RING_SIZE/4)
+#define RING_MASK         (RING_WORDS-1)
+
+VERIFY_STATIC((RING_WORDS & RING_MASK) == 0);
+
+/* Record is word aligned and never wraps around the ring
+ * - word 0 : site id (16) | record words (8) | nargs (8)
+ * - word 1 : timestamp in 1/32768 second (RTC2)
+ * - args   : one word each, string argument holds its length
+ * - strings: copied string arguments, each NUL terminated and padded to word
+ * Call site formatted synchronously has nargs = NARGS_TEXT and a single string.
+ */
+#define ID_PAD            0xFFFF   // rest of ring is unused, continue from start
+#define ID_DROPPED        0xFFFE   // binary output only, arg is number of dropped records
+#define NARGS_TEXT        0xFF
+
+#define INFO_PARSED       0x8000
+#define INFO_SYNC         0x4000   // format at call site
+#define INFO_STR_MASK     0x00FF
+
+#define TEXT_MAX          80
+#define DRAIN_STACK_SZ    (256*3)
+
+// binary frame sync, followed by record
+#define FRAME_SYNC0       0xAD
+#define FRAME_SYNC1       0x10
+
+extern adalog_site_t const __adalog_site_start__[];
+extern int _write (int fd, const void *buf, size_t count);
+
+static uint32_t _ring[RING_WORDS];
+static volatile uint32_t _wr_idx = 0; // free running word index
+static volatile uint32_t _rd_idx = 0;
+static volatile uint32_t _dropped = 0;
+
+static TaskHandle_t _drain_hdl = NULL;
+
+//--------------------------------------------------------------------+
+// Format parsing
+//--------------------------------------------------------------------+
+// Determine string arguments, or if call site can not be deferred
+static uint16_t parse_format(const char* fmt, uint32_t nargs)
+{
+  uint16_t info  = INFO_PARSED;
+  uint32_t count = 0;
+
+  for(const char* p = fmt; *p; p++)
+  {
+    if ( *p != '%' ) continue;
+
+    p++;
+    if ( *p == '%' ) continue;
+
+    // flags, width and precision
+    while ( *p && strchr("-+ #0", *p) ) p++;
+    while ( *p == '*' || isdigit((unsigned char) *p) ) { if ( *p == '*' ) count++; p++; }
+    if ( *p == '.' )
+    {
+      p++;
+      while ( *p == '*' || isdigit((unsigned char) *p) ) { if ( *p == '*' ) count++; p++; }
+    }
+
+    // length modifier, only 32-bit or smaller are deferred
+    if ( *p == 'h' )
+    {
+      p++;
+      if ( *p == 'h' ) p++;
+    }
+    else if ( *p == 'l' )
+    {
+      p++;
+      if ( *p == 'l' ) return info | INFO_SYNC;
+    }
+    else if ( *p == 'z' || *p == 't' )
+    {
+      p++;
+    }
+
+    switch ( *p )
+    {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c': case 'p':
+        count++;
+      break;
+
+      case 's':
+        if ( count < ADALOG_ARGS_MAX ) info |= (1U << count);
+        count++;
+      break;
+
+      // floating point, %n, j/L modifiers or truncated format
+      default: return info | INFO_SYNC;
+    }
+  }
+
+  if ( count != nargs || count > ADALOG_ARGS_MAX ) info |= INFO_SYNC;
+
+  return info;
+}
+
+//--------------------------------------------------------------------+
+// Producer
+//--------------------------------------------------------------------+
+void adalog_write(adalog_site_t const* site, uint16_t* info, uint32_t nargs, ...)
+{
+  uint16_t inf = *info;
+  if ( !(inf & INFO_PARSED) )
+  {
+    inf = parse_format(site->fmt, nargs);
+    *info = inf;
+  }
+
+  uint32_t    args[ADALOG_ARGS_MAX];
+  const char* strs[ADALOG_ARGS_MAX];
+  char        text[TEXT_MAX];
+  uint32_t    words = 2;
+
+  va_list ap;
+  va_start(ap, nargs);
+
+  if ( inf & INFO_SYNC )
+  {
+    int len = vsnprintf(text, sizeof(text), site->fmt, ap);
+    if ( len < 0 ) len = 0;
+    if ( len > TEXT_MAX-1 ) len = TEXT_MAX-1;
+
+    args[0] = (uint32_t) len;
+    strs[0] = text;
+    nargs   = NARGS_TEXT;
+    words  += 1 + (len + 4)/4;
+  }else
+  {
+    for(uint32_t i=0; i<nargs; i++)
+    {
+      args[i] = va_arg(ap, uint32_t);
+
+      if ( inf & (1U << i) )
+      {
+        const char* s = args[i] ? (const char*) args[i] : "(null)";
+        strs[i] = s;
+        args[i] = strnlen(s, ADALOG_STR_MAX);
+        words  += (args[i] + 4)/4;
+      }
+    }
+    words += nargs;
+  }
+
+  va_end(ap);
+
+  uint32_t const header = ((uint32_t) (site - __adalog_site_start__)) | (words << 16) | (nargs << 24);
+  uint32_t const ts     = hrclock_count();
+
+  uint32_t const arg_count = (nargs == NARGS_TEXT) ? 1 : nargs;
+  uint32_t const str_mask  = (nargs == NARGS_TEXT) ? 1 : (inf & INFO_STR_MASK);
+
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  uint32_t const wr   = _wr_idx;
+  uint32_t const pos  = wr & RING_MASK;
+  uint32_t const tail = RING_WORDS - pos;
+  uint32_t const pad  = (tail < words) ? tail : 0;
+  bool const was_empty = (wr == _rd_idx);
+
+  if ( (wr - _rd_idx) + pad + words > RING_WORDS )
+  {
+    _dropped++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return;
+  }
+
+  if ( pad ) _ring[pos] = ID_PAD;
+
+  uint32_t* p = &_ring[(wr + pad) & RING_MASK];
+  *p++ = header;
+  *p++ = ts;
+
+  for(uint32_t i=0; i<arg_count; i++) *p++ = args[i];
+
+  for(uint32_t i=0; i<arg_count; i++)
+  {
+    if ( !(str_mask & (1U << i)) ) continue;
+
+    uint32_t const len = args[i];
+    p[len/4] = 0; // NUL and padding
+    memcpy(p, strs[i], len);
+    p += (len + 4)/4;
+  }
+
+  __DMB();
+  _wr_idx = wr + pad + words;
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  // only wake up drain task for the first pending record
+  if ( was_empty && _drain_hdl && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) )
+  {
+    if ( isInISR() )
+    {
+      vTaskNotifyGiveFromISR(_drain_hdl, NULL);
+    }else
+    {
+      xTaskNotifyGive(_drain_hdl);
+    }
+  }
+}
+
+uint32_t adalog_dropped(void)
+{
+  return _dropped;
+}
+
+//--------------------------------------------------------------------+
+// Consumer
+//--------------------------------------------------------------------+
+static void output_record(uint32_t const* p)
+{
+#if CFG_ADALOG_DEFERRED == 2
+  uint8_t const sync[2] = { FRAME_SYNC0, FRAME_SYNC1 };
+  _write(1, sync, 2);
+  _write(1, p, ((p[0] >> 16) & 0xFF)*4);
+#else
+  adalog_site_t const* site = &__adalog_site_start__[p[0] & 0xFFFF];
+  uint32_t const nargs = p[0] >> 24;
+
+  if ( site->tag ) PRINTF("[%-6s] ", site->tag);
+
+  if ( nargs == NARGS_TEXT )
+  {
+    PRINTF("%s", (const char*) &p[3]);
+  }else
+  {
+    uint32_t const str_mask = parse_format(site->fmt, nargs) & INFO_STR_MASK;
+    uint32_t a[ADALOG_ARGS_MAX] = { 0 };
+    uint32_t const* s = &p[2 + nargs];
+
+    for(uint32_t i=0; i<nargs; i++)
+    {
+      if ( str_mask & (1U << i) )
+      {
+        a[i] = (uint32_t) s;
+        s += (p[2+i] + 4)/4;
+      }else
+      {
+        a[i] = p[2+i];
+      }
+    }
+
+    PRINTF(site->fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+  }
+
+  PRINTF("\r\n");
+#endif
+}
+
+static void output_dropped(uint32_t count)
+{
+#if CFG_ADALOG_DEFERRED == 2
+  uint32_t const rec[3] = { ID_DROPPED | (3UL << 16), hrclock_count(), count };
+  output_record(rec);
+#else
+  PRINTF("[%-6s] %lu messages dropped\r\n", "LOG", count);
+#endif
+}
+
+static void adalog_drain_task(void* arg)
+{
+  (void) arg;
+
+  uint32_t dropped_reported = 0;
+
+  while(1)
+  {
+    while ( _rd_idx != _wr_idx )
+    {
+      uint32_t const rd = _rd_idx;
+      uint32_t const* p = &_ring[rd & RING_MASK];
+
+      if ( (p[0] & 0xFFFF) == ID_PAD )
+      {
+        _rd_idx = rd + (RING_WORDS - (rd & RING_MASK));
+        continue;
+      }
+
+      output_record(p);
+
+      __DMB();
+      _rd_idx = rd + ((p[0] >> 16) & 0xFF);
+    }
+
+    uint32_t const dropped = _dropped;
+    if ( dropped != dropped_reported )
+    {
+      output_dropped(dropped - dropped_reported);
+      dropped_reported = dropped;
+    }
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void adalog_init(void)
+{
+  // records logged before this are drained once scheduler starts
+  xTaskCreate(adalog_drain_task, "log", DRAIN_STACK_SZ, NULL, TASK_PRIO_LOW, &_drain_hdl);
+}
+
+#endif
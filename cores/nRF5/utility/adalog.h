@@ -0,0 +1,91 @@
+/**************************************************************************/
+/*!
+    @file     adalog.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef ADALOG_H_
+#define ADALOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Deferred logging for LOG_LV1/LOG_LV2
+ * - 0: ADALOG formats and prints synchronously (default)
+ * - 1: call site records format id and raw arguments into a RAM ring, a low
+ *      priority task formats and prints them
+ * - 2: same as 1 but the drain task outputs binary frames, decoded on host with
+ *      tools/adalog/adalog.py using the sketch's elf
+ *
+ * Only integer, char and string (copied, truncated to ADALOG_STR_MAX) arguments
+ * are deferred, call sites with floating point or 64-bit arguments are printed
+ * synchronously. Records are dropped (and counted) when the ring is full.
+ */
+#ifndef CFG_ADALOG_DEFERRED
+#define CFG_ADALOG_DEFERRED     0
+#endif
+
+#ifndef CFG_ADALOG_RING_SIZE
+#define CFG_ADALOG_RING_SIZE    2048 // bytes
+#endif
+
+#define ADALOG_ARGS_MAX         8
+#define ADALOG_STR_MAX          31
+
+// Call site, placed in .adalog_site section whose index is the record id
+typedef struct
+{
+  const char* tag;
+  const char* fmt;
+} adalog_site_t;
+
+void adalog_init(void);
+void adalog_write(adalog_site_t const* site, uint16_t* info, uint32_t nargs, ...);
+uint32_t adalog_dropped(void);
+
+#define ADALOG_DEFERRED(_tag, _fmt, ...) \
+  do { \
+    static const adalog_site_t _adalog_site __attribute__((section(".adalog_site"), used)) = { _tag, _fmt }; \
+    static uint16_t _adalog_info = 0; \
+    adalog_write(&_adalog_site, &_adalog_info, VA_ARGS_NUM(__VA_ARGS__), ##__VA_ARGS__); \
+  } while(0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADALOG_H_ */
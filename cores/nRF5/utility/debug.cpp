@@ -131,6 +131,20 @@ void dbgMemInfo(void)
   PRINTF("|______________________________________________|\r\n");
   PRINTF("\n");
 
+  // Print rtos heap pool usage per subsystem
+  rtos_heap_stats_t hstats;
+  if ( rtos_heap_stats(&hstats) && hstats.size )
+  {
+    PRINTF("Pool: %lu / %lu used (peak %lu), largest free %lu, fragmentation %u.%u%%, %lu fallback\r\n",
+           hstats.used, hstats.size, hstats.used_peak, hstats.largest_free,
+           hstats.frag_permille/10, hstats.frag_permille%10, hstats.fallback_count);
+    for(uint8_t tag=0; tag<HEAP_TAG_COUNT; tag++)
+    {
+      if ( hstats.tag_blocks[tag] ) PRINTF("  %-8s %6lu bytes in %u blocks\r\n", rtos_heap_tag_str(tag), hstats.tag_used[tag], hstats.tag_blocks[tag]);
+    }
+    PRINTF("\n");
+  }
+
   // Print Task list
   uint32_t tasknum = uxTaskGetNumberOfTasks();
   char* buf = (char*) rtos_malloc(tasknum*40); // 40 bytes per task
@@ -153,6 +167,215 @@ void dbgPrintVersion(void)
   PRINTF("\r\n");
 }
 
+//--------------------------------------------------------------------+
+// Runtime Stats
+//--------------------------------------------------------------------+
+#define STATS_TASK_MAX    16
+
+// hrclock count (32768 Hz) to microseconds
+#define STATS_COUNT2US(_cnt)   ((uint32_t) ((((uint64_t) (_cnt)) * 15625) / 512))
+
+volatile uint32_t _dbg_isr_count  = 0;
+volatile uint32_t _dbg_isr_cycles = 0;
+volatile uint32_t _dbg_isr_start  = 0;
+volatile uint8_t  _dbg_isr_depth  = 0;
+
+static volatile uint32_t _sleep_enter = 0;
+static volatile uint32_t _sleep_total = 0;
+
+// Snapshot of previous call, tasks are identified by their unique task number
+static struct
+{
+  uint32_t time;
+  uint32_t sleep;
+  uint32_t isr_count;
+  uint32_t isr_cycles;
+
+  uint8_t  count;
+  struct
+  {
+    UBaseType_t num;
+    uint32_t runtime;
+    uint32_t switches;
+  } task[STATS_TASK_MAX];
+} _stats_prev;
+
+static TimerHandle_t _stats_timer = NULL;
+
+void dbgSleepEnter(void)
+{
+  _sleep_enter = hrclock_count();
+}
+
+void dbgSleepExit(void)
+{
+  _sleep_total += hrclock_count() - _sleep_enter;
+}
+
+static uint16_t stats_permille(uint32_t part, uint32_t total)
+{
+  if ( total == 0 ) return 0;
+  return (uint16_t) minof((((uint64_t) part) * 1000) / total, (uint64_t) 1000);
+}
+
+uint8_t dbgTaskStats(dbg_sys_stats_t* sys, dbg_task_stats_t* tasks, uint8_t max)
+{
+  UBaseType_t const tasknum = uxTaskGetNumberOfTasks();
+  TaskStatus_t* status = (TaskStatus_t*) rtos_malloc(tasknum*sizeof(TaskStatus_t));
+  VERIFY(status, 0);
+
+  UBaseType_t const count = uxTaskGetSystemState(status, tasknum, NULL);
+
+  uint32_t const now        = hrclock_count();
+  uint32_t const sleep      = _sleep_total;
+  uint32_t const isr_count  = _dbg_isr_count;
+  uint32_t const isr_cycles = _dbg_isr_cycles;
+
+  uint32_t const window = now - _stats_prev.time;
+  TaskHandle_t const idle_hdl = xTaskGetIdleTaskHandle();
+
+  uint32_t idle_time  = 0;
+  uint32_t switches   = 0;
+  uint8_t  filled     = 0;
+  uint8_t  prev_count = 0;
+
+  for(UBaseType_t i=0; i<count; i++)
+  {
+    TaskStatus_t const* st = &status[i];
+    uint32_t const sw = (uint32_t) pvTaskGetThreadLocalStoragePointer(st->xHandle, configSTATS_SWITCH_TLS_INDEX);
+
+    // task created within window has its whole lifetime counted
+    uint32_t d_runtime = st->ulRunTimeCounter;
+    uint32_t d_switch  = sw;
+    for(uint8_t p=0; p<_stats_prev.count; p++)
+    {
+      if ( _stats_prev.task[p].num == st->xTaskNumber )
+      {
+        d_runtime -= _stats_prev.task[p].runtime;
+        d_switch  -= _stats_prev.task[p].switches;
+        break;
+      }
+    }
+
+    if ( prev_count < STATS_TASK_MAX )
+    {
+      _stats_prev.task[prev_count].num      = st->xTaskNumber;
+      _stats_prev.task[prev_count].runtime  = st->ulRunTimeCounter;
+      _stats_prev.task[prev_count].switches = sw;
+      prev_count++;
+    }
+
+    if ( st->xHandle == idle_hdl ) idle_time = d_runtime;
+    switches += d_switch;
+
+    if ( tasks == NULL || max == 0 ) continue;
+
+    dbg_task_stats_t item;
+    strncpy(item.name, st->pcTaskName, sizeof(item.name)-1);
+    item.name[sizeof(item.name)-1] = 0;
+    item.handle       = st->xHandle;
+    item.priority     = (uint8_t) st->uxCurrentPriority;
+    item.stack_left   = (uint16_t) st->usStackHighWaterMark;
+    item.runtime_us   = STATS_COUNT2US(d_runtime);
+    item.cpu_permille = stats_permille(d_runtime, window);
+    item.switches     = d_switch;
+
+    // insertion sort by cpu usage, drop the least busy when full
+    uint8_t pos = filled;
+    while ( pos > 0 && tasks[pos-1].cpu_permille < item.cpu_permille ) pos--;
+
+    if ( pos < max )
+    {
+      uint8_t const last = (filled < max) ? filled : (max-1);
+      for(uint8_t k=last; k>pos; k--) tasks[k] = tasks[k-1];
+      tasks[pos] = item;
+      if ( filled < max ) filled++;
+    }
+  }
+
+  rtos_free(status);
+
+  if ( sys )
+  {
+    uint32_t const d_sleep = sleep - _stats_prev.sleep;
+
+    sys->window_us      = STATS_COUNT2US(window);
+    sys->sleep_permille = stats_permille(d_sleep, window);
+    sys->idle_permille  = (idle_time > d_sleep) ? stats_permille(idle_time - d_sleep, window) : 0;
+    sys->cpu_permille   = 1000 - minof(sys->idle_permille + sys->sleep_permille, 1000);
+    sys->isr_count      = isr_count - _stats_prev.isr_count;
+    sys->switches       = switches;
+    sys->task_count     = (uint8_t) count;
+
+    // cycles per hrclock count is F_CPU/32768
+    sys->isr_permille = stats_permille(isr_cycles - _stats_prev.isr_cycles,
+                                       (uint32_t) minof((((uint64_t) window) * F_CPU) / 32768, (uint64_t) UINT32_MAX));
+  }
+
+  _stats_prev.time       = now;
+  _stats_prev.sleep      = sleep;
+  _stats_prev.isr_count  = isr_count;
+  _stats_prev.isr_cycles = isr_cycles;
+  _stats_prev.count      = prev_count;
+
+  return filled;
+}
+
+void dbgPrintTaskStats(void)
+{
+  dbg_task_stats_t* tasks = (dbg_task_stats_t*) rtos_malloc(STATS_TASK_MAX*sizeof(dbg_task_stats_t));
+  VERIFY(tasks, );
+
+  dbg_sys_stats_t sys;
+  uint8_t const count = dbgTaskStats(&sys, tasks, STATS_TASK_MAX);
+
+  PRINTF("Window %lu ms: CPU %u.%u%%, Idle %u.%u%%, Sleep %u.%u%%, ISR %u.%u%% (%lu irqs), %lu switches\r\n",
+         sys.window_us/1000, sys.cpu_permille/10, sys.cpu_permille%10, sys.idle_permille/10, sys.idle_permille%10,
+         sys.sleep_permille/10, sys.sleep_permille%10, sys.isr_permille/10, sys.isr_permille%10, sys.isr_count, sys.switches);
+
+  PRINTF("Task     Prio  StackLeft   CPU%%  Runtime(us)  Switches\r\n");
+  PRINTF("--------------------------------------------------------\r\n");
+  for(uint8_t i=0; i<count; i++)
+  {
+    dbg_task_stats_t const* t = &tasks[i];
+    PRINTF("%-8s %4u  %9u  %3u.%u  %11lu  %8lu\r\n", t->name, t->priority, t->stack_left,
+           t->cpu_permille/10, t->cpu_permille%10, t->runtime_us, t->switches);
+  }
+  PRINTF("\n");
+
+  rtos_free(tasks);
+}
+
+static void stats_timer_cb(TimerHandle_t xTimer)
+{
+  (void) xTimer;
+
+  // timer task stack is too small for printing
+  ada_callback(NULL, 0, dbgPrintTaskStats);
+}
+
+void dbgTaskStatsPrinter(uint32_t interval_ms)
+{
+  if ( interval_ms == 0 )
+  {
+    if ( _stats_timer ) xTimerStop(_stats_timer, 0);
+    return;
+  }
+
+  if ( _stats_timer == NULL )
+  {
+    _stats_timer = xTimerCreate(NULL, ms2tick(interval_ms), true, NULL, stats_timer_cb);
+    VERIFY(_stats_timer, );
+  }else
+  {
+    xTimerChangePeriod(_stats_timer, ms2tick(interval_ms), 0);
+  }
+
+  // reset window
+  (void) dbgTaskStats(NULL, NULL, 0);
+  xTimerStart(_stats_timer, 0);
+}
+
 /******************************************************************************/
 /*!
     @brief  Helper function to display memory contents in a friendly format
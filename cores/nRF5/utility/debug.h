@@ -38,6 +38,7 @@
 #define _DEBUG_H
 
 #include "common_inc.h"
+#include "delay.h"
 
 #ifdef __cplusplus
  extern "C" {
@@ -65,6 +66,73 @@ void dbgPrintVersion(void);
 void dbgDumpMemory(void const *buf, uint8_t size, uint16_t count, bool printOffset);
 void dbgDumpMemoryCFormat(const char* str, void const *buf, uint16_t count);
 
+//--------------------------------------------------------------------+
+// Runtime Stats
+// Run time counter is RTC2 (32768 Hz) which keeps running in tickless idle.
+// All numbers are computed over the window since the previous dbgTaskStats()
+// call, windows are shared between all callers.
+//--------------------------------------------------------------------+
+typedef struct
+{
+  char     name[8];        // configMAX_TASK_NAME_LEN
+  void*    handle;         // TaskHandle_t
+  uint8_t  priority;
+  uint16_t stack_left;     // high water mark in words
+  uint32_t runtime_us;     // within window
+  uint16_t cpu_permille;
+  uint32_t switches;       // context switches into this task within window
+} dbg_task_stats_t;
+
+typedef struct
+{
+  uint32_t window_us;
+  uint16_t cpu_permille;   // running tasks or ISR
+  uint16_t idle_permille;  // idle task but not sleeping
+  uint16_t sleep_permille; // tickless sleep
+  uint16_t isr_permille;   // core ISRs, 0 unless DWT is enabled with dwt_enable()
+  uint32_t isr_count;
+  uint32_t switches;
+  uint8_t  task_count;
+} dbg_sys_stats_t;
+
+// Fill sys stats and up to max tasks sorted by CPU usage, return number of tasks filled
+uint8_t dbgTaskStats(dbg_sys_stats_t* sys, dbg_task_stats_t* tasks, uint8_t max);
+
+void dbgPrintTaskStats(void);
+
+// Periodically print task stats from callback task, 0 to stop
+void dbgTaskStatsPrinter(uint32_t interval_ms);
+
+// Sleep residency, invoked by tickless idle
+void dbgSleepEnter(void);
+void dbgSleepExit(void);
+
+// ISR accounting, core handlers are wrapped with these
+extern volatile uint32_t _dbg_isr_count;
+extern volatile uint32_t _dbg_isr_cycles;
+extern volatile uint32_t _dbg_isr_start;
+extern volatile uint8_t  _dbg_isr_depth;
+
+// Handlers of different priorities nest, read-modify-write is done with interrupts masked
+static inline void dbgIsrEnter(void)
+{
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  _dbg_isr_count++;
+  if ( _dbg_isr_depth++ == 0 ) _dbg_isr_start = DWT->CYCCNT;
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+static inline void dbgIsrExit(void)
+{
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if ( --_dbg_isr_depth == 0 && dwt_enabled() ) _dbg_isr_cycles += DWT->CYCCNT - _dbg_isr_start;
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
 #ifdef __cplusplus
  }
 #endif
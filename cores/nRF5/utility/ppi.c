@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*!
+    @file     ppi.c
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2020, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "Arduino.h"
+#include "nrf_soc.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define PPI_PROG_CHANNELS     20 // channel 20-31 are pre-programmed
+
+#define PPI_APP_CHANNELS_MSK  (NRF_SOC_APP_PPI_CHANNELS_SD_ENABLED_MSK & ((1UL << PPI_PROG_CHANNELS) - 1))
+
+static uint32_t _ppi_used = 0;
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+int8_t ppi_channel_alloc(volatile uint32_t const* eep, volatile uint32_t const* tep)
+{
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint32_t const free_msk = PPI_APP_CHANNELS_MSK & ~_ppi_used;
+  int8_t const ch = free_msk ? (int8_t) __builtin_ctz(free_msk) : -1;
+  if ( ch >= 0 ) _ppi_used |= (1UL << ch);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  VERIFY(ch >= 0, -1);
+
+  NRF_PPI->CHENCLR      = (1UL << ch);
+  NRF_PPI->CH[ch].EEP   = (uint32_t) eep;
+  NRF_PPI->CH[ch].TEP   = (uint32_t) tep;
+  NRF_PPI->FORK[ch].TEP = 0;
+
+  return ch;
+}
+
+void ppi_channel_fork(int8_t ch, volatile uint32_t const* tep)
+{
+  NRF_PPI->FORK[ch].TEP = (uint32_t) tep;
+}
+
+void ppi_channel_task(int8_t ch, volatile uint32_t const* tep)
+{
+  NRF_PPI->CH[ch].TEP = (uint32_t) tep;
+}
+
+void ppi_channel_enable(int8_t ch)
+{
+  NRF_PPI->CHENSET = (1UL << ch);
+}
+
+void ppi_channel_disable(int8_t ch)
+{
+  NRF_PPI->CHENCLR = (1UL << ch);
+}
+
+void ppi_channel_free(int8_t ch)
+{
+  if ( ch < 0 || ch >= PPI_PROG_CHANNELS ) return;
+
+  NRF_PPI->CHENCLR      = (1UL << ch);
+  NRF_PPI->CH[ch].EEP   = 0;
+  NRF_PPI->CH[ch].TEP   = 0;
+  NRF_PPI->FORK[ch].TEP = 0;
+
+  UBaseType_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  _ppi_used &= ~(1UL << ch);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
@@ -0,0 +1,271 @@
+/**************************************************************************/
+/*!
+    @file     systrace.c
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "Arduino.h"
+
+#if CFG_SYSTRACE
+
+#if CFG_SYSVIEW
+#include "SEGGER_SYSVIEW.h"
+#endif
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define RING_MASK   (CFG_SYSTRACE_BUFFER_SIZE-1)
+
+VERIFY_STATIC((CFG_SYSTRACE_BUFFER_SIZE & RING_MASK) == 0);
+
+static systrace_rec_t _ring[CFG_SYSTRACE_BUFFER_SIZE];
+static uint32_t _wr_idx = 0; // free running
+static volatile bool _enabled = true;
+
+// No space since they are also SystemView event names
+static const char* _names[SYSTRACE_ID_MAX] =
+{
+  [SYSTRACE_BLE_EVT     ] = "BleEvt",
+  [SYSTRACE_BLE_HVN_WAIT] = "HvnWait",
+  [SYSTRACE_BLE_NOTIFY  ] = "Notify",
+  [SYSTRACE_CALLBACK    ] = "Callback",
+  [SYSTRACE_FLASH_ERASE ] = "FlashErase",
+  [SYSTRACE_FLASH_WRITE ] = "FlashWrite",
+  [SYSTRACE_FS          ] = "LittleFS",
+  [SYSTRACE_UART_TX     ] = "UartTx",
+  [SYSTRACE_UART_RX     ] = "UartRx",
+  [SYSTRACE_WIRE        ] = "Wire",
+};
+
+static const char* _type_str[] = { "START", "STOP", "MARK" };
+
+//--------------------------------------------------------------------+
+// SystemView
+//--------------------------------------------------------------------+
+#if CFG_SYSVIEW
+static void sysview_send_desc(void);
+
+static SEGGER_SYSVIEW_MODULE _sysview_module =
+{
+  .sModule          = "M=Adafruit",
+  .NumEvents        = SYSTRACE_ID_MAX,
+  .EventOffset      = 0,
+  .pfSendModuleDesc = sysview_send_desc,
+  .pNext            = NULL
+};
+
+// Invoked when host starts recording
+static void sysview_send_desc(void)
+{
+  char desc[32];
+
+  for(uint8_t id=0; id<SYSTRACE_ID_MAX; id++)
+  {
+    if ( !_names[id] ) continue;
+
+    SEGGER_SYSVIEW_NameMarker(id, _names[id]);
+
+    snprintf(desc, sizeof(desc), "%u %s data=%%u", id, _names[id]);
+    SEGGER_SYSVIEW_RecordModuleDescription(&_sysview_module, desc);
+  }
+}
+#endif
+
+//--------------------------------------------------------------------+
+// Recording
+//--------------------------------------------------------------------+
+static void ring_record(uint8_t id, uint8_t type, uint32_t data)
+{
+  if ( !_enabled ) return;
+
+  // slot is claimed atomically (ldrex/strex), safe from ISR of any priority
+  uint32_t const idx  = __atomic_fetch_add(&_wr_idx, 1, __ATOMIC_RELAXED);
+  uint32_t const ipsr = __get_IPSR();
+
+  systrace_rec_t* rec = &_ring[idx & RING_MASK];
+
+  rec->time_us = micros();
+  rec->id      = id;
+  rec->type    = type;
+  rec->isr     = (uint8_t) ipsr;
+  rec->task    = ipsr ? NULL : xTaskGetCurrentTaskHandle();
+  rec->data    = data;
+}
+
+void systrace_start(uint8_t id, uint32_t data)
+{
+#if CFG_SYSVIEW
+  if ( SEGGER_SYSVIEW_IsStarted() )
+  {
+    SEGGER_SYSVIEW_RecordU32(_sysview_module.EventOffset + id, data);
+    SEGGER_SYSVIEW_MarkStart(id);
+    return;
+  }
+#endif
+
+  ring_record(id, SYSTRACE_TYPE_START, data);
+}
+
+void systrace_stop(uint8_t id, uint32_t data)
+{
+#if CFG_SYSVIEW
+  if ( SEGGER_SYSVIEW_IsStarted() )
+  {
+    SEGGER_SYSVIEW_MarkStop(id);
+    return;
+  }
+#endif
+
+  ring_record(id, SYSTRACE_TYPE_STOP, data);
+}
+
+void systrace_mark(uint8_t id, uint32_t data)
+{
+#if CFG_SYSVIEW
+  if ( SEGGER_SYSVIEW_IsStarted() )
+  {
+    SEGGER_SYSVIEW_RecordU32(_sysview_module.EventOffset + id, data);
+    return;
+  }
+#endif
+
+  ring_record(id, SYSTRACE_TYPE_MARK, data);
+}
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+void systrace_init(void)
+{
+  // interpolate micros() with cycle counter for ~1 us resolution
+  if ( !dwt_enabled() ) dwt_enable();
+
+#if CFG_SYSVIEW
+  SEGGER_SYSVIEW_RegisterModule(&_sysview_module);
+#endif
+}
+
+void systrace_enable(bool enabled)
+{
+  _enabled = enabled;
+}
+
+void systrace_clear(void)
+{
+  __atomic_store_n(&_wr_idx, 0, __ATOMIC_RELAXED);
+}
+
+void systrace_name(uint8_t id, const char* name)
+{
+  if ( id < SYSTRACE_USER || id >= SYSTRACE_ID_MAX ) return;
+  _names[id] = name;
+}
+
+uint32_t systrace_read(systrace_rec_t* recs, uint32_t max)
+{
+  uint32_t const wr = __atomic_load_n(&_wr_idx, __ATOMIC_ACQUIRE);
+
+  uint32_t count = minof(wr, (uint32_t) CFG_SYSTRACE_BUFFER_SIZE);
+  count = minof(count, max);
+
+  for(uint32_t i=0; i<count; i++)
+  {
+    recs[i] = _ring[(wr - count + i) & RING_MASK];
+  }
+
+  return count;
+}
+
+static const char* task_name(void* handle, TaskStatus_t const* status, UBaseType_t count)
+{
+  for(UBaseType_t i=0; i<count; i++)
+  {
+    if ( status[i].xHandle == handle ) return status[i].pcTaskName;
+  }
+
+  return "?";
+}
+
+void systrace_dump(void)
+{
+  // freeze the ring while printing
+  bool const enabled = _enabled;
+  _enabled = false;
+
+  // task handles are resolved against current tasks, deleted one is shown as '?'
+  UBaseType_t tasknum = uxTaskGetNumberOfTasks();
+  TaskStatus_t* status = (TaskStatus_t*) rtos_malloc(tasknum*sizeof(TaskStatus_t));
+  tasknum = status ? uxTaskGetSystemState(status, tasknum, NULL) : 0;
+
+  uint32_t const wr    = __atomic_load_n(&_wr_idx, __ATOMIC_ACQUIRE);
+  uint32_t const count = minof(wr, (uint32_t) CFG_SYSTRACE_BUFFER_SIZE);
+
+  PRINTF("\r\n  Time (us)    Delta  Context   Type   Marker        Data\r\n");
+
+  uint32_t prev_us = 0;
+  for(uint32_t i=0; i<count; i++)
+  {
+    systrace_rec_t const* rec = &_ring[(wr - count + i) & RING_MASK];
+
+    char ctx[12];
+    if ( rec->isr )
+    {
+      snprintf(ctx, sizeof(ctx), "ISR %d", ((int) rec->isr) - 16);
+    }else
+    {
+      snprintf(ctx, sizeof(ctx), "%s", task_name(rec->task, status, tasknum));
+    }
+
+    char marker[12];
+    if ( rec->id < SYSTRACE_ID_MAX && _names[rec->id] )
+    {
+      snprintf(marker, sizeof(marker), "%s", _names[rec->id]);
+    }else
+    {
+      snprintf(marker, sizeof(marker), "USER+%u", rec->id - SYSTRACE_USER);
+    }
+
+    PRINTF("%11lu %8ld  %-8s  %-5s  %-12s  0x%08lX\r\n", rec->time_us, i ? (int32_t) (rec->time_us - prev_us) : 0,
+           ctx, _type_str[rec->type], marker, rec->data);
+
+    prev_us = rec->time_us;
+  }
+
+  PRINTF("\r\n");
+
+  rtos_free(status);
+  _enabled = enabled;
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**************************************************************************/
+/*!
+    @file     systrace.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef SYSTRACE_H_
+#define SYSTRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hot path instrumentation markers
+ * - SYSTRACE_START/STOP bracket an operation (SystemView named marker)
+ * - SYSTRACE_MARK is a point event carrying 32-bit data (SystemView user event)
+ *
+ * When SystemView is recording, markers are sent to it. Otherwise they are
+ * stored in a RAM ring (flight recorder, oldest records are overwritten) that
+ * can be read back with systrace_read() or printed with systrace_dump().
+ * Enabled by default with CFG_SYSVIEW, or alone with -DCFG_SYSTRACE=1.
+ * Markers compile to nothing when disabled.
+ */
+#ifndef CFG_SYSTRACE
+#define CFG_SYSTRACE              CFG_SYSVIEW
+#endif
+
+#ifndef CFG_SYSTRACE_BUFFER_SIZE
+#define CFG_SYSTRACE_BUFFER_SIZE  128 // records, must be power of 2
+#endif
+
+enum
+{
+  SYSTRACE_BLE_EVT = 0,   // data: BLE event id
+  SYSTRACE_BLE_HVN_WAIT,  // waiting for free notification packet, data: conn handle
+  SYSTRACE_BLE_NOTIFY,    // data: conn handle << 16 | packet length
+  SYSTRACE_CALLBACK,      // data: callback function
+  SYSTRACE_FLASH_ERASE,   // data: address
+  SYSTRACE_FLASH_WRITE,   // data: address
+  SYSTRACE_FS,            // LittleFS operation (lock held)
+  SYSTRACE_UART_TX,       // DMA transfer, data: count
+  SYSTRACE_UART_RX,       // data: received byte
+  SYSTRACE_WIRE,          // data: address << 16 | count, bit 15 set for read
+
+  SYSTRACE_USER,          // first id for application markers
+  SYSTRACE_ID_MAX = 32
+};
+
+enum
+{
+  SYSTRACE_TYPE_START = 0,
+  SYSTRACE_TYPE_STOP,
+  SYSTRACE_TYPE_MARK,
+};
+
+typedef struct
+{
+  uint32_t time_us;       // micros(), ~1 us resolution with DWT enabled
+  uint8_t  id;
+  uint8_t  type;
+  uint8_t  isr;           // active exception number, 0 in thread mode
+  uint8_t  reserved;
+  void*    task;          // TaskHandle_t, NULL if isr
+  uint32_t data;
+} systrace_rec_t;
+
+void systrace_init(void);
+
+void systrace_start(uint8_t id, uint32_t data);
+void systrace_stop (uint8_t id, uint32_t data);
+void systrace_mark (uint8_t id, uint32_t data);
+
+void systrace_enable(bool enabled); // e.g stop recording to freeze the ring after an anomaly
+void systrace_clear(void);
+void systrace_name(uint8_t id, const char* name); // name of application markers
+
+// Copy up to max records from oldest to newest, return number of records copied
+uint32_t systrace_read(systrace_rec_t* recs, uint32_t max);
+void systrace_dump(void);
+
+#if CFG_SYSTRACE
+  #define SYSTRACE_START(_id, _data)  systrace_start(_id, (uint32_t) (_data))
+  #define SYSTRACE_STOP(_id, _data)   systrace_stop(_id, (uint32_t) (_data))
+  #define SYSTRACE_MARK(_id, _data)   systrace_mark(_id, (uint32_t) (_data))
+#else
+  #define SYSTRACE_START(_id, _data)
+  #define SYSTRACE_STOP(_id, _data)
+  #define SYSTRACE_MARK(_id, _data)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYSTRACE_H_ */
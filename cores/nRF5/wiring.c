@@ -62,6 +62,9 @@ void init( void )
   NRF_RTC1->TASKS_STOP  = 1;
   NRF_RTC1->TASKS_CLEAR = 1;
 
+  // RTC2 is used for 64-bit clock micros64()
+  hrclock_init();
+
   // Make sure all pin is set HIGH when pinmode() is called
   NRF_P0->OUTSET = UINT32_MAX;
 #ifdef NRF_P1
@@ -32,6 +32,7 @@
 #include "littlefs/lfs.h"
 #include "Adafruit_LittleFS_File.h"
 #include "rtos.h" // tied to FreeRTOS for serialization
+#include "utility/systrace.h"
 
 class Adafruit_LittleFS
 {
@@ -76,8 +77,8 @@ class Adafruit_LittleFS
      * code. User should not call these directly
      *------------------------------------------------------------------*/
     lfs_t* _getFS   (void) { return &_lfs; }
-    void   _lockFS  (void) { xSemaphoreTake(_mutex,  portMAX_DELAY); }
-    void   _unlockFS(void) { xSemaphoreGive(_mutex); }
+    void   _lockFS  (void) { xSemaphoreTake(_mutex,  portMAX_DELAY); SYSTRACE_START(SYSTRACE_FS, 0); }
+    void   _unlockFS(void) { SYSTRACE_STOP(SYSTRACE_FS, 0); xSemaphoreGive(_mutex); }
 
   protected:
     bool _mounted;
@@ -57,7 +57,7 @@ bool File::_open_file (char const *filepath, uint8_t mode)
 
   if ( flags )
   {
-    _file = (lfs_file_t*) rtos_malloc(sizeof(lfs_file_t));
+    _file = (lfs_file_t*) rtos_malloc_tag(sizeof(lfs_file_t), HEAP_TAG_FS);
     if (!_file) return false;
 
     int rc = lfs_file_open(_fs->_getFS(), _file, filepath, flags);
@@ -80,7 +80,7 @@ bool File::_open_file (char const *filepath, uint8_t mode)
 
 bool File::_open_dir (char const *filepath)
 {
-  _dir = (lfs_dir_t*) rtos_malloc(sizeof(lfs_dir_t));
+  _dir = (lfs_dir_t*) rtos_malloc_tag(sizeof(lfs_dir_t), HEAP_TAG_FS);
   if (!_dir) return false;
 
   int rc = lfs_dir_open(_fs->_getFS(), _dir, filepath);
@@ -94,7 +94,7 @@ bool File::_open_dir (char const *filepath)
 
   _is_dir = true;
 
-  _dir_path = (char*) rtos_malloc(strlen(filepath) + 1);
+  _dir_path = (char*) rtos_malloc_tag(strlen(filepath) + 1, HEAP_TAG_FS);
   strcpy(_dir_path, filepath);
 
   return true;
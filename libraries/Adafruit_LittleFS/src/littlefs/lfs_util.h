@@ -26,6 +26,7 @@
 
 #ifndef LFS_NO_MALLOC
 #include <stdlib.h>
+#include "rtos_heap.h"
 #endif
 #ifndef LFS_NO_ASSERT
 #include <assert.h>
@@ -168,8 +169,7 @@ void lfs_crc(uint32_t *crc, const void *buffer, size_t size);
 // Allocate memory, only used if buffers are not provided to littlefs
 static inline void *lfs_malloc(size_t size) {
 #ifndef LFS_NO_MALLOC
-    extern void *pvPortMalloc( size_t xWantedSize );
-    return pvPortMalloc(size);
+    return rtos_malloc_tag(size, HEAP_TAG_FS);
 #else
     (void)size;
     return NULL;
@@ -179,8 +179,7 @@ static inline void *lfs_malloc(size_t size) {
 // Deallocate memory, only used if buffers are not provided to littlefs
 static inline void lfs_free(void *p) {
 #ifndef LFS_NO_MALLOC
-    extern void vPortFree( void *pv );
-    vPortFree(p);
+    rtos_free(p);
 #else
     (void)p;
 #endif
@@ -0,0 +1,58 @@
+/*********************************************************************
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ Copyright (c) 2019 Ha Thach for Adafruit Industries
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This example streams data to host as fast as possible using zero-copy
+ * write: Serial lends free space of its TX FIFO, sketch fills it in place
+ * then commits. Bytes sent per second are printed every second.
+ *
+ * Capture on host e.g: cat /dev/ttyACM0 > /dev/null
+ *
+ * Requirement:
+ *  For best throughput build with -DCFG_TUD_CDC_HIGH_THROUGHPUT=1 (nRF52)
+ *  which enables multi-KB CDC FIFOs and 512-byte transfers.
+ *  Config file is located in Adafruit_TinyUSB_Arduino/src/arduino/ports/nrf/tusb_config_nrf.h
+ */
+
+#include <Adafruit_TinyUSB.h>
+
+uint32_t total = 0;
+uint32_t last_ms = 0;
+uint8_t pattern = 0;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10);   // wait for host to open port
+}
+
+void loop() {
+  uint8_t* buf;
+  size_t const len = Serial.writeReserve(&buf);
+
+  if (len) {
+    // fill FIFO in place, data is sent on packet boundaries
+    for (size_t i = 0; i < len; i++) {
+      buf[i] = 'A' + (pattern++ % 26);
+    }
+    total += Serial.writeCommit(len);
+  } else {
+    // FIFO is full, let usb task drain it
+    yield();
+  }
+
+  if (millis() - last_ms >= 1000) {
+    last_ms = millis();
+
+    char msg[32];
+    int n = snprintf(msg, sizeof(msg), "\r\n%lu B/s\r\n", (unsigned long) total);
+    Serial.write((uint8_t const*) msg, n);
+    total = 0;
+  }
+}
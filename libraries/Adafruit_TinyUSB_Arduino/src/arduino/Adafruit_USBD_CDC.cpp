@@ -41,15 +41,33 @@
 #define EPOUT 0x00
 #define EPIN 0x80
 
+// With an RTOS, write() blocks on a semaphore given by usb task when a
+// transfer completes instead of polling with yield()
+#if defined(ARDUINO_NRF52_ADAFRUIT) && CFG_TUSB_OS == OPT_OS_FREERTOS
+#define CDC_TX_SEMAPHORE 1
+#define CDC_TX_WAIT_MS 10
+
+static osal_semaphore_def_t _tx_sem_def[CFG_TUD_CDC];
+static osal_semaphore_t _tx_sem[CFG_TUD_CDC];
+#else
+#define CDC_TX_SEMAPHORE 0
+#endif
+
 // SerialTinyUSB can be macro expanding to "Serial" on supported cores
 Adafruit_USBD_CDC SerialTinyUSB;
 
+// Instances by interface for callbacks
+static Adafruit_USBD_CDC *_cdc_itf[CFG_TUD_CDC];
+
 //------------- Static member -------------//
 uint8_t Adafruit_USBD_CDC::_instance_count = 0;
 
 uint8_t Adafruit_USBD_CDC::getInstanceCount(void) { return _instance_count; }
 
-Adafruit_USBD_CDC::Adafruit_USBD_CDC(void) { _instance = INVALID_INSTANCE; }
+Adafruit_USBD_CDC::Adafruit_USBD_CDC(void) {
+  _instance = INVALID_INSTANCE;
+  _rx_cb = NULL;
+}
 
 uint16_t Adafruit_USBD_CDC::getInterfaceDescriptor(uint8_t itfnum, uint8_t *buf,
                                                    uint16_t bufsize) {
@@ -81,6 +99,14 @@ void Adafruit_USBD_CDC::begin(uint32_t baud) {
   }
 
   _instance = _instance_count++;
+  _cdc_itf[_instance] = this;
+
+#if CDC_TX_SEMAPHORE
+  if (!_tx_sem[_instance]) {
+    _tx_sem[_instance] = osal_semaphore_create(&_tx_sem_def[_instance]);
+  }
+#endif
+
   this->setStringDescriptor("TinyUSB Serial");
   TinyUSBDevice.addInterface(*this);
 }
@@ -94,6 +120,7 @@ void Adafruit_USBD_CDC::end(void) {
   // Reset configuration descriptor without Serial as CDC
   TinyUSBDevice.clearConfiguration();
   _instance_count = 0;
+  memset(_cdc_itf, 0, sizeof(_cdc_itf));
   _instance = INVALID_INSTANCE;
 }
 
@@ -229,6 +256,15 @@ size_t Adafruit_USBD_CDC::write(const uint8_t *buffer, size_t size) {
 
     // Write FIFO is full, run usb background to flush
     if (remain) {
+#if CDC_TX_SEMAPHORE
+      if (!isInISR()) {
+        // kick transfer in case FIFO is below packet size, then wait for
+        // usb task to drain it
+        tud_cdc_n_write_flush(_instance);
+        osal_semaphore_wait(_tx_sem[_instance], CDC_TX_WAIT_MS);
+        continue;
+      }
+#endif
       yield();
     }
   }
@@ -236,6 +272,44 @@ size_t Adafruit_USBD_CDC::write(const uint8_t *buffer, size_t size) {
   return size - remain;
 }
 
+size_t Adafruit_USBD_CDC::writeReserve(uint8_t **buffer) {
+  *buffer = NULL;
+
+  if (!isValid() || !tud_cdc_n_connected(_instance)) {
+    return 0;
+  }
+
+  return tud_cdc_n_write_reserve(_instance, (void **)buffer);
+}
+
+size_t Adafruit_USBD_CDC::writeCommit(size_t count) {
+  if (!isValid()) {
+    return 0;
+  }
+
+  return tud_cdc_n_write_commit(_instance, count);
+}
+
+size_t Adafruit_USBD_CDC::readSpan(uint8_t const **buffer) {
+  *buffer = NULL;
+
+  if (!isValid()) {
+    return 0;
+  }
+
+  return tud_cdc_n_read_span(_instance, (void const **)buffer);
+}
+
+size_t Adafruit_USBD_CDC::readAdvance(size_t count) {
+  if (!isValid()) {
+    return 0;
+  }
+
+  return tud_cdc_n_read_advance(_instance, count);
+}
+
+void Adafruit_USBD_CDC::setRxCallback(rx_callback_t fp) { _rx_cb = fp; }
+
 int Adafruit_USBD_CDC::availableForWrite(void) {
   if (!isValid()) {
     return 0;
@@ -245,6 +319,25 @@ int Adafruit_USBD_CDC::availableForWrite(void) {
 
 extern "C" {
 
+// Invoked by usb task when data is received. Weak so that a sketch can still
+// define its own tud_cdc_rx_cb(), setRxCallback() is then no longer dispatched
+TU_ATTR_WEAK void tud_cdc_rx_cb(uint8_t itf) {
+  Adafruit_USBD_CDC *cdc = _cdc_itf[itf];
+
+  if (cdc && cdc->_rx_cb) {
+    cdc->_rx_cb();
+  }
+}
+
+#if CDC_TX_SEMAPHORE
+// Invoked by usb task when a transfer completes, FIFO has room again
+void tud_cdc_tx_complete_cb(uint8_t instance) {
+  if (_tx_sem[instance]) {
+    osal_semaphore_post(_tx_sem[instance], false);
+  }
+}
+#endif
+
 // Invoked when cdc when line state changed e.g connected/disconnected
 // Use to reset to DFU when disconnect with 1200 bps
 void tud_cdc_line_state_cb(uint8_t instance, bool dtr, bool rts) {
@@ -39,8 +39,12 @@
 #include "Adafruit_USBD_Interface.h"
 #include "Stream.h"
 
+extern "C" void tud_cdc_rx_cb(uint8_t itf);
+
 class Adafruit_USBD_CDC : public Stream, public Adafruit_USBD_Interface {
 public:
+  typedef void (*rx_callback_t)(void);
+
   Adafruit_USBD_CDC(void);
 
   static uint8_t getInstanceCount(void);
@@ -81,6 +85,22 @@ public:
 
   virtual int availableForWrite(void);
   using Print::write; // pull in write(str) from Print
+
+  // Zero-copy write: lend linear free space of TX FIFO, return its size.
+  // Fill up to that size then commit, data is sent on 64-byte packet
+  // boundaries or on flush(). A non-zero reserve locks out other writers
+  // and must always be followed by writeCommit(), even with 0 bytes
+  size_t writeReserve(uint8_t **buffer);
+  size_t writeCommit(size_t count);
+
+  // Zero-copy read: lend linear received data of RX FIFO, return its size.
+  // Consumed bytes must be advanced to make room for more data from host
+  size_t readSpan(uint8_t const **buffer);
+  size_t readAdvance(size_t count);
+
+  // Invoked by usb task when data is received from host
+  void setRxCallback(rx_callback_t fp);
+
   operator bool();
 
 private:
@@ -88,8 +108,11 @@ private:
   static uint8_t _instance_count;
 
   uint8_t _instance;
+  rx_callback_t _rx_cb;
 
   bool isValid(void) { return _instance != INVALID_INSTANCE; }
+
+  friend void tud_cdc_rx_cb(uint8_t itf);
 };
 
 // "Serial" is used with TinyUSB CDC
@@ -113,6 +113,10 @@ void Adafruit_USBD_MSC::setStartStopCallback(uint8_t lun,
   _lun_info[lun].start_stop_cb = cb;
 }
 
+void Adafruit_USBD_MSC::setSyncCallback(uint8_t lun, flush_callback_t cb) {
+  _lun_info[lun].sync_cb = cb;
+}
+
 void Adafruit_USBD_MSC::setReadyCallback(uint8_t lun, ready_callback_t cb) {
   _lun_info[lun].ready_cb = cb;
 }
@@ -208,6 +212,13 @@ int32_t tud_msc_scsi_cb(uint8_t lun, const uint8_t scsi_cmd[16], void *buffer,
   int32_t resplen = 0;
 
   switch (scsi_cmd[0]) {
+  case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+    // write back cached data, no data phase
+    if (_msc_dev && _msc_dev->_lun_info[lun].sync_cb) {
+      _msc_dev->_lun_info[lun].sync_cb();
+    }
+    resplen = 0;
+    break;
 
   default:
     // Set Sense = Invalid Command Operation
@@ -235,6 +246,11 @@ int32_t tud_msc_scsi_cb(uint8_t lun, const uint8_t scsi_cmd[16], void *buffer,
 // Callback invoked on start/stop
 bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start,
                            bool load_eject) {
+  // write back cached data before medium is ejected
+  if (_msc_dev && _msc_dev->_lun_info[lun].sync_cb && load_eject && !start) {
+    _msc_dev->_lun_info[lun].sync_cb();
+  }
+
   if (!(_msc_dev && _msc_dev->_lun_info[lun].start_stop_cb)) {
     return true;
   }
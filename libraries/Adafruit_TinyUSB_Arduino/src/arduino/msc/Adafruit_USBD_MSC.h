@@ -57,6 +57,10 @@ public:
   void setWritableCallback(uint8_t lun, writable_callback_t cb);
   void setStartStopCallback(uint8_t lun, start_stop_callback_t cb);
 
+  // Invoked on SCSI SYNCHRONIZE CACHE and on eject to write back cached data.
+  // Unlike the flush callback, it is not invoked after every WRITE10
+  void setSyncCallback(uint8_t lun, flush_callback_t cb);
+
   //------------- Single LUN API -------------//
   void setID(const char *vendor_id, const char *product_id,
              const char *product_rev) {
@@ -81,6 +85,7 @@ public:
   void setStartStopCallback(start_stop_callback_t cb) {
     setStartStopCallback(0, cb);
   }
+  void setSyncCallback(flush_callback_t cb) { setSyncCallback(0, cb); }
 
   // from Adafruit_USBD_Interface
   virtual uint16_t getInterfaceDescriptor(uint8_t itfnum, uint8_t *buf,
@@ -92,6 +97,7 @@ private:
     read_callback_t rd_cb;
     write_callback_t wr_cb;
     flush_callback_t fl_cb;
+    flush_callback_t sync_cb;
     ready_callback_t ready_cb;
     writable_callback_t writable_cb;
     start_stop_callback_t start_stop_cb;
@@ -117,6 +123,8 @@ private:
                                   uint16_t *block_size);
   friend int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset,
                                    void *buffer, uint32_t bufsize);
+  friend int32_t tud_msc_scsi_cb(uint8_t lun, const uint8_t scsi_cmd[16],
+                                 void *buffer, uint16_t bufsize);
   friend int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset,
                                     uint8_t *buffer, uint32_t bufsize);
   friend void tud_msc_write10_complete_cb(uint8_t lun);
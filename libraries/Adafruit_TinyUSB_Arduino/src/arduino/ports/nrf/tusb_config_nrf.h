@@ -61,9 +61,33 @@ extern "C" {
 #define CFG_TUD_MIDI 1
 #define CFG_TUD_VENDOR 1
 
+// CDC high throughput mode: multi-KB FIFOs and 512 bytes (8 packets) per
+// transfer, enabled with build flag -DCFG_TUD_CDC_HIGH_THROUGHPUT=1.
+// Each size can also be overridden by its own build flag.
+#ifndef CFG_TUD_CDC_HIGH_THROUGHPUT
+#define CFG_TUD_CDC_HIGH_THROUGHPUT 0
+#endif
+
+#if CFG_TUD_CDC_HIGH_THROUGHPUT
+#define CFG_TUD_CDC_FIFO_DFLT 4096
+#define CFG_TUD_CDC_EP_DFLT 512
+#else
+#define CFG_TUD_CDC_FIFO_DFLT 256
+#define CFG_TUD_CDC_EP_DFLT 64
+#endif
+
 // CDC FIFO size of TX and RX
-#define CFG_TUD_CDC_RX_BUFSIZE 256
-#define CFG_TUD_CDC_TX_BUFSIZE 256
+#ifndef CFG_TUD_CDC_RX_BUFSIZE
+#define CFG_TUD_CDC_RX_BUFSIZE CFG_TUD_CDC_FIFO_DFLT
+#endif
+#ifndef CFG_TUD_CDC_TX_BUFSIZE
+#define CFG_TUD_CDC_TX_BUFSIZE CFG_TUD_CDC_FIFO_DFLT
+#endif
+
+// CDC endpoint buffer: max bytes per transfer, a multiple of 64-byte packet
+#ifndef CFG_TUD_CDC_EP_BUFSIZE
+#define CFG_TUD_CDC_EP_BUFSIZE CFG_TUD_CDC_EP_DFLT
+#endif
 
 // MSC Buffer size of Device Mass storage
 #define CFG_TUD_MSC_EP_BUFSIZE 512
@@ -53,6 +53,7 @@ typedef struct
 
   /*------------- From this point, data is not cleared by bus reset -------------*/
   char    wanted_char;
+  bool    tx_reserved; // write_reserve() holds tx_ff write mutex until commit
   TU_ATTR_ALIGNED(4) cdc_line_coding_t line_coding;
 
   // FIFO
@@ -160,6 +161,31 @@ void tud_cdc_n_read_flush (uint8_t itf)
   _prep_out_transaction(p_cdc);
 }
 
+uint32_t tud_cdc_n_read_span(uint8_t itf, void const** buffer)
+{
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_read_info(&_cdcd_itf[itf].rx_ff, &info);
+
+  *buffer = info.ptr_lin;
+  return info.len_lin;
+}
+
+uint32_t tud_cdc_n_read_advance(uint8_t itf, uint32_t count)
+{
+  cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_read_info(&p_cdc->rx_ff, &info);
+  count = tu_min32(count, info.len_lin);
+
+  tu_fifo_advance_read_pointer(&p_cdc->rx_ff, (uint16_t) count);
+
+  // same as tud_cdc_n_read(): resume receiving if FIFO has room again
+  _prep_out_transaction(p_cdc);
+
+  return count;
+}
+
 //--------------------------------------------------------------------+
 // WRITE API
 //--------------------------------------------------------------------+
@@ -219,6 +245,73 @@ bool tud_cdc_n_write_clear (uint8_t itf)
   return tu_fifo_clear(&_cdcd_itf[itf].tx_ff);
 }
 
+// Reserved space is written outside of the fifo API, hold the same write mutex
+// as tu_fifo_write_n() from reserve to commit so other writers are kept out.
+TU_ATTR_ALWAYS_INLINE static inline void _tx_ff_lock(cdcd_interface_t* p_cdc)
+{
+#if CFG_FIFO_MUTEX
+  if (p_cdc->tx_ff.mutex_wr) osal_mutex_lock(p_cdc->tx_ff.mutex_wr, OSAL_TIMEOUT_WAIT_FOREVER);
+#else
+  (void) p_cdc;
+#endif
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void _tx_ff_unlock(cdcd_interface_t* p_cdc)
+{
+#if CFG_FIFO_MUTEX
+  if (p_cdc->tx_ff.mutex_wr) osal_mutex_unlock(p_cdc->tx_ff.mutex_wr);
+#else
+  (void) p_cdc;
+#endif
+}
+
+uint32_t tud_cdc_n_write_reserve(uint8_t itf, void** buffer)
+{
+  cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+
+  _tx_ff_lock(p_cdc);
+
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_write_info(&p_cdc->tx_ff, &info);
+
+  *buffer = info.ptr_lin;
+
+  // nothing lent, no commit will follow
+  if ( !info.len_lin )
+  {
+    _tx_ff_unlock(p_cdc);
+    return 0;
+  }
+
+  p_cdc->tx_reserved = true;
+  return info.len_lin;
+}
+
+uint32_t tud_cdc_n_write_commit(uint8_t itf, uint32_t count)
+{
+  cdcd_interface_t* p_cdc = &_cdcd_itf[itf];
+
+  // commit without a successful reserve: no space was lent, nothing to unlock
+  if ( !p_cdc->tx_reserved ) return 0;
+
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_write_info(&p_cdc->tx_ff, &info);
+  count = tu_min32(count, info.len_lin);
+
+  tu_fifo_advance_write_pointer(&p_cdc->tx_ff, (uint16_t) count);
+
+  p_cdc->tx_reserved = false;
+  _tx_ff_unlock(p_cdc);
+
+  // same as tud_cdc_n_write(): flush if queue more than packet size
+  if ( (tu_fifo_count(&p_cdc->tx_ff) >= BULK_PACKET_SIZE) || ((CFG_TUD_CDC_TX_BUFSIZE < BULK_PACKET_SIZE) && tu_fifo_full(&p_cdc->tx_ff)) )
+  {
+    tud_cdc_n_write_flush(itf);
+  }
+
+  return count;
+}
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
@@ -80,6 +80,12 @@ int32_t  tud_cdc_n_read_char       (uint8_t itf);
 // Clear the received FIFO
 void     tud_cdc_n_read_flush      (uint8_t itf);
 
+// Zero-copy read: get linear readable span of RX FIFO, return its size in bytes
+uint32_t tud_cdc_n_read_span       (uint8_t itf, void const** buffer);
+
+// Consume bytes of the span returned by tud_cdc_n_read_span()
+uint32_t tud_cdc_n_read_advance    (uint8_t itf, uint32_t count);
+
 // Get a byte from FIFO without removing it
 bool     tud_cdc_n_peek            (uint8_t itf, uint8_t* ui8);
 
@@ -103,6 +109,16 @@ uint32_t tud_cdc_n_write_available (uint8_t itf);
 // Clear the transmit FIFO
 bool tud_cdc_n_write_clear (uint8_t itf);
 
+// Zero-copy write: get linear free space of TX FIFO, return its size in bytes.
+// Fill the space then commit it. A non-zero reserve holds the TX FIFO write mutex
+// until commit: other writers block meanwhile, and the reserving task must not
+// call tud_cdc_n_write() or tud_cdc_n_write_clear() before committing.
+uint32_t tud_cdc_n_write_reserve   (uint8_t itf, void** buffer);
+
+// Commit bytes written to the space returned by tud_cdc_n_write_reserve() and release the FIFO.
+// Must be called once after every non-zero reserve, with count = 0 if nothing was written
+uint32_t tud_cdc_n_write_commit    (uint8_t itf, uint32_t count);
+
 //--------------------------------------------------------------------+
 // Application API (Single Port)
 //--------------------------------------------------------------------+
@@ -116,6 +132,8 @@ static inline int32_t  tud_cdc_read_char       (void);
 static inline uint32_t tud_cdc_read            (void* buffer, uint32_t bufsize);
 static inline void     tud_cdc_read_flush      (void);
 static inline bool     tud_cdc_peek            (uint8_t* ui8);
+static inline uint32_t tud_cdc_read_span       (void const** buffer);
+static inline uint32_t tud_cdc_read_advance    (uint32_t count);
 
 static inline uint32_t tud_cdc_write_char      (char ch);
 static inline uint32_t tud_cdc_write           (void const* buffer, uint32_t bufsize);
@@ -123,6 +141,8 @@ static inline uint32_t tud_cdc_write_str       (char const* str);
 static inline uint32_t tud_cdc_write_flush     (void);
 static inline uint32_t tud_cdc_write_available (void);
 static inline bool     tud_cdc_write_clear     (void);
+static inline uint32_t tud_cdc_write_reserve   (void** buffer);
+static inline uint32_t tud_cdc_write_commit    (uint32_t count);
 
 //--------------------------------------------------------------------+
 // Application Callback API (weak is optional)
@@ -210,6 +230,16 @@ static inline bool tud_cdc_peek (uint8_t* ui8)
   return tud_cdc_n_peek(0, ui8);
 }
 
+static inline uint32_t tud_cdc_read_span (void const** buffer)
+{
+  return tud_cdc_n_read_span(0, buffer);
+}
+
+static inline uint32_t tud_cdc_read_advance (uint32_t count)
+{
+  return tud_cdc_n_read_advance(0, count);
+}
+
 static inline uint32_t tud_cdc_write_char (char ch)
 {
   return tud_cdc_n_write_char(0, ch);
@@ -240,6 +270,16 @@ static inline bool tud_cdc_write_clear(void)
   return tud_cdc_n_write_clear(0);
 }
 
+static inline uint32_t tud_cdc_write_reserve(void** buffer)
+{
+  return tud_cdc_n_write_reserve(0, buffer);
+}
+
+static inline uint32_t tud_cdc_write_commit(uint32_t count)
+{
+  return tud_cdc_n_write_commit(0, count);
+}
+
 /** @} */
 /** @} */
 
@@ -121,6 +121,7 @@ typedef enum
   SCSI_CMD_READ_FORMAT_CAPACITY         = 0x23, ///< The command allows the Host to request a list of the possible format capacities for an installed writable media. This command also has the capability to report the writable capacity for a media when it is installed
   SCSI_CMD_READ_10                      = 0x28, ///< The READ (10) command requests that the device server read the specified logical block(s) and transfer them to the data-in buffer.
   SCSI_CMD_WRITE_10                     = 0x2A, ///< The WRITE (10) command requests thatthe device server transfer the specified logical block(s) from the data-out buffer and write them.
+  SCSI_CMD_SYNCHRONIZE_CACHE_10         = 0x35, ///< The SYNCHRONIZE CACHE (10) command requests that the device server write any cached logical block(s) to the medium.
 }scsi_cmd_type_t;
 
 /// SCSI Sense Key
@@ -0,0 +1,183 @@
+#include "Adafruit_nRFCrypto.h"
+#include <Adafruit_TinyUSB.h> // for Serial
+
+/* Test vectors are from NIST SP 800-38A (CBC, CTR) and SP 800-38C (CCM).
+ * CBC/CTR results can also be verified with openssl on your PC
+ *
+ *  $ echo -n 6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51 | xxd -r -p | \
+ *    openssl enc -aes-128-cbc -K 2b7e151628aed2a6abf7158809cf4f3c -iv 000102030405060708090a0b0c0d0e0f -nopad | xxd -p
+ *    7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2
+ *
+ *  $ echo -n 6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51 | xxd -r -p | \
+ *    openssl enc -aes-128-ctr -K 2b7e151628aed2a6abf7158809cf4f3c -iv f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff | xxd -p
+ *    874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff
+ *
+ * Note: CryptoCell can only access RAM, input must not be declared const
+ */
+uint8_t key[16] =
+{
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+uint8_t cbc_iv[16] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+uint8_t ctr_iv[16] =
+{
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+uint8_t plain_text[64] =
+{
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+uint8_t const cbc_cipher[64] =
+{
+  0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+  0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+  0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+  0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+uint8_t const ctr_cipher[64] =
+{
+  0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+  0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+  0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+  0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+// SP 800-38C Example 3
+uint8_t ccm_key[16] =
+{
+  0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f
+};
+
+uint8_t ccm_nonce[12] =
+{
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b
+};
+
+uint8_t ccm_adata[20] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13
+};
+
+uint8_t ccm_plain[24] =
+{
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37
+};
+
+uint8_t const ccm_cipher[24] =
+{
+  0xe3, 0xb2, 0x01, 0xa9, 0xf5, 0xb7, 0x1a, 0x7a, 0x9b, 0x1c, 0xea, 0xec, 0xcd, 0x97, 0xe7, 0x0b,
+  0x61, 0x76, 0xaa, 0xd9, 0xa4, 0x42, 0x8a, 0xa5
+};
+
+uint8_t const ccm_tag[8] =
+{
+  0x48, 0x43, 0x92, 0xfb, 0xc1, 0xb0, 0x99, 0x51
+};
+
+nRFCrypto_AES    aes;
+nRFCrypto_AESCCM aesccm;
+
+// the setup function runs once when you press reset or power the board
+void setup()
+{
+  // initialize digital pin LED_BUILTIN as an output.
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  while( !Serial) delay(10);
+  Serial.println("nRFCrypto AES example");
+
+  nRFCrypto.begin();
+
+  test_aes(SASI_AES_MODE_CBC, "AES-128-CBC", cbc_iv, cbc_cipher);
+  test_aes(SASI_AES_MODE_CTR, "AES-128-CTR", ctr_iv, ctr_cipher);
+  test_aesccm();
+
+  nRFCrypto.end();
+}
+
+void print_result(const char* name, bool passed)
+{
+  Serial.print(name);
+  Serial.println(passed ? ": PASSED" : ": FAILED");
+  Serial.flush();
+}
+
+void test_aes(SaSiAesOperationMode_t mode, const char* modestr, uint8_t iv[16], uint8_t const expected[64])
+{
+  uint8_t buf[64];
+  bool passed;
+
+  Serial.println(modestr);
+
+  // Encrypt: first 2 blocks streamed with update(), the rest by finish()
+  aes.begin(mode, SASI_AES_ENCRYPT, key, sizeof(key));
+  aes.setIV(iv);
+  passed = aes.update(plain_text, 32, buf);
+  passed = passed && aes.finish(plain_text+32, 32, buf+32) == 32;
+  print_result("  Encrypt", passed && (0 == memcmp(buf, expected, 64)));
+
+  // Decrypt in-place
+  aes.begin(mode, SASI_AES_DECRYPT, key, sizeof(key));
+  aes.setIV(iv);
+  passed = aes.finish(buf, 64, buf) == 64;
+  print_result("  Decrypt in-place", passed && (0 == memcmp(buf, plain_text, 64)));
+
+  // Decrypt again with the same key, only IV is set
+  memcpy(buf, expected, 64);
+  aes.setIV(iv);
+  passed = aes.finish(buf, 64, buf) == 64;
+  print_result("  Key reuse", passed && (0 == memcmp(buf, plain_text, 64)));
+
+  aes.end();
+  Serial.println();
+}
+
+void test_aesccm(void)
+{
+  uint8_t buf[24];
+  uint8_t tag[8];
+  bool passed;
+
+  Serial.println("AES-128-CCM");
+
+  aesccm.begin(ccm_key);
+
+  passed = aesccm.encrypt(ccm_nonce, sizeof(ccm_nonce), ccm_adata, sizeof(ccm_adata),
+                          ccm_plain, sizeof(ccm_plain), buf, tag, sizeof(tag));
+  print_result("  Encrypt", passed && (0 == memcmp(buf, ccm_cipher, sizeof(buf))) && (0 == memcmp(tag, ccm_tag, sizeof(tag))));
+
+  // Streaming decryption in-place
+  aesccm.start(SASI_AES_DECRYPT, ccm_nonce, sizeof(ccm_nonce), ccm_adata, sizeof(ccm_adata), sizeof(buf), sizeof(tag));
+  passed = aesccm.update(buf, 16, buf);
+  passed = passed && aesccm.finish(buf+16, 8, buf+16, tag);
+  print_result("  Decrypt", passed && (0 == memcmp(buf, ccm_plain, sizeof(buf))));
+
+  // Tampered tag must be rejected
+  memcpy(buf, ccm_cipher, sizeof(buf));
+  tag[0] ^= 0x01;
+  passed = aesccm.decrypt(ccm_nonce, sizeof(ccm_nonce), ccm_adata, sizeof(ccm_adata),
+                          buf, sizeof(buf), buf, tag, sizeof(tag));
+  print_result("  Reject bad tag", !passed);
+
+  aesccm.end();
+  Serial.println();
+}
+
+void loop()
+{
+  digitalToggle(LED_BUILTIN);
+  delay(1000);
+}
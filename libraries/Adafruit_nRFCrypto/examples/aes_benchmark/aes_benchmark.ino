@@ -0,0 +1,109 @@
+#include "Adafruit_nRFCrypto.h"
+#include <Adafruit_TinyUSB.h> // for Serial
+
+#include "soft_aes.h"
+
+/* Compare throughput of AES-128 with CryptoCell CC310 against a software
+ * implementation (soft_aes.h). Both encrypt the same buffer in-place and
+ * the results are compared to make sure they match.
+ */
+
+// Size of buffer to encrypt
+#define BENCH_SIZE    (16*1024)
+
+// Number of times buffer is encrypted
+#define BENCH_LOOP    8
+
+uint8_t key[16] =
+{
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+uint8_t iv[16] =
+{
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+uint8_t hw_buf[BENCH_SIZE];
+uint8_t sw_buf[BENCH_SIZE];
+
+nRFCrypto_AES aes;
+soft_aes_t    soft_aes;
+
+void setup()
+{
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  while( !Serial) delay(10);
+  Serial.println("nRFCrypto AES benchmark");
+  Serial.printf("Encrypt %d KB %d times\n\n", BENCH_SIZE/1024, BENCH_LOOP);
+
+  nRFCrypto.begin();
+  soft_aes_init(&soft_aes, key);
+
+  bench(SASI_AES_MODE_CBC, "AES-128-CBC");
+  bench(SASI_AES_MODE_CTR, "AES-128-CTR");
+
+  nRFCrypto.end();
+}
+
+void fill_buffers(void)
+{
+  for(uint32_t i=0; i<BENCH_SIZE; i++) hw_buf[i] = sw_buf[i] = (uint8_t) i;
+}
+
+void bench(SaSiAesOperationMode_t mode, const char* modestr)
+{
+  uint8_t sw_iv[16];
+  uint32_t start;
+
+  fill_buffers();
+
+  //------------- Hardware -------------//
+  start = micros();
+
+  // key is set once, only IV is changed per message
+  aes.begin(mode, SASI_AES_ENCRYPT, key, sizeof(key));
+  for(int i=0; i<BENCH_LOOP; i++)
+  {
+    aes.setIV(iv);
+    aes.finish(hw_buf, BENCH_SIZE, hw_buf);
+  }
+  aes.end();
+
+  uint32_t const hw_us = micros() - start;
+
+  //------------- Software -------------//
+  start = micros();
+
+  for(int i=0; i<BENCH_LOOP; i++)
+  {
+    memcpy(sw_iv, iv, 16);
+    if ( mode == SASI_AES_MODE_CBC )
+    {
+      soft_aes_cbc_encrypt(&soft_aes, sw_iv, sw_buf, BENCH_SIZE);
+    }else
+    {
+      soft_aes_ctr_crypt(&soft_aes, sw_iv, sw_buf, BENCH_SIZE);
+    }
+  }
+
+  uint32_t const sw_us = micros() - start;
+
+  //------------- Result -------------//
+  uint32_t const total = BENCH_SIZE*BENCH_LOOP;
+
+  Serial.println(modestr);
+  Serial.printf("  CC310   : %6lu us, %5lu KB/s\n", hw_us, (total*1000UL/1024) / (hw_us/1000 + 1));
+  Serial.printf("  Software: %6lu us, %5lu KB/s\n", sw_us, (total*1000UL/1024) / (sw_us/1000 + 1));
+  Serial.printf("  Speedup : %.1fx\n", ((float) sw_us) / hw_us);
+  Serial.println(memcmp(hw_buf, sw_buf, BENCH_SIZE) ? "  Results MISMATCHED" : "  Results matched");
+  Serial.println();
+  Serial.flush();
+}
+
+void loop()
+{
+  digitalToggle(LED_BUILTIN);
+  delay(1000);
+}
@@ -0,0 +1,141 @@
+#include "Adafruit_nRFCrypto.h"
+#include <Adafruit_TinyUSB.h> // for Serial
+
+/* This sketch demonstrates ECDSA P-256 and Ed25519 signatures. All
+ * operations are run by nRFCrypto.Queue task, the calling task blocks
+ * until the job is done. Batch verification checks several signatures
+ * in a single job, one of them is tampered and must be rejected.
+ *
+ * Ed25519 result is checked against RFC 8032 section 7.1 TEST 2
+ */
+#define BATCH_COUNT   4
+
+uint8_t message[] = // "Hello World!"
+{
+  0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20,
+  0x57, 0x6f, 0x72, 0x6c, 0x64, 0x21
+};
+
+// RFC 8032 TEST 2
+uint8_t ed_seed[32] =
+{
+  0x4c, 0xcd, 0x08, 0x9b, 0x28, 0xff, 0x96, 0xda, 0x9d, 0xb6, 0xc3, 0x46, 0xec, 0x11, 0x4e, 0x0f,
+  0x5b, 0x8a, 0x31, 0x9f, 0x35, 0xab, 0xa6, 0x24, 0xda, 0x8c, 0xf6, 0xed, 0x4f, 0xb8, 0xa6, 0xfb
+};
+
+uint8_t ed_message[1] = { 0x72 };
+
+uint8_t const ed_signature[64] =
+{
+  0x92, 0xa0, 0x09, 0xa9, 0xf0, 0xd4, 0xca, 0xb8, 0x72, 0x0e, 0x82, 0x0b, 0x5f, 0x64, 0x25, 0x40,
+  0xa2, 0xb2, 0x7b, 0x54, 0x16, 0x50, 0x3f, 0x8f, 0xb3, 0x76, 0x22, 0x23, 0xeb, 0xdb, 0x69, 0xda,
+  0x08, 0x5a, 0xc1, 0xe4, 0x3e, 0x15, 0x99, 0x6e, 0x45, 0x8f, 0x36, 0x13, 0xd0, 0xf1, 0x1d, 0x8c,
+  0x38, 0x7b, 0x2e, 0xae, 0xb4, 0x30, 0x2a, 0xee, 0xb0, 0x0d, 0x29, 0x16, 0x12, 0xbb, 0x0c, 0x00
+};
+
+nRFCrypto_ECC_PrivateKey privkey;
+nRFCrypto_ECC_PublicKey  pubkey;
+
+void setup()
+{
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  while( !Serial) delay(10);
+  Serial.println("nRFCrypto Signature example");
+
+  nRFCrypto.begin();
+
+  test_ecdsa();
+  test_ed25519();
+
+  nRFCrypto.end();
+}
+
+void print_result(const char* name, bool passed, uint32_t start_ms)
+{
+  Serial.printf("  %-16s: %s (%lu ms)\n", name, passed ? "PASSED" : "FAILED", millis() - start_ms);
+  Serial.flush();
+}
+
+void test_ecdsa(void)
+{
+  uint8_t sig[BATCH_COUNT][64];
+  uint32_t sig_len = 0;
+  uint32_t ms;
+
+  Serial.println("ECDSA P-256 with SHA-256");
+
+  privkey.begin(CRYS_ECPKI_DomainID_secp256r1);
+  pubkey.begin(CRYS_ECPKI_DomainID_secp256r1);
+
+  ms = millis();
+  print_result("Generate key", nRFCrypto_ECC::genKeyPair(privkey, pubkey), ms);
+
+  ms = millis();
+  for(int i=0; i<BATCH_COUNT; i++)
+  {
+    sig_len = nRFCrypto_ECC::ECDSA_Sign(privkey, CRYS_ECPKI_HASH_SHA256_mode, message, sizeof(message), sig[i], sizeof(sig[i]));
+  }
+  print_result("Sign x4", sig_len == 64, ms);
+
+  ms = millis();
+  bool passed = nRFCrypto_ECC::ECDSA_Verify(pubkey, CRYS_ECPKI_HASH_SHA256_mode, message, sizeof(message), sig[0], sig_len);
+  print_result("Verify", passed, ms);
+
+  // tamper last signature
+  sig[BATCH_COUNT-1][10] ^= 0x01;
+
+  nRFCrypto_ECDSA_Verify_t items[BATCH_COUNT];
+  for(int i=0; i<BATCH_COUNT; i++)
+  {
+    items[i].pubkey    = &pubkey;
+    items[i].message   = message;
+    items[i].msg_len   = sizeof(message);
+    items[i].signature = sig[i];
+    items[i].sig_len   = sig_len;
+  }
+
+  ms = millis();
+  uint16_t valid = nRFCrypto_ECC::ECDSA_VerifyBatch(CRYS_ECPKI_HASH_SHA256_mode, items, BATCH_COUNT);
+  print_result("Verify batch x4", (valid == BATCH_COUNT-1) && !items[BATCH_COUNT-1].valid, ms);
+
+  privkey.end();
+  pubkey.end();
+  Serial.println();
+}
+
+void test_ed25519(void)
+{
+  uint8_t secret_key[64];
+  uint8_t public_key[32];
+  uint8_t sig[64];
+  uint32_t ms;
+
+  Serial.println("Ed25519");
+
+  ms = millis();
+  bool passed = nRFCrypto_Ed25519::genKeyPair(ed_seed, secret_key, public_key);
+  print_result("Key from seed", passed, ms);
+
+  ms = millis();
+  passed = nRFCrypto_Ed25519::sign(secret_key, ed_message, sizeof(ed_message), sig);
+  print_result("Sign", passed && (0 == memcmp(sig, ed_signature, 64)), ms);
+
+  ms = millis();
+  passed = nRFCrypto_Ed25519::verify(public_key, ed_message, sizeof(ed_message), sig);
+  print_result("Verify", passed, ms);
+
+  // tamper signature
+  sig[0] ^= 0x01;
+  ms = millis();
+  passed = nRFCrypto_Ed25519::verify(public_key, ed_message, sizeof(ed_message), sig);
+  print_result("Reject tampered", !passed, ms);
+
+  Serial.println();
+}
+
+void loop()
+{
+  digitalToggle(LED_BUILTIN);
+  delay(1000);
+}
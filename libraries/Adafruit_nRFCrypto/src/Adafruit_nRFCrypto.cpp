@@ -55,6 +55,7 @@ Adafruit_nRFCrypto nRFCrypto;
 Adafruit_nRFCrypto::Adafruit_nRFCrypto(void)
 {
   _begun = false;
+  _mutex = NULL;
 }
 
 bool Adafruit_nRFCrypto::begin(void)
@@ -68,7 +69,17 @@ bool Adafruit_nRFCrypto::begin(void)
   NVIC_EnableIRQ(CRYPTOCELL_IRQn);
 #endif
 
-  VERIFY_ERROR(SaSi_LibInit(), false);
+  if ( _mutex == NULL )
+  {
+    _mutex = xSemaphoreCreateRecursiveMutex();
+    VERIFY(_mutex);
+  }
+
+  lock();
+  uint32_t const err = SaSi_LibInit();
+  unlock();
+
+  VERIFY_ERROR(err, false);
   VERIFY( Random.begin() );
 
   return true;
@@ -80,14 +91,30 @@ void Adafruit_nRFCrypto::end(void)
   if (!_begun) return;
   _begun = false;
 
-  SaSi_LibFini();
   Random.end();
 
+  lock();
+  SaSi_LibFini();
+  unlock();
+
 #ifndef USE_CC310_LIB_NO_INTERRUPT
   NVIC_DisableIRQ(CRYPTOCELL_IRQn);
 #endif
 }
 
+bool Adafruit_nRFCrypto::lock(void)
+{
+  // not begin-ed yet
+  if ( _mutex == NULL ) return true;
+
+  return xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+}
+
+void Adafruit_nRFCrypto::unlock(void)
+{
+  if ( _mutex ) xSemaphoreGiveRecursive(_mutex);
+}
+
 //--------------------------------------------------------------------+
 // Debug
 //--------------------------------------------------------------------+
@@ -28,10 +28,14 @@
 #include "common_inc.h"
 #include "rtos.h"
 
+#include "nRFCrypto_Queue.h"
 #include "nRFCrypto_Random.h"
 #include "nRFCrypto_Hash.h"
 #include "nRFCrypto_Hmac.h"
+#include "nRFCrypto_AES.h"
+#include "nRFCrypto_AESCCM.h"
 #include "ecc/nRFCrypto_ECC.h"
+#include "ecc/nRFCrypto_Ed25519.h"
 
 class Adafruit_nRFCrypto
 {
@@ -41,10 +45,18 @@ class Adafruit_nRFCrypto
     bool begin(void);
     void end(void);
 
+    // Serialize CryptoCell access between tasks: every CC310 call of the
+    // library, including the shared Random context, is made with the lock
+    // held. Jobs run by Queue are already locked, lock is recursive
+    bool lock(void);
+    void unlock(void);
+
     nRFCrypto_Random Random;
+    nRFCrypto_Queue  Queue;
 
   private:
     bool _begun;
+    SemaphoreHandle_t _mutex;
 };
 
 extern Adafruit_nRFCrypto nRFCrypto;
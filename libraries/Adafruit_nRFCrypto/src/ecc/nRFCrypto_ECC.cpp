@@ -24,6 +24,7 @@
 
 #include "nrf_cc310/include/crys_ecpki_kg.h"
 #include "nrf_cc310/include/crys_ecpki_dh.h"
+#include "nrf_cc310/include/crys_ecpki_ecdsa.h"
 
 #include "Adafruit_nRFCrypto.h"
 
@@ -31,6 +32,25 @@
 // MACRO TYPEDEF CONSTANT ENUM DECLARATION
 //--------------------------------------------------------------------+
 
+// Arguments of jobs run by nRFCrypto.Queue
+typedef struct
+{
+  nRFCrypto_ECC_PrivateKey* key;
+  CRYS_ECPKI_HASH_OpMode_t hash_mode;
+  uint8_t* message;
+  uint32_t msg_len;
+  uint8_t* signature;
+  uint32_t sig_len;
+} ecdsa_sign_args_t;
+
+typedef struct
+{
+  CRYS_ECPKI_HASH_OpMode_t hash_mode;
+  nRFCrypto_ECDSA_Verify_t* items;
+  uint16_t count;
+  uint16_t valid_count;
+} ecdsa_verify_args_t;
+
 //--------------------------------------------------------------------+
 // ECC
 //--------------------------------------------------------------------+
@@ -42,9 +62,12 @@ bool nRFCrypto_ECC::genKeyPair(nRFCrypto_ECC_PrivateKey& private_key, nRFCrypto_
   CRYS_ECPKI_KG_TempData_t* tempbuf = (CRYS_ECPKI_KG_TempData_t*) rtos_malloc( sizeof(CRYS_ECPKI_KG_TempData_t) );
   VERIFY(tempbuf);
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_ECPKI_GenKeyPair(nRFCrypto.Random.getContext(), CRYS_RND_GenerateVector, private_key.getDomain(),
                                        &private_key._key, &public_key._key,
                                        tempbuf, NULL);
+  nRFCrypto.unlock();
+
   rtos_free(tempbuf);
 
   VERIFY_CRYS(err, false);
@@ -56,7 +79,9 @@ uint32_t nRFCrypto_ECC::SVDP_DH(nRFCrypto_ECC_PrivateKey& private_key, nRFCrypto
   CRYS_ECDH_TempData_t* tempbuf = (CRYS_ECDH_TempData_t *) rtos_malloc(sizeof(CRYS_ECDH_TempData_t));
   VERIFY(tempbuf);
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_ECDH_SVDP_DH(&peer_pubkey._key, &private_key._key, shared_secret, &bufsize, tempbuf);
+  nRFCrypto.unlock();
 
   rtos_free(tempbuf);
 
@@ -64,6 +89,97 @@ uint32_t nRFCrypto_ECC::SVDP_DH(nRFCrypto_ECC_PrivateKey& private_key, nRFCrypto
   return bufsize;
 }
 
+//--------------------------------------------------------------------+
+// ECDSA
+//--------------------------------------------------------------------+
+
+uint32_t nRFCrypto_ECC::_ecdsa_sign_job(void* arg)
+{
+  ecdsa_sign_args_t* args = (ecdsa_sign_args_t*) arg;
+
+  CRYS_ECDSA_SignUserContext_t* context = (CRYS_ECDSA_SignUserContext_t*) rtos_malloc( sizeof(CRYS_ECDSA_SignUserContext_t) );
+  if ( !context ) return CRYS_ECDSA_SIGN_INVALID_USER_CONTEXT_PTR_ERROR;
+
+  uint32_t err = CRYS_ECDSA_Sign(nRFCrypto.Random.getContext(), CRYS_RND_GenerateVector, context,
+                                 &args->key->_key, args->hash_mode, args->message, args->msg_len,
+                                 args->signature, &args->sig_len);
+  rtos_free(context);
+
+  return err;
+}
+
+// Context is allocated once for the whole batch
+uint32_t nRFCrypto_ECC::_ecdsa_verify_job(void* arg)
+{
+  ecdsa_verify_args_t* args = (ecdsa_verify_args_t*) arg;
+
+  CRYS_ECDSA_VerifyUserContext_t* context = (CRYS_ECDSA_VerifyUserContext_t*) rtos_malloc( sizeof(CRYS_ECDSA_VerifyUserContext_t) );
+  if ( !context ) return CRYS_ECDSA_VERIFY_INVALID_USER_CONTEXT_PTR_ERROR;
+
+  uint32_t err = CRYS_OK;
+  args->valid_count = 0;
+
+  for(uint16_t i=0; i<args->count; i++)
+  {
+    nRFCrypto_ECDSA_Verify_t* item = &args->items[i];
+
+    err = CRYS_ECDSA_Verify(context, &item->pubkey->_key, args->hash_mode, item->signature, item->sig_len,
+                            item->message, item->msg_len);
+    item->valid = (err == CRYS_OK);
+    if ( item->valid ) args->valid_count++;
+  }
+
+  rtos_free(context);
+
+  // error of single verification
+  return err;
+}
+
+uint32_t nRFCrypto_ECC::ECDSA_Sign(nRFCrypto_ECC_PrivateKey& private_key, CRYS_ECPKI_HASH_OpMode_t hash_mode,
+                                   uint8_t* message, uint32_t msg_len, uint8_t* signature, uint32_t bufsize)
+{
+  ecdsa_sign_args_t args =
+  {
+    .key       = &private_key,
+    .hash_mode = hash_mode,
+    .message   = message,
+    .msg_len   = msg_len,
+    .signature = signature,
+    .sig_len   = bufsize
+  };
+
+  VERIFY_CRYS(nRFCrypto.Queue.run(_ecdsa_sign_job, &args), 0);
+  return args.sig_len;
+}
+
+bool nRFCrypto_ECC::ECDSA_Verify(nRFCrypto_ECC_PublicKey& public_key, CRYS_ECPKI_HASH_OpMode_t hash_mode,
+                                 uint8_t* message, uint32_t msg_len, uint8_t* signature, uint32_t sig_len)
+{
+  nRFCrypto_ECDSA_Verify_t item =
+  {
+    .pubkey    = &public_key,
+    .message   = message,
+    .msg_len   = msg_len,
+    .signature = signature,
+    .sig_len   = sig_len,
+    .valid     = false
+  };
+
+  ecdsa_verify_args_t args = { .hash_mode = hash_mode, .items = &item, .count = 1, .valid_count = 0 };
+
+  VERIFY_CRYS(nRFCrypto.Queue.run(_ecdsa_verify_job, &args), false);
+  return item.valid;
+}
+
+uint16_t nRFCrypto_ECC::ECDSA_VerifyBatch(CRYS_ECPKI_HASH_OpMode_t hash_mode, nRFCrypto_ECDSA_Verify_t items[], uint16_t count)
+{
+  ecdsa_verify_args_t args = { .hash_mode = hash_mode, .items = items, .count = count, .valid_count = 0 };
+
+  // invalid signatures are reported per item
+  (void) nRFCrypto.Queue.run(_ecdsa_verify_job, &args);
+  return args.valid_count;
+}
+
 nRFCrypto_ECC::nRFCrypto_ECC(void)
 {
 
@@ -32,6 +32,17 @@
 #include "nRFCrypto_ECC_PublicKey.h"
 #include "nRFCrypto_ECC_PrivateKey.h"
 
+// An entry of ECDSA batch verification
+typedef struct
+{
+  nRFCrypto_ECC_PublicKey* pubkey;
+  uint8_t* message;
+  uint32_t msg_len;
+  uint8_t* signature;
+  uint32_t sig_len;
+  bool     valid; // result
+} nRFCrypto_ECDSA_Verify_t;
+
 class nRFCrypto_ECC
 {
   public:
@@ -39,13 +50,25 @@ class nRFCrypto_ECC
     static bool genKeyPair(nRFCrypto_ECC_PrivateKey& private_key, nRFCrypto_ECC_PublicKey& public_key);
     static uint32_t SVDP_DH(nRFCrypto_ECC_PrivateKey& private_key, nRFCrypto_ECC_PublicKey& peer_pubkey, uint8_t* shared_secret, uint32_t bufsize);
 
+    // ECDSA, run by nRFCrypto.Queue. Message is hashed with hash_mode, or
+    // is already a digest if one of CRYS_ECPKI_AFTER_HASH_xxx modes is used.
+    // Sign returns signature size (r || s), 0 if failed
+    static uint32_t ECDSA_Sign(nRFCrypto_ECC_PrivateKey& private_key, CRYS_ECPKI_HASH_OpMode_t hash_mode,
+                               uint8_t* message, uint32_t msg_len, uint8_t* signature, uint32_t bufsize);
+    static bool ECDSA_Verify(nRFCrypto_ECC_PublicKey& public_key, CRYS_ECPKI_HASH_OpMode_t hash_mode,
+                             uint8_t* message, uint32_t msg_len, uint8_t* signature, uint32_t sig_len);
+
+    // Verify multiple signatures in a single job, return number of valid ones
+    static uint16_t ECDSA_VerifyBatch(CRYS_ECPKI_HASH_OpMode_t hash_mode, nRFCrypto_ECDSA_Verify_t items[], uint16_t count);
+
   public:
     nRFCrypto_ECC(void);
     bool begin(void);
     void end(void);
 
   private:
-
+    static uint32_t _ecdsa_sign_job(void* arg);
+    static uint32_t _ecdsa_verify_job(void* arg);
 };
 
 #endif /* NRFCRYPTO_ECC_H_ */
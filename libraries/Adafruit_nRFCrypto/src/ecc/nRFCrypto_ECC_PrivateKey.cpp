@@ -53,13 +53,21 @@ void nRFCrypto_ECC_PrivateKey::end(void)
 // return raw buffer size = keysize + 1 (header)
 uint32_t nRFCrypto_ECC_PrivateKey::toRaw(uint8_t* buffer, uint32_t bufsize)
 {
-  VERIFY_CRYS(CRYS_ECPKI_ExportPrivKey(&_key, buffer, &bufsize), 0);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_ECPKI_ExportPrivKey(&_key, buffer, &bufsize);
+  nRFCrypto.unlock();
+
+  VERIFY_CRYS(err, 0);
   return bufsize;
 }
 
 // Build public key from raw bytes in Big Endian
 bool nRFCrypto_ECC_PrivateKey::fromRaw(uint8_t* buffer, uint32_t bufsize)
 {
-  VERIFY_CRYS(CRYS_ECPKI_BuildPrivKey(_domain, buffer, bufsize, &_key), false);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_ECPKI_BuildPrivKey(_domain, buffer, bufsize, &_key);
+  nRFCrypto.unlock();
+
+  VERIFY_CRYS(err, false);
   return true;
 }
@@ -53,7 +53,11 @@ void nRFCrypto_ECC_PublicKey::end(void)
 // return raw buffer size = keysize + 1 (header)
 uint32_t nRFCrypto_ECC_PublicKey::toRaw(uint8_t* buffer, uint32_t bufsize)
 {
-  VERIFY_CRYS(CRYS_ECPKI_ExportPublKey(&_key, CRYS_EC_PointUncompressed, buffer, &bufsize), 0);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_ECPKI_ExportPublKey(&_key, CRYS_EC_PointUncompressed, buffer, &bufsize);
+  nRFCrypto.unlock();
+
+  VERIFY_CRYS(err, 0);
   return bufsize;
 }
 
@@ -63,7 +67,9 @@ bool nRFCrypto_ECC_PublicKey::fromRaw(uint8_t* buffer, uint32_t bufsize)
   CRYS_ECPKI_BUILD_TempData_t* tempbuf = (CRYS_ECPKI_BUILD_TempData_t*) rtos_malloc( sizeof(CRYS_ECPKI_BUILD_TempData_t) );
   VERIFY(tempbuf);
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_ECPKI_BuildPublKeyPartlyCheck(_domain, buffer, bufsize, &_key, tempbuf);
+  nRFCrypto.unlock();
 
   rtos_free(tempbuf);
 
@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_nRFCrypto.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Arguments of jobs run by nRFCrypto.Queue
+typedef struct
+{
+  uint8_t const* seed; // NULL for random key
+  uint8_t* secret_key;
+  uint8_t* public_key;
+} edw_keypair_args_t;
+
+typedef struct
+{
+  uint8_t const* secret_key;
+  uint8_t const* message;
+  uint32_t msg_len;
+  uint8_t* signature;
+} edw_sign_args_t;
+
+typedef struct
+{
+  nRFCrypto_Ed25519_Verify_t* items;
+  uint16_t count;
+  uint16_t valid_count;
+} edw_verify_args_t;
+
+static uint32_t edw_keypair_job(void* arg)
+{
+  edw_keypair_args_t* args = (edw_keypair_args_t*) arg;
+
+  CRYS_ECEDW_TempBuff_t* tempbuf = (CRYS_ECEDW_TempBuff_t*) rtos_malloc( sizeof(CRYS_ECEDW_TempBuff_t) );
+  if ( !tempbuf ) return CRYS_ECEDW_INVALID_INPUT_POINTER_ERROR;
+
+  size_t secret_size = nRFCrypto_Ed25519::SECRET_KEY_SIZE;
+  size_t public_size = nRFCrypto_Ed25519::PUBLIC_KEY_SIZE;
+  uint32_t err;
+
+  if ( args->seed )
+  {
+    err = CRYS_ECEDW_SeedKeyPair(args->seed, nRFCrypto_Ed25519::SEED_SIZE, args->secret_key, &secret_size,
+                                 args->public_key, &public_size, tempbuf);
+  }else
+  {
+    err = CRYS_ECEDW_KeyPair(args->secret_key, &secret_size, args->public_key, &public_size,
+                             nRFCrypto.Random.getContext(), CRYS_RND_GenerateVector, tempbuf);
+  }
+
+  rtos_free(tempbuf);
+  return err;
+}
+
+static uint32_t edw_sign_job(void* arg)
+{
+  edw_sign_args_t* args = (edw_sign_args_t*) arg;
+
+  CRYS_ECEDW_TempBuff_t* tempbuf = (CRYS_ECEDW_TempBuff_t*) rtos_malloc( sizeof(CRYS_ECEDW_TempBuff_t) );
+  if ( !tempbuf ) return CRYS_ECEDW_INVALID_INPUT_POINTER_ERROR;
+
+  size_t sig_size = nRFCrypto_Ed25519::SIGNATURE_SIZE;
+  uint32_t err = CRYS_ECEDW_Sign(args->signature, &sig_size, args->message, args->msg_len,
+                                 args->secret_key, nRFCrypto_Ed25519::SECRET_KEY_SIZE, tempbuf);
+
+  rtos_free(tempbuf);
+  return err;
+}
+
+// Temp buffer is allocated once for the whole batch
+static uint32_t edw_verify_job(void* arg)
+{
+  edw_verify_args_t* args = (edw_verify_args_t*) arg;
+
+  CRYS_ECEDW_TempBuff_t* tempbuf = (CRYS_ECEDW_TempBuff_t*) rtos_malloc( sizeof(CRYS_ECEDW_TempBuff_t) );
+  if ( !tempbuf ) return CRYS_ECEDW_INVALID_INPUT_POINTER_ERROR;
+
+  uint32_t err = CRYS_OK;
+  args->valid_count = 0;
+
+  for(uint16_t i=0; i<args->count; i++)
+  {
+    nRFCrypto_Ed25519_Verify_t* item = &args->items[i];
+
+    err = CRYS_ECEDW_Verify(item->signature, nRFCrypto_Ed25519::SIGNATURE_SIZE,
+                            item->pubkey, nRFCrypto_Ed25519::PUBLIC_KEY_SIZE,
+                            item->message, item->msg_len, tempbuf);
+    item->valid = (err == CRYS_OK);
+    if ( item->valid ) args->valid_count++;
+  }
+
+  rtos_free(tempbuf);
+
+  // error of single verification
+  return err;
+}
+
+//------------- IMPLEMENTATION -------------//
+bool nRFCrypto_Ed25519::genKeyPair(uint8_t secret_key[64], uint8_t public_key[32])
+{
+  return genKeyPair(NULL, secret_key, public_key);
+}
+
+bool nRFCrypto_Ed25519::genKeyPair(uint8_t const seed[32], uint8_t secret_key[64], uint8_t public_key[32])
+{
+  edw_keypair_args_t args = { .seed = seed, .secret_key = secret_key, .public_key = public_key };
+
+  VERIFY_CRYS(nRFCrypto.Queue.run(edw_keypair_job, &args), false);
+  return true;
+}
+
+bool nRFCrypto_Ed25519::sign(uint8_t const secret_key[64], uint8_t const* message, uint32_t msg_len, uint8_t signature[64])
+{
+  edw_sign_args_t args = { .secret_key = secret_key, .message = message, .msg_len = msg_len, .signature = signature };
+
+  VERIFY_CRYS(nRFCrypto.Queue.run(edw_sign_job, &args), false);
+  return true;
+}
+
+bool nRFCrypto_Ed25519::verify(uint8_t const public_key[32], uint8_t* message, uint32_t msg_len, uint8_t const signature[64])
+{
+  nRFCrypto_Ed25519_Verify_t item =
+  {
+    .pubkey    = public_key,
+    .message   = message,
+    .msg_len   = msg_len,
+    .signature = signature,
+    .valid     = false
+  };
+
+  edw_verify_args_t args = { .items = &item, .count = 1, .valid_count = 0 };
+
+  VERIFY_CRYS(nRFCrypto.Queue.run(edw_verify_job, &args), false);
+  return item.valid;
+}
+
+uint16_t nRFCrypto_Ed25519::verifyBatch(nRFCrypto_Ed25519_Verify_t items[], uint16_t count)
+{
+  edw_verify_args_t args = { .items = items, .count = count, .valid_count = 0 };
+
+  // invalid signatures are reported per item
+  (void) nRFCrypto.Queue.run(edw_verify_job, &args);
+  return args.valid_count;
+}
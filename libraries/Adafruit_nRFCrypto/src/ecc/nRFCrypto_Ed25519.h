@@ -0,0 +1,66 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NRFCRYPTO_ED25519_H_
+#define NRFCRYPTO_ED25519_H_
+
+#include "nrf_cc310/include/crys_ec_edw_api.h"
+#include "nrf_cc310/include/crys_ec_mont_edw_error.h"
+
+// An entry of Ed25519 batch verification
+typedef struct
+{
+  uint8_t const* pubkey;    // 32 bytes
+  uint8_t* message;
+  uint32_t msg_len;
+  uint8_t const* signature; // 64 bytes
+  bool     valid;           // result
+} nRFCrypto_Ed25519_Verify_t;
+
+/* Ed25519 signature, all operations are run by nRFCrypto.Queue
+ * - Secret key is 64 bytes: seed || public key
+ * - Message is limited to CRYS_HASH_UPDATE_DATA_MAX_SIZE_IN_BYTES - 64 bytes
+ */
+class nRFCrypto_Ed25519
+{
+  public:
+    enum
+    {
+      SEED_SIZE       = CRYS_ECEDW_SEED_BYTES,
+      PUBLIC_KEY_SIZE = CRYS_ECEDW_MOD_SIZE_IN_BYTES,
+      SECRET_KEY_SIZE = CRYS_ECEDW_SECRET_KEY_BYTES,
+      SIGNATURE_SIZE  = CRYS_ECEDW_SIGNATURE_BYTES
+    };
+
+    static bool genKeyPair(uint8_t secret_key[64], uint8_t public_key[32]);
+    static bool genKeyPair(uint8_t const seed[32], uint8_t secret_key[64], uint8_t public_key[32]);
+
+    static bool sign(uint8_t const secret_key[64], uint8_t const* message, uint32_t msg_len, uint8_t signature[64]);
+    static bool verify(uint8_t const public_key[32], uint8_t* message, uint32_t msg_len, uint8_t const signature[64]);
+
+    // Verify multiple signatures in a single job, return number of valid ones
+    static uint16_t verifyBatch(nRFCrypto_Ed25519_Verify_t items[], uint16_t count);
+};
+
+#endif /* NRFCRYPTO_ED25519_H_ */
@@ -0,0 +1,156 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_nRFCrypto.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Each CC310 operation is limited to 64KB, larger data is split
+#define AES_CHUNK_MAX   (32*1024)
+
+//------------- IMPLEMENTATION -------------//
+nRFCrypto_AES::nRFCrypto_AES(void)
+{
+  varclr(&_context);
+  _keylen  = 0;
+  _mode    = 0;
+  _dir     = 0;
+  _padding = 0;
+}
+
+bool nRFCrypto_AES::begin(SaSiAesOperationMode_t mode, SaSiAesEncryptMode_t dir, uint8_t const* key, uint8_t keylen,
+                          SaSiAesPaddingType_t padding)
+{
+  VERIFY(key && keylen && keylen <= sizeof(_key));
+
+  memcpy(_key, key, keylen);
+  _keylen  = keylen;
+  _mode    = (uint8_t) mode;
+  _dir     = (uint8_t) dir;
+  _padding = (uint8_t) padding;
+
+  return _setup();
+}
+
+void nRFCrypto_AES::end(void)
+{
+  nRFCrypto.lock();
+  SaSi_AesFree(&_context);
+  nRFCrypto.unlock();
+
+  // don't leave key in memory
+  memset(_key, 0, sizeof(_key));
+  _keylen = 0;
+}
+
+// (Re)initialize context with stored key
+bool nRFCrypto_AES::_setup(void)
+{
+  SaSiAesUserKeyData_t key_data =
+  {
+    .pKey    = _key,
+    .keySize = _keylen
+  };
+
+  nRFCrypto.lock();
+  uint32_t err = SaSi_AesInit(&_context, (SaSiAesEncryptMode_t) _dir, (SaSiAesOperationMode_t) _mode,
+                              (SaSiAesPaddingType_t) _padding);
+  if ( !err ) err = SaSi_AesSetKey(&_context, SASI_AES_USER_KEY, &key_data, sizeof(key_data));
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
+  return true;
+}
+
+bool nRFCrypto_AES::setIV(uint8_t const iv[16])
+{
+  nRFCrypto.lock();
+  uint32_t const err = SaSi_AesSetIv(&_context, (uint8_t*) iv);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
+  return true;
+}
+
+bool nRFCrypto_AES::getIV(uint8_t iv[16])
+{
+  nRFCrypto.lock();
+  uint32_t const err = SaSi_AesGetIv(&_context, iv);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
+  return true;
+}
+
+bool nRFCrypto_AES::update(uint8_t* input, size_t size, uint8_t* output)
+{
+  VERIFY( (size % BLOCK_SIZE) == 0 );
+
+  while ( size )
+  {
+    size_t const count = minof(size, (size_t) AES_CHUNK_MAX);
+
+    nRFCrypto.lock();
+    uint32_t const err = SaSi_AesBlock(&_context, input, count, output);
+    nRFCrypto.unlock();
+
+    VERIFY_ERROR(err, false);
+
+    input  += count;
+    size   -= count;
+    if ( output ) output += count;
+  }
+
+  return true;
+}
+
+size_t nRFCrypto_AES::finish(uint8_t* input, size_t size, uint8_t* output)
+{
+  // keep at least one block for finish, CBC-CTS needs more than 16 bytes
+  while ( size > AES_CHUNK_MAX + BLOCK_SIZE )
+  {
+    VERIFY( update(input, AES_CHUNK_MAX, output), 0 );
+
+    input  += AES_CHUNK_MAX;
+    size   -= AES_CHUNK_MAX;
+    if ( output ) output += AES_CHUNK_MAX;
+  }
+
+  // PKCS7 encryption may append a whole block
+  size_t bufsize = size;
+  if ( _padding == SASI_AES_PADDING_PKCS7 && _dir == SASI_AES_ENCRYPT ) bufsize = (size/BLOCK_SIZE + 1)*BLOCK_SIZE;
+
+  size_t outsize = maxof(bufsize, (size_t) BLOCK_SIZE);
+  nRFCrypto.lock();
+  uint32_t const err = SaSi_AesFinish(&_context, size, input, bufsize, output, &outsize);
+  nRFCrypto.unlock();
+
+  // Ready for next message with the same key
+  _setup();
+
+  VERIFY_ERROR(err, 0);
+  return outsize;
+}
@@ -0,0 +1,73 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NRFCRYPTO_AES_H_
+#define NRFCRYPTO_AES_H_
+
+#include "nrf_cc310/include/ssi_aes.h"
+
+/* AES (ECB, CBC, CTR, OFB, CBC-CTS, CBC-MAC, CMAC) with CryptoCell CC310
+ * - Key is kept by the object: after finish(), call setIV() to process
+ *   another message with the same key without calling begin() again.
+ * - Data is streamed with update() in multiple of 16 bytes, last (partial)
+ *   block is processed by finish().
+ * - Output can be the same as input buffer (in-place)
+ * - CC310 DMA can only access RAM, data must not be placed in flash.
+ */
+class nRFCrypto_AES
+{
+  public:
+    enum { BLOCK_SIZE = SASI_AES_BLOCK_SIZE_IN_BYTES };
+
+    nRFCrypto_AES(void);
+
+    bool begin(SaSiAesOperationMode_t mode, SaSiAesEncryptMode_t dir, uint8_t const* key, uint8_t keylen,
+               SaSiAesPaddingType_t padding = SASI_AES_PADDING_NONE);
+    void end(void);
+
+    bool setIV(uint8_t const iv[16]);
+    bool getIV(uint8_t iv[16]);
+
+    // size must be multiple of 16
+    bool update(uint8_t* input, size_t size, uint8_t* output);
+
+    // Process the remaining data, return number of output bytes i.e
+    // - Padded size for PKCS7 encryption, buffers must have room for the padding
+    // - Unpadded size for PKCS7 decryption
+    // - 16 bytes MAC for CBC-MAC and CMAC
+    size_t finish(uint8_t* input, size_t size, uint8_t* output);
+
+  private:
+    SaSiAesUserContext_t _context;
+    uint8_t _key[2*SASI_AES_KEY_MAX_SIZE_IN_BYTES]; // XTS uses double key
+    uint8_t _keylen;
+
+    uint8_t _mode;
+    uint8_t _dir;
+    uint8_t _padding;
+
+    bool _setup(void);
+};
+
+#endif /* NRFCRYPTO_AES_H_ */
@@ -0,0 +1,159 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_nRFCrypto.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Each CC310 operation is limited to 64KB, larger data is split
+#define AESCCM_CHUNK_MAX   (32*1024)
+
+//------------- IMPLEMENTATION -------------//
+nRFCrypto_AESCCM::nRFCrypto_AESCCM(void)
+{
+  varclr(&_context);
+  memset(_key, 0, sizeof(_key));
+  _dir     = 0;
+  _tag_len = 0;
+}
+
+bool nRFCrypto_AESCCM::begin(uint8_t const key[16])
+{
+  VERIFY(key);
+
+  memset(_key, 0, sizeof(_key));
+  memcpy(_key, key, KEY_SIZE);
+
+  return true;
+}
+
+void nRFCrypto_AESCCM::end(void)
+{
+  // don't leave key in memory
+  varclr(&_context);
+  memset(_key, 0, sizeof(_key));
+}
+
+bool nRFCrypto_AESCCM::start(SaSiAesEncryptMode_t dir, uint8_t* nonce, uint8_t nonce_len,
+                             uint8_t* adata, uint32_t adata_len, uint32_t text_len, uint8_t tag_len)
+{
+  _dir     = (uint8_t) dir;
+  _tag_len = tag_len;
+
+  nRFCrypto.lock();
+  uint32_t err = CRYS_AESCCM_Init(&_context, dir, _key, CRYS_AES_Key128BitSize, adata_len, text_len,
+                                  nonce, nonce_len, tag_len);
+
+  // Associated data can only be added once
+  if ( !err && adata_len ) err = CRYS_AESCCM_BlockAdata(&_context, adata, adata_len);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
+  return true;
+}
+
+bool nRFCrypto_AESCCM::update(uint8_t* input, size_t size, uint8_t* output)
+{
+  VERIFY( (size % SASI_AES_BLOCK_SIZE_IN_BYTES) == 0 );
+
+  while ( size )
+  {
+    size_t const count = minof(size, (size_t) AESCCM_CHUNK_MAX);
+
+    nRFCrypto.lock();
+    uint32_t const err = CRYS_AESCCM_BlockTextData(&_context, input, count, output);
+    nRFCrypto.unlock();
+
+    VERIFY_ERROR(err, false);
+
+    input  += count;
+    output += count;
+    size   -= count;
+  }
+
+  return true;
+}
+
+bool nRFCrypto_AESCCM::finish(uint8_t* input, size_t size, uint8_t* output, uint8_t* tag)
+{
+  // keep a partial or whole block for finish
+  while ( size > AESCCM_CHUNK_MAX )
+  {
+    VERIFY( update(input, AESCCM_CHUNK_MAX, output) );
+
+    input  += AESCCM_CHUNK_MAX;
+    output += AESCCM_CHUNK_MAX;
+    size   -= AESCCM_CHUNK_MAX;
+  }
+
+  // MAC buffer holds expected tag when decrypting
+  CRYS_AESCCM_Mac_Res_t mac;
+  memset(mac, 0, sizeof(mac));
+  if ( _dir == SASI_AES_DECRYPT ) memcpy(mac, tag, _tag_len);
+
+  uint8_t tag_len = _tag_len;
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_AESCCM_Finish(&_context, input, size, output, mac, &tag_len);
+  nRFCrypto.unlock();
+
+  if ( _dir == SASI_AES_DECRYPT )
+  {
+    // don't release unauthenticated plain text
+    if ( err && size ) memset(output, 0, size);
+  }
+  else if ( !err )
+  {
+    memcpy(tag, mac, tag_len);
+  }
+
+  VERIFY_ERROR(err, false);
+  return true;
+}
+
+bool nRFCrypto_AESCCM::_crypt(SaSiAesEncryptMode_t dir, uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                              uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len)
+{
+  VERIFY( start(dir, nonce, nonce_len, adata, adata_len, size, tag_len) );
+
+  bool const ok = finish(input, size, output, tag);
+
+  // chunks before the last one are already decrypted, don't release any unauthenticated plain text
+  if ( !ok && dir == SASI_AES_DECRYPT ) memset(output, 0, size);
+
+  return ok;
+}
+
+bool nRFCrypto_AESCCM::encrypt(uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                               uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len)
+{
+  return _crypt(SASI_AES_ENCRYPT, nonce, nonce_len, adata, adata_len, input, size, output, tag, tag_len);
+}
+
+bool nRFCrypto_AESCCM::decrypt(uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                               uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len)
+{
+  return _crypt(SASI_AES_DECRYPT, nonce, nonce_len, adata, adata_len, input, size, output, tag, tag_len);
+}
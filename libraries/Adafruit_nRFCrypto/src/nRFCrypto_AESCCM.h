@@ -0,0 +1,86 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NRFCRYPTO_AESCCM_H_
+#define NRFCRYPTO_AESCCM_H_
+
+#include "nrf_cc310/include/crys_aesccm.h"
+
+/* AES-CCM authenticated encryption with CryptoCell CC310 (128-bit key)
+ * - Key is kept by the object, each message starts with start() which
+ *   takes nonce, whole associated data and total text length.
+ * - Text is streamed with update() in multiple of 16 bytes, the rest is
+ *   processed by finish() which outputs (encrypt) or verifies (decrypt) the tag.
+ * - Decrypted text from update() is unauthenticated until finish() succeeds,
+ *   caller must discard it if finish() fails. decrypt() clears the whole output.
+ * - Output can be the same as input buffer (in-place)
+ * - CC310 DMA can only access RAM, data must not be placed in flash.
+ */
+class nRFCrypto_AESCCM
+{
+  public:
+    enum
+    {
+      KEY_SIZE = 16,
+      NONCE_MIN_SIZE = CRYS_AESCCM_NONCE_MIN_SIZE_BYTES,
+      NONCE_MAX_SIZE = CRYS_AESCCM_NONCE_MAX_SIZE_BYTES,
+      TAG_MAX_SIZE   = CRYS_AESCCM_MAC_MAX_SIZE_BYTES
+    };
+
+    nRFCrypto_AESCCM(void);
+
+    bool begin(uint8_t const key[16]);
+    void end(void);
+
+    //------------- Streaming -------------//
+    bool start(SaSiAesEncryptMode_t dir, uint8_t* nonce, uint8_t nonce_len,
+               uint8_t* adata, uint32_t adata_len, uint32_t text_len, uint8_t tag_len);
+
+    // size must be multiple of 16. Decrypt: output is not authenticated yet
+    bool update(uint8_t* input, size_t size, uint8_t* output);
+
+    // Encrypt: tag is output, Decrypt: tag is input and verified, output of
+    // this call is cleared if tag does not match (not the one of update())
+    bool finish(uint8_t* input, size_t size, uint8_t* output, uint8_t* tag);
+
+    //------------- One shot -------------//
+    bool encrypt(uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                 uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len);
+
+    // output is cleared if tag does not match
+    bool decrypt(uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                 uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len);
+
+  private:
+    CRYS_AESCCM_UserContext_t _context;
+    CRYS_AESCCM_Key_t _key;
+
+    uint8_t _dir;
+    uint8_t _tag_len;
+
+    bool _crypt(SaSiAesEncryptMode_t dir, uint8_t* nonce, uint8_t nonce_len, uint8_t* adata, uint32_t adata_len,
+                uint8_t* input, size_t size, uint8_t* output, uint8_t* tag, uint8_t tag_len);
+};
+
+#endif /* NRFCRYPTO_AESCCM_H_ */
@@ -48,7 +48,11 @@ nRFCrypto_Hash::nRFCrypto_Hash(void)
 
 bool nRFCrypto_Hash::begin(CRYS_HASH_OperationMode_t mode)
 {
-  VERIFY_ERROR( CRYS_HASH_Init(&_context, mode), false );
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_HASH_Init(&_context, mode);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
   if ( mode < CRYS_HASH_NumOfModes ) _digest_len = digest_len_arr[mode];
 
   return true;
@@ -56,13 +60,21 @@ bool nRFCrypto_Hash::begin(CRYS_HASH_OperationMode_t mode)
 
 bool nRFCrypto_Hash::update(uint8_t data[], size_t size)
 {
-  VERIFY_ERROR( CRYS_HASH_Update(&_context, data, size), false );
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_HASH_Update(&_context, data, size);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
   return true;
 }
 
 uint8_t nRFCrypto_Hash::end(uint32_t result[16])
 {
-  VERIFY_ERROR( CRYS_HASH_Finish(&_context, result), 0);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_HASH_Finish(&_context, result);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, 0);
   return _digest_len;
 }
 
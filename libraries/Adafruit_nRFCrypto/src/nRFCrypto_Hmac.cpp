@@ -48,16 +48,28 @@ nRFCrypto_Hmac::nRFCrypto_Hmac(void) { _digest_size = 0; }
 bool nRFCrypto_Hmac::begin(CRYS_HASH_OperationMode_t mode, uint8_t *key_ptr,
                            uint16_t keySize) {
     _digest_size = digestSize(mode);
-    VERIFY_ERROR(CRYS_HMAC_Init(&_context, mode, key_ptr, keySize), false);
+    nRFCrypto.lock();
+    uint32_t const err = CRYS_HMAC_Init(&_context, mode, key_ptr, keySize);
+    nRFCrypto.unlock();
+
+    VERIFY_ERROR(err, false);
     return true;
 }
 
 bool nRFCrypto_Hmac::update(uint8_t data[], size_t size) {
-    VERIFY_ERROR(CRYS_HMAC_Update(&_context, data, size), false);
+    nRFCrypto.lock();
+    uint32_t const err = CRYS_HMAC_Update(&_context, data, size);
+    nRFCrypto.unlock();
+
+    VERIFY_ERROR(err, false);
     return true;
 }
 
 uint8_t nRFCrypto_Hmac::end(uint32_t result[16]) {
-    VERIFY_ERROR(CRYS_HMAC_Finish(&_context, result), 0);
+    nRFCrypto.lock();
+    uint32_t const err = CRYS_HMAC_Finish(&_context, result);
+    nRFCrypto.unlock();
+
+    VERIFY_ERROR(err, 0);
     return _digest_size;
 }
@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Adafruit_nRFCrypto.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Job is allocated on submitter's stack, it is valid until done is given
+typedef struct
+{
+  nRFCrypto_Queue::job_func_t func;
+  void* arg;
+  uint32_t result;
+  SemaphoreHandle_t done;
+} crypto_job_t;
+
+//------------- IMPLEMENTATION -------------//
+nRFCrypto_Queue::nRFCrypto_Queue(void)
+{
+  _queue = NULL;
+  _task  = NULL;
+}
+
+bool nRFCrypto_Queue::begin(uint8_t depth, uint32_t stack_size)
+{
+  // skip if already started
+  if ( _task ) return true;
+
+  // First jobs from several tasks may race to start the queue. nRFCrypto mutex
+  // doesn't exist before nRFCrypto.begin(), suspend the scheduler instead: it
+  // nests with the heap lock and the new task doesn't run before resuming.
+  bool const started = (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+  if ( started ) vTaskSuspendAll();
+
+  if ( _task == NULL )
+  {
+    _queue = xQueueCreate(depth, sizeof(crypto_job_t*));
+
+    if ( _queue && pdPASS != xTaskCreate(_task_entry, "crypto", stack_size, this, TASK_PRIO_NORMAL, &_task) )
+    {
+      vQueueDelete(_queue);
+      _queue = NULL;
+      _task  = NULL;
+    }
+  }
+
+  if ( started ) (void) xTaskResumeAll();
+
+  VERIFY(_task);
+  return true;
+}
+
+void nRFCrypto_Queue::_task_entry(void* arg)
+{
+  nRFCrypto_Queue* self = (nRFCrypto_Queue*) arg;
+
+  while (1)
+  {
+    crypto_job_t* job;
+    if ( !xQueueReceive(self->_queue, &job, portMAX_DELAY) ) continue;
+
+    nRFCrypto.lock();
+    job->result = job->func(job->arg);
+    nRFCrypto.unlock();
+
+    xSemaphoreGive(job->done);
+  }
+}
+
+uint32_t nRFCrypto_Queue::run(job_func_t func, void* arg)
+{
+  // task is started on first job, only sketches using it pay for its stack
+  if ( _task == NULL ) (void) begin();
+
+  // Called from a job or task cannot be created: run directly
+  if ( _task == NULL || xTaskGetCurrentTaskHandle() == _task )
+  {
+    nRFCrypto.lock();
+    uint32_t const result = func(arg);
+    nRFCrypto.unlock();
+
+    return result;
+  }
+
+  StaticSemaphore_t sem_buf;
+
+  crypto_job_t job =
+  {
+    .func   = func,
+    .arg    = arg,
+    .result = 0,
+    .done   = xSemaphoreCreateBinaryStatic(&sem_buf)
+  };
+
+  crypto_job_t* job_ptr = &job;
+  xQueueSend(_queue, &job_ptr, portMAX_DELAY);
+
+  xSemaphoreTake(job.done, portMAX_DELAY);
+  vSemaphoreDelete(job.done);
+
+  return job.result;
+}
@@ -0,0 +1,56 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 Ha Thach (tinyusb.org) for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NRFCRYPTO_QUEUE_H_
+#define NRFCRYPTO_QUEUE_H_
+
+#include "rtos.h"
+
+/* CryptoCell job queue
+ * Jobs are executed one at a time by a dedicated task while holding
+ * nRFCrypto lock. Submitting task blocks on a semaphore until its job is
+ * complete instead of polling CC310 itself, other tasks keep running.
+ * Task is started by the first job if begin() is not called.
+ */
+class nRFCrypto_Queue
+{
+  public:
+    // Job function, return CRYS error code
+    typedef uint32_t (*job_func_t)(void* arg);
+
+    nRFCrypto_Queue(void);
+
+    bool begin(uint8_t depth = 8, uint32_t stack_size = 512);
+
+    // Run func with arg in the crypto task, block until it is done
+    uint32_t run(job_func_t func, void* arg);
+
+  private:
+    QueueHandle_t _queue;
+    TaskHandle_t  _task;
+
+    static void _task_entry(void* arg);
+};
+
+#endif /* NRFCRYPTO_QUEUE_H_ */
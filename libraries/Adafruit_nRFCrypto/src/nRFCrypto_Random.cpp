@@ -44,7 +44,9 @@ bool nRFCrypto_Random::begin(void)
   CRYS_RND_WorkBuff_t* workbuf = (CRYS_RND_WorkBuff_t*) rtos_malloc(sizeof(CRYS_RND_WorkBuff_t));
   VERIFY(workbuf);
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_RndInit(&_state, workbuf);
+  nRFCrypto.unlock();
   rtos_free(workbuf);
 
   VERIFY_ERROR(err, false);
@@ -57,7 +59,9 @@ void nRFCrypto_Random::end(void)
   if (!_begun) return;
   _begun = false;
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_RND_UnInstantiation(&_state);
+  nRFCrypto.unlock();
   VERIFY_ERROR(err, );
 }
 
@@ -68,7 +72,11 @@ CRYS_RND_State_t* nRFCrypto_Random::getContext(void)
 
 bool nRFCrypto_Random::addAdditionalInput(uint8_t* input, uint16_t size)
 {
-  VERIFY_ERROR(CRYS_RND_AddAdditionalInput(&_state, input, size), false);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_RND_AddAdditionalInput(&_state, input, size);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
   return true;
 }
 
@@ -77,7 +85,9 @@ bool nRFCrypto_Random::reseed(void)
   CRYS_RND_WorkBuff_t* workbuf = (CRYS_RND_WorkBuff_t*) rtos_malloc(sizeof(CRYS_RND_WorkBuff_t));
   VERIFY(workbuf);
 
+  nRFCrypto.lock();
   uint32_t err = CRYS_RND_Reseeding(&_state, workbuf);
+  nRFCrypto.unlock();
   rtos_free(workbuf);
 
   VERIFY_ERROR(err, false);
@@ -86,12 +96,20 @@ bool nRFCrypto_Random::reseed(void)
 
 bool nRFCrypto_Random::generate(uint8_t* buf, uint16_t bufsize)
 {
-  VERIFY_ERROR(CRYS_RND_GenerateVector(&_state, bufsize, buf), false);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_RND_GenerateVector(&_state, bufsize, buf);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
   return true;
 }
 
 bool nRFCrypto_Random::generateInRange(uint8_t* buf, uint32_t bitsize, uint8_t* max)
 {
-  VERIFY_ERROR(CRYS_RND_GenerateVectorInRange(&_state, CRYS_RND_GenerateVector, bitsize, max, buf), false);
+  nRFCrypto.lock();
+  uint32_t const err = CRYS_RND_GenerateVectorInRange(&_state, CRYS_RND_GenerateVector, bitsize, max, buf);
+  nRFCrypto.unlock();
+
+  VERIFY_ERROR(err, false);
   return true;
 }
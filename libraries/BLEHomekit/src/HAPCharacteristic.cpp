@@ -149,7 +149,7 @@ err_t HAPCharacteristic::_addChrIdDescriptor(void)
 
 uint16_t HAPCharacteristic::writeHapValue(const void* data, uint16_t len)
 {
-  free(_value);
+  rtos_free(_value);
 
   _vallen = len;
   _value  = rtos_malloc(len);
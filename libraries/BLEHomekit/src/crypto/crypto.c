@@ -21,6 +21,8 @@
 #include "utility/AdaCallback.h"
 
 #include "crypto.h"
+#include "crypto_backend.h"
+#include "poly1305.h"
 
 using namespace Adafruit_LittleFS_Namespace;
 
@@ -28,7 +30,12 @@ using namespace Adafruit_LittleFS_Namespace;
 
 crypto_keys_t crypto_keys;
 
-static const uint8_t zeros64[64];
+#if CFG_HOMEKIT_CRYPTO_CC310
+static const crypto_backend_t* _backend = &crypto_backend_cc310;
+#else
+static const crypto_backend_t* _backend = &crypto_backend_sw;
+#endif
+
 //static pstorage_handle_t crypto_store_handle;
 //static volatile uint8_t crypto_storing;
 static uint8_t crypto_loadKeys(void);
@@ -70,8 +77,24 @@ void crypto_printkey(void)
   }
 }
 
+void crypto_setBackend(const crypto_backend_t* backend)
+{
+  _backend = backend ? backend : &crypto_backend_sw;
+}
+
+const crypto_backend_t* crypto_getBackend(void)
+{
+  return _backend;
+}
+
 void crypto_init(void)
 {
+  if ( !_backend->init() )
+  {
+    LOG_LV1("HAP", "%s crypto backend failed, use software", _backend->name);
+    _backend = &crypto_backend_sw;
+  }
+
 //  uint32_t err_code;
 //
 //  static const pstorage_module_param_t param =
@@ -83,16 +106,17 @@ void crypto_init(void)
 //  err_code = pstorage_register((pstorage_module_param_t*)&param, &crypto_store_handle);
 //  APP_ERROR_CHECK(err_code);
 
-  if (!crypto_loadKeys())
-  {
-    srp_init();
+  uint8_t const loaded = crypto_loadKeys();
 
+  if (!loaded)
+  {
     crypto_sign_keypair(crypto_keys.sign.pub, crypto_keys.sign.secret);
+  }
 
-    // Store for reuse
+  // SRP salt & verifier (first run) and public key B are computed in background,
+  // keys are stored for reuse once new verifier is ready
 //    crypto_scheduleStoreKeys();
-    crypto_storeKeys();
-  }
+  srp_precompute(loaded, crypto_storeKeys);
 }
 
 static uint8_t crypto_loadKeys(void)
@@ -211,46 +235,55 @@ uint8_t crypto_advertise(void)
   }
 }
 
-uint8_t crypto_verifyAndDecrypt(const uint8_t* key, uint8_t* nonce, uint8_t* encrypted, uint8_t length, uint8_t* output_buf, uint8_t* mac)
+// RFC 7539 AEAD tag with empty AAD: Poly1305 keyed by ChaCha20 block 0 over
+// ciphertext | zero padding | le64(0) | le64(length). The tag is fed in
+// pieces so that neither a padded copy of the message nor a second buffer is
+// needed and decryption can run in place.
+static void crypto_aeadTag(uint8_t mac[16], const uint8_t* key, const uint8_t* nonce, const uint8_t* cipher, uint16_t length)
 {
-  uint8_t polykey[sizeof(zeros64)];
-  crypto_stream_chacha20_xor(polykey, zeros64, sizeof(zeros64), nonce, key, 0);
+  uint8_t polykey[32];
+  _backend->chacha20_xor(polykey, NULL, sizeof(polykey), nonce, key, 0);
+
+  poly1305_ctx_t ctx;
+  poly1305_init(&ctx, polykey);
+  memset(polykey, 0, sizeof(polykey));
+
+  uint8_t block[16] = { 0 };
+
+  poly1305_update(&ctx, cipher, length);
+  if ( length % 16 ) poly1305_update(&ctx, block, 16 - (length % 16));
 
-  uint8_t padding = (16 - length % 16) % 16;
-  uint8_t message[length + padding + 16];
-  memcpy(message, encrypted, length);
-  memset(message + length, 0, padding + 16);
-  message[length + padding + 8] = (uint8_t)length;
-  message[length + padding + 9] = (uint8_t)(length >> 8);
+  block[8] = (uint8_t) length;
+  block[9] = (uint8_t) (length >> 8);
+  poly1305_update(&ctx, block, sizeof(block));
 
-  if (crypto_onetimeauth_poly1305_verify(mac, message, sizeof(message), polykey) != 0)
+  poly1305_finish(&ctx, mac);
+}
+
+uint8_t crypto_verifyAndDecrypt(const uint8_t* key, uint8_t* nonce, uint8_t* encrypted, uint8_t length, uint8_t* output_buf, uint8_t* mac)
+{
+  uint8_t tag[16];
+  crypto_aeadTag(tag, key, nonce, encrypted, length);
+
+  // constant time compare
+  if (crypto_verify_16(mac, tag) != 0)
   {
     // Fail
     return 0;
   }
   else
   {
-    crypto_stream_chacha20_xor(output_buf, message, length, nonce, key, 1);
+    // encrypted and output_buf may be the same buffer
+    _backend->chacha20_xor(output_buf, encrypted, length, nonce, key, 1);
     return 1;
   }
 }
 
 void crypto_encryptAndSeal(const uint8_t* key, uint8_t* nonce, uint8_t* plain, uint16_t length, uint8_t* output_buf, uint8_t* output_mac)
 {
-  uint8_t polykey[sizeof(zeros64)];
-  crypto_stream_chacha20_xor(polykey, zeros64, sizeof(zeros64), nonce, key, 0);
-
-  uint8_t padding = (16 - length % 16) % 16;
-  uint8_t message[length + padding + 16];
-
-  crypto_stream_chacha20_xor(message, plain, length, nonce, key, 1);
-  memset(message + length, 0, padding + 16);
-  message[length + padding + 8] = (uint8_t)length;
-  message[length + padding + 9] = (uint8_t)(length >> 8);
-
-  crypto_onetimeauth_poly1305(output_mac, message, sizeof(message), polykey);
-
-  memcpy(output_buf, message, length);
+  // plain and output_buf may be the same buffer
+  _backend->chacha20_xor(output_buf, plain, length, nonce, key, 1);
+  crypto_aeadTag(output_mac, key, nonce, output_buf, length);
 }
 
 void crypto_sha512hmac(uint8_t* hash, uint8_t* salt, uint8_t salt_length, uint8_t* data, uint8_t data_length)
@@ -272,8 +305,7 @@ void crypto_sha512hmac(uint8_t* hash, uint8_t* salt, uint8_t salt_length, uint8_
 
 void crypto_hkdf(uint8_t* target, uint8_t* salt, uint8_t salt_length, uint8_t* info, uint8_t info_length, uint8_t* ikm, uint8_t ikm_length)
 {
-  crypto_sha512hmac(target, salt, salt_length, ikm, ikm_length);
-  crypto_sha512hmac(target, target, 64, info, info_length);
+  _backend->hkdf(target, salt, salt_length, info, info_length, ikm, ikm_length);
 }
 
 void crypto_transportEncrypt(uint8_t* key, uint8_t* nonce, uint8_t* plaintext, uint16_t plength, uint8_t* ciphertext, uint16_t* clength)
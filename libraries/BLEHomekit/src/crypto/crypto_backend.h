@@ -0,0 +1,72 @@
+/*
+ * crypto_backend.h
+ *
+ *  Pluggable primitives used by HAP session crypto. ChaCha20 and HKDF-SHA512
+ *  are run for every pairing message and every encrypted characteristic
+ *  access, SRP-3072 for pair-setup. On nRF52840 they are offloaded to the
+ *  CryptoCell CC310 while nRF52832 uses an optimized software implementation.
+ */
+
+#ifndef HOMEKIT_CRYPTO_BACKEND_H_
+#define HOMEKIT_CRYPTO_BACKEND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Use CryptoCell CC310 (Adafruit_nRFCrypto) for session crypto when available
+#ifndef CFG_HOMEKIT_CRYPTO_CC310
+  #ifdef NRF52840_XXAA
+    #define CFG_HOMEKIT_CRYPTO_CC310    1
+  #else
+    #define CFG_HOMEKIT_CRYPTO_CC310    0
+  #endif
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct
+{
+  const char* name;
+
+  // Prepare hardware if any, return false to fall back to software backend
+  bool (*init) (void);
+
+  // ChaCha20 with 64-bit nonce and 64-bit block counter starting at 'counter'.
+  // in and out may be the same buffer, in = NULL produces raw keystream.
+  void (*chacha20_xor) (uint8_t* out, const uint8_t* in, uint32_t len,
+                        const uint8_t nonce[8], const uint8_t key[32], uint32_t counter);
+
+  // HKDF-SHA512 producing 64 bytes of output key material. As in the HAP
+  // spec tables, info includes the trailing 0x01 block counter.
+  void (*hkdf) (uint8_t okm[64], const uint8_t* salt, uint8_t salt_length,
+                const uint8_t* info, uint8_t info_length, const uint8_t* ikm, uint8_t ikm_length);
+
+  // Optional SRP-6a host for pair-setup (3072-bit group, SHA-512, HAP variant).
+  // Leave NULL to use the software bignum implementation in srp/srp.c.
+  // Private ephemeral 'b' stays within the backend after srp_pubkey().
+  bool (*srp_setup)    (const uint8_t N[384], uint8_t g, const uint8_t* user, uint8_t user_length,
+                        const uint8_t* pwd, uint8_t pwd_length);
+  bool (*srp_verifier) (uint8_t salt[16], uint8_t v[384]);
+  bool (*srp_pubkey)   (const uint8_t v[384], uint8_t B[384]);
+  bool (*srp_proof)    (const uint8_t salt[16], const uint8_t v[384], const uint8_t A[384], const uint8_t B[384],
+                        const uint8_t M1[64], uint8_t M2[64], uint8_t K[64]);
+} crypto_backend_t;
+
+extern const crypto_backend_t crypto_backend_sw;
+
+#if CFG_HOMEKIT_CRYPTO_CC310
+extern const crypto_backend_t crypto_backend_cc310;
+#endif
+
+// Select backend, must be called before crypto_init()
+void crypto_setBackend(const crypto_backend_t* backend);
+const crypto_backend_t* crypto_getBackend(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOMEKIT_CRYPTO_BACKEND_H_ */
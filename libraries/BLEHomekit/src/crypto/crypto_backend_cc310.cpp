@@ -0,0 +1,188 @@
+/*
+ * crypto_backend_cc310.cpp
+ *
+ *  CryptoCell CC310 backend (nRF52840) using Adafruit_nRFCrypto.
+ *
+ *  Note: CRYS_CHACHA_POLY requires non-empty additional data while HAP uses
+ *  none, therefore only ChaCha20 runs on hardware and the tag is computed by
+ *  the incremental software Poly1305 in crypto.c.
+ *
+ *  SRP uses the PKA through the CRYS_SRP HomeKit variant (CRYS_SRP_VER_HK).
+ */
+
+#include "crypto_backend.h"
+
+#if CFG_HOMEKIT_CRYPTO_CC310
+
+#include <string.h>
+#include <Adafruit_nRFCrypto.h>
+#include "nrf_cc310/include/crys_chacha.h"
+#include "nrf_cc310/include/crys_hkdf.h"
+#include "nrf_cc310/include/crys_srp.h"
+
+// CC310 DMA can only access RAM, const data in flash must be copied first
+#define IS_RAM(_p)    ( ((uint32_t) (_p)) >= 0x20000000UL )
+
+// Bounds of the RAM copies, HAP salt/info are < 40 bytes, ikm is K (64 bytes)
+// and SRP credentials are "Pair-Setup" and the "XXX-XX-XXX" setup code
+#define HKDF_FIELD_MAX    64
+#define SRP_CRED_MAX      32
+
+static bool cc310_init(void)
+{
+  return nRFCrypto.begin();
+}
+
+static void cc310_chacha20_xor(uint8_t* out, const uint8_t* in, uint32_t len,
+                               const uint8_t nonce[8], const uint8_t key[32], uint32_t counter)
+{
+  if ( len == 0 ) return;
+
+  // keystream is keystream XOR zeros, flash input is processed in place
+  if ( in == NULL )
+  {
+    memset(out, 0, len);
+    in = out;
+  }
+  else if ( !IS_RAM(in) )
+  {
+    memcpy(out, in, len);
+    in = out;
+  }
+
+  CRYS_CHACHA_Nonce_t nonce_buf;
+  CRYS_CHACHA_Key_t   key_buf;
+  memcpy(nonce_buf, nonce, 8);
+  memcpy(key_buf, key, 32);
+
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_CHACHA(nonce_buf, CRYS_CHACHA_Nonce64BitSize, key_buf, counter, CRYS_CHACHA_Encrypt,
+                                (uint8_t*) in, len, out);
+  nRFCrypto.unlock();
+
+  memset(key_buf, 0, sizeof(key_buf));
+
+  // Only parameter errors are reported before any data is processed
+  if ( err != CRYS_OK )
+  {
+    LOG_LV1("HAP", "CRYS_CHACHA failed 0x%08lX, use software", err);
+    crypto_backend_sw.chacha20_xor(out, in, len, nonce, key, counter);
+  }
+}
+
+static void cc310_hkdf(uint8_t okm[64], const uint8_t* salt, uint8_t salt_length,
+                       const uint8_t* info, uint8_t info_length, const uint8_t* ikm, uint8_t ikm_length)
+{
+  // HAP salt/info are string literals in flash
+  if ( salt_length > HKDF_FIELD_MAX || info_length > HKDF_FIELD_MAX || ikm_length > HKDF_FIELD_MAX )
+  {
+    crypto_backend_sw.hkdf(okm, salt, salt_length, info, info_length, ikm, ikm_length);
+    return;
+  }
+
+  uint8_t salt_buf[HKDF_FIELD_MAX];
+  uint8_t info_buf[HKDF_FIELD_MAX];
+  uint8_t ikm_buf[HKDF_FIELD_MAX];
+  memcpy(salt_buf, salt, salt_length);
+  memcpy(info_buf, info, info_length);
+  memcpy(ikm_buf, ikm, ikm_length);
+
+  // CC310 appends the block counter itself
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_HKDF_KeyDerivFunc(CRYS_HKDF_HASH_SHA512_mode, salt_buf, salt_length, ikm_buf, ikm_length,
+                                           info_buf, info_length - 1, okm, 64, SASI_FALSE);
+  nRFCrypto.unlock();
+
+  memset(ikm_buf, 0, ikm_length);
+
+  if ( err != CRYS_OK )
+  {
+    LOG_LV1("HAP", "CRYS_HKDF failed 0x%08lX, use software", err);
+    crypto_backend_sw.hkdf(okm, salt, salt_length, info, info_length, ikm, ikm_length);
+  }
+}
+
+//--------------------------------------------------------------------+
+// SRP
+//--------------------------------------------------------------------+
+
+// Group, credentials and private ephemeral 'b' of the host
+static CRYS_SRP_Context_t _srp_ctx;
+
+static bool cc310_srp_setup(const uint8_t N[384], uint8_t g, const uint8_t* user, uint8_t user_length,
+                            const uint8_t* pwd, uint8_t pwd_length)
+{
+  // false falls back to the software SRP in srp/srp.c
+  VERIFY(user_length <= SRP_CRED_MAX && pwd_length <= SRP_CRED_MAX, false);
+
+  CRYS_SRP_Modulus_t modulus;
+  uint8_t user_buf[SRP_CRED_MAX];
+  uint8_t pwd_buf[SRP_CRED_MAX];
+  memcpy(modulus, N, sizeof(modulus));
+  memcpy(user_buf, user, user_length);
+  memcpy(pwd_buf, pwd, pwd_length);
+
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_SRP_HK_INIT(CRYS_SRP_HOST, modulus, g, CRYS_SRP_MODULUS_SIZE_3072_BITS,
+                                     user_buf, user_length, pwd_buf, pwd_length,
+                                     nRFCrypto.Random.getContext(), CRYS_RND_GenerateVector, &_srp_ctx);
+  nRFCrypto.unlock();
+
+  memset(pwd_buf, 0, pwd_length);
+
+  VERIFY_CRYS(err, false);
+  return true;
+}
+
+static bool cc310_srp_verifier(uint8_t salt[16], uint8_t v[384])
+{
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_SRP_PwdVerCreate(16, salt, v, &_srp_ctx);
+  nRFCrypto.unlock();
+
+  VERIFY_CRYS(err, false);
+  return true;
+}
+
+static bool cc310_srp_pubkey(const uint8_t v[384], uint8_t B[384])
+{
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_SRP_HostPubKeyCreate(32, (uint8_t*) v, B, &_srp_ctx);
+  nRFCrypto.unlock();
+
+  VERIFY_CRYS(err, false);
+  return true;
+}
+
+static bool cc310_srp_proof(const uint8_t salt[16], const uint8_t v[384], const uint8_t A[384], const uint8_t B[384],
+                            const uint8_t M1[64], uint8_t M2[64], uint8_t K[64])
+{
+  // Secret buffer is sized for interleaved SHA, HAP K = H(S) is a single digest
+  CRYS_SRP_Secret_t secret;
+
+  nRFCrypto.lock();
+  CRYSError_t err = CRYS_SRP_HostProofVerifyAndCalc(16, (uint8_t*) salt, (uint8_t*) v, (uint8_t*) A, (uint8_t*) B,
+                                                    (uint8_t*) M1, M2, secret, &_srp_ctx);
+  nRFCrypto.unlock();
+
+  // also fails if client proof M1 does not match
+  if ( err == CRYS_OK ) memcpy(K, secret, 64);
+  memset(secret, 0, sizeof(secret));
+
+  return err == CRYS_OK;
+}
+
+const crypto_backend_t crypto_backend_cc310 =
+{
+  .name         = "CC310",
+  .init         = cc310_init,
+  .chacha20_xor = cc310_chacha20_xor,
+  .hkdf         = cc310_hkdf,
+
+  .srp_setup    = cc310_srp_setup,
+  .srp_verifier = cc310_srp_verifier,
+  .srp_pubkey   = cc310_srp_pubkey,
+  .srp_proof    = cc310_srp_proof
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * crypto_backend_sw.c
+ *
+ *  Software backend: word oriented ChaCha20 with unrolled rounds instead of
+ *  the generic byte oriented tweetnacl core.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "crypto.h"
+#include "crypto_backend.h"
+
+#define ROTL32(v, n)    ( ((v) << (n)) | ((v) >> (32 - (n))) )
+
+#define QUARTERROUND(a, b, c, d) \
+  do {                                                  \
+    a += b; d ^= a; d = ROTL32(d, 16);                  \
+    c += d; b ^= c; b = ROTL32(b, 12);                  \
+    a += b; d ^= a; d = ROTL32(d,  8);                  \
+    c += d; b ^= c; b = ROTL32(b,  7);                  \
+  } while(0)
+
+static inline uint32_t ld32(const uint8_t* p)
+{
+  return ((uint32_t) p[0]) | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void chacha20_block(uint32_t out[16], const uint32_t in[16])
+{
+  uint32_t x0  = in[0] , x1  = in[1] , x2  = in[2] , x3  = in[3] ,
+           x4  = in[4] , x5  = in[5] , x6  = in[6] , x7  = in[7] ,
+           x8  = in[8] , x9  = in[9] , x10 = in[10], x11 = in[11],
+           x12 = in[12], x13 = in[13], x14 = in[14], x15 = in[15];
+
+  for (int i = 0; i < 10; i++)
+  {
+    // column round
+    QUARTERROUND(x0, x4, x8 , x12);
+    QUARTERROUND(x1, x5, x9 , x13);
+    QUARTERROUND(x2, x6, x10, x14);
+    QUARTERROUND(x3, x7, x11, x15);
+
+    // diagonal round
+    QUARTERROUND(x0, x5, x10, x15);
+    QUARTERROUND(x1, x6, x11, x12);
+    QUARTERROUND(x2, x7, x8 , x13);
+    QUARTERROUND(x3, x4, x9 , x14);
+  }
+
+  out[0]  = x0  + in[0] ; out[1]  = x1  + in[1] ; out[2]  = x2  + in[2] ; out[3]  = x3  + in[3] ;
+  out[4]  = x4  + in[4] ; out[5]  = x5  + in[5] ; out[6]  = x6  + in[6] ; out[7]  = x7  + in[7] ;
+  out[8]  = x8  + in[8] ; out[9]  = x9  + in[9] ; out[10] = x10 + in[10]; out[11] = x11 + in[11];
+  out[12] = x12 + in[12]; out[13] = x13 + in[13]; out[14] = x14 + in[14]; out[15] = x15 + in[15];
+}
+
+static bool sw_init(void)
+{
+  return true;
+}
+
+static void sw_chacha20_xor(uint8_t* out, const uint8_t* in, uint32_t len,
+                            const uint8_t nonce[8], const uint8_t key[32], uint32_t counter)
+{
+  // Original layout: 64-bit block counter in words 12-13, 64-bit nonce in 14-15
+  uint32_t state[16] =
+  {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, // "expand 32-byte k"
+    ld32(key+ 0), ld32(key+ 4), ld32(key+ 8), ld32(key+12),
+    ld32(key+16), ld32(key+20), ld32(key+24), ld32(key+28),
+    counter, 0, ld32(nonce), ld32(nonce+4)
+  };
+
+  uint32_t block[16];
+
+  while (len)
+  {
+    chacha20_block(block, state);
+    if ( ++state[12] == 0 ) state[13]++;
+
+    uint32_t const n = (len < 64) ? len : 64;
+
+    // nRF52 is little endian, keystream bytes are the block words in memory order
+    uint8_t const* ks = (uint8_t const*) block;
+    if ( in )
+    {
+      for(uint32_t i=0; i<n; i++) out[i] = in[i] ^ ks[i];
+      in += n;
+    }else
+    {
+      memcpy(out, ks, n);
+    }
+
+    out += n;
+    len -= n;
+  }
+
+  memset(block, 0, sizeof(block));
+  memset(state, 0, sizeof(state));
+}
+
+static void sw_hkdf(uint8_t okm[64], const uint8_t* salt, uint8_t salt_length,
+                    const uint8_t* info, uint8_t info_length, const uint8_t* ikm, uint8_t ikm_length)
+{
+  // extract then expand single block T(1) = HMAC(PRK, info | 0x01)
+  crypto_sha512hmac(okm, (uint8_t*) salt, salt_length, (uint8_t*) ikm, ikm_length);
+  crypto_sha512hmac(okm, okm, 64, (uint8_t*) info, info_length);
+}
+
+const crypto_backend_t crypto_backend_sw =
+{
+  .name         = "software",
+  .init         = sw_init,
+  .chacha20_xor = sw_chacha20_xor,
+  .hkdf         = sw_hkdf
+};
@@ -0,0 +1,169 @@
+/*
+ * poly1305.c
+ *
+ *  Incremental Poly1305, 32-bit variant of poly1305-donna (public domain)
+ */
+
+#include <string.h>
+#include "poly1305.h"
+
+static inline uint32_t ld32(const uint8_t* p)
+{
+  return ((uint32_t) p[0]) | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline void st32(uint8_t* p, uint32_t v)
+{
+  p[0] = (uint8_t) v; p[1] = (uint8_t) (v >> 8); p[2] = (uint8_t) (v >> 16); p[3] = (uint8_t) (v >> 24);
+}
+
+void poly1305_init(poly1305_ctx_t* ctx, const uint8_t key[32])
+{
+  // r &= 0xffffffc0ffffffc0ffffffc0fffffff
+  ctx->r[0] = (ld32(&key[ 0])     ) & 0x3ffffff;
+  ctx->r[1] = (ld32(&key[ 3]) >> 2) & 0x3ffff03;
+  ctx->r[2] = (ld32(&key[ 6]) >> 4) & 0x3ffc0ff;
+  ctx->r[3] = (ld32(&key[ 9]) >> 6) & 0x3f03fff;
+  ctx->r[4] = (ld32(&key[12]) >> 8) & 0x00fffff;
+
+  for(int i=0; i<5; i++) ctx->h[i] = 0;
+  for(int i=0; i<4; i++) ctx->pad[i] = ld32(&key[16 + 4*i]);
+
+  ctx->leftover = 0;
+}
+
+// hibit is 2^128 (in the 5th limb) for full blocks, 0 for the padded final block
+static void poly1305_blocks(poly1305_ctx_t* ctx, const uint8_t* m, size_t len, uint32_t hibit)
+{
+  const uint32_t r0 = ctx->r[0], r1 = ctx->r[1], r2 = ctx->r[2], r3 = ctx->r[3], r4 = ctx->r[4];
+  const uint32_t s1 = r1*5, s2 = r2*5, s3 = r3*5, s4 = r4*5;
+
+  uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2], h3 = ctx->h[3], h4 = ctx->h[4];
+
+  while (len >= 16)
+  {
+    // h += m
+    h0 += (ld32(m+ 0)     ) & 0x3ffffff;
+    h1 += (ld32(m+ 3) >> 2) & 0x3ffffff;
+    h2 += (ld32(m+ 6) >> 4) & 0x3ffffff;
+    h3 += (ld32(m+ 9) >> 6) & 0x3ffffff;
+    h4 += (ld32(m+12) >> 8) | hibit;
+
+    // h *= r
+    uint64_t d0 = ((uint64_t) h0*r0) + ((uint64_t) h1*s4) + ((uint64_t) h2*s3) + ((uint64_t) h3*s2) + ((uint64_t) h4*s1);
+    uint64_t d1 = ((uint64_t) h0*r1) + ((uint64_t) h1*r0) + ((uint64_t) h2*s4) + ((uint64_t) h3*s3) + ((uint64_t) h4*s2);
+    uint64_t d2 = ((uint64_t) h0*r2) + ((uint64_t) h1*r1) + ((uint64_t) h2*r0) + ((uint64_t) h3*s4) + ((uint64_t) h4*s3);
+    uint64_t d3 = ((uint64_t) h0*r3) + ((uint64_t) h1*r2) + ((uint64_t) h2*r1) + ((uint64_t) h3*r0) + ((uint64_t) h4*s4);
+    uint64_t d4 = ((uint64_t) h0*r4) + ((uint64_t) h1*r3) + ((uint64_t) h2*r2) + ((uint64_t) h3*r1) + ((uint64_t) h4*r0);
+
+    // partial h %= p
+    uint32_t c;
+                c = (uint32_t) (d0 >> 26); h0 = (uint32_t) d0 & 0x3ffffff;
+    d1 += c;    c = (uint32_t) (d1 >> 26); h1 = (uint32_t) d1 & 0x3ffffff;
+    d2 += c;    c = (uint32_t) (d2 >> 26); h2 = (uint32_t) d2 & 0x3ffffff;
+    d3 += c;    c = (uint32_t) (d3 >> 26); h3 = (uint32_t) d3 & 0x3ffffff;
+    d4 += c;    c = (uint32_t) (d4 >> 26); h4 = (uint32_t) d4 & 0x3ffffff;
+    h0 += c*5;  c = h0 >> 26;              h0 &= 0x3ffffff;
+    h1 += c;
+
+    m   += 16;
+    len -= 16;
+  }
+
+  ctx->h[0] = h0; ctx->h[1] = h1; ctx->h[2] = h2; ctx->h[3] = h3; ctx->h[4] = h4;
+}
+
+void poly1305_update(poly1305_ctx_t* ctx, const uint8_t* data, size_t len)
+{
+  // complete partial block from previous call
+  if ( ctx->leftover )
+  {
+    size_t want = 16 - ctx->leftover;
+    if ( want > len ) want = len;
+
+    memcpy(ctx->buffer + ctx->leftover, data, want);
+    ctx->leftover += want;
+    data += want;
+    len  -= want;
+
+    if ( ctx->leftover < 16 ) return;
+
+    poly1305_blocks(ctx, ctx->buffer, 16, 1UL << 24);
+    ctx->leftover = 0;
+  }
+
+  if ( len >= 16 )
+  {
+    size_t const full = len & ~((size_t) 15);
+    poly1305_blocks(ctx, data, full, 1UL << 24);
+    data += full;
+    len  -= full;
+  }
+
+  if ( len )
+  {
+    memcpy(ctx->buffer, data, len);
+    ctx->leftover = (uint8_t) len;
+  }
+}
+
+void poly1305_finish(poly1305_ctx_t* ctx, uint8_t mac[16])
+{
+  // last partial block is terminated with 0x01 then zero padded
+  if ( ctx->leftover )
+  {
+    size_t i = ctx->leftover;
+    ctx->buffer[i++] = 1;
+    for (; i < 16; i++) ctx->buffer[i] = 0;
+    poly1305_blocks(ctx, ctx->buffer, 16, 0);
+  }
+
+  uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2], h3 = ctx->h[3], h4 = ctx->h[4];
+  uint32_t c;
+
+  // fully carry h
+               c = h1 >> 26; h1 &= 0x3ffffff;
+  h2 += c;     c = h2 >> 26; h2 &= 0x3ffffff;
+  h3 += c;     c = h3 >> 26; h3 &= 0x3ffffff;
+  h4 += c;     c = h4 >> 26; h4 &= 0x3ffffff;
+  h0 += c*5;   c = h0 >> 26; h0 &= 0x3ffffff;
+  h1 += c;
+
+  // g = h + -p
+  uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+  uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+  uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+  uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+  uint32_t g4 = h4 + c - (1UL << 26);
+
+  // select h if h < p, or h + -p if h >= p, in constant time
+  uint32_t mask = (g4 >> 31) - 1;
+  g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+  mask = ~mask;
+  h0 = (h0 & mask) | g0;
+  h1 = (h1 & mask) | g1;
+  h2 = (h2 & mask) | g2;
+  h3 = (h3 & mask) | g3;
+  h4 = (h4 & mask) | g4;
+
+  // h = h % 2^128
+  h0 = ((h0      ) | (h1 << 26));
+  h1 = ((h1 >>  6) | (h2 << 20));
+  h2 = ((h2 >> 12) | (h3 << 14));
+  h3 = ((h3 >> 18) | (h4 <<  8));
+
+  // mac = (h + pad) % 2^128
+  uint64_t f;
+  f = (uint64_t) h0 + ctx->pad[0]            ; h0 = (uint32_t) f;
+  f = (uint64_t) h1 + ctx->pad[1] + (f >> 32); h1 = (uint32_t) f;
+  f = (uint64_t) h2 + ctx->pad[2] + (f >> 32); h2 = (uint32_t) f;
+  f = (uint64_t) h3 + ctx->pad[3] + (f >> 32); h3 = (uint32_t) f;
+
+  st32(mac +  0, h0);
+  st32(mac +  4, h1);
+  st32(mac +  8, h2);
+  st32(mac + 12, h3);
+
+  // wipe key material
+  memset(ctx, 0, sizeof(poly1305_ctx_t));
+}
@@ -0,0 +1,38 @@
+/*
+ * poly1305.h
+ *
+ *  Incremental Poly1305 one-time authenticator (RFC 7539), 26-bit limbs
+ *  based on poly1305-donna. Unlike crypto_onetimeauth_poly1305() the message
+ *  can be fed in pieces, so the AEAD tag can be computed without copying
+ *  ciphertext, padding and length block into one buffer.
+ */
+
+#ifndef HOMEKIT_CRYPTO_POLY1305_H_
+#define HOMEKIT_CRYPTO_POLY1305_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct
+{
+  uint32_t r[5];
+  uint32_t h[5];
+  uint32_t pad[4];
+  uint8_t  buffer[16];
+  uint8_t  leftover;
+} poly1305_ctx_t;
+
+void poly1305_init  (poly1305_ctx_t* ctx, const uint8_t key[32]);
+void poly1305_update(poly1305_ctx_t* ctx, const uint8_t* data, size_t len);
+void poly1305_finish(poly1305_ctx_t* ctx, uint8_t mac[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOMEKIT_CRYPTO_POLY1305_H_ */
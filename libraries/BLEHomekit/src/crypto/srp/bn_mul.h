@@ -31,7 +31,7 @@
  *         . IA-32 (SSE2)         . Motorola 68000
  *         . PowerPC, 32-bit      . MicroBlaze
  *         . PowerPC, 64-bit      . TriCore
- *         . SPARC v8             . ARM v3+
+ *         . SPARC v8             . ARM v3+ (UMAAL on v7E-M)
  *         . Alpha                . MIPS32
  *         . C, longlong          . C, generic
  */
@@ -614,6 +614,35 @@
            "r6", "r7", "r8", "r9", "cc"         \
          );
 
+#elif defined(__ARM_FEATURE_DSP)
+
+/*
+ * Adafruit: Cortex-M4 (nRF52) has UMAAL, d + s * b + c in one instruction
+ * i.e RdHi:RdLo = Rn * Rm + RdHi + RdLo cannot overflow 64 bits
+ */
+#define MULADDC_INIT                                    \
+    asm(                                                \
+            "ldr    r0, %3                      \n\t"   \
+            "ldr    r1, %4                      \n\t"   \
+            "ldr    r2, %5                      \n\t"   \
+            "ldr    r3, %6                      \n\t"
+
+#define MULADDC_CORE                                    \
+            "ldr    r4, [r0], #4                \n\t"   \
+            "ldr    r6, [r1]                    \n\t"   \
+            "umaal  r6, r2, r3, r4              \n\t"   \
+            "str    r6, [r1], #4                \n\t"
+
+#define MULADDC_STOP                                    \
+            "str    r2, %0                      \n\t"   \
+            "str    r1, %1                      \n\t"   \
+            "str    r0, %2                      \n\t"   \
+         : "=m" (c),  "=m" (d), "=m" (s)        \
+         : "m" (s), "m" (d), "m" (c), "m" (b)   \
+         : "r0", "r1", "r2", "r3", "r4", "r6",  \
+           "cc"                                 \
+         );
+
 #else
 
 #define MULADDC_INIT                                    \
@@ -7,6 +7,11 @@
  *         This library uses a massive amount of RAM during calculations.
  *         The SRP handshake takes 30+ seconds.
  *
+ *  Adafruit: when crypto backend provides SRP (CC310 on nRF52840) the PKA does
+ *  all the modular arithmetic. Salt/verifier (first run) and public key B are
+ *  precomputed on a background task right after boot, pair-setup only runs
+ *  the proof.
+ *
  *  Created on: Jun 10, 2015
  *      Author: tim
  */
@@ -22,6 +27,7 @@
 #include "../random.h"
 #include "srp.h"
 #include "../tweetnacl-modified/tweetnacl.h"
+#include "../crypto_backend.h"
 //#include "homekit/pairing.h"
 
 #include "common_inc.h"
@@ -123,6 +129,32 @@ void print_mpi(const char* str, mpi* m)
 
 srp_keys_t srp;
 
+#define SRP_TASK_STACK_SZ   (256*4)
+
+// Work left for srp_prepare()
+enum
+{
+  SRP_PENDING_NONE = 0,
+  SRP_PENDING_PUBKEY,   // verifier is loaded, need new b and B
+  SRP_PENDING_VERIFIER, // need new salt, verifier, b and B
+};
+
+static volatile uint8_t _srp_pending = SRP_PENDING_NONE;
+static SemaphoreHandle_t _srp_mutex = NULL;
+static void (*_srp_verifier_cb) (void) = NULL;
+
+static uint8_t _srp_group_ready = 0;
+
+// Backend doing SRP in hardware, NULL for software
+static const crypto_backend_t* _srp_hw = NULL;
+
+// Hardware proof needs both A and M1 from pair-setup M3
+static uint8_t _srp_A[384];
+
+// Software: N and Montgomery R^2 mod N are shared by all exponentiations
+static mpi _srp_n;
+static mpi _srp_rr;
+
 //static void MPI_ERROR_CHECK(int CODE)
 //{
 //  if (CODE != 0)
@@ -133,6 +165,95 @@ srp_keys_t srp;
 
 #define MPI_ERROR_CHECK(_code)     VERIFY_STATUS(_code, )
 
+static void srp_group_init(void)
+{
+  if ( _srp_group_ready ) return;
+  _srp_group_ready = 1;
+
+  const crypto_backend_t* backend = crypto_getBackend();
+  uint8_t const user_len = strlen(HOMEKIT_USERNAME);
+
+  if ( backend->srp_setup &&
+       backend->srp_setup((const uint8_t*) srp_N, srp_G, pincode, user_len,
+                          pincode + user_len + 1, sizeof(pincode) - user_len - 1) )
+  {
+    _srp_hw = backend;
+    return;
+  }
+
+  mpi_init(&_srp_n);
+  mpi_init(&_srp_rr);
+  int err_code = mpi_read_binary(&_srp_n, (uint8_t*)srp_N, srp_N_sizeof);
+  MPI_ERROR_CHECK(err_code);
+}
+
+/**
+ * Generate 'b' and 'B' = k*v + g^b % N, verifier must be ready
+ */
+static void srp_pubkey(void)
+{
+  int err_code;
+
+  if ( _srp_hw )
+  {
+    // 'b' is kept by the backend
+    memset(srp.b, 0, sizeof(srp.b));
+    VERIFY(_srp_hw->srp_pubkey(srp.v, srp.B), );
+    return;
+  }
+
+#if DEBUG_SRP
+  memcpy(srp.b, dbg_b, 32);
+#else
+  // Generate 'b' - a random value
+  random_create(srp.b, 32);
+#endif
+
+  mpi g;
+  mpi_init(&g);
+  err_code = mpi_lset(&g, srp_G);
+  MPI_ERROR_CHECK(err_code);
+
+  // Calculate 'k'
+  mpi k;
+  mpi_init(&k);
+  err_code = mpi_read_binary(&k, srp_N_G_hash, sizeof(srp_N_G_hash));
+  MPI_ERROR_CHECK(err_code);
+
+  mpi v;
+  mpi_init(&v);
+  err_code = mpi_read_binary(&v, srp.v, sizeof(srp.v));
+  MPI_ERROR_CHECK(err_code);
+
+  mpi B;
+  mpi_init(&B);
+  err_code = mpi_mul_mpi(&B, &k, &v);
+  MPI_ERROR_CHECK(err_code);
+  mpi_free(&v);
+
+  mpi b;
+  mpi_init(&b);
+  err_code = mpi_read_binary(&b, srp.b, sizeof(srp.b));
+  MPI_ERROR_CHECK(err_code);
+
+  mpi gb;
+  mpi_init(&gb);
+  err_code = mpi_exp_mod(&gb, &g, &b, &_srp_n, &_srp_rr);
+  MPI_ERROR_CHECK(err_code);
+  err_code = mpi_add_abs(&B, &B, &gb);
+  MPI_ERROR_CHECK(err_code);
+  err_code = mpi_mod_mpi(&B, &B, &_srp_n);
+  MPI_ERROR_CHECK(err_code);
+  err_code = mpi_write_binary(&B, srp.B, sizeof(srp.B));
+  MPI_ERROR_CHECK(err_code);
+
+  mpi_free(&gb);
+  mpi_free(&b);
+  mpi_free(&B);
+  mpi_free(&k);
+  mpi_free(&g);
+}
+
 /**
  * Adafruit: re-calculate x if p changes (setup code)
  */
@@ -140,6 +261,16 @@ void srp_init(void)
 {
   int err_code;
 
+  srp_group_init();
+
+  if ( _srp_hw )
+  {
+    // salt is generated by the backend as well
+    VERIFY(_srp_hw->srp_verifier(srp.salt, srp.v), );
+    srp_pubkey();
+    return;
+  }
+
   // The MPI library uses a ridiculous amount of memory. We use the stack allocator
   // so we don't tie this memory up except when we absolutely need to.
 //  uint8_t memory[11 * 1024];
@@ -147,13 +278,9 @@ void srp_init(void)
 
 #if DEBUG_SRP
   memcpy(srp.salt, dbg_salt, sizeof(srp.salt));
-  memcpy(srp.b, dbg_b, 32);
 #else
   // Generate salt
   random_create(srp.salt, sizeof(srp.salt));
-
-  // Generate 'b' - a random value
-  random_create(srp.b, 32);
 #endif
 
   // Calculate 'x' = H(s | H(I | ":" | P))
@@ -174,68 +301,111 @@ void srp_init(void)
   err_code = mpi_lset(&g, srp_G);
   MPI_ERROR_CHECK(err_code);
 
-  mpi n;
-  mpi_init(&n);
-  err_code = mpi_read_binary(&n, (uint8_t*)srp_N, srp_N_sizeof);
-  MPI_ERROR_CHECK(err_code);
-
-  mpi tmp;
-  mpi_init(&tmp);
   mpi v;
   mpi_init(&v);
-  err_code = mpi_exp_mod(&v, &g, &x, &n, &tmp);
-  MPI_ERROR_CHECK(err_code);
-
-  // Calculate 'k'
-  mpi k;
-  mpi_init(&k);
-  err_code = mpi_read_binary(&k, srp_N_G_hash, sizeof(srp_N_G_hash));
-  MPI_ERROR_CHECK(err_code);
-
-  // Calculate 'B' = k*v + g^b % N
-  mpi B;
-  mpi_init(&B);
-  err_code = mpi_mul_mpi(&B, &k, &v);
+  err_code = mpi_exp_mod(&v, &g, &x, &_srp_n, &_srp_rr);
   MPI_ERROR_CHECK(err_code);
 
   err_code = mpi_write_binary(&v, srp.v, sizeof(srp.v));
   MPI_ERROR_CHECK(err_code);
-  mpi_free(&v);
 
-  mpi b;
-  mpi_init(&b);
-  err_code = mpi_read_binary(&b, srp.b, sizeof(srp.b));
-  MPI_ERROR_CHECK(err_code);
-
-  err_code = mpi_exp_mod(&x, &g, &b, &n, &tmp);
-  MPI_ERROR_CHECK(err_code);
-  err_code = mpi_add_abs(&B, &B, &x);
-  MPI_ERROR_CHECK(err_code);
-  err_code = mpi_mod_mpi(&B, &B, &n);
-  MPI_ERROR_CHECK(err_code);
-  err_code = mpi_write_binary(&B, srp.B, sizeof(srp.B));
-
-  mpi_free(&b);
-  mpi_free(&B);
-  mpi_free(&k);
-  mpi_free(&tmp);
-  mpi_free(&n);
+  mpi_free(&v);
   mpi_free(&g);
   mpi_free(&x);
 
+  srp_pubkey();
+
 //  memory_buffer_alloc_free();
 }
 
+/**
+ * Complete pending precompute, either by background task or by pair-setup
+ * if it comes first. Only one does the work, the other waits for it.
+ */
+static void srp_prepare(void)
+{
+  if ( _srp_pending == SRP_PENDING_NONE ) return;
+
+  xSemaphoreTake(_srp_mutex, portMAX_DELAY);
+
+  uint8_t const pending = _srp_pending;
+  if ( pending == SRP_PENDING_VERIFIER )
+  {
+    srp_init();
+  }
+  else if ( pending == SRP_PENDING_PUBKEY )
+  {
+    srp_group_init();
+    srp_pubkey();
+  }
+  _srp_pending = SRP_PENDING_NONE;
+
+  xSemaphoreGive(_srp_mutex);
+
+  if ( pending == SRP_PENDING_VERIFIER && _srp_verifier_cb ) _srp_verifier_cb();
+}
+
+static void srp_precompute_task(void* arg)
+{
+  (void) arg;
+
+  srp_prepare();
+  vTaskDelete(NULL);
+}
+
+void srp_precompute(uint8_t have_verifier, void (*verifier_cb) (void))
+{
+  if ( _srp_mutex == NULL ) _srp_mutex = xSemaphoreCreateMutex();
+  VERIFY(_srp_mutex, );
+
+  _srp_verifier_cb = verifier_cb;
+  _srp_pending = have_verifier ? SRP_PENDING_PUBKEY : SRP_PENDING_VERIFIER;
+
+  // Low priority to keep BLE and sketch responsive
+  if ( pdPASS != xTaskCreate(srp_precompute_task, "srp", SRP_TASK_STACK_SZ, NULL, TASK_PRIO_LOW, NULL) )
+  {
+    srp_prepare();
+  }
+}
+
 void srp_start(void)
 {
+  // B is sent in M2, wait for precompute if it is still running
+  srp_prepare();
+
   srp.clientM1 = 0;
   srp.serverM1 = 0;
 }
 
+static uint8_t srp_proof_hw(void)
+{
+  return _srp_hw->srp_proof(srp.salt, srp.v, _srp_A, srp.B, srp.M1, srp.M2, srp.K) ? 1 : 0;
+}
+
 uint8_t srp_setA(uint8_t* abuf, uint16_t length, moretime_t moretime, uint16_t conn_hdl)
 {
   int err_code;
 
+  if ( _srp_hw )
+  {
+    VERIFY(length <= sizeof(_srp_A), 0);
+
+    // left pad to modulus size
+    memset(_srp_A, 0, sizeof(_srp_A) - length);
+    memcpy(_srp_A + sizeof(_srp_A) - length, abuf, length);
+
+    if (moretime)
+    {
+      moretime(conn_hdl);
+    }
+
+    // Proof needs both A and client M1
+    srp.serverM1 = 1;
+    return srp.clientM1 ? srp_proof_hw() : 1;
+  }
+
+  srp_group_init();
+
   // The MPI library uses a ridiculous amount of memory. We use the stack allocator
   // so we don't tie this memory up except when we absolutely need to.
 //  uint8_t memory[11 * 1024];
@@ -246,11 +416,6 @@ uint8_t srp_setA(uint8_t* abuf, uint16_t length, moretime_t moretime, uint16_t c
     mpi s;
     mpi_init(&s);
 
-    mpi n;
-    mpi_init(&n);
-    err_code = mpi_read_binary(&n, (uint8_t*)srp_N, srp_N_sizeof);
-    MPI_ERROR_CHECK(err_code);
-
     {
       // u = H(A | B)
       mpi u;
@@ -270,7 +435,7 @@ uint8_t srp_setA(uint8_t* abuf, uint16_t length, moretime_t moretime, uint16_t c
       err_code = mpi_read_binary(&v, srp.v, sizeof(srp.v));
 
       // getS = (A * v^u mod N)^b mod N
-      err_code = mpi_exp_mod(&s, &v, &u, &n, NULL);
+      err_code = mpi_exp_mod(&s, &v, &u, &_srp_n, &_srp_rr);
       MPI_ERROR_CHECK(err_code);
 
       mpi_free(&v);
@@ -297,14 +462,12 @@ uint8_t srp_setA(uint8_t* abuf, uint16_t length, moretime_t moretime, uint16_t c
       mpi_init(&b);
       err_code = mpi_read_binary(&b, srp.b, sizeof(srp.b));
 
-      err_code = mpi_exp_mod(&s, &s, &b, &n, NULL);
+      err_code = mpi_exp_mod(&s, &s, &b, &_srp_n, &_srp_rr);
       MPI_ERROR_CHECK(err_code);
 
       mpi_free(&b);
     }
 
-    mpi_free(&n);
-
 #if DEBUG_SRP > 1
 //    print_mpi("S", &s);
 #endif
@@ -387,6 +550,11 @@ uint8_t srp_checkM1(uint8_t* m1, uint16_t length)
   {
     return 0;
   }
+  if (_srp_hw)
+  {
+    memcpy(srp.M1, m1, sizeof(srp.M1));
+    return srp.serverM1 ? srp_proof_hw() : 1;
+  }
   if (srp.serverM1)
   {
     if (memcmp(srp.M1, m1, sizeof(srp.M1)) != 0)
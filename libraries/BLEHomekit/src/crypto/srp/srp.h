@@ -39,6 +39,7 @@ extern srp_keys_t srp;
 typedef void (*moretime_t)(uint16_t);
 
 extern void srp_init(void);
+extern void srp_precompute(uint8_t have_verifier, void (*verifier_cb) (void));
 extern void srp_start(void);
 extern uint8_t srp_setA(uint8_t* a, uint16_t length, moretime_t moretime, uint16_t conn_hdl);
 extern uint8_t srp_checkM1(uint8_t* m1, uint16_t length);
@@ -0,0 +1,183 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* Benchmark for the hot paths of Bluefruit52Lib: BLECharacteristic::notify(),
+ * BLEUart write and BLEScanner report dispatch. Connect with any central
+ * (e.g Bluefruit Connect app), enable notification on both the uart TXD and
+ * the benchmark characteristic then send any key over Serial to run.
+ *
+ * Results are printed one per line in the form
+ *    BENCH <name> <value> <unit>
+ * so that they can be collected by a script and compared between builds.
+ */
+#include <bluefruit.h>
+
+// Number of MTU-sized packets sent for each notify/uart test
+#define PACKET_NUM      500
+
+// Duration of scanner test
+#define SCAN_TIME_MS    5000
+
+BLEUart bleuart;
+
+BLEService        bench_svc(0x1234);
+BLECharacteristic bench_chr(0x1235);
+
+uint8_t test_data[BLE_GATT_ATT_MTU_MAX];
+
+// Scanner statistics, updated in scan callback
+volatile uint32_t scan_count = 0;
+volatile uint32_t scan_cb_max_us = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Bluefruit52 Benchmark");
+  Serial.println("---------------------\n");
+
+  // Maximum bandwidth for peripheral connection, 1 central role for scanner
+  // Note: All config***() function must be called before begin()
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+  Bluefruit.begin(1, 1);
+  Bluefruit.setTxPower(4);    // Check bluefruit.h for supported values
+  Bluefruit.Periph.setConnectCallback(connect_callback);
+
+  bleuart.begin();
+
+  bench_svc.begin();
+  bench_chr.setProperties(CHR_PROPS_NOTIFY);
+  bench_chr.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  bench_chr.setMaxLen(BLE_GATT_ATT_MTU_MAX - 3);
+  bench_chr.begin();
+
+  Bluefruit.Scanner.setRxCallback(scan_callback);
+  Bluefruit.Scanner.setInterval(160, 80); // in unit of 0.625 ms
+
+  memset(test_data, 'a', sizeof(test_data));
+
+  startAdv();
+}
+
+void startAdv(void)
+{
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addTxPower();
+  Bluefruit.Advertising.addService(bleuart);
+  Bluefruit.ScanResponse.addName();
+
+  Bluefruit.Advertising.restartOnDisconnect(true);
+  Bluefruit.Advertising.setInterval(32, 244);    // in unit of 0.625 ms
+  Bluefruit.Advertising.setFastTimeout(30);      // number of seconds in fast mode
+  Bluefruit.Advertising.start(0);                // 0 = Don't stop advertising after n seconds
+}
+
+void connect_callback(uint16_t conn_handle)
+{
+  BLEConnection* conn = Bluefruit.Connection(conn_handle);
+
+  // Get the link to its maximum before measuring
+  conn->requestPHY();
+  conn->requestDataLengthUpdate();
+  conn->requestMtuExchange(BLE_GATT_ATT_MTU_MAX);
+
+  Serial.println("Connected, enable notify then send any key to start");
+}
+
+void scan_callback(ble_gap_evt_adv_report_t* report)
+{
+  (void) report;
+  uint32_t start = micros();
+
+  scan_count++;
+  Bluefruit.Scanner.resume();
+
+  uint32_t duration = micros() - start;
+  if ( duration > scan_cb_max_us ) scan_cb_max_us = duration;
+}
+
+void print_result(const char* name, float value, const char* unit)
+{
+  Serial.printf("BENCH %-20s %10.2f %s\n", name, value, unit);
+}
+
+// Send PACKET_NUM MTU-sized packets with either characteristic notify or bleuart
+void bench_notify(bool use_uart)
+{
+  uint16_t const conn_hdl = Bluefruit.connHandle();
+  BLEConnection* conn = Bluefruit.Connection(conn_hdl);
+  if ( !conn ) return;
+
+  uint16_t const len = conn->getMtu() - 3;
+  uint32_t call_max_us = 0;
+  uint32_t sent = 0;
+
+  uint32_t const start = micros();
+  for (uint32_t i = 0; i < PACKET_NUM && Bluefruit.connected(); i++)
+  {
+    uint32_t const call_start = micros();
+    bool ok = use_uart ? (bleuart.write(test_data, len) == len) : bench_chr.notify(test_data, len);
+    uint32_t const call_us = micros() - call_start;
+
+    if ( !ok ) break;
+
+    sent += len;
+    if ( call_us > call_max_us ) call_max_us = call_us;
+  }
+  uint32_t const elapsed = micros() - start;
+
+  const char* prefix = use_uart ? "uart" : "notify";
+  char name[32];
+
+  sprintf(name, "%s_throughput", prefix);
+  print_result(name, (sent * 1000.0F) / elapsed, "KB/s");
+
+  sprintf(name, "%s_avg_call", prefix);
+  print_result(name, sent ? ((float) elapsed * len) / sent : 0, "us");
+
+  sprintf(name, "%s_max_call", prefix);
+  print_result(name, call_max_us, "us");
+}
+
+void bench_scanner(void)
+{
+  scan_count = 0;
+  scan_cb_max_us = 0;
+
+  Bluefruit.Scanner.start(0);
+  delay(SCAN_TIME_MS);
+  Bluefruit.Scanner.stop();
+
+  print_result("scan_reports", (scan_count * 1000.0F) / SCAN_TIME_MS, "report/s");
+  print_result("scan_cb_max", scan_cb_max_us, "us");
+}
+
+void loop()
+{
+  if ( !Serial.available() ) return;
+  while ( Serial.available() ) Serial.read();
+
+  if ( Bluefruit.connected() )
+  {
+    BLEConnection* conn = Bluefruit.Connection(Bluefruit.connHandle());
+    Serial.printf("MTU = %d, Interval = %.2f ms, PHY = %d, Data Length = %d\n",
+                  conn->getMtu(), conn->getConnectionInterval()*1.25f, conn->getPHY(), conn->getDataLength());
+
+    if ( bench_chr.notifyEnabled() ) bench_notify(false);
+    if ( bleuart.notifyEnabled()   ) bench_notify(true);
+  }
+
+  bench_scanner();
+}
@@ -0,0 +1,231 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* Micro-benchmark for the pure logic utilities of the core: RingBuffer,
+ * Adafruit_FIFO, Print, String, itoa, Stream parsing and AdaCallback.
+ * Timing uses the DWT cycle counter, each result is printed as
+ *    BENCH <name> <ns/op> ns/op <throughput> B/s <heap> heap B/op
+ * so that output of different builds can be compared by a script.
+ */
+#include <Arduino.h>
+#include "RingBuffer.h"
+#include "utility/adafruit_fifo.h"
+
+#define ITERATIONS    1000
+
+// Print sink that discards everything, only counts bytes
+class NullPrint : public Print
+{
+  public:
+    size_t count = 0;
+    virtual size_t write(uint8_t b) { (void) b; count++; return 1; }
+};
+
+// Print sink with bulk write, counts calls like a Serial/BLEUart transfer
+class NullBulkPrint : public NullPrint
+{
+  public:
+    size_t calls = 0;
+    virtual size_t write(uint8_t b) { calls++; return NullPrint::write(b); }
+    virtual size_t write(const uint8_t* buf, size_t len) { (void) buf; calls++; count += len; return len; }
+    using Print::write;
+};
+
+// Stream that endlessly replays a string, used to benchmark parsing
+class ReplayStream : public Stream
+{
+  public:
+    ReplayStream(const char* str) : _str(str), _pos(0) { }
+
+    virtual int available(void) { return 1; }
+    virtual int peek(void)      { return _str[_pos]; }
+    virtual int read(void)
+    {
+      int ch = _str[_pos++];
+      if ( _str[_pos] == 0 ) _pos = 0;
+      return ch;
+    }
+    virtual void flush(void) { }
+    virtual size_t write(uint8_t b) { (void) b; return 0; }
+
+  private:
+    const char* _str;
+    uint16_t _pos;
+};
+
+NullPrint nullPrint;
+NullBulkPrint bulkPrint;
+BufferedPrintN<64> bufPrint(bulkPrint);
+volatile uint32_t cb_count = 0;
+
+// measure cycles of a code block executed ITERATIONS times
+#define BENCH(_name, _bytes_per_op, _code)                    \
+  do {                                                        \
+    int const _heap = dbgHeapUsed();                          \
+    uint32_t const _start = DWT->CYCCNT;                      \
+    for (uint32_t _i = 0; _i < ITERATIONS; _i++) { _code; }   \
+    uint32_t const _cycles = DWT->CYCCNT - _start;            \
+    print_result(_name, _cycles, _bytes_per_op, dbgHeapUsed() - _heap); \
+  } while(0)
+
+void print_result(const char* name, uint32_t cycles, uint32_t bytes_per_op, int heap_delta)
+{
+  float const ns_per_op = (cycles * (1000000000.0F / F_CPU)) / ITERATIONS;
+  float const bytes_per_sec = bytes_per_op ? (bytes_per_op * 1000000000.0F) / ns_per_op : 0;
+
+  Serial.printf("BENCH %-20s %10.1f ns/op %12.0f B/s %6.1f heap B/op\n",
+                name, ns_per_op, bytes_per_sec, ((float) heap_delta) / ITERATIONS);
+}
+
+void adacb_counter(uint32_t arg)
+{
+  (void) arg;
+  cb_count++;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Core Utilities Benchmark");
+  Serial.println("------------------------\n");
+
+  dwt_enable();
+}
+
+void bench_ringbuffer(void)
+{
+  RingBuffer rb;
+
+  BENCH("ringbuffer_store_read", 1,
+    rb.store_char((uint8_t) _i);
+    (void) rb.read_char();
+  );
+}
+
+void bench_fifo(void)
+{
+  uint8_t buf[64];
+  memset(buf, 0x55, sizeof(buf));
+
+  Adafruit_FIFO fifo(1);
+  fifo.begin(256);
+
+  BENCH("fifo_write_read_1", 1,
+    fifo.write(buf, 1);
+    fifo.read(buf, 1);
+  );
+
+  BENCH("fifo_write_read_64", 64,
+    fifo.write(buf, 64);
+    fifo.read(buf, 64);
+  );
+}
+
+void bench_print(void)
+{
+  BENCH("print_int", 0, nullPrint.print(-1234567));
+  BENCH("print_hex", 0, nullPrint.print(0xDEADBEEFUL, HEX));
+  BENCH("print_float", 0, nullPrint.print(3.14159F, 4));
+  BENCH("print_str", 16, nullPrint.print("0123456789abcdef"));
+  BENCH("printf", 0, nullPrint.printf("t=%lu v=%d", _i, 42));
+
+  // A typical log line: unbuffered vs BufferedPrint, both to a bulk sink
+  BENCH("print_line", 0,
+    bulkPrint.print("t="); bulkPrint.print(_i); bulkPrint.print(" v="); bulkPrint.println(23.456F, 3);
+  );
+
+  BENCH("buffered_print_line", 0,
+    bufPrint.print("t="); bufPrint.print(_i); bufPrint.print(" v="); bufPrint.println(23.456F, 3);
+  );
+  bufPrint.flush();
+
+  BENCH("buffered_printf", 0, bufPrint.printf("t=%lu v=%d\n", _i, 42));
+  bufPrint.flush();
+}
+
+void bench_string(void)
+{
+  BENCH("string_from_int", 0, String s(_i); (void) s.length() );
+
+  BENCH("string_concat", 0,
+    String s("temp=");
+    s += 25;
+    s += ",hum=";
+    s += 60;
+    (void) s.length();
+  );
+
+  BENCH("string_format_float", 0, String s(23.456F, 2); (void) s.length() );
+
+  // Telemetry line built from temporaries, heap vs per-scope arena
+  String::resetAllocStats();
+  BENCH("string_telemetry", 0,
+    String s = "t=" + String(_i) + ",temp=" + String(23.456F, 2) + ",status=ok";
+    (void) s.length();
+  );
+  Serial.printf("  heap allocs %lu\n", String::getAllocStats().heap_alloc);
+
+  String::resetAllocStats();
+  BENCH("string_telemetry_arena", 0,
+    StringArenaN<128> arena;
+    String s = "t=" + String(_i) + ",temp=" + String(23.456F, 2) + ",status=ok";
+    (void) s.length();
+  );
+  Serial.printf("  heap allocs %lu, arena allocs %lu\n", String::getAllocStats().heap_alloc, String::getAllocStats().arena_alloc);
+}
+
+void bench_itoa(void)
+{
+  char buf[16];
+  BENCH("itoa_dec", 0, itoa((int) _i * 12345, buf, 10) );
+  BENCH("utoa_hex", 0, utoa(_i * 0x10001, buf, 16) );
+}
+
+void bench_stream(void)
+{
+  ReplayStream stream("12345,-678,3.25\n");
+  stream.setTimeout(0);
+
+  BENCH("stream_parse_int", 0, (void) stream.parseInt() );
+  BENCH("stream_parse_float", 0, (void) stream.parseFloat() );
+}
+
+void bench_adacallback(void)
+{
+  cb_count = 0;
+
+  // time to queue callback, they are executed later by the Callback task
+  BENCH("adacallback_queue", 0, ada_callback(NULL, 0, adacb_counter, _i) );
+
+  // then until all are executed
+  uint32_t const start = millis();
+  while ( (cb_count < ITERATIONS) && (millis() - start < 1000) ) delay(1);
+  Serial.printf("BENCH %-20s %10lu callbacks in %lu ms\n", "adacallback_exec", cb_count, millis() - start);
+}
+
+void loop()
+{
+  bench_ringbuffer();
+  bench_fifo();
+  bench_print();
+  bench_string();
+  bench_itoa();
+  bench_stream();
+  bench_adacallback();
+
+  Serial.println();
+  delay(5000);
+}
@@ -0,0 +1,61 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h> // for Serial
+
+/* HardwareTimer uses a TIMER peripheral (HwTimer1, HwTimer3 or HwTimer4) to
+ * invoke callback with microsecond resolution, independent of the rtos tick.
+ * Callback runs in interrupt context, keep it short.
+ *
+ * This sketch counts a 100 us periodic callback and blinks the LED using
+ * a one-shot on another timer.
+ */
+
+volatile uint32_t tick_count = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Hardware Timer Example");
+  Serial.println("----------------------\n");
+
+  pinMode(LED_RED, OUTPUT);
+
+  HwTimer3.begin(tick_callback);
+  HwTimer3.startPeriodic(100);
+
+  HwTimer4.begin(blink_callback);
+  HwTimer4.startOnce(500000);
+}
+
+void loop()
+{
+  delay(1000);
+  Serial.printf("%lu ticks of 100 us\n", tick_count);
+}
+
+void tick_callback(void)
+{
+  tick_count++;
+}
+
+void blink_callback(void)
+{
+  digitalToggle(LED_RED);
+
+  // re-arm one-shot timer
+  HwTimer4.startOnce(500000);
+}
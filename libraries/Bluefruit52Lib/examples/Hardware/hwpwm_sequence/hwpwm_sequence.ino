@@ -0,0 +1,87 @@
+/*********************************************************************
+ This is an example for our Feather Bluefruit modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/*
+ * This sketch fades LED RED and LED BLUE in opposite direction using
+ * PWM sequence playback. Duty values are played by EasyDMA from two
+ * buffers in turn: while one is playing, the other is refilled in the
+ * sequence end callback, CPU is not used between buffer swaps.
+ * - PWM1 : clock/16 ~ 1Mhz, top = 1000 --> PWM period is 1 ms
+ * - Each step is repeated 10 periods (refresh = 9) --> 10 ms per step
+ */
+
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h> // for Serial
+
+#define TOP       1000
+#define STEPS     32    // steps per buffer
+#define RAMP      100   // steps for fade in (or fade out)
+
+// Individual decoder: 4 values (one per channel) per step
+uint16_t seq_buf[2][STEPS*4];
+uint32_t phase = 0;
+
+void fill_buffer(uint8_t seq)
+{
+  uint16_t* buf = seq_buf[seq];
+
+  for(int i=0; i<STEPS; i++)
+  {
+    uint32_t p = (phase++) % (2*RAMP);
+    uint16_t duty = (p < RAMP ? p : (2*RAMP-1-p)) * (TOP/RAMP);
+
+    // bit 15 set for non-inverted polarity
+    buf[4*i+0] = duty | bit(15);          // LED RED
+    buf[4*i+1] = (TOP - duty) | bit(15);  // LED BLUE
+    buf[4*i+2] = bit(15);
+    buf[4*i+3] = bit(15);
+  }
+}
+
+// Invoked in ISR when a buffer is done playing
+void sequence_end_callback(uint8_t seq)
+{
+  fill_buffer(seq);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // channel 0 is LED RED, channel 1 is LED BLUE
+  HwPWM1.addPin( LED_RED );
+  HwPWM1.addPin( LED_BLUE );
+
+  HwPWM1.begin();
+  HwPWM1.setMaxValue(TOP);
+  HwPWM1.setClockDiv(PWM_PRESCALER_PRESCALER_DIV_16); // freq = 1Mhz
+
+  HwPWM1.setDecoder(PWM_DECODER_LOAD_Individual);
+
+  fill_buffer(0);
+  fill_buffer(1);
+  HwPWM1.setSequence(0, seq_buf[0], STEPS*4, 9);
+  HwPWM1.setSequence(1, seq_buf[1], STEPS*4, 9);
+
+  HwPWM1.setSequenceCallback(sequence_end_callback);
+
+  // play forever
+  HwPWM1.playSequence(0);
+}
+
+void loop()
+{
+  Serial.printf("Fading step %u\n", (unsigned) phase);
+  delay(1000);
+}
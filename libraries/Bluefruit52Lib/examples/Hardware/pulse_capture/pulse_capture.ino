@@ -0,0 +1,61 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h> // for Serial
+
+/* PulseCapture timestamps every edge of a pin with TIMER capture through
+ * PPI (62.5 ns resolution), widths are not affected by interrupt latency.
+ *
+ * This sketch records pulses on A0 (e.g an IR receiver output or a PWM signal)
+ * and prints them. pulseIn() uses the same hardware, here it measures a HIGH
+ * pulse on A1 while the loop task sleeps.
+ */
+
+#define CAPTURE_PIN   A0
+#define PULSEIN_PIN   A1
+
+PulseCapture capture;
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Pulse Capture Example");
+  Serial.println("---------------------\n");
+
+  pinMode(CAPTURE_PIN, INPUT_PULLUP);
+  pinMode(PULSEIN_PIN, INPUT_PULLDOWN);
+
+  if ( !capture.begin(CAPTURE_PIN, 128) )
+  {
+    Serial.println("No TIMER/GPIOTE/PPI channel available");
+    while(1) delay(10);
+  }
+}
+
+void loop()
+{
+  pulse_capture_t pulse;
+
+  while ( capture.read(&pulse) )
+  {
+    Serial.printf("%s %lu us\n", pulse.level ? "HIGH" : "LOW ", PulseCapture::ticksToMicros(pulse.ticks));
+  }
+
+  if ( capture.overflows() ) Serial.printf("%lu pulses lost\n", capture.overflows());
+
+  uint32_t width = pulseIn(PULSEIN_PIN, HIGH, 500000);
+  if ( width ) Serial.printf("pulseIn: %lu us\n", width);
+}
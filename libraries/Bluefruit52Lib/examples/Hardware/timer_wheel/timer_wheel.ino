@@ -0,0 +1,59 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h> // for Serial
+
+/* WheelTimer has the same usage as SoftwareTimer but all instances share a
+ * single FreeRTOS timer through a timer wheel. Starting and stopping is
+ * cheap and does not flood the rtos timer queue, which makes it suitable for
+ * a large number of timers e.g one per sensor or per connection.
+ *
+ * This sketch runs 100 timers with different periods and prints how many
+ * times each group has fired.
+ */
+
+#define WHEEL_TIMER_COUNT   100
+
+WheelTimer timers[WHEEL_TIMER_COUNT];
+volatile uint32_t fired[10] = { 0 };
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Timer Wheel Example");
+  Serial.println("-------------------\n");
+
+  for(uint32_t i=0; i<WHEEL_TIMER_COUNT; i++)
+  {
+    // group i%10 has period of (i%10 + 1) * 100 ms
+    timers[i].begin( ((i % 10) + 1) * 100, timer_callback, (void*) (i % 10) );
+    timers[i].start();
+  }
+}
+
+void loop()
+{
+  delay(1000);
+
+  for(uint8_t g=0; g<10; g++) Serial.printf("%lu ", fired[g]);
+  Serial.println();
+}
+
+void timer_callback(WheelTimer* timer)
+{
+  uint32_t group = (uint32_t) timer->getID();
+  fired[group]++;
+}
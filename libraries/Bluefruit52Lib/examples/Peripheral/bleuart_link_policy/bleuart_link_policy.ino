@@ -0,0 +1,131 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This sketch demonstrates BLELinkPolicy which automatically switches
+ * each connection between
+ * - bulk mode: short connection interval, 2M PHY, max data length and MTU
+ * - idle mode: long connection interval with slave latency to save power
+ * depending on how much data is sent. Send a few characters from Serial
+ * to trigger a burst of data over BLEUart and watch the mode changes.
+ */
+#include <bluefruit.h>
+
+// Number of bytes sent in a burst
+#define BURST_SIZE    (16*1024)
+
+BLEDis  bledis;
+BLEUart bleuart;
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Bluefruit52 Link Policy Example");
+  Serial.println("-------------------------------\n");
+
+  // Bulk mode can only use what SoftDevice is configured for
+  // Note: All config***() function must be called before begin()
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+
+  Bluefruit.begin();
+  Bluefruit.setTxPower(4);    // Check bluefruit.h for supported values
+  Bluefruit.Periph.setConnectCallback(connect_callback);
+
+  // Enable link policy with default profiles, then lower the threshold to
+  // enter bulk mode. Other fields of ble_link_policy_t can be tuned similarly
+  ble_link_policy_t policy;
+  Bluefruit.LinkPolicy.getPolicy(BLE_GAP_ROLE_PERIPH, &policy);
+  policy.enabled  = true;
+  policy.bulk_bps = 1000;
+  Bluefruit.LinkPolicy.setPolicy(BLE_GAP_ROLE_PERIPH, &policy);
+
+  Bluefruit.LinkPolicy.setModeChangeCallback(link_mode_callback);
+
+  bledis.setManufacturer("Adafruit Industries");
+  bledis.setModel("Bluefruit Feather52");
+  bledis.begin();
+
+  bleuart.begin();
+
+  startAdv();
+}
+
+void startAdv(void)
+{
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addTxPower();
+  Bluefruit.Advertising.addService(bleuart);
+  Bluefruit.ScanResponse.addName();
+
+  Bluefruit.Advertising.restartOnDisconnect(true);
+  Bluefruit.Advertising.setInterval(32, 244);    // in unit of 0.625 ms
+  Bluefruit.Advertising.setFastTimeout(30);      // number of seconds in fast mode
+  Bluefruit.Advertising.start(0);                // 0 = Don't stop advertising after n seconds
+}
+
+void connect_callback(uint16_t conn_handle)
+{
+  (void) conn_handle;
+  Serial.println("Connected, send any key to start a burst");
+}
+
+void link_mode_callback(uint16_t conn_handle, uint8_t mode)
+{
+  BLEConnection* conn = Bluefruit.Connection(conn_handle);
+  if ( !conn ) return;
+
+  Serial.printf("Conn %d is now in %s mode\n", conn_handle, (mode == LINK_MODE_BULK) ? "bulk" : "idle");
+}
+
+void loop()
+{
+  if ( Serial.available() )
+  {
+    while ( Serial.available() ) Serial.read();
+
+    if ( Bluefruit.connected() && bleuart.notifyEnabled() )
+    {
+      uint8_t buf[244];
+      memset(buf, 'a', sizeof(buf));
+
+      uint32_t start = millis();
+      uint32_t sent = 0;
+
+      while ( sent < BURST_SIZE && Bluefruit.connected() )
+      {
+        uint16_t count = bleuart.write(buf, minof(sizeof(buf), BURST_SIZE - sent));
+        if ( count == 0 ) break;
+        sent += count;
+      }
+
+      Serial.printf("Sent %lu bytes in %lu ms\n", sent, millis() - start);
+    }
+  }
+
+  // Print current parameters every few seconds
+  static uint32_t last_ms = 0;
+  if ( Bluefruit.connected() && (millis() - last_ms > 5000) )
+  {
+    last_ms = millis();
+
+    BLEConnection* conn = Bluefruit.Connection(Bluefruit.connHandle());
+    if ( conn )
+    {
+      Serial.printf("Interval = %.2f ms, Latency = %d, PHY = %d, MTU = %d, Data Length = %d\n",
+                    conn->getConnectionInterval()*1.25f, conn->getSlaveLatency(), conn->getPHY(),
+                    conn->getMtu(), conn->getDataLength());
+    }
+  }
+}
@@ -0,0 +1,67 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This sketch bridges USB Serial with BLEUart using BLEUartBridge. Data
+ * is moved by a dedicated task without going through loop(), anything
+ * sent from the PC terminal is notified to the BLE central (e.g Bluefruit
+ * Connect app) and vice versa.
+ * Note: only for nRF52840 with native USB
+ */
+#include <bluefruit.h>
+
+BLEDis        bledis;
+BLEUart       bleuart;
+BLEUartBridge bridge;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Max bandwidth for largest MTU and data length
+  // Note: All config***() function must be called before begin()
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+
+  Bluefruit.begin();
+  Bluefruit.setTxPower(4);    // Check bluefruit.h for supported values
+
+  bledis.setManufacturer("Adafruit Industries");
+  bledis.setModel("Bluefruit Feather52");
+  bledis.begin();
+
+  bleuart.begin();
+
+  // Serial and bleuart must not be read by sketch afterwards
+  bridge.begin(Serial, bleuart);
+
+  startAdv();
+}
+
+void startAdv(void)
+{
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addTxPower();
+  Bluefruit.Advertising.addService(bleuart);
+  Bluefruit.ScanResponse.addName();
+
+  Bluefruit.Advertising.restartOnDisconnect(true);
+  Bluefruit.Advertising.setInterval(32, 244);    // in unit of 0.625 ms
+  Bluefruit.Advertising.setFastTimeout(30);      // number of seconds in fast mode
+  Bluefruit.Advertising.start(0);                // 0 = Don't stop advertising after n seconds
+}
+
+void loop()
+{
+  // Nothing to do, bridge task does all the work
+  delay(1000);
+}
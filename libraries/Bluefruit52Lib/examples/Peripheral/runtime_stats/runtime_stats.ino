@@ -0,0 +1,84 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This sketch shows where CPU time goes: per-task CPU usage, idle and
+ * sleep residency, context switches and ISR time. A snapshot is printed
+ * to Serial every 5 seconds and exported over BLE by BLERuntimeStats
+ * every second, connect with a generic BLE app and enable notifications
+ * on the System (ADAF0F01-...) and Tasks (ADAF0F02-...) characteristics.
+ */
+#include <bluefruit.h>
+
+BLEDis          bledis;
+BLERuntimeStats blestats;
+
+// a busy task to show up in the stats
+void busy_task(void* arg)
+{
+  (void) arg;
+
+  while(1)
+  {
+    delayMicroseconds(2000); // spin 2 ms
+    delay(8);
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Bluefruit52 Runtime Stats Example");
+  Serial.println("---------------------------------\n");
+
+  // ISR time is measured with DWT cycle counter
+  dwt_enable();
+
+  Bluefruit.begin();
+  Bluefruit.setTxPower(4);    // Check bluefruit.h for supported values
+
+  bledis.setManufacturer("Adafruit Industries");
+  bledis.setModel("Bluefruit Feather52");
+  bledis.begin();
+
+  blestats.begin();
+  blestats.setPeriod(1000);
+
+  xTaskCreate(busy_task, "busy", 256, NULL, TASK_PRIO_LOW, NULL);
+
+  // Stats window is shared, the printer reports time since the last BLE update
+  dbgTaskStatsPrinter(5000);
+
+  startAdv();
+}
+
+void startAdv(void)
+{
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addTxPower();
+  Bluefruit.Advertising.addService(blestats);
+  Bluefruit.ScanResponse.addName();
+
+  Bluefruit.Advertising.restartOnDisconnect(true);
+  Bluefruit.Advertising.setInterval(32, 244);    // in unit of 0.625 ms
+  Bluefruit.Advertising.setFastTimeout(30);      // number of seconds in fast mode
+  Bluefruit.Advertising.start(0);                // 0 = Don't stop advertising after n seconds
+}
+
+void loop()
+{
+  // nothing to do, loop task is suspended to show up as idle
+  suspendLoop();
+}
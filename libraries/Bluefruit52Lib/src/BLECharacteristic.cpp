@@ -458,7 +458,7 @@ void BLECharacteristic::_eventHandler(ble_evt_t* event)
             {
               // Allocate long write buffer if not previously
               _long_wr.bufsize = 1024; // TODO bufsize is 10x MTU
-              _long_wr.buffer = (uint8_t*) rtos_malloc(_long_wr.bufsize);
+              _long_wr.buffer = (uint8_t*) rtos_malloc_tag(_long_wr.bufsize, HEAP_TAG_BLE);
               _long_wr.count = 0;
             }
 
@@ -725,7 +725,11 @@ bool BLECharacteristic::notify(uint16_t conn_hdl, const void* data, uint16_t len
     while ( remaining )
     {
       // Failed if there is no free buffer
-      if ( !conn->getHvnPacket() ) return false;
+      SYSTRACE_START(SYSTRACE_BLE_HVN_WAIT, conn_hdl);
+      bool const got_packet = conn->getHvnPacket();
+      SYSTRACE_STOP(SYSTRACE_BLE_HVN_WAIT, conn_hdl);
+
+      if ( !got_packet ) return false;
 
       uint16_t packet_len = min16(max_payload, remaining);
 
@@ -746,6 +750,9 @@ bool BLECharacteristic::notify(uint16_t conn_hdl, const void* data, uint16_t len
       }
       VERIFY_STATUS(status, false );
 
+      conn->_trackTx(packet_len);
+      SYSTRACE_MARK(SYSTRACE_BLE_NOTIFY, (conn_hdl << 16) | packet_len);
+
       remaining -= packet_len;
       u8data    += packet_len;
     }
@@ -310,6 +310,8 @@ uint16_t BLEClientCharacteristic::write(const void* data, uint16_t len)
 
     VERIFY_STATUS( sd_ble_gattc_write(_service->connHandle(), &param), len-remaining);
 
+    conn->_trackTx(packet_len);
+
     remaining -= packet_len;
     u8data    += packet_len;
   }
@@ -368,6 +370,7 @@ bool BLEClientCharacteristic::writeCCCD(uint16_t value)
   VERIFY( conn && conn->getWriteCmdPacket() );
 
   VERIFY_STATUS( sd_ble_gattc_write(conn_handle, &param), false );
+  conn->_trackTx(param.len);
 
   return true;
 }
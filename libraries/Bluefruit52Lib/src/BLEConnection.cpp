@@ -64,6 +64,14 @@ BLEConnection::BLEConnection(uint16_t conn_hdl, ble_gap_evt_connected_t const* e
   _hvc_received = false;
 
   _ediv = 0xFFFF;
+
+  _tx_bytes = 0;
+  _tx_queued = _tx_completed = 0;
+  _tx_stall = 0;
+  _link_idle_ms = 0;
+  _link_mode = LINK_MODE_DEFAULT;
+  _link_weak = false;
+  _link_mtu_requested = false;
 }
 
 BLEConnection::~BLEConnection()
@@ -130,6 +138,11 @@ uint8_t BLEConnection::getPHY(void)
   return _phy;
 }
 
+uint8_t BLEConnection::getLinkMode(void)
+{
+  return _link_mode;
+}
+
 ble_gap_addr_t BLEConnection::getPeerAddr (void)
 {
   return _bonded ? _bond_id_addr : _peer_addr;
@@ -231,6 +244,7 @@ void BLEConnection::stopRssi(void)
 
 bool BLEConnection::getHvnPacket (void)
 {
+  if ( uxSemaphoreGetCount(_hvn_sem) == 0 ) __atomic_fetch_add(&_tx_stall, 1, __ATOMIC_RELAXED);
   return xSemaphoreTake(_hvn_sem, ms2tick(BLE_GENERIC_TIMEOUT));
 }
 
@@ -241,9 +255,18 @@ bool BLEConnection::releaseHvnPacket(void)
 
 bool BLEConnection::getWriteCmdPacket (void)
 {
+  if ( uxSemaphoreGetCount(_wrcmd_sem) == 0 ) __atomic_fetch_add(&_tx_stall, 1, __ATOMIC_RELAXED);
   return xSemaphoreTake(_wrcmd_sem, ms2tick(BLE_GENERIC_TIMEOUT));
 }
 
+// Called after a notification or write command packet is queued to SoftDevice.
+// Counters are swapped out by BLELinkPolicy timer while any task can be sending
+void BLEConnection::_trackTx(uint16_t len)
+{
+  __atomic_fetch_add(&_tx_bytes, len, __ATOMIC_RELAXED);
+  _tx_queued++;
+}
+
 bool BLEConnection::saveCccd(void)
 {
   return bond_save_cccd(_role, _conn_hdl, &_bond_id_addr);
@@ -417,10 +440,12 @@ void BLEConnection::_eventHandler(ble_evt_t* evt)
     //--------------------------------------------------------------------+
     case BLE_GATTS_EVT_HVN_TX_COMPLETE:
       for(uint8_t i=0; i<evt->evt.gatts_evt.params.hvn_tx_complete.count; i++) xSemaphoreGive(_hvn_sem);
+      _tx_completed += evt->evt.gatts_evt.params.hvn_tx_complete.count;
     break;
 
     case BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE:
       for(uint8_t i=0; i<evt->evt.gattc_evt.params.write_cmd_tx_complete.count; i++) xSemaphoreGive(_wrcmd_sem);
+      _tx_completed += evt->evt.gattc_evt.params.write_cmd_tx_complete.count;
     break;
 
     case BLE_GATTS_EVT_HVC:
@@ -70,6 +70,18 @@ class BLEConnection
     // On-demand semaphore/data that are created on the fly
     SemaphoreHandle_t _hvc_sem;
 
+    // Traffic statistics and state for BLELinkPolicy
+    uint32_t _tx_bytes;     // bytes queued to SoftDevice since last sample
+    uint32_t _tx_queued;    // packets queued to SoftDevice
+    uint32_t _tx_completed; // packets reported as sent by SoftDevice
+    uint16_t _tx_stall;     // number of times TX queue is full since last sample
+    uint16_t _link_idle_ms;
+    uint8_t  _link_mode;
+    bool     _link_weak;    // RSSI too low for 2M PHY
+    bool     _link_mtu_requested;
+
+    friend class BLELinkPolicy;
+
   public:
     BLEConnection(uint16_t conn_hdl, ble_gap_evt_connected_t const * evt_connected, uint8_t hvn_qsize, uint8_t wrcmd_qsize);
     virtual ~BLEConnection();
@@ -86,6 +98,7 @@ class BLEConnection
     uint16_t getSupervisionTimeout(void);
     uint16_t getDataLength(void);
     uint8_t  getPHY(void);
+    uint8_t  getLinkMode(void);
 
     ble_gap_addr_t getPeerAddr(void);
     uint16_t getPeerName(char* buf, uint16_t bufsize);
@@ -123,6 +136,7 @@ class BLEConnection
      * Although declare as public, it is meant to be invoked by internal code.
      *------------------------------------------------------------------*/
     void _eventHandler(ble_evt_t* evt);
+    void _trackTx(uint16_t len);
 };
 
 
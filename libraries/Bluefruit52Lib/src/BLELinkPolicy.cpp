@@ -0,0 +1,318 @@
+/**************************************************************************/
+/*!
+    @file     BLELinkPolicy.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "bluefruit.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define LINK_SAMPLE_MS_DFLT   250
+
+/* Default profiles
+ * - Peripheral bulk interval is 15 ms, the minimum accepted by iOS
+ * - Idle: 100 ms interval with latency 4 i.e peripheral can sleep up to 500 ms
+ */
+static const ble_link_policy_t _prph_policy_dflt =
+{
+  .enabled      = false,
+  .bulk         = { .conn_interval = MS100TO125(15) , .slave_latency = 0, .sup_timeout = 200,
+                    .phy = BLE_GAP_PHY_2MBPS, .max_data_len = true, .mtu = BLE_GATT_ATT_MTU_MAX },
+  .idle         = { .conn_interval = MS100TO125(100), .slave_latency = 4, .sup_timeout = 400,
+                    .phy = BLE_GAP_PHY_1MBPS, .max_data_len = false, .mtu = 0 },
+  .bulk_bps     = 2000,
+  .idle_bps     = 200,
+  .idle_hold_ms = 2000,
+  .rssi_min     = -80,
+  .rssi_hyst    = 6
+};
+
+static const ble_link_policy_t _central_policy_dflt =
+{
+  .enabled      = false,
+  .bulk         = { .conn_interval = 6              , .slave_latency = 0, .sup_timeout = 200,
+                    .phy = BLE_GAP_PHY_2MBPS, .max_data_len = true, .mtu = BLE_GATT_ATT_MTU_MAX },
+  .idle         = { .conn_interval = MS100TO125(100), .slave_latency = 4, .sup_timeout = 400,
+                    .phy = BLE_GAP_PHY_1MBPS, .max_data_len = false, .mtu = 0 },
+  .bulk_bps     = 2000,
+  .idle_bps     = 200,
+  .idle_hold_ms = 2000,
+  .rssi_min     = -80,
+  .rssi_hyst    = 6
+};
+
+static void link_policy_timer_cb(TimerHandle_t xTimer)
+{
+  (void) xTimer;
+  Bluefruit.LinkPolicy._sample();
+}
+
+BLELinkPolicy::BLELinkPolicy(void)
+{
+  _policy[0] = _prph_policy_dflt;
+  _policy[1] = _central_policy_dflt;
+
+  _sample_ms = LINK_SAMPLE_MS_DFLT;
+  _timer     = NULL;
+  _mode_cb   = NULL;
+}
+
+ble_link_policy_t* BLELinkPolicy::_get_policy(uint8_t role)
+{
+  return &_policy[ (role == BLE_GAP_ROLE_PERIPH) ? 0 : 1 ];
+}
+
+void BLELinkPolicy::enable(bool enabled)
+{
+  enable(BLE_GAP_ROLE_PERIPH, enabled);
+  enable(BLE_GAP_ROLE_CENTRAL, enabled);
+}
+
+void BLELinkPolicy::enable(uint8_t role, bool enabled)
+{
+  _get_policy(role)->enabled = enabled;
+  if ( enabled ) _manage_connected(role);
+}
+
+bool BLELinkPolicy::enabled(uint8_t role)
+{
+  return _get_policy(role)->enabled;
+}
+
+void BLELinkPolicy::setPolicy(uint8_t role, ble_link_policy_t const* policy)
+{
+  *_get_policy(role) = *policy;
+  if ( policy->enabled ) _manage_connected(role);
+}
+
+void BLELinkPolicy::getPolicy(uint8_t role, ble_link_policy_t* policy)
+{
+  *policy = *_get_policy(role);
+}
+
+void BLELinkPolicy::setSampleInterval(uint16_t ms)
+{
+  _sample_ms = maxof(ms, (uint16_t) 50);
+  if ( _timer ) xTimerChangePeriod(_timer, ms2tick(_sample_ms), 0);
+}
+
+void BLELinkPolicy::setModeChangeCallback(mode_change_cb_t fp)
+{
+  _mode_cb = fp;
+}
+
+uint8_t BLELinkPolicy::getMode(uint16_t conn_hdl)
+{
+  BLEConnection* conn = Bluefruit.Connection(conn_hdl);
+  return conn ? conn->getLinkMode() : (uint8_t) LINK_MODE_DEFAULT;
+}
+
+bool BLELinkPolicy::setMode(uint16_t conn_hdl, uint8_t mode)
+{
+  BLEConnection* conn = Bluefruit.Connection(conn_hdl);
+  VERIFY(conn && conn->connected());
+  VERIFY(mode == LINK_MODE_IDLE || mode == LINK_MODE_BULK);
+
+  conn->_link_idle_ms = 0;
+  return _apply(conn, mode);
+}
+
+void BLELinkPolicy::_start_timer(void)
+{
+  if ( _timer == NULL )
+  {
+    _timer = xTimerCreate(NULL, ms2tick(_sample_ms), true, NULL, link_policy_timer_cb);
+    VERIFY(_timer, );
+  }
+
+  if ( !xTimerIsTimerActive(_timer) ) xTimerStart(_timer, 0);
+}
+
+/**
+ * Take over links of a role that were already up when its policy got enabled,
+ * same as what is done on BLE_GAP_EVT_CONNECTED for new ones
+ */
+void BLELinkPolicy::_manage_connected(uint8_t role)
+{
+  ble_link_policy_t const* policy = _get_policy(role);
+  bool found = false;
+
+  for (uint16_t c=0; c<BLE_MAX_CONNECTION; c++)
+  {
+    BLEConnection* conn = Bluefruit.Connection(c);
+    if ( !(conn && conn->connected() && conn->getRole() == role) ) continue;
+
+    // Sample RSSI without generating RSSI changed events
+    if ( policy->rssi_min ) (void) conn->monitorRssi();
+    found = true;
+  }
+
+  if ( found ) _start_timer();
+}
+
+/**
+ * Apply profile of a mode to the connection
+ * @return false if SoftDevice is busy with another procedure, caller
+ * should retry on next sample
+ */
+bool BLELinkPolicy::_apply(BLEConnection* conn, uint8_t mode)
+{
+  ble_link_policy_t const* policy = _get_policy(conn->getRole());
+  ble_link_profile_t const* profile = (mode == LINK_MODE_BULK) ? &policy->bulk : &policy->idle;
+
+  // Only one connection parameter update procedure is allowed at a time
+  if ( profile->conn_interval &&
+       (profile->conn_interval != conn->getConnectionInterval() || profile->slave_latency != conn->getSlaveLatency()) )
+  {
+    VERIFY( conn->requestConnectionParameter(profile->conn_interval, profile->slave_latency, profile->sup_timeout) );
+  }
+
+  uint8_t phy = profile->phy;
+  if ( phy == BLE_GAP_PHY_2MBPS && conn->_link_weak ) phy = BLE_GAP_PHY_1MBPS;
+  if ( phy && phy != conn->getPHY() ) (void) conn->requestPHY(phy);
+
+  if ( profile->max_data_len && conn->getDataLength() <= BLE_GATT_ATT_MTU_DEFAULT + 4 )
+  {
+    (void) conn->requestDataLengthUpdate();
+  }
+
+  // MTU exchange can only be initiated once per connection
+  if ( profile->mtu && !conn->_link_mtu_requested && conn->getMtu() < profile->mtu )
+  {
+    uint16_t const mtu = minof(profile->mtu, Bluefruit.getMaxMtu(conn->getRole()));
+    if ( mtu > conn->getMtu() ) conn->_link_mtu_requested = conn->requestMtuExchange(mtu);
+  }
+
+  if ( conn->_link_mode != mode )
+  {
+    LOG_LV1("LINK", "Conn %d switched to %s mode", conn->handle(), (mode == LINK_MODE_BULK) ? "bulk" : "idle");
+
+    conn->_link_mode = mode;
+    if ( _mode_cb ) ada_callback(NULL, 0, _mode_cb, conn->handle(), mode);
+  }
+
+  return true;
+}
+
+/**
+ * Invoked periodically by timer to evaluate traffic of all managed connections
+ */
+void BLELinkPolicy::_sample(void)
+{
+  uint8_t managed = 0;
+
+  for (uint16_t c=0; c<BLE_MAX_CONNECTION; c++)
+  {
+    BLEConnection* conn = Bluefruit.Connection(c);
+    if ( !(conn && conn->connected()) ) continue;
+
+    ble_link_policy_t const* policy = _get_policy(conn->getRole());
+    if ( !policy->enabled ) continue;
+
+    managed++;
+
+    // senders keep counting concurrently, swap so that nothing is lost
+    uint32_t const tx_bytes = __atomic_exchange_n(&conn->_tx_bytes, 0, __ATOMIC_RELAXED);
+    uint16_t const tx_stall = __atomic_exchange_n(&conn->_tx_stall, 0, __ATOMIC_RELAXED);
+
+    uint32_t const bps = (tx_bytes * 1000UL) / _sample_ms;
+    bool const in_flight = (int32_t) (conn->_tx_queued - conn->_tx_completed) > 0;
+
+    //------------- RSSI -------------//
+    bool weak_changed = false;
+    if ( policy->rssi_min )
+    {
+      int8_t const rssi = conn->getRssi(); // 0 if not available
+      bool weak = conn->_link_weak;
+
+      if ( rssi && rssi < policy->rssi_min ) weak = true;
+      else if ( rssi && rssi >= policy->rssi_min + policy->rssi_hyst ) weak = false;
+
+      weak_changed = (weak != conn->_link_weak);
+      conn->_link_weak = weak;
+    }
+
+    //------------- Mode -------------//
+    if ( bps >= policy->bulk_bps || tx_stall )
+    {
+      conn->_link_idle_ms = 0;
+
+      // PHY may need to change within bulk mode following RSSI
+      if ( conn->_link_mode != LINK_MODE_BULK || weak_changed ) _apply(conn, LINK_MODE_BULK);
+    }
+    else if ( conn->_link_mode != LINK_MODE_IDLE )
+    {
+      if ( bps <= policy->idle_bps && !in_flight )
+      {
+        conn->_link_idle_ms += _sample_ms;
+        if ( conn->_link_idle_ms >= policy->idle_hold_ms )
+        {
+          if ( _apply(conn, LINK_MODE_IDLE) ) conn->_link_idle_ms = 0;
+        }
+      }else
+      {
+        conn->_link_idle_ms = 0;
+      }
+    }
+  }
+
+  // Nothing to manage, stop sampling to save power
+  if ( managed == 0 ) xTimerStop(_timer, 0);
+}
+
+void BLELinkPolicy::_eventHandler(ble_evt_t* evt)
+{
+  switch ( evt->header.evt_id )
+  {
+    case BLE_GAP_EVT_CONNECTED:
+    {
+      uint16_t const conn_hdl = evt->evt.gap_evt.conn_handle;
+      BLEConnection* conn = Bluefruit.Connection(conn_hdl);
+      VERIFY(conn, );
+
+      ble_link_policy_t const* policy = _get_policy(conn->getRole());
+      if ( policy->enabled )
+      {
+        // Sample RSSI without generating RSSI changed events
+        if ( policy->rssi_min ) (void) conn->monitorRssi();
+
+        _start_timer();
+      }
+    }
+    break;
+
+    default: break;
+  }
+}
@@ -0,0 +1,124 @@
+/**************************************************************************/
+/*!
+    @file     BLELinkPolicy.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef BLELINKPOLICY_H_
+#define BLELINKPOLICY_H_
+
+#include <Arduino.h>
+#include "bluefruit_common.h"
+
+class BLEConnection;
+
+enum
+{
+  LINK_MODE_DEFAULT = 0, // not yet managed, parameters negotiated at connection
+  LINK_MODE_IDLE,
+  LINK_MODE_BULK,
+};
+
+// Connection parameters applied when a link enters a mode
+typedef struct
+{
+  uint16_t conn_interval;  // in 1.25 ms unit
+  uint16_t slave_latency;
+  uint16_t sup_timeout;    // in 10 ms unit
+  uint8_t  phy;            // BLE_GAP_PHY_*
+  bool     max_data_len;   // request Data Length Extension
+  uint16_t mtu;            // ATT MTU to exchange, 0 to skip
+} ble_link_profile_t;
+
+typedef struct
+{
+  bool enabled;
+
+  ble_link_profile_t bulk;
+  ble_link_profile_t idle;
+
+  // Hysteresis: enter bulk when TX rate reaches bulk_bps (or the TX queue is
+  // full), go back to idle only after the rate stays at or below idle_bps with
+  // nothing in flight for idle_hold_ms.
+  uint32_t bulk_bps;
+  uint32_t idle_bps;
+  uint16_t idle_hold_ms;
+
+  // 2M PHY has less sensitivity, fall back to 1M when RSSI drops below
+  // rssi_min and only use 2M again once it is rssi_min + rssi_hyst. 0 to disable.
+  int8_t   rssi_min;
+  uint8_t  rssi_hyst;
+} ble_link_policy_t;
+
+class BLELinkPolicy
+{
+  public:
+    typedef void (*mode_change_cb_t) (uint16_t conn_hdl, uint8_t mode);
+
+    BLELinkPolicy(void);
+
+    void enable (bool enabled);                 // both roles
+    void enable (uint8_t role, bool enabled);
+    bool enabled(uint8_t role);
+
+    void setPolicy(uint8_t role, ble_link_policy_t const* policy);
+    void getPolicy(uint8_t role, ble_link_policy_t* policy);
+
+    void setSampleInterval(uint16_t ms);
+
+    bool setMode(uint16_t conn_hdl, uint8_t mode); // force a mode, policy resumes afterwards
+    uint8_t getMode(uint16_t conn_hdl);
+
+    void setModeChangeCallback(mode_change_cb_t fp);
+
+    /*------------------------------------------------------------------*/
+    /* INTERNAL USAGE ONLY
+     * Although declare as public, it is meant to be invoked by internal code.
+     *------------------------------------------------------------------*/
+    void _eventHandler(ble_evt_t* evt);
+    void _sample(void);
+
+  private:
+    ble_link_policy_t _policy[2]; // peripheral, central
+    uint16_t _sample_ms;
+    TimerHandle_t _timer;
+
+    mode_change_cb_t _mode_cb;
+
+    ble_link_policy_t* _get_policy(uint8_t role);
+    bool _apply(BLEConnection* conn, uint8_t mode);
+    void _start_timer(void);
+    void _manage_connected(uint8_t role);
+};
+
+#endif /* BLELINKPOLICY_H_ */
@@ -0,0 +1,251 @@
+/**************************************************************************/
+/*!
+    @file     BLEUartBridge.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "bluefruit.h"
+
+#ifdef USE_TINYUSB
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define BRIDGE_STACK_SZ     (256)
+#define BRIDGE_RETRY_MS     50
+#define BRIDGE_DRAIN_MS     1
+
+// Callbacks have no context, only one bridge is active
+static BLEUartBridge* _bridge = NULL;
+
+static void bridge_task(void* arg)
+{
+  BLEUartBridge* bridge = (BLEUartBridge*) arg;
+  bool usb_full = false;
+
+  while (1)
+  {
+    // woken up by CDC receive or BLE data, timeout to retry when link was
+    // not ready. Poll faster while BLE data is waiting for CDC FIFO space
+    ulTaskNotifyTake(pdTRUE, ms2tick(usb_full ? BRIDGE_DRAIN_MS : BRIDGE_RETRY_MS));
+
+    usb_full = !bridge->_drain();
+    bridge->_pump();
+  }
+}
+
+static void bridge_cdc_rx_cb(void)
+{
+  if ( _bridge ) _bridge->_wakeup();
+}
+
+// Invoked in BLE task with data in event buffer
+static void bridge_uart_rxd_cb(uint16_t conn_hdl, BLECharacteristic* chr, uint8_t* data, uint16_t len)
+{
+  (void) conn_hdl;
+  (void) chr;
+  _bridge->_to_usb(data, len);
+}
+
+static void bridge_client_notify_cb(BLEClientCharacteristic* chr, uint8_t* data, uint16_t len)
+{
+  (void) chr;
+  _bridge->_to_usb(data, len);
+}
+
+BLEUartBridge::BLEUartBridge(uint16_t fifo_depth)
+{
+  _cdc      = NULL;
+  _uart     = NULL;
+  _client   = NULL;
+  _conn_hdl = BLE_CONN_HANDLE_INVALID;
+  _task     = NULL;
+  _dropped  = 0;
+
+  _usb_fifo       = NULL;
+  _usb_fifo_depth = fifo_depth;
+}
+
+bool BLEUartBridge::begin(Adafruit_USBD_CDC& cdc, BLEUart& uart)
+{
+  VERIFY( _begin(cdc) );
+
+  _uart = &uart;
+  _uart->_rxd.setWriteCallback(bridge_uart_rxd_cb, false);
+
+  return true;
+}
+
+bool BLEUartBridge::begin(Adafruit_USBD_CDC& cdc, BLEClientUart& client)
+{
+  VERIFY( _begin(cdc) );
+
+  _client = &client;
+  _client->_txd.setNotifyCallback(bridge_client_notify_cb, false);
+
+  return true;
+}
+
+bool BLEUartBridge::_begin(Adafruit_USBD_CDC& cdc)
+{
+  VERIFY(_bridge == NULL);
+
+  _cdc    = &cdc;
+  _bridge = this;
+
+  _usb_fifo = new Adafruit_FIFO(1);
+  _usb_fifo->begin(_usb_fifo_depth);
+
+  VERIFY( pdPASS == xTaskCreate(bridge_task, "bridge", BRIDGE_STACK_SZ, this, TASK_PRIO_NORMAL, &_task) );
+  _cdc->setRxCallback(bridge_cdc_rx_cb);
+
+  return true;
+}
+
+void BLEUartBridge::_wakeup(void)
+{
+  if ( _task ) xTaskNotifyGive(_task);
+}
+
+void BLEUartBridge::setConnHandle(uint16_t conn_hdl)
+{
+  _conn_hdl = conn_hdl;
+}
+
+uint16_t BLEUartBridge::_link_conn_hdl(void)
+{
+  if ( _client ) return _client->discovered() ? _client->connHandle() : BLE_CONN_HANDLE_INVALID;
+
+  uint16_t const conn_hdl = (_conn_hdl == BLE_CONN_HANDLE_INVALID) ? Bluefruit.connHandle() : _conn_hdl;
+  return _uart->notifyEnabled(conn_hdl) ? conn_hdl : BLE_CONN_HANDLE_INVALID;
+}
+
+/**
+ * USB -> BLE, run by bridge task
+ * Chunks are sent straight from CDC FIFO, SoftDevice copies them to its
+ * TX queue. Sending blocks until HVN/Write Command TX complete frees a buffer.
+ */
+void BLEUartBridge::_pump(void)
+{
+  while (1)
+  {
+    uint8_t const* data;
+    size_t count = _cdc->readSpan(&data);
+    if ( count == 0 ) return;
+
+    uint16_t const conn_hdl = _link_conn_hdl();
+    BLEConnection* conn = Bluefruit.Connection(conn_hdl);
+
+    // no peer to receive, discard
+    if ( !(conn && conn->connected()) )
+    {
+      _dropped += _cdc->readAdvance(count);
+      continue;
+    }
+
+    count = minof(count, (size_t) (conn->getMtu() - 3));
+
+    uint16_t sent;
+    if ( _client )
+    {
+      sent = _client->_rxd.write(data, count);
+    }else
+    {
+      sent = _uart->_txd.notify(conn_hdl, data, count) ? count : 0;
+    }
+
+    // releasing FIFO space lets host send more
+    _cdc->readAdvance(sent);
+
+    // notify may have waited for TX complete, keep BLE -> USB moving
+    (void) _drain();
+
+    // TX queue still full after timeout, retry later
+    if ( sent < count ) return;
+  }
+}
+
+/**
+ * BLE -> USB, run by BLE task
+ * Only queue the packet, waiting here for CDC FIFO space would hold every BLE
+ * event including the TX complete that _pump() waits for.
+ */
+void BLEUartBridge::_to_usb(uint8_t const* data, uint16_t len)
+{
+  uint16_t const count = _usb_fifo->write(data, len);
+  _dropped += len - count;
+
+  _wakeup();
+}
+
+/**
+ * BLE -> USB, run by bridge task
+ * Move queued data into CDC TX FIFO.
+ * @return false if data is left because CDC FIFO is full
+ */
+bool BLEUartBridge::_drain(void)
+{
+  bool written = false;
+
+  while ( !_usb_fifo->empty() )
+  {
+    uint8_t* buf;
+    size_t count = _cdc->writeReserve(&buf);
+
+    if ( count == 0 )
+    {
+      // host is not connected, nothing will be read
+      if ( !_cdc->dtr() )
+      {
+        uint16_t const pending = _usb_fifo->count();
+        _usb_fifo->advanceRead(pending);
+        _dropped += pending;
+        break;
+      }
+
+      if ( written ) _cdc->flush();
+      return false;
+    }
+
+    count = _usb_fifo->read(buf, minof(count, (size_t) _usb_fifo->count()));
+    _cdc->writeCommit(count);
+    written = true;
+  }
+
+  // send partial packet now
+  if ( written ) _cdc->flush();
+
+  return true;
+}
+
+#endif // USE_TINYUSB
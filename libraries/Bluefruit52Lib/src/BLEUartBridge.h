@@ -0,0 +1,104 @@
+/**************************************************************************/
+/*!
+    @file     BLEUartBridge.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+#ifndef BLEUARTBRIDGE_H_
+#define BLEUARTBRIDGE_H_
+
+#include <Arduino.h>
+#include "bluefruit_common.h"
+
+#ifdef USE_TINYUSB
+
+#include "Adafruit_TinyUSB.h"
+
+#define BLE_UART_BRIDGE_FIFO_DEPTH   1024
+
+class BLEUart;
+class BLEClientUart;
+
+/* Moves data between a USB CDC port and a BLE UART link in both directions
+ * - USB -> BLE: woken up by CDC receive, data is notified (peripheral) or
+ *   written without response (central) in MTU-sized chunks straight from
+ *   the CDC FIFO. Host is flow controlled by the CDC FIFO while BLE TX queue
+ *   is full.
+ * - BLE -> USB: received packets are queued to a FIFO by the BLE task and
+ *   moved to the CDC TX FIFO by the bridge task, so that a slow USB host
+ *   never stalls BLE events. Data that does not fit is dropped.
+ * Data is dropped when the other side is not connected, see dropped().
+ */
+class BLEUartBridge
+{
+  public:
+    BLEUartBridge(uint16_t fifo_depth = BLE_UART_BRIDGE_FIFO_DEPTH);
+
+    // Peripheral: bridge with BLEUart service
+    bool begin(Adafruit_USBD_CDC& cdc, BLEUart& uart);
+
+    // Central: bridge with BLEClientUart
+    bool begin(Adafruit_USBD_CDC& cdc, BLEClientUart& client);
+
+    // Connection used by peripheral, default is Bluefruit.connHandle()
+    void setConnHandle(uint16_t conn_hdl);
+
+    uint32_t dropped(void) { return _dropped; }
+
+    /*------------------------------------------------------------------*/
+    /* INTERNAL USAGE ONLY
+     *------------------------------------------------------------------*/
+    void _pump(void);
+    bool _drain(void);
+    void _wakeup(void);
+    void _to_usb(uint8_t const* data, uint16_t len);
+
+  private:
+    Adafruit_USBD_CDC* _cdc;
+    BLEUart*           _uart;
+    BLEClientUart*     _client;
+
+    uint16_t     _conn_hdl;
+    TaskHandle_t _task;
+
+    Adafruit_FIFO* _usb_fifo;
+    uint16_t       _usb_fifo_depth;
+
+    volatile uint32_t _dropped;
+
+    bool _begin(Adafruit_USBD_CDC& cdc);
+    uint16_t _link_conn_hdl(void);
+};
+
+#endif // USE_TINYUSB
+
+#endif /* BLEUARTBRIDGE_H_ */
@@ -106,7 +106,7 @@ size_t BLEUuid::size (void) const
 
 uint8_t* parse_str2uuid128(const char* str)
 {
-  uint8_t* u128 = (uint8_t*) rtos_malloc(16);
+  uint8_t* u128 = (uint8_t*) rtos_malloc_tag(16, HEAP_TAG_BLE);
   uint8_t len = 0;
 
   // str is input as big endian
@@ -669,6 +669,7 @@ extern "C" void SD_EVT_IRQHandler(void)
 #if CFG_SYSVIEW
   SEGGER_SYSVIEW_RecordEnterISR();
 #endif
+  dbgIsrEnter();
 
   // Notify both BLE & SOC & MultiProtocol (if any) Task
   xSemaphoreGiveFromISR(Bluefruit._soc_event_sem, NULL);
@@ -678,6 +679,7 @@ extern "C" void SD_EVT_IRQHandler(void)
   if (Bluefruit._mprot_event_sem)  xSemaphoreGiveFromISR(Bluefruit._mprot_event_sem, NULL);
 #endif
 
+  dbgIsrExit();
 #if CFG_SYSVIEW
   SEGGER_SYSVIEW_RecordExitISR();
 #endif
@@ -742,7 +744,7 @@ void adafruit_ble_task(void* arg)
   (void) arg;
 
   // malloc buffered is algined by 4
-  uint8_t * ev_buf = (uint8_t*) rtos_malloc(BLE_EVT_LEN_MAX(BLE_GATT_ATT_MTU_MAX));
+  uint8_t * ev_buf = (uint8_t*) rtos_malloc_tag(BLE_EVT_LEN_MAX(BLE_GATT_ATT_MTU_MAX), HEAP_TAG_BLE);
 
   while (1)
   {
@@ -761,7 +763,11 @@ void adafruit_ble_task(void* arg)
         // Handle valid event
         if( NRF_SUCCESS == err)
         {
-          Bluefruit._ble_handler( (ble_evt_t*) ev_buf );
+          ble_evt_t* evt = (ble_evt_t*) ev_buf;
+
+          SYSTRACE_START(SYSTRACE_BLE_EVT, evt->header.evt_id);
+          Bluefruit._ble_handler(evt);
+          SYSTRACE_STOP(SYSTRACE_BLE_EVT, evt->header.evt_id);
         }else if ( NRF_ERROR_NOT_FOUND != err )
         {
           LOG_LV1("BLE", "SD event error %s", dbg_err_str(err));
@@ -840,9 +846,6 @@ void AdafruitBluefruit::_ble_handler(ble_evt_t* evt)
 
       LOG_LV2("GAP", "Disconnect Reason: %s", dbg_hci_str(evt->evt.gap_evt.params.disconnected.reason));
 
-      // Turn off Conn LED If not connected at all
-      if ( !this->connected() ) _setConnLed(false);
-
       // Invoke disconnect callback
       if ( conn->getRole() == BLE_GAP_ROLE_PERIPH )
       {
@@ -851,9 +854,6 @@ void AdafruitBluefruit::_ble_handler(ble_evt_t* evt)
       {
         if ( Central._disconnect_cb ) ada_callback(NULL, 0, Central._disconnect_cb, conn_hdl, para->reason);
       }
-
-      delete _connection[conn_hdl];
-      _connection[conn_hdl] = NULL;
     }
     break;
 
@@ -881,6 +881,7 @@ void AdafruitBluefruit::_ble_handler(ble_evt_t* evt)
 
   Advertising._eventHandler(evt);
   Scanner._eventHandler(evt);
+  LinkPolicy._eventHandler(evt);
 
   /*------------- BLE Peripheral Events -------------*/
   /* Only handle Peripheral events with matched connection handle
@@ -932,6 +933,16 @@ void AdafruitBluefruit::_ble_handler(ble_evt_t* evt)
 
   // User callback if set
   if (_event_cb) _event_cb(evt);
+
+  // Connection is released last, all handlers above still use it
+  if ( evt->header.evt_id == BLE_GAP_EVT_DISCONNECTED && _connection[conn_hdl] )
+  {
+    delete _connection[conn_hdl];
+    _connection[conn_hdl] = NULL;
+
+    // Turn off Conn LED If not connected at all
+    if ( !this->connected() ) _setConnLed(false);
+  }
 }
 
 /*------------------------------------------------------------------*/
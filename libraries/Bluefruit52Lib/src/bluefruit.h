@@ -54,6 +54,7 @@
 #include "BLEClientService.h"
 #include "BLEDiscovery.h"
 #include "BLEConnection.h"
+#include "BLELinkPolicy.h"
 #include "BLEGatt.h"
 #include "BLESecurity.h"
 
@@ -62,6 +63,7 @@
 #include "services/BLEDfu.h"
 #include "services/BLEUart.h"
 #include "services/BLEBas.h"
+#include "services/BLERuntimeStats.h"
 #include "services/BLEIas.h"
 #include "services/BLEBeacon.h"
 #include "services/BLEHidGeneric.h"
@@ -78,6 +80,8 @@
 #include "clients/BLEClientBas.h"
 #include "clients/BLEClientIas.h"
 
+#include "BLEUartBridge.h"
+
 #include "utility/AdaCallback.h"
 #include "utility/bonding.h"
 
@@ -122,6 +126,8 @@ class AdafruitBluefruit
     BLEScanner         Scanner;
     BLEDiscovery       Discovery;
 
+    BLELinkPolicy      LinkPolicy;
+
     /*------------------------------------------------------------------*/
     /* SoftDevice Configure Functions, must call before begin().
      * These function affect the SRAM consumed by SoftDevice.
@@ -226,7 +226,7 @@ uint16_t BLEAncs::getAppAttribute(const char* appid, uint8_t attr, void* buffer,
 
   // command ID | App ID (including Null terminator) | Attr
   uint8_t cmdlen = 1 + strlen(appid)+1 + 1;
-  uint8_t* command = (uint8_t*) rtos_malloc( cmdlen );
+  uint8_t* command = (uint8_t*) rtos_malloc_tag(cmdlen, HEAP_TAG_BLE);
 
   command[0] = ANCS_CMD_GET_APP_ATTR;
   strcpy( (char*) command+1, appid);
@@ -84,6 +84,8 @@ class BLEClientUart : public BLEClientService, public Stream
     rx_callback_t     _rx_cb;
 
     friend void bleuart_central_notify_cb(BLEClientCharacteristic* chr, uint8_t* data, uint16_t len);
+
+    friend class BLEUartBridge;
 };
 
 #endif /* BLECLIENTUART_H_ */
@@ -0,0 +1,165 @@
+/**************************************************************************/
+/*!
+    @file     BLERuntimeStats.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "bluefruit.h"
+
+/* Runtime Stats Service : ADAF0F00-C332-42A8-93BD-25E905756CB8
+ * System             : ADAF0F01-C332-42A8-93BD-25E905756CB8
+ * Tasks              : ADAF0F02-C332-42A8-93BD-25E905756CB8
+ */
+
+const uint8_t BLERUNTIMESTATS_UUID_SERVICE[] =
+{
+    0xB8, 0x6C, 0x75, 0x05, 0xE9, 0x25, 0xBD, 0x93,
+    0xA8, 0x42, 0x32, 0xC3, 0x00, 0x0F, 0xAF, 0xAD
+};
+
+const uint8_t BLERUNTIMESTATS_UUID_CHR_SYSTEM[] =
+{
+    0xB8, 0x6C, 0x75, 0x05, 0xE9, 0x25, 0xBD, 0x93,
+    0xA8, 0x42, 0x32, 0xC3, 0x01, 0x0F, 0xAF, 0xAD
+};
+
+const uint8_t BLERUNTIMESTATS_UUID_CHR_TASKS[] =
+{
+    0xB8, 0x6C, 0x75, 0x05, 0xE9, 0x25, 0xBD, 0x93,
+    0xA8, 0x42, 0x32, 0xC3, 0x02, 0x0F, 0xAF, 0xAD
+};
+
+BLERuntimeStats::BLERuntimeStats(void) :
+  BLEService(BLERUNTIMESTATS_UUID_SERVICE), _system(BLERUNTIMESTATS_UUID_CHR_SYSTEM), _tasks(BLERUNTIMESTATS_UUID_CHR_TASKS)
+{
+  _timer = NULL;
+}
+
+err_t BLERuntimeStats::begin(void)
+{
+  // Invoke base class begin()
+  VERIFY_STATUS( BLEService::begin() );
+
+  _system.setProperties(CHR_PROPS_READ | CHR_PROPS_NOTIFY);
+  _system.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  _system.setFixedLen(sizeof(ble_runtime_sys_t));
+  VERIFY_STATUS( _system.begin() );
+
+  _tasks.setProperties(CHR_PROPS_READ | CHR_PROPS_NOTIFY);
+  _tasks.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  _tasks.setMaxLen(BLE_RUNTIME_STATS_TASKS*sizeof(ble_runtime_task_t));
+  VERIFY_STATUS( _tasks.begin() );
+
+  return ERROR_NONE;
+}
+
+bool BLERuntimeStats::update(void)
+{
+  dbg_sys_stats_t sys;
+  dbg_task_stats_t tasks[BLE_RUNTIME_STATS_TASKS];
+
+  uint8_t const count = dbgTaskStats(&sys, tasks, BLE_RUNTIME_STATS_TASKS);
+
+  ble_runtime_sys_t const sys_data =
+  {
+    .window_ms      = sys.window_us / 1000,
+    .cpu_permille   = sys.cpu_permille,
+    .idle_permille  = sys.idle_permille,
+    .sleep_permille = sys.sleep_permille,
+    .isr_permille   = sys.isr_permille,
+    .isr_count      = sys.isr_count,
+    .switches       = sys.switches
+  };
+
+  ble_runtime_task_t task_data[BLE_RUNTIME_STATS_TASKS];
+  for(uint8_t i=0; i<count; i++)
+  {
+    task_data[i].index        = i;
+    task_data[i].count        = count;
+    memcpy(task_data[i].name, tasks[i].name, sizeof(task_data[i].name));
+    task_data[i].cpu_permille = tasks[i].cpu_permille;
+    task_data[i].switches     = tasks[i].switches;
+  }
+
+  // Update values for read
+  _system.write(&sys_data, sizeof(sys_data));
+  _tasks.write(task_data, count*sizeof(ble_runtime_task_t));
+
+  // Notify each record separately so that it is never split across packets
+  bool result = true;
+  for(uint16_t c=0; c<BLE_MAX_CONNECTION; c++)
+  {
+    if ( _system.notifyEnabled(c) ) result &= _system.notify(c, &sys_data, sizeof(sys_data));
+
+    if ( _tasks.notifyEnabled(c) )
+    {
+      for(uint8_t i=0; i<count; i++)
+      {
+        result &= _tasks.notify(c, &task_data[i], sizeof(ble_runtime_task_t));
+      }
+    }
+  }
+
+  return result;
+}
+
+static void runtime_stats_update(BLERuntimeStats* svc)
+{
+  (void) svc->update();
+}
+
+void BLERuntimeStats::_timer_cb(TimerHandle_t xTimer)
+{
+  // timer task stack is too small for sampling stats
+  ada_callback(NULL, 0, runtime_stats_update, pvTimerGetTimerID(xTimer));
+}
+
+void BLERuntimeStats::setPeriod(uint32_t ms)
+{
+  if ( ms == 0 )
+  {
+    if ( _timer ) xTimerStop(_timer, 0);
+    return;
+  }
+
+  if ( _timer == NULL )
+  {
+    _timer = xTimerCreate(NULL, ms2tick(ms), true, this, _timer_cb);
+    VERIFY(_timer, );
+  }else
+  {
+    xTimerChangePeriod(_timer, ms2tick(ms), 0);
+  }
+
+  xTimerStart(_timer, 0);
+}
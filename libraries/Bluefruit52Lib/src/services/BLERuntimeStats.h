@@ -0,0 +1,99 @@
+/**************************************************************************/
+/*!
+    @file     BLERuntimeStats.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2019, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef BLERUNTIMESTATS_H_
+#define BLERUNTIMESTATS_H_
+
+#include "bluefruit_common.h"
+
+#include "BLECharacteristic.h"
+#include "BLEService.h"
+
+#define BLE_RUNTIME_STATS_TASKS   6
+
+extern const uint8_t BLERUNTIMESTATS_UUID_SERVICE[];
+extern const uint8_t BLERUNTIMESTATS_UUID_CHR_SYSTEM[];
+extern const uint8_t BLERUNTIMESTATS_UUID_CHR_TASKS[];
+
+// System characteristic, fit in a single notification with default MTU
+typedef struct ATTR_PACKED
+{
+  uint32_t window_ms;
+  uint16_t cpu_permille;
+  uint16_t idle_permille;
+  uint16_t sleep_permille;
+  uint16_t isr_permille;
+  uint32_t isr_count;
+  uint32_t switches;
+} ble_runtime_sys_t;
+
+VERIFY_STATIC(sizeof(ble_runtime_sys_t) == 20);
+
+// Tasks characteristic: one record per notification, read returns all records
+typedef struct ATTR_PACKED
+{
+  uint8_t  index;
+  uint8_t  count;
+  char     name[8];
+  uint16_t cpu_permille;
+  uint32_t switches;
+} ble_runtime_task_t;
+
+VERIFY_STATIC(sizeof(ble_runtime_task_t) == 16);
+
+class BLERuntimeStats : public BLEService
+{
+  protected:
+    BLECharacteristic _system;
+    BLECharacteristic _tasks;
+
+    TimerHandle_t _timer;
+
+    static void _timer_cb(TimerHandle_t xTimer);
+
+  public:
+    BLERuntimeStats(void);
+
+    virtual err_t begin(void);
+
+    // Sample runtime stats (see dbgTaskStats()) then write and notify characteristics
+    bool update(void);
+
+    // Periodically update from callback task, 0 to stop
+    void setPeriod(uint32_t ms);
+};
+
+#endif /* BLERUNTIMESTATS_H_ */
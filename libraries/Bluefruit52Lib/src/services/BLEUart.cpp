@@ -72,13 +72,15 @@ BLEUart::BLEUart(uint16_t fifo_depth)
   _overflow_cb   = NULL;
 
   _tx_fifo       = NULL;
+  _tx_mutex      = NULL;
   _tx_buffered   = false;
 }
 
 // Destructor
 BLEUart::~BLEUart()
 {
-  if ( _tx_fifo ) delete _tx_fifo;
+  if ( _tx_fifo  ) delete _tx_fifo;
+  if ( _tx_mutex ) vSemaphoreDelete(_tx_mutex);
 }
 
 // Callback when received new data
@@ -146,9 +148,12 @@ void BLEUart::bufferTXD(bool enable)
       _tx_fifo = new Adafruit_FIFO(1);
       _tx_fifo->begin( Bluefruit.getMaxMtu(BLE_GAP_ROLE_PERIPH) );
     }
+
+    if ( _tx_mutex == NULL ) _tx_mutex = xSemaphoreCreateMutex();
   }else
   {
     if ( _tx_fifo ) delete _tx_fifo;
+    _tx_fifo = NULL;
   }
 }
 
@@ -249,31 +254,35 @@ size_t BLEUart::write(uint16_t conn_hdl, const uint8_t *content, size_t len)
   if ( !notifyEnabled(conn_hdl) ) return 0;
 
   // notify right away if txd buffered is not enabled
-  if ( !(_tx_buffered && _tx_fifo) )
+  if ( !(_tx_buffered && _tx_fifo && _tx_mutex) )
   {
     return _txd.notify(conn_hdl, content, len) ? len : 0;
   }else
   {
+    // fifo is lock-free for a single producer only, writers can be several tasks
+    xSemaphoreTake(_tx_mutex, portMAX_DELAY);
+
+    size_t result = len;
     uint16_t written = _tx_fifo->write(content, len);
 
     // Not up to GATT MTU, notify will be sent later by TXD timer handler
-    if ( _tx_fifo->count() < (conn->getMtu() - 3) )
-    {
-      return len;
-    }
-    else
+    if ( _tx_fifo->count() >= (conn->getMtu() - 3) )
     {
       // TX fifo has enough data, send notify right away
-      VERIFY( flushTXD(conn_hdl), 0);
-
+      if ( !_flushTXD(conn_hdl) )
+      {
+        result = 0;
+      }
       // still more data left, send them all
-      if ( written < len )
+      else if ( written < len && !_txd.notify(conn_hdl, content+written, len-written) )
       {
-        VERIFY(_txd.notify(conn_hdl, content+written, len-written), written);
+        result = written;
       }
-
-      return len;
     }
+
+    xSemaphoreGive(_tx_mutex);
+
+    return result;
   }
 }
 
@@ -299,22 +308,41 @@ bool BLEUart::flushTXD (void)
 }
 
 bool BLEUart::flushTXD(uint16_t conn_hdl)
+{
+  VERIFY(_tx_fifo && _tx_mutex);
+
+  xSemaphoreTake(_tx_mutex, portMAX_DELAY);
+  bool const result = _flushTXD(conn_hdl);
+  xSemaphoreGive(_tx_mutex);
+
+  return result;
+}
+
+bool BLEUart::_flushTXD(uint16_t conn_hdl)
 {
   BLEConnection* conn = Bluefruit.Connection(conn_hdl);
   VERIFY(conn);
 
   uint16_t const gatt_mtu = conn->getMtu() - 3;
-  uint8_t* ff_data = (uint8_t*) rtos_malloc( gatt_mtu );
-  VERIFY(ff_data);
-
-  uint16_t len = _tx_fifo->read(ff_data, gatt_mtu);
-  bool result = true;
+  uint16_t const len = min(_tx_fifo->count(), gatt_mtu);
+  if ( len == 0 ) return true;
 
-  if ( len )
+  // Notify directly from fifo memory if data is contiguous, hvx copies it to SoftDevice buffer
+  void* ff_span;
+  if ( _tx_fifo->getReadSpan(&ff_span) >= len )
   {
-    result = _txd.notify(conn_hdl, ff_data, len);
+    bool const result = _txd.notify(conn_hdl, ff_span, len);
+    _tx_fifo->advanceRead(len);
+    return result;
   }
 
+  // Data wraps around fifo's end
+  uint8_t* ff_data = (uint8_t*) rtos_malloc_tag(len, HEAP_TAG_BLE);
+  VERIFY(ff_data);
+
+  _tx_fifo->read(ff_data, len);
+  bool const result = _txd.notify(conn_hdl, ff_data, len);
+
   rtos_free(ff_data);
 
   return result;
@@ -104,17 +104,22 @@ class BLEUart : public BLEService, public Stream
     uint16_t       _rx_fifo_depth;
 
     // TXD
-    Adafruit_FIFO* _tx_fifo;
-    bool           _tx_buffered; // default is false
+    Adafruit_FIFO*    _tx_fifo;
+    SemaphoreHandle_t _tx_mutex;    // Adafruit_FIFO is single producer/consumer, serialize writers and flush
+    bool              _tx_buffered; // default is false
 
     // Callbacks
     rx_callback_t           _rx_cb;
     notify_callback_t       _notify_cb;
     rx_overflow_callback_t  _overflow_cb;
 
+    bool _flushTXD(uint16_t conn_hdl); // _tx_mutex must be held
+
     // Static Method for callbacks
     static void bleuart_rxd_cb(uint16_t conn_hdl, BLECharacteristic* chr, uint8_t* data, uint16_t len);
     static void bleuart_txd_cccd_cb(uint16_t conn_hdl, BLECharacteristic* chr, uint16_t value);
+
+    friend class BLEUartBridge;
 };
 
 #endif /* BLEUART_H_ */
@@ -0,0 +1,56 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This sketch exposes the on-board flash as a USB drive. QSPI flash is used
+ * if the board has one, otherwise the InternalFS region of internal flash.
+ * Format the drive as FAT on the PC for first use.
+ *
+ * Note: drive content replaces InternalFS, don't use InternalFS together
+ * with this sketch.
+ */
+#include <FlashMSC.h>
+
+FlashMSC flash_msc;
+
+void setup()
+{
+  // Set disk vendor id, product id and revision
+  flash_msc.setID("Adafruit", "nRF52 Flash", "1.0");
+
+  // Write back cache 1 second after last write if host does not sync
+  flash_msc.setIdleFlush(1000);
+
+  bool ok = flash_msc.begin(FLASH_MSC_QSPI) || flash_msc.begin(FLASH_MSC_INTERNAL);
+
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("Flash Mass Storage Example");
+
+  if ( ok )
+  {
+    Serial.print("Disk size: ");
+    Serial.print(flash_msc.size() / 1024);
+    Serial.println(" KB");
+  }else
+  {
+    Serial.println("Failed to start Mass Storage");
+  }
+}
+
+void loop()
+{
+  // nothing to do, USB task serves the host
+  delay(1000);
+}
@@ -0,0 +1,443 @@
+/**************************************************************************/
+/*!
+    @file     FlashMSC.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2020, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "InternalFileSystem.h"
+#include "flash/flash_nrf5x.h"
+#include "ext_flash.h"
+#include "FlashMSC.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define INVALID_ADDR        0xFFFFFFFFUL
+#define SECTORS_PER_BLOCK   (FLASH_MSC_BLOCK_SIZE/FLASH_MSC_SECTOR_SIZE)
+#define ALL_SECTORS         ((uint8_t) ((1UL << SECTORS_PER_BLOCK) - 1))
+
+VERIFY_STATIC(SECTORS_PER_BLOCK <= 8);
+
+// USB callbacks have no context, only one instance is active
+static FlashMSC* _fmsc = NULL;
+
+static int32_t msc_read_cb(uint32_t lba, void* buffer, uint32_t bufsize)
+{
+  return _fmsc->_read(lba, buffer, bufsize);
+}
+
+static int32_t msc_write_cb(uint32_t lba, uint8_t* buffer, uint32_t bufsize)
+{
+  return _fmsc->_write(lba, buffer, bufsize);
+}
+
+static void msc_sync_cb(void)
+{
+  _fmsc->flush();
+}
+
+static void idle_flush_task(void)
+{
+  if ( _fmsc ) _fmsc->flush();
+}
+
+static void idle_timer_cb(TimerHandle_t xTimer)
+{
+  (void) xTimer;
+
+  // flash operation blocks, defer to callback task to keep timer task responsive
+  ada_callback(NULL, 0, idle_flush_task);
+}
+
+static inline uint32_t block_of(uint32_t addr)
+{
+  return addr & ~(FLASH_MSC_BLOCK_SIZE-1);
+}
+
+#if QSPI_FLASH_USED
+// Driver is busy until erase/program is complete on flash
+static void qspi_wait(uint32_t ms)
+{
+  while ( nrfx_qspi_mem_busy_check() != NRFX_SUCCESS )
+  {
+    if ( ms ) delay(ms);
+    else yield();
+  }
+}
+#endif
+
+FlashMSC::FlashMSC(void)
+{
+  _type    = FLASH_MSC_INTERNAL;
+  _addr    = 0;
+  _size    = 0;
+
+  varclr(_cache);
+  _age     = 0;
+
+  _ra_buf  = NULL;
+  _ra_addr = INVALID_ADDR;
+
+  _idle_ms = FLASH_MSC_IDLE_FLUSH_MS;
+  _timer   = NULL;
+  _mutex   = NULL;
+
+  _msc.setID("Adafruit", "Flash", "1.0");
+}
+
+void FlashMSC::setID(const char* vendor_id, const char* product_id, const char* product_rev)
+{
+  _msc.setID(vendor_id, product_id, product_rev);
+}
+
+void FlashMSC::setIdleFlush(uint32_t ms)
+{
+  _idle_ms = ms;
+
+  if ( _timer )
+  {
+    if ( ms ) xTimerChangePeriod(_timer, ms2tick(ms), 0);
+    xTimerStop(_timer, 0);
+  }
+}
+
+bool FlashMSC::begin(uint8_t type)
+{
+  if ( type == FLASH_MSC_INTERNAL ) return begin(type, LFS_FLASH_ADDR, LFS_FLASH_TOTAL_SIZE);
+
+#if QSPI_FLASH_USED
+  if ( type == FLASH_MSC_QSPI ) return begin(type, 0, getExtFlashSize());
+#endif
+
+  return false;
+}
+
+bool FlashMSC::begin(uint8_t type, uint32_t addr, uint32_t size)
+{
+  VERIFY(_fmsc == NULL);
+  VERIFY(size && !(addr & (FLASH_MSC_BLOCK_SIZE-1)) && !(size & (FLASH_MSC_BLOCK_SIZE-1)));
+
+  if ( type == FLASH_MSC_INTERNAL )
+  {
+    VERIFY(addr >= LFS_FLASH_ADDR && addr + size <= LFS_FLASH_ADDR + LFS_FLASH_TOTAL_SIZE);
+
+    // write back pending data of InternalFS before exposing its region
+    flash_nrf5x_flush();
+  }
+#if QSPI_FLASH_USED
+  else if ( type == FLASH_MSC_QSPI )
+  {
+    VERIFY(addr + size <= getExtFlashSize());
+  }
+#endif
+  else
+  {
+    return false;
+  }
+
+  _type = type;
+  _addr = addr;
+  _size = size;
+
+  // cache blocks and read ahead block in one allocation
+  uint8_t* mem = (uint8_t*) rtos_malloc((FLASH_MSC_CACHE_COUNT+1)*FLASH_MSC_BLOCK_SIZE);
+  VERIFY(mem);
+
+  for(uint8_t i=0; i<FLASH_MSC_CACHE_COUNT; i++)
+  {
+    _cache[i].addr = INVALID_ADDR;
+    _cache[i].buf  = mem + i*FLASH_MSC_BLOCK_SIZE;
+  }
+
+  _ra_buf  = mem + FLASH_MSC_CACHE_COUNT*FLASH_MSC_BLOCK_SIZE;
+  _ra_addr = INVALID_ADDR;
+
+  _mutex = xSemaphoreCreateMutex();
+  _timer = xTimerCreate(NULL, ms2tick(_idle_ms ? _idle_ms : FLASH_MSC_IDLE_FLUSH_MS), false, NULL, idle_timer_cb);
+
+  _fmsc = this;
+
+  _msc.setCapacity(size/FLASH_MSC_SECTOR_SIZE, FLASH_MSC_SECTOR_SIZE);
+  _msc.setReadWriteCallback(msc_read_cb, msc_write_cb, NULL);
+  _msc.setSyncCallback(msc_sync_cb);
+  _msc.setUnitReady(true);
+
+  return _msc.begin();
+}
+
+void FlashMSC::flush(void)
+{
+  if ( !_mutex ) return;
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  (void) _flush();
+  xSemaphoreGive(_mutex);
+}
+
+//--------------------------------------------------------------------+
+// Flash Abstraction Layer
+//--------------------------------------------------------------------+
+bool FlashMSC::_flash_erase(uint32_t addr)
+{
+#if QSPI_FLASH_USED
+  if ( _type == FLASH_MSC_QSPI )
+  {
+    qspi_wait(0);
+    VERIFY(erase4kBSectorExtFlash(addr));
+    qspi_wait(1);
+    return true;
+  }
+#endif
+
+  return flash_nrf5x_erase(addr);
+}
+
+bool FlashMSC::_flash_program(uint32_t addr, void const* buf)
+{
+#if QSPI_FLASH_USED
+  if ( _type == FLASH_MSC_QSPI )
+  {
+    qspi_wait(0);
+    VERIFY(writeExtFlash((void*) buf, FLASH_MSC_BLOCK_SIZE, addr));
+    qspi_wait(1);
+    return true;
+  }
+#endif
+
+  return flash_nrf5x_program_page(addr, buf);
+}
+
+bool FlashMSC::_flash_read(void* buf, uint32_t addr, uint32_t len)
+{
+#if QSPI_FLASH_USED
+  if ( _type == FLASH_MSC_QSPI )
+  {
+    qspi_wait(0);
+    VERIFY(readExtFlash(buf, len, addr));
+    qspi_wait(0);
+    return true;
+  }
+#endif
+
+  memcpy(buf, (void const*) addr, len);
+  return true;
+}
+
+// Internal flash is memory mapped, skip erase & program if content matches
+bool FlashMSC::_flash_verify(uint32_t addr, void const* buf)
+{
+  return (_type == FLASH_MSC_INTERNAL) && (0 == memcmp((void const*) addr, buf, FLASH_MSC_BLOCK_SIZE));
+}
+
+//--------------------------------------------------------------------+
+// Cache
+//--------------------------------------------------------------------+
+FlashMSC::cache_t* FlashMSC::_find(uint32_t addr)
+{
+  for(uint8_t i=0; i<FLASH_MSC_CACHE_COUNT; i++)
+  {
+    if ( _cache[i].addr == addr ) return &_cache[i];
+  }
+
+  return NULL;
+}
+
+// Get a cache block for addr, least recently used one is written back if needed
+FlashMSC::cache_t* FlashMSC::_alloc(uint32_t addr)
+{
+  cache_t* c = &_cache[0];
+
+  for(uint8_t i=0; i<FLASH_MSC_CACHE_COUNT; i++)
+  {
+    if ( _cache[i].addr == INVALID_ADDR )
+    {
+      c = &_cache[i];
+      break;
+    }
+
+    if ( _cache[i].age < c->age ) c = &_cache[i];
+  }
+
+  VERIFY(_writeback(c), NULL);
+
+  c->addr  = addr;
+  c->valid = 0;
+  c->dirty = 0;
+
+  return c;
+}
+
+bool FlashMSC::_writeback(cache_t* c)
+{
+  if ( c->addr == INVALID_ADDR ) return true;
+
+  if ( c->dirty )
+  {
+    // fill sectors not written by host with current content
+    for(uint8_t s=0; s<SECTORS_PER_BLOCK; s++)
+    {
+      if ( c->valid & bit(s) ) continue;
+      VERIFY( _flash_read(c->buf + s*FLASH_MSC_SECTOR_SIZE, c->addr + s*FLASH_MSC_SECTOR_SIZE, FLASH_MSC_SECTOR_SIZE) );
+    }
+
+    if ( !_flash_verify(c->addr, c->buf) )
+    {
+      ledOn(LED_BUILTIN);
+
+      bool const ok = _flash_erase(c->addr) && _flash_program(c->addr, c->buf);
+
+      ledOff(LED_BUILTIN);
+      VERIFY(ok);
+    }
+  }
+
+  c->addr  = INVALID_ADDR;
+  c->valid = 0;
+  c->dirty = 0;
+
+  return true;
+}
+
+bool FlashMSC::_flush(void)
+{
+  bool ok = true;
+
+  for(uint8_t i=0; i<FLASH_MSC_CACHE_COUNT; i++)
+  {
+    if ( !_writeback(&_cache[i]) ) ok = false;
+  }
+
+  return ok;
+}
+
+//--------------------------------------------------------------------+
+// MSC callbacks
+//--------------------------------------------------------------------+
+int32_t FlashMSC::_read(uint32_t lba, void* buffer, uint32_t bufsize)
+{
+  uint32_t addr = _addr + lba*FLASH_MSC_SECTOR_SIZE;
+  VERIFY(addr + bufsize <= _addr + _size, -1);
+
+  uint8_t* dst = (uint8_t*) buffer;
+  int32_t  ret = (int32_t) bufsize;
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+
+  for(uint32_t count = 0; count < bufsize; count += FLASH_MSC_SECTOR_SIZE)
+  {
+    uint32_t const blk    = block_of(addr);
+    uint32_t const offset = addr - blk;
+
+    cache_t* c = _find(blk);
+
+    if ( c && (c->valid & bit(offset/FLASH_MSC_SECTOR_SIZE)) )
+    {
+      memcpy(dst, c->buf + offset, FLASH_MSC_SECTOR_SIZE);
+    }
+    else
+    {
+      // Host reads sequentially, fetch the rest of erase block ahead
+      if ( _ra_addr != blk )
+      {
+        _ra_addr = INVALID_ADDR;
+        if ( !_flash_read(_ra_buf, blk, FLASH_MSC_BLOCK_SIZE) )
+        {
+          ret = -1;
+          break;
+        }
+        _ra_addr = blk;
+      }
+
+      memcpy(dst, _ra_buf + offset, FLASH_MSC_SECTOR_SIZE);
+    }
+
+    dst  += FLASH_MSC_SECTOR_SIZE;
+    addr += FLASH_MSC_SECTOR_SIZE;
+  }
+
+  xSemaphoreGive(_mutex);
+
+  return ret;
+}
+
+int32_t FlashMSC::_write(uint32_t lba, uint8_t const* buffer, uint32_t bufsize)
+{
+  uint32_t addr = _addr + lba*FLASH_MSC_SECTOR_SIZE;
+  VERIFY(addr + bufsize <= _addr + _size, -1);
+
+  int32_t ret = (int32_t) bufsize;
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+
+  for(uint32_t count = 0; count < bufsize; count += FLASH_MSC_SECTOR_SIZE)
+  {
+    uint32_t const blk    = block_of(addr);
+    uint32_t const offset = addr - blk;
+    uint8_t  const sector = bit(offset/FLASH_MSC_SECTOR_SIZE);
+
+    cache_t* c = _find(blk);
+    if ( !c ) c = _alloc(blk);
+    if ( !c )
+    {
+      ret = -1;
+      break;
+    }
+
+    memcpy(c->buf + offset, buffer, FLASH_MSC_SECTOR_SIZE);
+    c->valid |= sector;
+    c->dirty |= sector;
+    c->age    = ++_age;
+
+    if ( _ra_addr == blk ) _ra_addr = INVALID_ADDR;
+
+    // Sequential sectors completed the block: program it as a whole now
+    if ( c->valid == ALL_SECTORS && offset == FLASH_MSC_BLOCK_SIZE - FLASH_MSC_SECTOR_SIZE )
+    {
+      if ( !_writeback(c) )
+      {
+        ret = -1;
+        break;
+      }
+    }
+
+    buffer += FLASH_MSC_SECTOR_SIZE;
+    addr   += FLASH_MSC_SECTOR_SIZE;
+  }
+
+  xSemaphoreGive(_mutex);
+
+  // Host may never sync (e.g Windows), write back once it is idle
+  if ( _idle_ms ) xTimerReset(_timer, 0);
+
+  return ret;
+}
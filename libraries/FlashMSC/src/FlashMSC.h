@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*!
+    @file     FlashMSC.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2020, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef FLASHMSC_H_
+#define FLASHMSC_H_
+
+#include "Arduino.h"
+#include "Adafruit_TinyUSB.h"
+
+#define FLASH_MSC_SECTOR_SIZE     512
+#define FLASH_MSC_BLOCK_SIZE      4096  // erase block of both internal and QSPI flash
+
+// Number of erase blocks held by write-back cache
+#ifndef FLASH_MSC_CACHE_COUNT
+#define FLASH_MSC_CACHE_COUNT     2
+#endif
+
+#define FLASH_MSC_IDLE_FLUSH_MS   500
+
+enum
+{
+  FLASH_MSC_INTERNAL = 0, // InternalFS region of internal flash
+  FLASH_MSC_QSPI,         // external QSPI flash
+};
+
+/* Mass Storage backend for internal and QSPI flash.
+ * Sectors written by host are gathered per erase block in a write-back cache,
+ * a block fully written by sequential sectors is programmed at once without
+ * reading it back. Reads fetch the whole erase block ahead. Cache is written
+ * back on SCSI SYNCHRONIZE CACHE, eject, flush() or when host is idle.
+ *
+ * Note: host formats the disk as FAT, filesystem in the region (e.g InternalFS)
+ * must not be used at the same time.
+ */
+class FlashMSC
+{
+  public:
+    FlashMSC(void);
+
+    bool begin(uint8_t type);
+
+    // Expose part of flash, addr and size must be multiple of erase block
+    bool begin(uint8_t type, uint32_t addr, uint32_t size);
+
+    // Set before begin(), string up to 8, 16, 4 characters respectively
+    void setID(const char* vendor_id, const char* product_id, const char* product_rev);
+
+    // Write back cache after host is idle for ms, 0 to disable
+    void setIdleFlush(uint32_t ms);
+
+    void flush(void);
+
+    uint32_t size(void) { return _size; }
+
+    /*------------------------------------------------------------------*/
+    /* INTERNAL USAGE ONLY
+     *------------------------------------------------------------------*/
+    int32_t _read(uint32_t lba, void* buffer, uint32_t bufsize);
+    int32_t _write(uint32_t lba, uint8_t const* buffer, uint32_t bufsize);
+
+  private:
+    typedef struct
+    {
+      uint32_t addr;
+      uint32_t age;
+      uint8_t  valid; // sectors holding data, bit per sector
+      uint8_t  dirty; // sectors written by host
+      uint8_t* buf;
+    } cache_t;
+
+    Adafruit_USBD_MSC _msc;
+
+    uint8_t  _type;
+    uint32_t _addr;
+    uint32_t _size;
+
+    cache_t  _cache[FLASH_MSC_CACHE_COUNT];
+    uint32_t _age;
+
+    uint8_t* _ra_buf;
+    uint32_t _ra_addr;
+
+    uint32_t _idle_ms;
+    TimerHandle_t _timer;
+    SemaphoreHandle_t _mutex;
+
+    bool _flash_erase(uint32_t addr);
+    bool _flash_program(uint32_t addr, void const* buf);
+    bool _flash_read(void* buf, uint32_t addr, uint32_t len);
+    bool _flash_verify(uint32_t addr, void const* buf);
+
+    cache_t* _find(uint32_t addr);
+    cache_t* _alloc(uint32_t addr);
+    bool _writeback(cache_t* c);
+    bool _flush(void);
+};
+
+#endif /* FLASHMSC_H_ */
@@ -0,0 +1,86 @@
+/*********************************************************************
+ This is an example for our nRF52 based Bluefruit LE modules
+
+ Pick one up today in the adafruit shop!
+
+ Adafruit invests time and resources providing this open source code,
+ please support Adafruit and open-source hardware by purchasing
+ products from Adafruit!
+
+ MIT license, check LICENSE for more information
+ All text above, and the splash screen below must be included in
+ any redistribution
+*********************************************************************/
+
+/* This sketch plays a 440 Hz sine tone on an I2S DAC/amplifier such as
+ * MAX98357A. Samples are generated by the transmit callback invoked from
+ * I2S interrupt whenever EasyDMA releases a buffer, loop() is free to do
+ * other work.
+ */
+#include <I2S.h>
+
+#define PIN_I2S_SCK     A0
+#define PIN_I2S_LRCK    A1
+#define PIN_I2S_SDOUT   A2
+
+#define SAMPLE_RATE     48000
+#define TONE_FREQ       440
+#define AMPLITUDE       8000
+
+// quarter is enough but full table keeps the callback simple
+#define SINE_TABLE_SIZE 256
+int16_t sine_table[SINE_TABLE_SIZE];
+
+// 32-bit phase accumulator, top 8 bits index the table
+volatile uint32_t phase = 0;
+uint32_t phase_inc;
+
+// Called in ISR: fill buffer with stereo 16-bit samples
+void fill_buffer(void* buffer, uint32_t bytes)
+{
+  uint32_t* frame = (uint32_t*) buffer;
+  uint32_t const count = bytes / 4;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint16_t const sample = (uint16_t) sine_table[phase >> 24];
+    frame[i] = (((uint32_t) sample) << 16) | sample; // right | left
+    phase += phase_inc;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while ( !Serial ) delay(10);   // for nrf52840 with native usb
+
+  Serial.println("I2S Sine Tone Example");
+
+  for (int i = 0; i < SINE_TABLE_SIZE; i++)
+  {
+    sine_table[i] = (int16_t) (AMPLITUDE * sin(2 * PI * i / SINE_TABLE_SIZE));
+  }
+
+  I2S.setPins(PIN_I2S_SCK, PIN_I2S_LRCK, PIN_I2S_SDOUT);
+  I2S.onTransmit(fill_buffer);
+
+  if ( !I2S.begin(SAMPLE_RATE, 16, 2) )
+  {
+    Serial.println("Failed to start I2S!");
+    while(1) yield();
+  }
+
+  // rate actually achieved by MCK divider and ratio
+  phase_inc = (uint32_t) ((((uint64_t) TONE_FREQ) << 32) / I2S.sampleRate());
+
+  Serial.print("Sample rate: ");
+  Serial.println(I2S.sampleRate());
+}
+
+void loop()
+{
+  Serial.print("Underruns: ");
+  Serial.println(I2S.underruns());
+
+  delay(1000);
+}
@@ -0,0 +1,586 @@
+/**************************************************************************/
+/*!
+    @file     I2S.cpp
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2020, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#include "I2S.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+#define I2S_IRQ_PRIORITY   6
+#define NO_BUF             0xff
+
+static const struct
+{
+  uint32_t reg;
+  uint8_t  div;
+} _mck_tbl[] =
+{
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV8  , 8   },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV10 , 10  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV11 , 11  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV15 , 15  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV16 , 16  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV21 , 21  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV23 , 23  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV30 , 30  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV31 , 31  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV32 , 32  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV42 , 42  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV63 , 63  },
+  { I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV125, 125 },
+};
+
+// indexed by I2S_CONFIG_RATIO_RATIO_*
+static const uint16_t _ratio_tbl[] = { 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+I2SClass I2S;
+
+extern "C"
+{
+  void I2S_IRQHandler(void)
+  {
+    I2S._irq_handler();
+  }
+}
+
+static void hfclk_request(void)
+{
+  // MCK is derived from HFCLK, crystal is needed for accurate sample rate
+  uint8_t sd_en = 0;
+  sd_softdevice_is_enabled(&sd_en);
+
+  if (sd_en)
+  {
+    uint32_t is_running = 0;
+    sd_clock_hfclk_is_running(&is_running);
+
+    if (!is_running)
+    {
+      sd_clock_hfclk_request();
+
+      while(!is_running)
+      {
+        yield();
+        sd_clock_hfclk_is_running(&is_running);
+      }
+    }
+  }
+  else
+  {
+    if (NRF_CLOCK->EVENTS_HFCLKSTARTED == 0)
+    {
+      NRF_CLOCK->TASKS_HFCLKSTART = 1;
+      while (NRF_CLOCK->EVENTS_HFCLKSTARTED == 0) yield();
+    }
+  }
+}
+
+static uint32_t pin_psel(int pin)
+{
+  return (pin < 0) ? 0xFFFFFFFFUL : g_ADigitalPinMap[pin];
+}
+
+I2SClass::I2SClass(void)
+{
+  _sck = _lrck = _sdout = _sdin = _mck = -1;
+
+  _words   = I2S_BUFFER_WORDS_DFLT;
+  _count   = I2S_BUFFER_COUNT_DFLT;
+  _bytes   = 4*_words;
+
+  _format  = I2S_CONFIG_FORMAT_FORMAT_I2S;
+  _align   = I2S_CONFIG_ALIGN_ALIGN_Left;
+  _mckfreq = 0;
+  _ratio   = 0;
+
+  _sample_rate = 0;
+
+  _tx_cb = NULL;
+  _rx_cb = NULL;
+
+  varclr(&_tx);
+  varclr(&_rx);
+}
+
+void I2SClass::setPins(int sck, int lrck, int sdout, int sdin, int mck)
+{
+  _sck   = sck;
+  _lrck  = lrck;
+  _sdout = sdout;
+  _sdin  = sdin;
+  _mck   = mck;
+}
+
+bool I2SClass::setBufferSize(uint16_t words, uint8_t count)
+{
+  VERIFY(!NRF_I2S->ENABLE);
+  VERIFY(words && count >= 2 && count < NO_BUF);
+
+  _words = words;
+  _count = count;
+  _bytes = 4*words;
+
+  return true;
+}
+
+void I2SClass::setFormat(uint8_t format, uint8_t align)
+{
+  _format = format;
+  _align  = align;
+}
+
+void I2SClass::setClock(uint32_t mckfreq, uint8_t ratio)
+{
+  _mckfreq = mckfreq;
+  _ratio   = ratio;
+}
+
+void I2SClass::onTransmit(tx_callback_t fp)
+{
+  _tx_cb = fp;
+}
+
+void I2SClass::onReceive(rx_callback_t fp)
+{
+  _rx_cb = fp;
+}
+
+bool I2SClass::begin(uint32_t sample_rate, uint8_t bits, uint8_t channels, bool master)
+{
+  VERIFY(bits == 8 || bits == 16 || bits == 24);
+  VERIFY(channels == 1 || channels == 2);
+  VERIFY(_sck >= 0 && _lrck >= 0 && (_sdout >= 0 || _sdin >= 0));
+
+  end();
+
+  bool const tx = (_sdout >= 0);
+  bool const rx = (_sdin >= 0);
+
+  // Stream needs a buffer for sketch besides the two held by EasyDMA
+  VERIFY( (!tx || _tx_cb || _count >= 3) && (!rx || _rx_cb || _count >= 3) );
+
+  //------------- Clock -------------//
+  uint32_t mckfreq = _mckfreq;
+  uint8_t  ratio   = _ratio;
+  _sample_rate = sample_rate;
+
+  if ( master )
+  {
+    if ( !mckfreq )
+    {
+      // closest rate, ratio must be a multiple of frame size
+      uint32_t best_err = UINT32_MAX;
+      for(uint8_t m=0; m<arrcount(_mck_tbl); m++)
+      {
+        for(uint8_t r=0; r<arrcount(_ratio_tbl); r++)
+        {
+          if ( _ratio_tbl[r] % (2*bits) ) continue;
+
+          uint32_t const rate = 32000000UL / _mck_tbl[m].div / _ratio_tbl[r];
+          uint32_t const err  = (rate > sample_rate) ? (rate - sample_rate) : (sample_rate - rate);
+          if ( err < best_err )
+          {
+            best_err = err;
+            mckfreq  = _mck_tbl[m].reg;
+            ratio    = r;
+          }
+        }
+      }
+    }
+
+    for(uint8_t m=0; m<arrcount(_mck_tbl); m++)
+    {
+      if ( _mck_tbl[m].reg == mckfreq ) _sample_rate = 32000000UL / _mck_tbl[m].div / _ratio_tbl[ratio];
+    }
+
+    hfclk_request();
+  }
+
+  //------------- Buffers -------------//
+  // TX has an extra zeroed buffer played as silence on underrun
+  if ( tx ) _tx.buf = (uint32_t*) rtos_malloc(_bytes*(_count+1));
+  if ( rx ) _rx.buf = (uint32_t*) rtos_malloc(_bytes*_count);
+
+  if ( (tx && !_tx.buf) || (rx && !_rx.buf) )
+  {
+    end();
+    return false;
+  }
+
+  if ( tx ) memclr(_buf_ptr(&_tx, _count), _bytes);
+
+  //------------- Pins -------------//
+  uint32_t const clk_dir = master ? OUTPUT : INPUT;
+  pinMode(_sck , clk_dir);
+  pinMode(_lrck, clk_dir);
+  if ( _mck  >= 0 ) pinMode(_mck, OUTPUT);
+  if ( tx ) pinMode(_sdout, OUTPUT);
+  if ( rx ) pinMode(_sdin , INPUT);
+
+  NRF_I2S->PSEL.MCK   = pin_psel(_mck);
+  NRF_I2S->PSEL.SCK   = pin_psel(_sck);
+  NRF_I2S->PSEL.LRCK  = pin_psel(_lrck);
+  NRF_I2S->PSEL.SDOUT = pin_psel(_sdout);
+  NRF_I2S->PSEL.SDIN  = pin_psel(_sdin);
+
+  //------------- Config -------------//
+  NRF_I2S->CONFIG.MODE     = master ? I2S_CONFIG_MODE_MODE_Master : I2S_CONFIG_MODE_MODE_Slave;
+  NRF_I2S->CONFIG.TXEN     = tx ? I2S_CONFIG_TXEN_TXEN_Enabled : I2S_CONFIG_TXEN_TXEN_Disabled;
+  NRF_I2S->CONFIG.RXEN     = rx ? I2S_CONFIG_RXEN_RXEN_Enabled : I2S_CONFIG_RXEN_RXEN_Disabled;
+  NRF_I2S->CONFIG.MCKEN    = (master || _mck >= 0) ? I2S_CONFIG_MCKEN_MCKEN_Enabled : I2S_CONFIG_MCKEN_MCKEN_Disabled;
+  if ( mckfreq ) NRF_I2S->CONFIG.MCKFREQ = mckfreq;
+  NRF_I2S->CONFIG.RATIO    = ratio;
+  NRF_I2S->CONFIG.SWIDTH   = (bits == 8) ? I2S_CONFIG_SWIDTH_SWIDTH_8Bit :
+                             (bits == 16) ? I2S_CONFIG_SWIDTH_SWIDTH_16Bit : I2S_CONFIG_SWIDTH_SWIDTH_24Bit;
+  NRF_I2S->CONFIG.ALIGN    = _align;
+  NRF_I2S->CONFIG.FORMAT   = _format;
+  NRF_I2S->CONFIG.CHANNELS = (channels == 2) ? I2S_CONFIG_CHANNELS_CHANNELS_Stereo : I2S_CONFIG_CHANNELS_CHANNELS_Left;
+
+  NRF_I2S->RXTXD.MAXCNT = _words;
+
+  //------------- First buffers -------------//
+  uint32_t inten = 0;
+
+  if ( tx )
+  {
+    _tx.head = _tx.ready = 0;
+    _tx.pos = _tx.xruns = 0;
+    _tx.dma[0] = NO_BUF;
+
+    if ( _tx_cb )
+    {
+      _tx_cb(_buf_ptr(&_tx, 0), _bytes);
+      _tx.dma[1] = 0;
+    }else
+    {
+      _tx.dma[1] = NO_BUF;
+    }
+
+    NRF_I2S->TXD.PTR = (uint32_t) _buf_ptr(&_tx, _tx.dma[1] == NO_BUF ? _count : 0);
+    NRF_I2S->EVENTS_TXPTRUPD = 0;
+    inten |= I2S_INTENSET_TXPTRUPD_Msk;
+  }
+
+  if ( rx )
+  {
+    _rx.head = _rx.ready = 0;
+    _rx.pos = _rx.xruns = 0;
+    _rx.dma[0] = NO_BUF;
+    _rx.dma[1] = 0;
+
+    NRF_I2S->RXD.PTR = (uint32_t) _buf_ptr(&_rx, 0);
+    NRF_I2S->EVENTS_RXPTRUPD = 0;
+    inten |= I2S_INTENSET_RXPTRUPD_Msk;
+  }
+
+  NRF_I2S->EVENTS_STOPPED = 0;
+  NRF_I2S->INTENSET = inten;
+
+  NVIC_SetPriority(I2S_IRQn, I2S_IRQ_PRIORITY);
+  NVIC_ClearPendingIRQ(I2S_IRQn);
+  NVIC_EnableIRQ(I2S_IRQn);
+
+  NRF_I2S->ENABLE = 1;
+  NRF_I2S->TASKS_START = 1;
+
+  return true;
+}
+
+void I2SClass::end(void)
+{
+  if ( NRF_I2S->ENABLE )
+  {
+    NRF_I2S->TASKS_STOP = 1;
+
+    uint32_t const start_ms = millis();
+    while ( !NRF_I2S->EVENTS_STOPPED && (millis() - start_ms) < 10 ) yield();
+    NRF_I2S->EVENTS_STOPPED = 0;
+
+    NRF_I2S->ENABLE = 0;
+  }
+
+  NVIC_DisableIRQ(I2S_IRQn);
+  NRF_I2S->INTENCLR = 0xFFFFFFFFUL;
+
+  // Don't disable high frequency oscillator since it could be in use by RADIO
+
+  NRF_I2S->PSEL.MCK   = 0xFFFFFFFFUL;
+  NRF_I2S->PSEL.SCK   = 0xFFFFFFFFUL;
+  NRF_I2S->PSEL.LRCK  = 0xFFFFFFFFUL;
+  NRF_I2S->PSEL.SDOUT = 0xFFFFFFFFUL;
+  NRF_I2S->PSEL.SDIN  = 0xFFFFFFFFUL;
+
+  rtos_free(_tx.buf);
+  rtos_free(_rx.buf);
+
+  uint32_t const tx_xruns = _tx.xruns;
+  uint32_t const rx_xruns = _rx.xruns;
+
+  varclr(&_tx);
+  varclr(&_rx);
+
+  // keep counters for inspection after end()
+  _tx.xruns = tx_xruns;
+  _rx.xruns = rx_xruns;
+}
+
+//--------------------------------------------------------------------+
+// Stream API
+//--------------------------------------------------------------------+
+int I2SClass::available(void)
+{
+  NVIC_DisableIRQ(I2S_IRQn);
+  int const count = _rx.ready ? (_rx.ready*_bytes - _rx.pos) : 0;
+  NVIC_EnableIRQ(I2S_IRQn);
+
+  return count;
+}
+
+size_t I2SClass::read(void* buffer, size_t size)
+{
+  if ( !_rx.buf || _rx_cb ) return 0;
+
+  uint8_t* dst = (uint8_t*) buffer;
+  size_t count = 0;
+
+  while ( count < size )
+  {
+    NVIC_DisableIRQ(I2S_IRQn);
+
+    if ( !_rx.ready )
+    {
+      NVIC_EnableIRQ(I2S_IRQn);
+      break;
+    }
+
+    uint32_t const n = minof((uint32_t) (size - count), _bytes - _rx.pos);
+    memcpy(dst + count, ((uint8_t*) _buf_ptr(&_rx, _rx.head)) + _rx.pos, n);
+    count   += n;
+    _rx.pos += n;
+
+    if ( _rx.pos == _bytes )
+    {
+      _rx.pos  = 0;
+      _rx.head = (_rx.head + 1) % _count;
+      _rx.ready--;
+    }
+
+    NVIC_EnableIRQ(I2S_IRQn);
+  }
+
+  return count;
+}
+
+int I2SClass::read(void)
+{
+  uint8_t ch;
+  return read(&ch, 1) ? (int) ch : -1;
+}
+
+int I2SClass::peek(void)
+{
+  int ch = -1;
+
+  NVIC_DisableIRQ(I2S_IRQn);
+  if ( _rx.ready ) ch = ((uint8_t*) _buf_ptr(&_rx, _rx.head))[_rx.pos];
+  NVIC_EnableIRQ(I2S_IRQn);
+
+  return ch;
+}
+
+int I2SClass::availableForWrite(void)
+{
+  if ( !_tx.buf || _tx_cb ) return 0;
+
+  NVIC_DisableIRQ(I2S_IRQn);
+  int const free_buf = _count - _tx.ready - _held(&_tx);
+  NVIC_EnableIRQ(I2S_IRQn);
+
+  return (free_buf > 0) ? (free_buf*_bytes - _tx.pos) : 0;
+}
+
+size_t I2SClass::write(const uint8_t *buffer, size_t size)
+{
+  if ( !_tx.buf || _tx_cb ) return 0;
+
+  size_t count = 0;
+
+  while ( count < size )
+  {
+    NVIC_DisableIRQ(I2S_IRQn);
+
+    if ( _tx.ready + _held(&_tx) >= _count )
+    {
+      NVIC_EnableIRQ(I2S_IRQn);
+
+      // wait for EasyDMA to release a buffer
+      if ( isInISR() ) break;
+      yield();
+      continue;
+    }
+
+    uint8_t const idx = (_tx.head + _tx.ready) % _count;
+    uint32_t const n = minof((uint32_t) (size - count), _bytes - _tx.pos);
+    memcpy(((uint8_t*) _buf_ptr(&_tx, idx)) + _tx.pos, buffer + count, n);
+    count   += n;
+    _tx.pos += n;
+
+    if ( _tx.pos == _bytes )
+    {
+      _tx.pos = 0;
+      _tx.ready++;
+    }
+
+    NVIC_EnableIRQ(I2S_IRQn);
+  }
+
+  return count;
+}
+
+size_t I2SClass::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+void I2SClass::flush(void)
+{
+  if ( !_tx.buf || _tx_cb ) return;
+
+  // pad partial buffer with silence
+  if ( _tx.pos )
+  {
+    uint8_t zero[32] = { 0 };
+    while ( _tx.pos ) write(zero, minof((uint32_t) sizeof(zero), _bytes - _tx.pos));
+  }
+
+  while ( _tx.ready || _held(&_tx) ) yield();
+}
+
+//--------------------------------------------------------------------+
+// Interrupt
+//--------------------------------------------------------------------+
+uint32_t* I2SClass::_buf_ptr(ring_t* r, uint8_t idx)
+{
+  return r->buf + idx*_words;
+}
+
+uint8_t I2SClass::_held(ring_t const* r)
+{
+  return (r->dma[0] != NO_BUF) + (r->dma[1] != NO_BUF);
+}
+
+// TXD.PTR is latched: next buffer is in transfer, previous one is sent
+void I2SClass::_tx_update(void)
+{
+  ring_t* r = &_tx;
+  uint8_t next = NO_BUF;
+
+  r->dma[0] = r->dma[1];
+
+  if ( _tx_cb )
+  {
+    next = (r->dma[0] == 0) ? 1 : 0;
+    _tx_cb(_buf_ptr(r, next), _bytes);
+  }
+  else if ( r->ready )
+  {
+    next = r->head;
+    r->head = (r->head + 1) % _count;
+    r->ready--;
+  }
+  else if ( r->dma[0] != NO_BUF )
+  {
+    // gap in stream
+    r->xruns++;
+  }
+
+  r->dma[1] = next;
+  NRF_I2S->TXD.PTR = (uint32_t) _buf_ptr(r, (next == NO_BUF) ? _count : next);
+}
+
+// RXD.PTR is latched: next buffer is receiving, previous one is complete
+void I2SClass::_rx_update(void)
+{
+  ring_t* r = &_rx;
+  uint8_t const done = r->dma[0];
+  uint8_t next;
+
+  r->dma[0] = r->dma[1];
+
+  if ( _rx_cb )
+  {
+    if ( done != NO_BUF ) _rx_cb(_buf_ptr(r, done), _bytes);
+    next = (done != NO_BUF) ? done : ((r->dma[0] == 0) ? 1 : 0);
+  }
+  else
+  {
+    // buffers are received in ring order
+    if ( done != NO_BUF ) r->ready++;
+
+    uint8_t const held = (r->dma[0] != NO_BUF);
+    if ( r->ready + held >= _count )
+    {
+      // no free buffer: drop oldest one
+      r->head = (r->head + 1) % _count;
+      r->ready--;
+      r->pos = 0;
+      r->xruns++;
+    }
+
+    next = (r->head + r->ready + held) % _count;
+  }
+
+  r->dma[1] = next;
+  NRF_I2S->RXD.PTR = (uint32_t) _buf_ptr(r, next);
+}
+
+void I2SClass::_irq_handler(void)
+{
+  if ( NRF_I2S->EVENTS_TXPTRUPD )
+  {
+    NRF_I2S->EVENTS_TXPTRUPD = 0;
+    if ( _tx.buf ) _tx_update();
+  }
+
+  if ( NRF_I2S->EVENTS_RXPTRUPD )
+  {
+    NRF_I2S->EVENTS_RXPTRUPD = 0;
+    if ( _rx.buf ) _rx_update();
+  }
+
+  // read back to make sure event is cleared before exit
+  (void) NRF_I2S->EVENTS_RXPTRUPD;
+}
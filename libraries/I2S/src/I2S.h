@@ -0,0 +1,146 @@
+/**************************************************************************/
+/*!
+    @file     I2S.h
+    @author   hathach (tinyusb.org)
+
+    @section LICENSE
+
+    Software License Agreement (BSD License)
+
+    Copyright (c) 2020, Adafruit Industries (adafruit.com)
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holders nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**************************************************************************/
+
+#ifndef I2S_H_
+#define I2S_H_
+
+#include <Arduino.h>
+
+#define I2S_BUFFER_WORDS_DFLT   256 // 32-bit words per DMA buffer
+#define I2S_BUFFER_COUNT_DFLT   3   // DMA buffers per direction
+
+/* I2S with EasyDMA. Each direction rotates through a ring of buffers: EasyDMA holds
+ * the one in transfer and the next one (set when TXPTRUPD/RXPTRUPD says the pointer is
+ * latched), the others are filled or drained by the sketch through Stream API, or by
+ * the pull callback in ISR.
+ *
+ * Samples are packed in 32-bit words as transferred by the peripheral:
+ * - 8-bit : 4 samples per word
+ * - 16-bit: 2 samples per word (left in lower half for stereo)
+ * - 24-bit: 1 sample per word
+ * With mono, only the left channel is used.
+ */
+class I2SClass : public Stream
+{
+  public:
+    // Invoked in ISR for each buffer
+    typedef void (*tx_callback_t) (void* buffer, uint32_t bytes);      // must fill whole buffer
+    typedef void (*rx_callback_t) (void const* buffer, uint32_t bytes);
+
+    I2SClass(void);
+
+    // Pin set to -1 is not used: without sdout there is no TX, without sdin there is no RX
+    void setPins(int sck, int lrck, int sdout, int sdin = -1, int mck = -1);
+
+    // Buffer size is shared by TX and RX. Pull callback needs at least 2 buffers, Stream 3
+    bool setBufferSize(uint16_t words, uint8_t count = I2S_BUFFER_COUNT_DFLT);
+
+    // format is I2S_CONFIG_FORMAT_FORMAT_*, align is I2S_CONFIG_ALIGN_ALIGN_* for aligned format
+    void setFormat(uint8_t format, uint8_t align = I2S_CONFIG_ALIGN_ALIGN_Left);
+
+    // Master clock I2S_CONFIG_MCKFREQ_MCKFREQ_* and MCK/LRCK ratio I2S_CONFIG_RATIO_RATIO_*.
+    // If not set, the closest to sample rate is chosen by begin()
+    void setClock(uint32_t mckfreq, uint8_t ratio);
+
+    // bits is 8, 16 or 24, channels is 1 or 2
+    bool begin(uint32_t sample_rate, uint8_t bits = 16, uint8_t channels = 2, bool master = true);
+    void end(void);
+
+    uint32_t sampleRate(void) { return _sample_rate; } // actual rate in master mode
+
+    // Pull mode replaces Stream API for that direction, set before begin()
+    void onTransmit(tx_callback_t fp);
+    void onReceive (rx_callback_t fp);
+
+    // TX: gap in stream filled with silence, RX: received buffer dropped
+    uint32_t underruns(void) { return _tx.xruns; }
+    uint32_t overruns (void) { return _rx.xruns; }
+
+    // Stream API
+    virtual int    available(void);
+    virtual int    read(void);
+    virtual int    peek(void);
+    virtual void   flush(void);
+    virtual size_t write(uint8_t b);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    virtual int    availableForWrite(void);
+
+    size_t read(void* buffer, size_t size);
+
+    using Print::write;
+
+    // Internal use only
+    void _irq_handler(void);
+
+  private:
+    typedef struct
+    {
+      uint32_t* buf;
+      uint8_t   head;   // TX: next filled buffer to send, RX: next received buffer to read
+      uint8_t   ready;  // TX: filled buffers, RX: received buffers
+      uint8_t   dma[2]; // buffer in transfer and next one, NO_BUF for none (or silence)
+      uint32_t  pos;    // TX: bytes written after filled buffers, RX: bytes read from head
+      volatile uint32_t xruns;
+    } ring_t;
+
+    int8_t _sck, _lrck, _sdout, _sdin, _mck;
+
+    uint16_t _words;
+    uint8_t  _count;
+    uint32_t _bytes;
+
+    uint8_t  _format;
+    uint8_t  _align;
+    uint32_t _mckfreq; // 0 is auto
+    uint8_t  _ratio;
+
+    uint32_t _sample_rate;
+
+    tx_callback_t _tx_cb;
+    rx_callback_t _rx_cb;
+
+    ring_t _tx;
+    ring_t _rx;
+
+    uint32_t* _buf_ptr(ring_t* r, uint8_t idx);
+    uint8_t   _held(ring_t const* r);
+    void      _tx_update(void);
+    void      _rx_update(void);
+};
+
+extern I2SClass I2S;
+
+#endif /* I2S_H_ */
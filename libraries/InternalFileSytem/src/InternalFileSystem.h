@@ -27,6 +27,15 @@
 
 #include "Adafruit_LittleFS.h"
 
+// Flash region reserved for InternalFS
+#ifdef NRF52840_XXAA
+#define LFS_FLASH_ADDR        0xED000
+#else
+#define LFS_FLASH_ADDR        0x6D000
+#endif
+
+#define LFS_FLASH_TOTAL_SIZE  (7*4096)
+
 class InternalFileSystem : public Adafruit_LittleFS
 {
   public:
@@ -26,6 +26,7 @@
 #include "flash_cache.h"
 #include "nrf_sdm.h"
 #include "nrf_soc.h"
+#include "utility/systrace.h"
 #include "delay.h"
 #include "rtos.h"
 
@@ -99,18 +100,22 @@ bool flash_nrf5x_erase(uint32_t addr)
   return fal_erase(addr);
 }
 
+bool flash_nrf5x_program_page (uint32_t dst, void const * src)
+{
+  VERIFY(dst >= ((uint32_t) __flash_arduino_start) && dst < BOOTLOADER_ADDR);
+  VERIFY((dst & (FLASH_NRF52_PAGE_SIZE-1)) == 0);
+
+  // cached copy of this page is out of date
+  if ( _cache.cache_addr == dst ) _cache.cache_addr = FLASH_CACHE_INVALID_ADDR;
+
+  return fal_program(dst, src, FLASH_NRF52_PAGE_SIZE) == FLASH_NRF52_PAGE_SIZE;
+}
+
 //--------------------------------------------------------------------+
 // HAL for caching
 //--------------------------------------------------------------------+
-static bool fal_erase (uint32_t addr)
+static bool _erase_page (uint32_t addr)
 {
-  // Init semaphore for first call
-  if ( _sem == NULL )
-  {
-    _sem = xSemaphoreCreateCounting(10, 0);
-    VERIFY(_sem);
-  }
-
   // retry if busy
   uint32_t err;
   while ( NRF_ERROR_BUSY == (err = sd_flash_page_erase(addr / FLASH_NRF52_PAGE_SIZE)) )
@@ -128,7 +133,7 @@ static bool fal_erase (uint32_t addr)
   return true;
 }
 
-static uint32_t fal_program (uint32_t dst, void const * src, uint32_t len)
+static uint32_t _program (uint32_t dst, void const * src, uint32_t len)
 {
   // wait for async event if SD is enabled
   uint8_t sd_en = 0;
@@ -166,6 +171,32 @@ static uint32_t fal_program (uint32_t dst, void const * src, uint32_t len)
   return len;
 }
 
+// Workers above return early on error, trace is done here so that STOP always follows START
+static bool fal_erase (uint32_t addr)
+{
+  // Init semaphore for first call
+  if ( _sem == NULL )
+  {
+    _sem = xSemaphoreCreateCounting(10, 0);
+    VERIFY(_sem);
+  }
+
+  SYSTRACE_START(SYSTRACE_FLASH_ERASE, addr);
+  bool const ret = _erase_page(addr);
+  SYSTRACE_STOP(SYSTRACE_FLASH_ERASE, addr);
+
+  return ret;
+}
+
+static uint32_t fal_program (uint32_t dst, void const * src, uint32_t len)
+{
+  SYSTRACE_START(SYSTRACE_FLASH_WRITE, dst);
+  uint32_t const count = _program(dst, src, len);
+  SYSTRACE_STOP(SYSTRACE_FLASH_WRITE, dst);
+
+  return count;
+}
+
 static uint32_t fal_read (void* dst, uint32_t src, uint32_t len)
 {
   memcpy(dst, (void*) src, len);
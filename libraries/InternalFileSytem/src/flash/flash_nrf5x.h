@@ -39,6 +39,9 @@ bool flash_nrf5x_erase(uint32_t addr);
 int flash_nrf5x_write (uint32_t dst, void const * src, uint32_t len);
 int flash_nrf5x_read (void* dst, uint32_t src, uint32_t len);
 
+// Program a whole erased page, bypassing the cache
+bool flash_nrf5x_program_page (uint32_t dst, void const * src);
+
 //--------------------------------------------------------------------+
 // Write helper
 //--------------------------------------------------------------------+
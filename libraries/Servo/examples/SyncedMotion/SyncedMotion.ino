@@ -0,0 +1,48 @@
+/* SyncedMotion
+ This example code is in the public domain.
+
+ Moves two servos (e.g joints of a robot arm) between two poses.
+ - Speed and acceleration limits are applied by the library, the
+   trajectory is played by PWM hardware without CPU each period.
+ - Writes between Servo::beginUpdate() and Servo::endUpdate() are
+   applied together at the same PWM period.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_TinyUSB.h> // for Serial
+#include <Servo.h>
+
+Servo shoulder;
+Servo elbow;
+
+void setup() {
+  shoulder.attach(A0);
+  elbow.attach(A1);
+
+  // degrees per second, degrees per second^2
+  shoulder.setSpeed(90);
+  shoulder.setAcceleration(180);
+
+  elbow.setSpeed(120);
+  elbow.setAcceleration(240);
+}
+
+void move_to(int shoulder_deg, int elbow_deg) {
+  Servo::beginUpdate();
+  shoulder.write(shoulder_deg);
+  elbow.write(elbow_deg);
+  Servo::endUpdate();
+
+  // CPU is free while servos are moving
+  while ( shoulder.isMoving() || elbow.isMoving() ) {
+    delay(10);
+  }
+}
+
+void loop() {
+  move_to(30, 150);
+  delay(500);
+
+  move_to(150, 30);
+  delay(500);
+}
@@ -43,6 +43,12 @@
     readMicroseconds()   - Gets the last written servo pulse width in microseconds. (was read_us() in first release)
     attached()  - Returns true if there is a servo attached. 
     detach()    - Stops an attached servos from pulsing its i/o pin. 
+
+  NRF52 only:
+    setSpeed()        - Limits speed in degrees per second towards written position, 0 is unlimited
+    setAcceleration() - Limits acceleration in degrees per second^2, 0 is unlimited
+    isMoving()        - Returns true if servo has not reached the last written position
+    Servo::beginUpdate() / Servo::endUpdate() - Writes in between are applied at the same PWM period
  */
 
 #ifndef Servo_h
@@ -81,7 +87,9 @@
 #define REFRESH_INTERVAL    20000     // minumim time to refresh servos in microseconds 
 
 #define SERVOS_PER_TIMER       12     // the maximum number of servos controlled by one timer 
+#ifndef MAX_SERVOS
 #define MAX_SERVOS   (_Nbr_16timers  * SERVOS_PER_TIMER)
+#endif
 
 #define INVALID_SERVO         255     // flag indicating an invalid servo index
 
@@ -109,6 +117,16 @@ public:
   int read();                        // returns current pulse width as an angle between 0 and 180 degrees
   int readMicroseconds();            // returns current pulse width in microseconds for this servo (was read_us() in first release)
   bool attached();                   // return true if this servo is attached, otherwise false 
+
+#if defined(ARDUINO_ARCH_NRF52) || defined(ARDUINO_NRF52_ADAFRUIT)
+  void setSpeed(int deg_per_s);      // 0 for unlimited
+  void setAcceleration(int deg_per_s2); // 0 for unlimited
+  bool isMoving();
+
+  static void beginUpdate();
+  static void endUpdate();
+#endif
+
 private:
    uint8_t servoIndex;               // index into the channel data for this servo
    int16_t min;                      // minimum pulse in µs
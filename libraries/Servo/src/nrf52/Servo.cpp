@@ -26,14 +26,194 @@
 
 #include <Adafruit_TinyUSB.h> // for Serial
 
+/* All owned PWM modules are started together and play the same period back to back
+ * from two sequence buffers in Individual mode. Positions are only loaded into the
+ * buffer which just ended (by the callback of the last started module) therefore
+ * all servos change at the same period. When nothing changes, the callback is disabled
+ * and PWM keeps looping without CPU. While moving with a motion profile, each buffer
+ * holds SERVO_PROFILE_STEPS periods of the trajectory.
+ */
+
 enum
 {
   SERVO_TOKEN = 0x76726553 // 'S' 'e' 'r' 'v'
 };
 
+#define PERIOD_S   (MAXVALUE*DUTY_CYCLE_RESOLUTION / 1000000.0f)
+
+typedef struct
+{
+  float pos;        // current pulse in us, 0 is not pulsing
+  float vel;        // us per period
+  float vmax;       // us per period, 0 for unlimited
+  float accel;      // us per period^2, 0 for unlimited
+
+  uint16_t target;  // committed pulse in us
+  uint16_t staged;  // written pulse in us, committed by endUpdate()
+
+  uint8_t module;
+  uint8_t ch;
+} servo_motion_t;
+
 static servo_t servos[MAX_SERVOS];              // static array of servo structures
+static servo_motion_t motion[MAX_SERVOS];
 uint8_t ServoCount = 0;                         // the total number of attached servos
 
+static uint16_t seq_buf[HWPWM_MODULE_NUM][2][SERVO_PROFILE_STEPS*4];
+static HardwarePWM* master = NULL;
+static uint8_t update_depth = 0;
+static uint8_t idle_count = 0;
+
+//--------------------------------------------------------------------+
+// Sequence engine
+//--------------------------------------------------------------------+
+static void motion_step(servo_motion_t* m)
+{
+  float const d = m->target - m->pos;
+
+  // jump when not pulsing yet or no speed limit
+  if ( m->pos == 0 || m->vmax <= 0 )
+  {
+    m->pos = m->target;
+    m->vel = 0;
+    return;
+  }
+
+  float const dir  = (d >= 0) ? 1 : -1;
+  float const dist = d*dir;
+  float v = m->vel*dir; // speed towards target, negative when moving away
+
+  if ( m->accel <= 0 )
+  {
+    v = m->vmax;
+  }else if ( v < 0 )
+  {
+    // target is changed to the other side, brake first
+    v = min(v + m->accel, 0.0f);
+  }else
+  {
+    // accelerate up to max speed, but keep distance to brake
+    v = min(min(v + m->accel, m->vmax), sqrtf(2*m->accel*dist));
+    v = max(v, min(m->accel, dist));
+  }
+
+  if ( v >= dist )
+  {
+    m->pos = m->target;
+    m->vel = 0;
+  }else
+  {
+    m->pos += v*dir;
+    m->vel  = v*dir;
+  }
+}
+
+static bool is_moving(servo_motion_t const* m)
+{
+  return m->pos != m->target || m->vel != 0;
+}
+
+// Fill sequence buffer of all modules, return true if servos are still moving
+static bool engine_fill(uint8_t seq)
+{
+  bool moving = false;
+  for(uint8_t i=0; i<MAX_SERVOS; i++)
+  {
+    if ( servos[i].Pin.isActive && is_moving(&motion[i]) ) moving = true;
+  }
+
+  uint8_t const steps = moving ? SERVO_PROFILE_STEPS : 1;
+
+  for(uint8_t m=0; m<HWPWM_MODULE_NUM; m++)
+  {
+    if ( !HwPWMx[m]->isOwner(SERVO_TOKEN) ) continue;
+    for(uint16_t j=0; j<steps*4; j++) seq_buf[m][seq][j] = bit(15);
+  }
+
+  for(uint8_t s=0; s<steps; s++)
+  {
+    for(uint8_t i=0; i<MAX_SERVOS; i++)
+    {
+      servo_motion_t* m = &motion[i];
+      if ( !servos[i].Pin.isActive ) continue;
+
+      motion_step(m);
+      seq_buf[m->module][seq][4*s + m->ch] = ((uint16_t) (m->pos/DUTY_CYCLE_RESOLUTION + 0.5f)) | bit(15);
+    }
+  }
+
+  for(uint8_t m=0; m<HWPWM_MODULE_NUM; m++)
+  {
+    if ( HwPWMx[m]->isOwner(SERVO_TOKEN) ) HwPWMx[m]->setSequence(seq, seq_buf[m][seq], steps*4);
+  }
+
+  return moving;
+}
+
+// Invoked in ISR when all modules have ended sequence seq, the other is playing
+static void engine_seq_end(uint8_t seq)
+{
+  if ( engine_fill(seq) )
+  {
+    idle_count = 0;
+  }else if ( ++idle_count >= 2 )
+  {
+    // both buffers hold final positions
+    master->setSequenceCallback(NULL);
+  }
+}
+
+// Commit positions, applied at latest 2 periods later
+static void engine_commit(void)
+{
+  taskENTER_CRITICAL();
+
+  for(uint8_t i=0; i<MAX_SERVOS; i++) motion[i].target = motion[i].staged;
+
+  idle_count = 0;
+  if ( master ) master->setSequenceCallback(engine_seq_end);
+
+  taskEXIT_CRITICAL();
+}
+
+// (Re)start all modules together after attach/detach to keep their periods aligned
+static void engine_restart(void)
+{
+  taskENTER_CRITICAL();
+
+  master = NULL;
+  for(uint8_t m=0; m<HWPWM_MODULE_NUM; m++)
+  {
+    HardwarePWM* pwm = HwPWMx[m];
+    if ( !pwm->isOwner(SERVO_TOKEN) || !pwm->usedChannelCount() ) continue;
+
+    pwm->setSequenceCallback(NULL);
+    pwm->setDecoder(PWM_DECODER_LOAD_Individual);
+    master = pwm;
+  }
+
+  if ( master )
+  {
+    engine_fill(0);
+    engine_fill(1);
+
+    // last started module ends its sequence last, its callback refills all
+    for(uint8_t m=0; m<HWPWM_MODULE_NUM; m++)
+    {
+      HardwarePWM* pwm = HwPWMx[m];
+      if ( pwm->isOwner(SERVO_TOKEN) && pwm->usedChannelCount() ) pwm->playSequence(0);
+    }
+
+    idle_count = 0;
+    master->setSequenceCallback(engine_seq_end);
+  }
+
+  taskEXIT_CRITICAL();
+}
+
+//--------------------------------------------------------------------+
+// Servo
+//--------------------------------------------------------------------+
 Servo::Servo()
 {
   if (ServoCount < MAX_SERVOS) {
@@ -92,10 +272,20 @@ uint8_t Servo::attach(int pin, int min, int max)
   {
     for ( int i = 0; i < HWPWM_MODULE_NUM; i++ )
     {
-      if ( HwPWMx[i]->takeOwnership(SERVO_TOKEN) && HwPWMx[i]->addPin(pin) )
+      if ( HwPWMx[i]->takeOwnership(SERVO_TOKEN) )
       {
-        this->pwm = HwPWMx[i];
-        succeeded = true;
+        // period is configured once per module
+        HwPWMx[i]->setMaxValue(MAXVALUE);
+        HwPWMx[i]->setClockDiv(CLOCKDIV);
+
+        if ( HwPWMx[i]->addPin(pin) )
+        {
+          this->pwm = HwPWMx[i];
+          succeeded = true;
+        }else
+        {
+          HwPWMx[i]->releaseOwnership(SERVO_TOKEN);
+        }
         break;
       }
     }
@@ -107,8 +297,16 @@ uint8_t Servo::attach(int pin, int min, int max)
     servos[this->servoIndex].Pin.nbr = pin;
     servos[this->servoIndex].Pin.isActive = true;
 
-    this->pwm->setMaxValue(MAXVALUE);
-    this->pwm->setClockDiv(CLOCKDIV);
+    servo_motion_t* m = &motion[this->servoIndex];
+    m->pos    = m->vel = 0;
+    m->target = m->staged = 0;
+    m->ch     = this->pwm->pin2channel(pin);
+    for ( int i = 0; i < HWPWM_MODULE_NUM; i++ )
+    {
+      if ( HwPWMx[i] == this->pwm ) m->module = i;
+    }
+
+    engine_restart();
 
     return this->servoIndex;
   }else
@@ -119,7 +317,7 @@ uint8_t Servo::attach(int pin, int min, int max)
 
 void Servo::detach()
 {
-  if (this->servoIndex == INVALID_SERVO) {
+  if (this->servoIndex == INVALID_SERVO || !this->pwm) {
     return;
   }
 
@@ -134,6 +332,8 @@ void Servo::detach()
     pwm->stop(); // disables peripheral so can release ownership
     pwm->releaseOwnership(SERVO_TOKEN);
   }
+
+  engine_restart();
 }
 
 void Servo::write(int value)
@@ -152,8 +352,8 @@ void Servo::write(int value)
 void Servo::writeMicroseconds(int value)
 {
   if (this->pwm) {
-	  uint8_t pin = servos[this->servoIndex].Pin.nbr;
-  	this->pwm->writePin(pin, value/DUTY_CYCLE_RESOLUTION);
+    motion[this->servoIndex].staged = (uint16_t) value;
+    if ( update_depth == 0 ) engine_commit();
   }
 }
 
@@ -165,8 +365,8 @@ int Servo::read() // return the value as degrees
 int Servo::readMicroseconds()
 {	
   if (this->pwm) {
-    uint8_t pin = servos[this->servoIndex].Pin.nbr;
-    return this->pwm->readPin(pin)*DUTY_CYCLE_RESOLUTION;
+    // position being output, may not reach written value yet with motion profile
+    return ((int) (motion[this->servoIndex].pos/DUTY_CYCLE_RESOLUTION + 0.5f))*DUTY_CYCLE_RESOLUTION;
   }
 	return 0;
 }
@@ -179,4 +379,40 @@ bool Servo::attached()
   return servos[this->servoIndex].Pin.isActive;
 }
 
+void Servo::setSpeed(int deg_per_s)
+{
+  if (this->servoIndex == INVALID_SERVO) return;
+
+  // degree to us per PWM period
+  float const us_per_deg = (this->max - this->min) / 180.0f;
+  motion[this->servoIndex].vmax = (deg_per_s > 0 ? deg_per_s : 0) * us_per_deg * PERIOD_S;
+}
+
+void Servo::setAcceleration(int deg_per_s2)
+{
+  if (this->servoIndex == INVALID_SERVO) return;
+
+  float const us_per_deg = (this->max - this->min) / 180.0f;
+  motion[this->servoIndex].accel = (deg_per_s2 > 0 ? deg_per_s2 : 0) * us_per_deg * PERIOD_S * PERIOD_S;
+}
+
+bool Servo::isMoving()
+{
+  if (!this->pwm) return false;
+
+  servo_motion_t const* m = &motion[this->servoIndex];
+  return m->staged != m->target || is_moving(m);
+}
+
+void Servo::beginUpdate()
+{
+  update_depth++;
+}
+
+void Servo::endUpdate()
+{
+  if ( update_depth == 0 ) return;
+  if ( --update_depth == 0 ) engine_commit();
+}
+
 #endif // ARDUINO_ARCH_NRF52
@@ -35,7 +35,12 @@
 #define MAXVALUE 2500
 #define CLOCKDIV PWM_PRESCALER_PRESCALER_DIV_128
 
-// define one timer in order to have MAX_SERVOS = 12
+// define one timer to keep compatibility, servo count is 4 per PWM module
 typedef enum { _timer1, _Nbr_16timers } timer16_Sequence_t;
 
+#define MAX_SERVOS  (HWPWM_MODULE_NUM*4)
+
+// PWM periods per sequence buffer when servos are moving with a motion profile
+#define SERVO_PROFILE_STEPS 8
+
 #endif   // __SERVO_TIMERS_H__
@@ -25,22 +25,67 @@
 
 #include <Adafruit_TinyUSB.h> // for Serial
 
-SoftwareSerial *SoftwareSerial::active_object = 0;
-char SoftwareSerial::_receive_buffer[_SS_MAX_RX_BUFF]; 
-volatile uint8_t SoftwareSerial::_receive_buffer_tail = 0;
-volatile uint8_t SoftwareSerial::_receive_buffer_head = 0;
+enum { SWSERIAL_TOKEN = 0x65537753 }; // 'S' 'w' 'S' 'e'
 
+#define TIMER_FREQ      16000000UL
+#define TX_START_MARGIN 64 // ticks from write() to first transition of an idle port
+
+// TIMER capture/compare usage
+enum
+{
+  CC_NOW = 0,   // scratch to capture current time
+  CC_RX_EDGE,   // captured by every RX edge
+  CC_RX_FRAME,  // compare at middle of stop bit
+  CC_TX_SPACE,  // compare to drive line to space
+  CC_TX_MARK    // compare to drive line to mark
+};
+
+static SoftwareSerial* _ss_object[8]; // indexed by GPIOTE channel
+
+static void ss_gpiote_handler(uint8_t ch)
+{
+  if ( _ss_object[ch] ) _ss_object[ch]->handle_gpiote(ch);
+}
+
+static void ss_timer_handler(void* arg)
+{
+  ((SoftwareSerial*) arg)->handle_timer();
+}
+
+static inline uint32_t tx_cc(uint8_t level)
+{
+  return level ? CC_TX_MARK : CC_TX_SPACE;
+}
 
 SoftwareSerial::SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverse_logic /* = false */) :
-  _rx_delay_centering(0),
-  _rx_delay_intrabit(0),
-  _rx_delay_stopbit(0),
-  _tx_delay(0),
-  _buffer_overflow(false),
-  _inverse_logic(inverse_logic)
-{   
+  _inverse_logic(inverse_logic),
+  _buffer_overflow(false)
+{
   _receivePin = receivePin;
   _transmitPin = transmitPin;
+
+  _hwtimer = NULL;
+  _bit_q8 = 0;
+
+  _rx_ch = -1;
+  _rx_ppi = -1;
+  _rx_level = 1;
+  _rx_edge_t = 0;
+  _rx_active = false;
+  _rx_t0 = 0;
+  _edge_count = 0;
+  _edge_level = 0;
+  _receive_buffer_tail = _receive_buffer_head = 0;
+
+  _tx_ch = -1;
+  _tx_ppi[0] = _tx_ppi[1] = -1;
+  _tx_armed[0] = _tx_armed[1] = false;
+  _tx_peek = false;
+  _tx_level = 1;
+  _tx_bit = 10;
+  _tx_frame = 0;
+  _tx_t0 = _tx_peek_time = _tx_next_frame = 0;
+  _transmit_buffer_tail = _transmit_buffer_head = 0;
 }
 
 
@@ -50,76 +95,124 @@ SoftwareSerial::~SoftwareSerial()
 }
 
 void SoftwareSerial::begin(long speed)
- {  
-    setTX(_transmitPin);
-    setRX(_receivePin);
-    // Precalculate the various delays
-    //Calculate the distance between bit in micro seconds
-    uint32_t bit_delay = (float(1)/speed)*1000000;
- 
-    _tx_delay = bit_delay;
-  
-    //Wait 1/2 bit - 2 micro seconds (time for interrupt to be served)
-    _rx_delay_centering = (bit_delay/2) - 2;
-    //Wait 1 bit - 2 micro seconds (time in each loop iteration)
-    _rx_delay_intrabit = bit_delay - 1;//2
-    //Wait 1 bit (the stop one) 
-    _rx_delay_stopbit = bit_delay; 
-
-       
-      delayMicroseconds(_tx_delay);
-
-      listen();
+{
+  end();
+  if ( speed <= 0 ) return;
+
+  HardwareTimer* const timers[] = { &HwTimer4, &HwTimer3 }; // need 5 CCs
+  for(uint8_t i=0; i<arrcount(timers) && !_hwtimer; i++)
+  {
+    if ( timers[i]->takeOwnership(SWSERIAL_TOKEN) ) _hwtimer = timers[i];
+  }
+  VERIFY(_hwtimer, );
+
+  _bit_q8 = (TIMER_FREQ << 8) / (uint32_t) speed;
+
+  // Free running 32-bit counter at 16 MHz
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+  timer->TASKS_STOP  = 1;
+  timer->MODE        = TIMER_MODE_MODE_Timer;
+  timer->BITMODE     = TIMER_BITMODE_BITMODE_32Bit;
+  timer->PRESCALER   = 0;
+  timer->SHORTS      = 0;
+  timer->INTENCLR    = 0xFFFFFFFFUL;
+  for(uint8_t i=0; i<=CC_TX_MARK; i++) timer->EVENTS_COMPARE[i] = 0;
+  timer->TASKS_CLEAR = 1;
+
+  // same priority as GPIOTE so that edge and timer handlers never preempt each other
+  _hwtimer->attachHandler(ss_timer_handler, this, 3);
+  timer->TASKS_START = 1;
+
+  setTX(_transmitPin);
+  setRX(_receivePin);
+
+  listen();
 }
 
 bool SoftwareSerial::listen()
 {
-  if (!_rx_delay_stopbit)
-    return false;
+  if ( !_hwtimer || isListening() ) return false;
 
-  if (active_object != this)
+  uint32_t const nrf_pin = g_ADigitalPinMap[_receivePin];
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+
+  _buffer_overflow = false;
+  _rx_active = false;
+
+  // Single channel on both edges, level is known by alternation
+  _rx_ch = gpioteChannelAlloc(nrf_pin, GPIOTE_CONFIG_POLARITY_Toggle, ss_gpiote_handler);
+  if ( _rx_ch >= 0 )
   {
-    if (active_object)
-      active_object->stopListening();
-
-    _buffer_overflow = false;
-    _receive_buffer_head = _receive_buffer_tail = 0;
-    active_object = this;
-
-    if(_inverse_logic)
-        //Start bit high
-       _intMask = attachInterrupt(_receivePin, handle_interrupt, RISING);
-    else
-        //Start bit low
-        _intMask = attachInterrupt(_receivePin, handle_interrupt, FALLING);
-        
-    return true;
+    _ss_object[_rx_ch] = this;
+    _rx_ppi = ppi_channel_alloc(&NRF_GPIOTE->EVENTS_IN[_rx_ch], &timer->TASKS_CAPTURE[CC_RX_EDGE]);
   }
- return false;
+
+  if ( _rx_ppi < 0 )
+  {
+    stopListening();
+    return false;
+  }
+
+  _rx_level  = rx_pin_level();
+  _rx_edge_t = now();
+
+  timer->EVENTS_COMPARE[CC_RX_FRAME] = 0;
+  timer->INTENSET = TIMER_INTENSET_COMPARE0_Msk << CC_RX_FRAME;
+
+  ppi_channel_enable(_rx_ppi);
+
+  return true;
 }
 
 bool SoftwareSerial::stopListening()
 {
-   if (active_object == this)
-   {
-     detachInterrupt(_receivePin);
-     active_object = NULL;
-     return true;
-   }
-  return false;
+  if ( _rx_ch < 0 ) return false;
+
+  if ( _hwtimer ) _hwtimer->getTimer()->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk << CC_RX_FRAME;
+
+  if ( _rx_ppi >= 0 ) ppi_channel_free(_rx_ppi);
+  _rx_ppi = -1;
+
+  gpioteChannelFree(_rx_ch);
+  _ss_object[_rx_ch] = NULL;
+  _rx_ch = -1;
+
+  _rx_active = false;
+  return true;
 }
 
 void SoftwareSerial::end()
 {
   stopListening();
+
+  if ( !_hwtimer ) return;
+
+  flush();
+
+  for(uint8_t i=0; i<2; i++)
+  {
+    if ( _tx_ppi[i] >= 0 ) ppi_channel_free(_tx_ppi[i]);
+    _tx_ppi[i] = -1;
+    _tx_armed[i] = false;
+  }
+
+  // line is at mark, GPIO keeps it there once GPIOTE releases the pin
+  if ( _tx_ch >= 0 ) gpioteChannelFree(_tx_ch);
+  _tx_ch = -1;
+
+  _hwtimer->detachHandler();
+
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+  timer->TASKS_STOP  = 1;
+  timer->TASKS_CLEAR = 1;
+
+  _hwtimer->releaseOwnership(SWSERIAL_TOKEN);
+  _hwtimer = NULL;
+  _bit_q8 = 0;
 }
 
 int SoftwareSerial::read()
 {
-  if (!isListening()){
-    return -1;}
-
-
   // Empty buffer?
   if (_receive_buffer_head == _receive_buffer_tail){
     return -1;}
@@ -128,88 +221,76 @@ int SoftwareSerial::read()
   uint8_t d = _receive_buffer[_receive_buffer_head]; // grab next byte
   _receive_buffer_head = (_receive_buffer_head + 1) % _SS_MAX_RX_BUFF;
   return d;
-}  
+}
 
 int SoftwareSerial::available()
 {
-  if (!isListening())
-    return 0;
-  
   return (_receive_buffer_tail + _SS_MAX_RX_BUFF - _receive_buffer_head) % _SS_MAX_RX_BUFF;
 }
 
+int SoftwareSerial::availableForWrite()
+{
+  return _SS_MAX_TX_BUFF - 1 - (_transmit_buffer_tail + _SS_MAX_TX_BUFF - _transmit_buffer_head) % _SS_MAX_TX_BUFF;
+}
+
 size_t SoftwareSerial::write(uint8_t b)
 {
-  if (_tx_delay == 0) {
+  if (_tx_ch < 0) {
     setWriteError();
     return 0;
   }
 
-  // By declaring these as local variables, the compiler will put them
-  // in registers _before_ disabling interrupts and entering the
-  // critical timing sections below, which makes it a lot easier to
-  // verify the cycle timings
-  volatile uint32_t* reg = _transmitPortRegister;
-  uint32_t reg_mask = _transmitBitMask;
-  uint32_t inv_mask = ~_transmitBitMask;
-  bool inv = _inverse_logic;
-  uint16_t delay = _tx_delay;
-  
-  if (inv)
-    b = ~b;
-  // turn off interrupts for a clean txmit
-   NRF_GPIOTE->INTENCLR = _intMask;
-  // Write the start bit
-  if (inv)
-    *reg |= reg_mask;
-  else
-    *reg &= inv_mask;
+  uint8_t const next = (_transmit_buffer_tail + 1) % _SS_MAX_TX_BUFF;
+
+  // wait for timer interrupt to drain the buffer
+  while (next == _transmit_buffer_head)
+  {
+    if ( isInISR() ) return 0;
+    yield();
+  }
 
-  delayMicroseconds(delay);
+  _transmit_buffer[_transmit_buffer_tail] = b;
+  _transmit_buffer_tail = next;
 
+  uint32_t const mask = portSET_INTERRUPT_MASK_FROM_ISR();
 
-  // Write each of the 8 bits
-  for (uint8_t i = 8; i > 0; --i)
+  // Idle port: first frame starts shortly from now, but not before previous stop bit ends
+  if ( !_tx_peek && _tx_bit >= 10 )
   {
-    if (b & 1) // choose bit
-      *reg |= reg_mask; // send 1
-    else
-      *reg &= inv_mask; // send 0
+    uint32_t const start = now() + TX_START_MARGIN;
+    int32_t const ahead = (int32_t) (_tx_next_frame - start);
 
-    delayMicroseconds(delay); 
-    b >>= 1;
+    // stale end time of a long gone frame may look ahead after counter wraps
+    if ( ahead < 0 || ahead > (int32_t) ((10*_bit_q8) >> 8) ) _tx_next_frame = start;
   }
 
-  // restore pin to natural state
-  if (inv)
-    *reg &= inv_mask;
-  else
-    *reg |= reg_mask;
-  
-  NRF_GPIOTE->INTENSET = _intMask;
-  
-  delayMicroseconds(delay);  
-  
+  tx_fill();
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
   return 1;
 }
 
 void SoftwareSerial::flush()
 {
-  if (!isListening())
-    return;
+  if (_tx_ch < 0) return;
 
-  NRF_GPIOTE->INTENCLR = _intMask;
-  
-  _receive_buffer_head = _receive_buffer_tail = 0;
+  // wait for all bytes to be scheduled
+  while ( _transmit_buffer_head != _transmit_buffer_tail || _tx_armed[0] || _tx_armed[1] )
+  {
+    yield();
+  }
 
-  NRF_GPIOTE->INTENSET = _intMask;
+  // then for the last stop bit
+  int32_t const remaining = (int32_t) (_tx_next_frame - now());
+  if ( remaining > 0 && remaining <= (int32_t) ((10*_bit_q8) >> 8) )
+  {
+    delayMicroseconds(remaining/16 + 1);
+  }
 }
 
 int SoftwareSerial::peek()
 {
-  if (!isListening())
-    return -1;
-
   // Empty buffer?
   if (_receive_buffer_head == _receive_buffer_tail)
     return -1;
@@ -221,89 +302,230 @@ int SoftwareSerial::peek()
 
 //private methods
 
-void SoftwareSerial::recv()
+uint32_t SoftwareSerial::now()
 {
-  uint8_t d = 0;
-   
-  // If RX line is high, then we don't see any start bit
-  // so interrupt is probably not for us
-  if (_inverse_logic ? rx_pin_read() : !rx_pin_read())
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+  timer->TASKS_CAPTURE[CC_NOW] = 1;
+  return timer->CC[CC_NOW];
+}
+
+uint8_t SoftwareSerial::rx_pin_level()
+{
+  return (nrf_gpio_pin_read(g_ADigitalPinMap[_receivePin]) ? 1 : 0) ^ (_inverse_logic ? 1 : 0);
+}
+
+void SoftwareSerial::handle_gpiote(uint8_t ch)
+{
+  // Called by the frame compare to collect an edge the GPIOTE ISR has not handled yet,
+  // otherwise event of ch is already cleared by GPIOTE ISR
+  if ( ch != _rx_ch )
   {
+    if ( _rx_ch < 0 || !NRF_GPIOTE->EVENTS_IN[_rx_ch] ) return;
+    NRF_GPIOTE->EVENTS_IN[_rx_ch] = 0;
+  }
 
-    NRF_GPIOTE->INTENCLR = _intMask;
- 
-    // Wait approximately 1/2 of a bit width to "center" the sample
-       delayMicroseconds(_rx_delay_centering);
-   
-    // Read each of the 8 bits
-    for (uint8_t i=8; i > 0; --i)
+  // next edge came between event clear and capture read, and is handled already
+  uint32_t const t = _hwtimer->getTimer()->CC[CC_RX_EDGE];
+  if ( t == _rx_edge_t ) return;
+  _rx_edge_t = t;
+
+  // edges alternate: level is logical line level after the edge, 0 is space, 1 is mark
+  uint8_t const level = _rx_level ^ 1;
+  _rx_level = level;
+
+  // Pin disagrees while no newer edge is pending: an edge pair came within
+  // interrupt latency and is lost, so is the frame
+  uint8_t const pin = rx_pin_level();
+  if ( pin != level && !NRF_GPIOTE->EVENTS_IN[_rx_ch] )
+  {
+    _rx_level = pin;
+    _rx_active = false;
+    return;
+  }
+
+  rx_edge(t, level);
+}
+
+void SoftwareSerial::handle_timer()
+{
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+
+  if ( timer->EVENTS_COMPARE[CC_RX_FRAME] )
+  {
+    timer->EVENTS_COMPARE[CC_RX_FRAME] = 0;
+
+    // collect edges not yet handled by GPIOTE ISR
+    if ( isListening() ) handle_gpiote(0xff);
+    rx_check_end();
+  }
+
+  for(uint8_t level=0; level<2; level++)
+  {
+    uint32_t const cc = tx_cc(level);
+    if ( !timer->EVENTS_COMPARE[cc] ) continue;
+
+    timer->EVENTS_COMPARE[cc] = 0;
+    if ( _tx_armed[level] )
     {
-        
-     delayMicroseconds(_rx_delay_intrabit);
-	 // nRF52 needs another delay less than 1 uSec to be better synchronized
-	 // with the highest baud rates
-	 __ASM volatile (
-       " NOP\n\t"
-       " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	   " NOP\n"
-	 );
-
-      d >>= 1;
-
-      if (rx_pin_read()){
-        d |= 0x80;                  
-       }
-     
-    }
-    if (_inverse_logic){
-      d = ~d;
+      ppi_channel_disable(_tx_ppi[level]);
+      _tx_armed[level] = false;
     }
-    
-    // if buffer full, set the overflow flag and return
-    uint8_t next = (_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF;
-    if (next != _receive_buffer_head)
-    {
-      // save new data in buffer: tail points to where byte goes
-      _receive_buffer[_receive_buffer_tail] = d; // save new byte
-      _receive_buffer_tail = next;
-    } 
-    else 
+  }
+
+  tx_fill();
+}
+
+void SoftwareSerial::rx_edge(uint32_t t, uint8_t level)
+{
+  if ( _rx_active )
+  {
+    // frame has ended but its compare is not handled yet
+    if ( (int32_t) (t - _rx_t0) >= (int32_t) ((19*_bit_q8) >> 9) ) rx_frame_end();
+  }
+
+  if ( !_rx_active )
+  {
+    // wait for start bit
+    if ( level ) return;
+
+    _rx_active  = true;
+    _rx_t0      = t;
+    _edge_count = 0;
+    _edge_level = 0;
+
+    // decode in the middle of stop bit
+    NRF_TIMER_Type* timer = _hwtimer->getTimer();
+    timer->CC[CC_RX_FRAME] = t + ((19*_bit_q8) >> 9);
+
+    // compare may be already missed if ISR is late
+    rx_check_end();
+    return;
+  }
+
+  if ( _edge_count < _SS_MAX_EDGES )
+  {
+    _edge_time[_edge_count] = t - _rx_t0;
+    if ( level ) _edge_level |= (1U << _edge_count);
+    _edge_count++;
+  }
+}
+
+void SoftwareSerial::rx_check_end()
+{
+  if ( !_rx_active ) return;
+
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+  if ( (int32_t) (now() - timer->CC[CC_RX_FRAME]) >= 0 )
+  {
+    timer->EVENTS_COMPARE[CC_RX_FRAME] = 0;
+    rx_frame_end();
+  }
+}
+
+void SoftwareSerial::rx_frame_end()
+{
+  _rx_active = false;
+
+  // Sample each bit at its center from edge timestamps
+  uint16_t bits = 0;
+  uint8_t level = 0;
+  uint8_t idx = 0;
+
+  for(uint8_t i=0; i<10; i++)
+  {
+    uint32_t const center = ((2*i+1) * _bit_q8) >> 9;
+
+    while ( idx < _edge_count && _edge_time[idx] <= center )
     {
-      _buffer_overflow = true;
+      level = (_edge_level >> idx) & 1;
+      idx++;
     }
 
-    // skip the stop bit
-   delayMicroseconds(_rx_delay_stopbit); 
+    bits |= (level << i);
+  }
+
+  // framing error: glitch as start bit or missing stop bit
+  if ( (bits & 0x001) || !(bits & 0x200) ) return;
 
-   NRF_GPIOTE->INTENSET = _intMask;  
+  // if buffer full, set the overflow flag and return
+  uint8_t next = (_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF;
+  if (next != _receive_buffer_head)
+  {
+    // save new data in buffer: tail points to where byte goes
+    _receive_buffer[_receive_buffer_tail] = (uint8_t) (bits >> 1); // save new byte
+    _receive_buffer_tail = next;
+  }
+  else
+  {
+    _buffer_overflow = true;
   }
 }
 
-uint32_t SoftwareSerial::rx_pin_read()
-{ 
-  return *_receivePortRegister & digitalPinToBitMask(_receivePin);
+// Generate next line transition, false if there is nothing to send
+bool SoftwareSerial::tx_next()
+{
+  while (1)
+  {
+    if ( _tx_bit >= 10 )
+    {
+      if ( _transmit_buffer_head == _transmit_buffer_tail ) return false;
+
+      uint8_t const b = _transmit_buffer[_transmit_buffer_head];
+      _transmit_buffer_head = (_transmit_buffer_head + 1) % _SS_MAX_TX_BUFF;
+
+      // start bit, data LSB first, stop bit
+      _tx_frame = (uint16_t) ((b << 1) | 0x200);
+      _tx_bit = 0;
+      _tx_t0 = _tx_next_frame;
+      _tx_next_frame = _tx_t0 + ((10*_bit_q8) >> 8);
+    }
+
+    uint8_t const level = (_tx_frame >> _tx_bit) & 1;
+    uint32_t const t = _tx_t0 + ((_tx_bit*_bit_q8) >> 8);
+    _tx_bit++;
+
+    if ( level != _tx_level )
+    {
+      _tx_level = level;
+      _tx_peek_time = t;
+      _tx_peek = true;
+      return true;
+    }
+  }
 }
 
-/* static */
-inline void SoftwareSerial::handle_interrupt()
+// Schedule transitions on compare channels that are free. Transitions alternate between
+// space and mark, each compare is re-armed when it fires i.e 2 bit times ahead of the line.
+void SoftwareSerial::tx_fill()
 {
-   if (active_object)
-   {
-     active_object->recv();
-   }
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+
+  while ( _tx_peek || tx_next() )
+  {
+    uint8_t const level = _tx_level;
+    if ( _tx_armed[level] ) break;
+
+    uint32_t const cc = tx_cc(level);
+    timer->EVENTS_COMPARE[cc] = 0;
+    ppi_channel_enable(_tx_ppi[level]);
+    timer->CC[cc] = _tx_peek_time;
+    _tx_peek = false;
+
+    if ( (int32_t) (_tx_peek_time - now()) > 0 )
+    {
+      _tx_armed[level] = true;
+      continue;
+    }
+
+    // too late for compare: drive line by software unless compare has just fired
+    if ( !timer->EVENTS_COMPARE[cc] )
+    {
+      ((level ^ _inverse_logic) ? NRF_GPIOTE->TASKS_SET : NRF_GPIOTE->TASKS_CLR)[_tx_ch] = 1;
+    }
+
+    ppi_channel_disable(_tx_ppi[level]);
+    timer->EVENTS_COMPARE[cc] = 0;
+  }
 }
 
 void SoftwareSerial::setTX(uint8_t tx)
@@ -314,18 +536,42 @@ void SoftwareSerial::setTX(uint8_t tx)
   // is fine. With inverse logic, either order is fine.
   digitalWrite(tx, _inverse_logic ? LOW : HIGH);
   pinMode(tx, OUTPUT);
-  _transmitBitMask = digitalPinToBitMask(tx);
-  NRF_GPIO_Type * port = digitalPinToPort(tx);
-  _transmitPortRegister = portOutputRegister(port);
+
+  _tx_level = 1;
+  _tx_bit = 10;
+  _tx_peek = false;
+  _transmit_buffer_head = _transmit_buffer_tail = 0;
+
+  _tx_ch = gpioteTaskChannelAlloc(g_ADigitalPinMap[tx], !_inverse_logic);
+  VERIFY(_tx_ch >= 0, );
+
+  NRF_TIMER_Type* timer = _hwtimer->getTimer();
+  for(uint8_t level=0; level<2; level++)
+  {
+    volatile uint32_t* task = (level ^ _inverse_logic) ? &NRF_GPIOTE->TASKS_SET[_tx_ch] : &NRF_GPIOTE->TASKS_CLR[_tx_ch];
+    _tx_ppi[level] = ppi_channel_alloc(&timer->EVENTS_COMPARE[tx_cc(level)], task);
+  }
+
+  if ( _tx_ppi[0] < 0 || _tx_ppi[1] < 0 )
+  {
+    for(uint8_t level=0; level<2; level++)
+    {
+      if ( _tx_ppi[level] >= 0 ) ppi_channel_free(_tx_ppi[level]);
+      _tx_ppi[level] = -1;
+    }
+
+    gpioteChannelFree(_tx_ch);
+    _tx_ch = -1;
+    return;
+  }
+
+  timer->INTENSET = (TIMER_INTENSET_COMPARE0_Msk << CC_TX_SPACE) | (TIMER_INTENSET_COMPARE0_Msk << CC_TX_MARK);
 }
 
 void SoftwareSerial::setRX(uint8_t rx)
 {
-  pinMode(rx, INPUT);
-  if (!_inverse_logic)
-    digitalWrite(rx, HIGH);  // pullup for normal logic!
+  // pullup for normal logic!
+  pinMode(rx, _inverse_logic ? INPUT : INPUT_PULLUP);
   _receivePin = rx;
-  _receiveBitMask = digitalPinToBitMask(rx);
-  NRF_GPIO_Type * port = digitalPinToPort(rx);
-  _receivePortRegister = portInputRegister(port);
+  _receive_buffer_head = _receive_buffer_tail = 0;
 }
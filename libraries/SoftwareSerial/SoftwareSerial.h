@@ -24,48 +24,77 @@
 #include <inttypes.h>
 #include <Stream.h>
 #include <variant.h>
+#include <HardwareTimer.h>
 
 /******************************************************************************
 * Definitions
 ******************************************************************************/
 
 #define _SS_MAX_RX_BUFF 64 // RX buffer size
-
+#define _SS_MAX_TX_BUFF 64 // TX buffer size
+#define _SS_MAX_EDGES   12 // RX edges per frame (10 bits frame has up to 10)
+
+/* Each port runs on its own 16 Mhz TIMER (HwTimer4 or HwTimer3 i.e at most two ports).
+ * RX edges are timestamped by TIMER capture through a single toggle GPIOTE channel + PPI
+ * and the frame is decoded after its stop bit, TX transitions are driven by TIMER compare
+ * on GPIOTE SET/CLR tasks. Interrupts are not cycle exact: RX edges need to be served
+ * within 1 bit time (frame with a missed edge pair is dropped), TX within 2 bit times.
+ */
 class SoftwareSerial : public Stream
 {
 private:
   // per object data
   uint8_t _transmitPin;
   uint8_t _receivePin;
-  uint32_t _receiveBitMask;
-  volatile uint32_t* _receivePortRegister;
-  uint32_t _transmitBitMask;
-  volatile uint32_t* _transmitPortRegister;
-  volatile uint32_t _intMask;
-
-  // Expressed as 4-cycle delays (must never be 0!)
-  uint16_t _rx_delay_centering;
-  uint16_t _rx_delay_intrabit;
-  uint16_t _rx_delay_stopbit;
-  uint16_t _tx_delay;
-
-  uint16_t _buffer_overflow:1;
-  uint16_t _inverse_logic:1;
-
-  // static data
-  static char _receive_buffer[_SS_MAX_RX_BUFF]; 
-  static volatile uint8_t _receive_buffer_tail;
-  static volatile uint8_t _receive_buffer_head;
-  static SoftwareSerial *active_object;
+  bool _inverse_logic;
+  volatile bool _buffer_overflow;
+
+  HardwareTimer* _hwtimer;
+  uint32_t _bit_q8; // bit time in 1/256 of timer tick
+
+  // RX
+  int8_t _rx_ch; // GPIOTE toggle channel, nRF52 allows only one per pin
+  int8_t _rx_ppi;
+  uint8_t _rx_level; // logical line level after last edge, 0 is space, 1 is mark
+  uint32_t _rx_edge_t;
+  bool _rx_active;
+  uint32_t _rx_t0;
+  uint8_t _edge_count;
+  uint16_t _edge_level;
+  uint32_t _edge_time[_SS_MAX_EDGES]; // relative to _rx_t0
+
+  uint8_t _receive_buffer[_SS_MAX_RX_BUFF];
+  volatile uint8_t _receive_buffer_tail;
+  volatile uint8_t _receive_buffer_head;
+
+  // TX
+  int8_t _tx_ch;
+  int8_t _tx_ppi[2]; // indexed by level of transition
+  volatile bool _tx_armed[2];
+  bool _tx_peek;
+  uint8_t _tx_level;
+  uint8_t _tx_bit;
+  uint16_t _tx_frame;
+  uint32_t _tx_t0;
+  uint32_t _tx_peek_time;
+  volatile uint32_t _tx_next_frame;
+
+  uint8_t _transmit_buffer[_SS_MAX_TX_BUFF];
+  volatile uint8_t _transmit_buffer_tail;
+  volatile uint8_t _transmit_buffer_head;
 
   // private methods
-  void recv();
-  uint32_t rx_pin_read();
-  void tx_pin_write(uint8_t pin_state) __attribute__((__always_inline__));
+  uint32_t now();
   void setTX(uint8_t transmitPin);
   void setRX(uint8_t receivePin);
-  void setRxIntMsk(bool enable) __attribute__((__always_inline__));
+  uint8_t rx_pin_level();
 
+  void rx_edge(uint32_t t, uint8_t level);
+  void rx_check_end();
+  void rx_frame_end();
+
+  bool tx_next();
+  void tx_fill();
 
 public:
   // public methods
@@ -74,7 +103,7 @@ public:
   void begin(long speed);
   bool listen();
   void end();
-  bool isListening() { return this == active_object; }
+  bool isListening() { return _rx_ch >= 0; }
   bool stopListening();
   bool overflow() { bool ret = _buffer_overflow; if (ret) _buffer_overflow = false; return ret; }
   int peek();
@@ -82,13 +111,15 @@ public:
   virtual size_t write(uint8_t byte);
   virtual int read();
   virtual int available();
+  virtual int availableForWrite();
   virtual void flush();
-  operator bool() { return true; }
-  
+  operator bool() { return _hwtimer != NULL; }
+
   using Print::write;
 
   // public only for easy access by interrupt handlers
-  static inline void handle_interrupt() __attribute__((__always_inline__));
+  void handle_gpiote(uint8_t ch);
+  void handle_timer();
 };
 
 #endif
@@ -10,8 +10,8 @@
  
  This example code is in the public domain.
  
- Software Serial will not work when Bluetooth Radio is active because the softdevice
- interrupts the library.
+ Bits are timed by hardware timer, so Software Serial keeps working
+ while Bluetooth Radio is active.
 
  */
 
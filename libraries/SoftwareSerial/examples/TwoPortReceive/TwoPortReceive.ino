@@ -4,12 +4,9 @@
  Receives from the two software serial ports,
  sends to the hardware serial port.
 
- In order to listen on a software port, you call port.listen().
- When using two software serial ports, you have to switch ports
- by listen()ing on each one in turn. Pick a logical time to switch
- ports, like the end of an expected transmission, or when the
- buffer is empty. This example switches ports when there is nothing
- more to read from a port
+ Each software port has its own hardware timer and receive buffer,
+ both ports listen at the same time. Use port.stopListening() and
+ port.listen() to pause and resume receiving on a port.
 
  The circuit:
  Two devices which communicate serially are needed.
@@ -18,9 +15,9 @@
 
  This example code is in the public domain.
 
- Software Serial will not work when Bluetooth Radio is active because the softdevice
- interrupts the library.
- 
+ Bits are timed by hardware timer, so Software Serial keeps working
+ while Bluetooth Radio is active. At most two ports can be used.
+
  */
 
 #include <Arduino.h>
@@ -45,10 +42,6 @@ void setup()
 
 void loop()
 {
-  // By default, the last intialized port is listening.
-  // when you want to listen on a port, explicitly select it:
-  portOne.listen();
-
   Serial.println("Data from port one:");
   // while there is data coming in, read it
   // and send to the hardware serial port:
@@ -60,11 +53,8 @@ void loop()
   // blank line to separate data from the two ports:
   Serial.println("");
 
-  // Now listen on the second port
-  portTwo.listen();
   // while there is data coming in, read it
   // and send to the hardware serial port:
-
   Serial.println("Data from port two:");
   while (portTwo.available() > 0) {
     char inByte = portTwo.read();
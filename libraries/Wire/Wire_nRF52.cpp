@@ -156,6 +156,8 @@ uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stopBit)
   size_t byteRead = 0;
   rxBuffer.clear();
 
+  SYSTRACE_START(SYSTRACE_WIRE, (address << 16) | 0x8000 | quantity);
+
   _p_twim->ADDRESS = address;
 
   _p_twim->TASKS_RESUME = 0x1UL;
@@ -182,6 +184,8 @@ uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stopBit)
     _p_twim->EVENTS_SUSPENDED = 0x0UL;
   }
 
+  SYSTRACE_STOP(SYSTRACE_WIRE, (address << 16) | 0x8000 | quantity);
+
   if (_p_twim->EVENTS_ERROR)
   {
     _p_twim->EVENTS_ERROR = 0x0UL;
@@ -215,6 +219,8 @@ uint8_t TwoWire::endTransmission(bool stopBit)
 {
   transmissionBegun = false ;
 
+  SYSTRACE_START(SYSTRACE_WIRE, (txAddress << 16) | txBuffer.available());
+
   // Start I2C transmission
   _p_twim->ADDRESS = txAddress;
 
@@ -248,6 +254,8 @@ uint8_t TwoWire::endTransmission(bool stopBit)
     _p_twim->EVENTS_SUSPENDED = 0x0UL;
   }
 
+  SYSTRACE_STOP(SYSTRACE_WIRE, (txAddress << 16) | txBuffer.available());
+
   if (_p_twim->EVENTS_ERROR)
   {
     _p_twim->EVENTS_ERROR = 0x0UL;
@@ -0,0 +1,141 @@
+"""Run a host benchmark and compare its BENCH lines against a baseline file.
+
+    bench_compare.py <benchmark> <baseline> [--update]
+
+Allocations and heap usage per op are exact on the host and must not exceed
+the baseline. Time is host wall clock, it only fails when slower than
+baseline * BENCH_TIME_TOLERANCE (environment, default 3, 0 to skip timing).
+
+SIM lines are figures of the simulated SoftDevice in virtual time, exact and
+repeatable: throughput (KB/s, B/s, report/s) fails below the baseline, any
+other unit above it, by more than BENCH_SIM_TOLERANCE (environment, relative,
+default 0.02). allocs/op must not exceed the baseline.
+With --update the baseline is rewritten from the current run.
+"""
+import os
+import re
+import subprocess
+import sys
+
+BENCH_RE = re.compile(r'^BENCH\s+(\S+)\s+([\d.]+) ns/op\s+([\d.]+) B/s\s+([\d.]+) allocs/op\s+(-?[\d.]+) heap B/op')
+SIM_RE = re.compile(r'^SIM\s+(\S+)\s+(-?[\d.]+)\s+(\S+)')
+
+# SIM units where a higher value is better
+SIM_HIGHER = ('KB/s', 'B/s', 'report/s')
+
+
+def parse(lines):
+    results = {}
+    for line in lines:
+        m = BENCH_RE.match(line)
+        if m:
+            results[m.group(1)] = {
+                'ns': float(m.group(2)),
+                'allocs': float(m.group(4)),
+                'heap': float(m.group(5)),
+            }
+    return results
+
+
+def parse_sim(lines):
+    results = {}
+    for line in lines:
+        m = SIM_RE.match(line)
+        if m:
+            results[m.group(1)] = (float(m.group(2)), m.group(3))
+    return results
+
+
+def compare_sim(current, baseline, tolerance):
+    failed = []
+    for name, (base, unit) in baseline.items():
+        cur = current.get(name)
+        if cur is None:
+            failed.append('{}: missing'.format(name))
+            continue
+
+        value = cur[0]
+        if unit == 'allocs/op':
+            worse = value > base + 0.0005
+        elif unit in SIM_HIGHER:
+            worse = value < base * (1 - tolerance)
+        else:
+            worse = value > base * (1 + tolerance) + 0.005
+
+        if worse:
+            failed.append('{}: {:.2f} {}, baseline {:.2f}'.format(name, value, unit, base))
+
+    for name in current:
+        if name not in baseline:
+            print('{}: not in baseline'.format(name))
+
+    return failed
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith('--')]
+    update = '--update' in sys.argv
+    if len(args) != 2:
+        print(__doc__)
+        return 2
+
+    bench, baseline_file = args
+    tolerance = float(os.environ.get('BENCH_TIME_TOLERANCE', '3'))
+    sim_tolerance = float(os.environ.get('BENCH_SIM_TOLERANCE', '0.02'))
+
+    run = subprocess.run([bench], stdout=subprocess.PIPE, universal_newlines=True)
+    sys.stdout.write(run.stdout)
+    if run.returncode != 0:
+        print('{} exited with {}'.format(bench, run.returncode))
+        return 1
+
+    lines = run.stdout.splitlines()
+    current = parse(lines)
+
+    if update:
+        with open(baseline_file, 'w') as f:
+            for line in lines:
+                if BENCH_RE.match(line) or SIM_RE.match(line):
+                    f.write(line + '\n')
+        print('baseline {} updated'.format(baseline_file))
+        return 0
+
+    with open(baseline_file) as f:
+        baseline_lines = f.read().splitlines()
+    baseline = parse(baseline_lines)
+    sim_baseline = parse_sim(baseline_lines)
+
+    failed = []
+    for name, base in baseline.items():
+        cur = current.get(name)
+        if cur is None:
+            failed.append('{}: missing'.format(name))
+            continue
+
+        if cur['allocs'] > base['allocs'] + 0.0005:
+            failed.append('{}: {:.3f} allocs/op, baseline {:.3f}'.format(name, cur['allocs'], base['allocs']))
+
+        if cur['heap'] > base['heap'] + 0.05:
+            failed.append('{}: {:.1f} heap B/op, baseline {:.1f}'.format(name, cur['heap'], base['heap']))
+
+        if tolerance > 0 and cur['ns'] > base['ns'] * tolerance:
+            failed.append('{}: {:.1f} ns/op, baseline {:.1f} (x{})'.format(name, cur['ns'], base['ns'], tolerance))
+
+    for name in current:
+        if name not in baseline:
+            print('{}: not in baseline'.format(name))
+
+    failed += compare_sim(parse_sim(lines), sim_baseline, sim_tolerance)
+
+    if failed:
+        print('\nRegressions against {}:'.format(baseline_file))
+        for f in failed:
+            print('  ' + f)
+        return 1
+
+    print('\n{} benchmarks within baseline'.format(len(baseline) + len(sim_baseline)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,305 @@
+#include <bluefruit.h>
+#include "sd_sim.h"
+#include "bench.h"
+
+// Host run of the ble_benchmark sketch (examples/DualRoles/ble_benchmark) on
+// the simulated SoftDevice, same configuration and case names. Link figures
+// are in virtual time, so they are exact and printed as
+//    SIM <name> <value> <unit>
+// next to the BENCH lines of the host CPU cost of event dispatch. Both are
+// checked against bench_ble.baseline by bench_compare.py
+
+// Number of MTU-sized packets sent for each notify/uart test
+#define PACKET_NUM      500
+
+// Duration of scanner test
+#define SCAN_TIME_MS    5000
+
+// Advertisers around, 100 ms interval each
+#define ADV_NUM         20
+
+BLEUart bleuart;
+
+BLEService        bench_svc(0x1234);
+BLECharacteristic bench_chr(0x1235);
+
+BLEClientUart clientUart;
+
+uint8_t test_data[BLE_GATT_ATT_MTU_MAX];
+
+static volatile uint16_t prph_hdl    = BLE_CONN_HANDLE_INVALID;
+static volatile uint16_t central_hdl = BLE_CONN_HANDLE_INVALID;
+
+static volatile uint32_t scan_count = 0;
+static volatile bool     scan_resume = true;
+
+static void print_result(const char* name, double value, const char* unit)
+{
+  printf("SIM   %-24s %12.2f %s\n", name, value, unit);
+}
+
+static void fail(const char* msg)
+{
+  printf("%s\n", msg);
+  exit(1);
+}
+
+#define WAIT_FOR(_cond, _ms) \
+  do { for (uint32_t _t = 0; !(_cond) && _t < (_ms); _t += 10) delay(10); } while(0)
+
+static void prph_connect_callback(uint16_t conn_hdl)
+{
+  prph_hdl = conn_hdl;
+}
+
+static void central_connect_callback(uint16_t conn_hdl)
+{
+  central_hdl = conn_hdl;
+}
+
+static void scan_callback(ble_gap_evt_adv_report_t* report)
+{
+  (void) report;
+  scan_count++;
+  if ( scan_resume ) Bluefruit.Scanner.resume();
+}
+
+//--------------------------------------------------------------------+
+// Setup, same as the sketch
+//--------------------------------------------------------------------+
+static void setup_ble(void)
+{
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+  Bluefruit.configCentralBandwidth(BANDWIDTH_MAX);
+  Bluefruit.begin(1, 1);
+  Bluefruit.setTxPower(4);
+  Bluefruit.Periph.setConnectCallback(prph_connect_callback);
+  Bluefruit.Central.setConnectCallback(central_connect_callback);
+
+  bleuart.begin();
+
+  bench_svc.begin();
+  bench_chr.setProperties(CHR_PROPS_NOTIFY);
+  bench_chr.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  bench_chr.setMaxLen(BLE_GATT_ATT_MTU_MAX - 3);
+  bench_chr.begin();
+
+  clientUart.begin();
+
+  Bluefruit.Scanner.setRxCallback(scan_callback);
+  Bluefruit.Scanner.setInterval(160, 80);
+
+  memset(test_data, 'a', sizeof(test_data));
+
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addTxPower();
+  Bluefruit.Advertising.addService(bleuart);
+  Bluefruit.ScanResponse.addName();
+  Bluefruit.Advertising.setInterval(32, 244);
+  Bluefruit.Advertising.start(0);
+}
+
+// Peer central connects, enables both notifications and gets the link to
+// its maximum like connect_callback() of the sketch
+static void connect_peer_central(void)
+{
+  sd_sim_peer_connect();
+  WAIT_FOR(prph_hdl != BLE_CONN_HANDLE_INVALID, 1000);
+  if ( prph_hdl == BLE_CONN_HANDLE_INVALID ) fail("peer central not connected");
+
+  BLEConnection* conn = Bluefruit.Connection(prph_hdl);
+  conn->requestPHY();
+  conn->requestDataLengthUpdate();
+  conn->requestMtuExchange(BLE_GATT_ATT_MTU_MAX);
+
+  // one ATT request at a time, as any central
+  uint8_t const notify[2] = { BLE_GATT_HVX_NOTIFICATION, 0 };
+  uint8_t const uuid_bench[] = { 0x35, 0x12 };
+
+  sd_sim_peer_write(prph_hdl, sd_sim_gatts_cccd_find(uuid_bench, 2), notify, 2, true);
+  WAIT_FOR(bench_chr.notifyEnabled(), 500);
+
+  sd_sim_peer_write(prph_hdl, sd_sim_gatts_cccd_find(BLEUART_UUID_CHR_TXD, 16), notify, 2, true);
+  WAIT_FOR(bleuart.notifyEnabled() && conn->getMtu() == BLE_GATT_ATT_MTU_MAX, 1000);
+
+  if ( !bench_chr.notifyEnabled() || !bleuart.notifyEnabled() ) fail("notify not enabled");
+  delay(500);
+
+  printf("MTU = %d, Interval = %.2f ms, PHY = %d, Data Length = %d\n",
+         conn->getMtu(), conn->getConnectionInterval()*1.25f, conn->getPHY(), conn->getDataLength());
+}
+
+//--------------------------------------------------------------------+
+// Link benchmarks in virtual time
+//--------------------------------------------------------------------+
+
+// Send PACKET_NUM MTU-sized packets with either characteristic notify or bleuart
+static void bench_notify(bool use_uart)
+{
+  BLEConnection* conn = Bluefruit.Connection(prph_hdl);
+
+  uint16_t const len = conn->getMtu() - 3;
+  uint32_t call_max_us = 0;
+  uint32_t sent = 0;
+
+  sd_sim_stats_reset();
+  uint32_t const allocs0 = bench_allocs();
+
+  uint32_t const start = micros();
+  for (uint32_t i = 0; i < PACKET_NUM && Bluefruit.connected(); i++)
+  {
+    uint32_t const call_start = micros();
+    bool ok = use_uart ? (bleuart.write(test_data, len) == len) : bench_chr.notify(test_data, len);
+    uint32_t const call_us = micros() - call_start;
+
+    if ( !ok ) break;
+
+    sent += len;
+    if ( call_us > call_max_us ) call_max_us = call_us;
+  }
+  if ( use_uart ) bleuart.flushTXD();
+  uint32_t const elapsed = micros() - start;
+  uint32_t const allocs = bench_allocs() - allocs0;
+
+  // wait for the last packets to reach the peer
+  delay(200);
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+
+  if ( sent != PACKET_NUM*len || stats.hvn_bytes != sent ) fail("notify: packets lost");
+
+  const char* prefix = use_uart ? "uart" : "notify";
+  char name[32];
+
+  sprintf(name, "%s_throughput", prefix);
+  print_result(name, (sent * 1000.0) / elapsed, "KB/s");
+
+  sprintf(name, "%s_avg_call", prefix);
+  print_result(name, ((double) elapsed * len) / sent, "us");
+
+  sprintf(name, "%s_max_call", prefix);
+  print_result(name, call_max_us, "us");
+
+  sprintf(name, "%s_latency_avg", prefix);
+  print_result(name, ((double) stats.hvn_latency_sum) / stats.hvn_count, "us");
+
+  sprintf(name, "%s_allocs", prefix);
+  print_result(name, ((double) allocs) / PACKET_NUM, "allocs/op");
+}
+
+static void add_advertisers(void)
+{
+  for (uint8_t i = 0; i < ADV_NUM; i++)
+  {
+    sd_sim_adv_t adv;
+    memset(&adv, 0, sizeof(adv));
+
+    adv.addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+    adv.addr.addr[0]   = i;
+    adv.addr.addr[5]   = 0xC0;
+    adv.interval       = 160;
+    adv.rssi           = (int8_t) (-40 - i*2);
+    adv.connectable    = (i == 0);
+    adv.len            = 3;
+    memcpy(adv.data, "\x02\x01\x06", 3);
+
+    sd_sim_advertiser_add(&adv);
+  }
+}
+
+static void bench_scanner(void)
+{
+  scan_count = 0;
+  sd_sim_stats_reset();
+
+  Bluefruit.Scanner.start(0);
+  delay(SCAN_TIME_MS);
+  Bluefruit.Scanner.stop();
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+
+  print_result("scan_reports", (scan_count * 1000.0) / SCAN_TIME_MS, "report/s");
+  print_result("scan_missed", stats.scan_missed, "packets");
+}
+
+// Central side: connect to the first advertiser and discover its uart
+static void bench_discovery(void)
+{
+  sd_sim_peer_service_add(BLEUART_UUID_SERVICE, 16);
+  sd_sim_peer_char_add(BLEUART_UUID_CHR_RXD, 16, CHR_PROPS_WRITE | CHR_PROPS_WRITE_WO_RESP, NULL, 0);
+  sd_sim_peer_char_add(BLEUART_UUID_CHR_TXD, 16, CHR_PROPS_NOTIFY, NULL, 0);
+
+  ble_gap_addr_t addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+  addr.addr[5]   = 0xC0;
+
+  Bluefruit.Central.connect(&addr);
+  WAIT_FOR(central_hdl != BLE_CONN_HANDLE_INVALID, 1000);
+  if ( central_hdl == BLE_CONN_HANDLE_INVALID ) fail("central not connected");
+
+  sd_sim_stats_reset();
+
+  uint32_t const start = millis();
+  if ( !clientUart.discover(central_hdl) ) fail("discovery failed");
+  uint32_t const elapsed = millis() - start;
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+
+  print_result("discovery_time", elapsed, "ms");
+  print_result("discovery_requests", stats.att_requests, "requests");
+}
+
+//--------------------------------------------------------------------+
+// Host cost of event dispatch
+//--------------------------------------------------------------------+
+static void bench_dispatch(void)
+{
+  static uint8_t adv_data[] = { 0x02, 0x01, 0x06, 0x05, 0x09, 'b', 'e', 'n', 'c' };
+
+  ble_evt_t evt;
+  memset(&evt, 0, sizeof(evt));
+  evt.header.evt_id  = BLE_GAP_EVT_ADV_REPORT;
+  evt.header.evt_len = sizeof(evt);
+  evt.evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+
+  ble_gap_evt_adv_report_t* report = &evt.evt.gap_evt.params.adv_report;
+  report->rssi = -60;
+  report->data.p_data = adv_data;
+  report->data.len    = sizeof(adv_data);
+
+  // report passed to the callback task, which resumes
+  scan_count = 0;
+  BENCH("scan_report_callback", 1000, 0, Bluefruit.Scanner._eventHandler(&evt) );
+  if ( scan_count != 1000*BENCH_REPEAT ) fail("scan_report_callback: callbacks missing");
+
+  // filtered out by RSSI, resumed right away
+  Bluefruit.Scanner.filterRssi(-50);
+  BENCH("scan_report_filtered", 10000, 0, Bluefruit.Scanner._eventHandler(&evt) );
+  Bluefruit.Scanner.clearFilters();
+}
+
+static int run(void)
+{
+  setup_ble();
+  connect_peer_central();
+
+  bench_notify(false);
+  bench_notify(true);
+
+  add_advertisers();
+  bench_scanner();
+  bench_discovery();
+
+  bench_dispatch();
+
+  return 0;
+}
+
+int main(void)
+{
+  return host_main(run);
+}
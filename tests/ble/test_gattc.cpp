@@ -0,0 +1,198 @@
+#include <bluefruit.h>
+#include "sd_sim.h"
+#include "unit.h"
+
+// Central role of Bluefruit52Lib on the simulated SoftDevice: connect to a
+// peer peripheral, discover its Nordic UART and Device Information services,
+// read, write and receive notifications
+
+BLEClientUart clientUart;
+BLEClientDis  clientDis;
+
+static ble_gap_addr_t _peer_addr;
+
+static volatile uint16_t _conn_hdl = BLE_CONN_HANDLE_INVALID;
+static volatile uint32_t _peer_rx_bytes;
+static uint8_t           _peer_rx_data[64];
+
+static uint16_t _rxd_handle;
+static uint16_t _txd_handle;
+
+static void connect_callback(uint16_t conn_hdl)
+{
+  _conn_hdl = conn_hdl;
+}
+
+static void disconnect_callback(uint16_t conn_hdl, uint8_t reason)
+{
+  (void) conn_hdl; (void) reason;
+  _conn_hdl = BLE_CONN_HANDLE_INVALID;
+}
+
+static void peer_rx(uint16_t conn_hdl, uint16_t handle, uint8_t const* data, uint16_t len)
+{
+  (void) conn_hdl;
+  if ( handle != _rxd_handle ) return;
+
+  memcpy(_peer_rx_data + _peer_rx_bytes, data, min((uint32_t) len, sizeof(_peer_rx_data) - _peer_rx_bytes));
+  _peer_rx_bytes += len;
+}
+
+#define WAIT_FOR(_cond, _ms) \
+  do { for (uint32_t _t = 0; !(_cond) && _t < (_ms); _t += 10) delay(10); } while(0)
+
+// Peer peripheral: advertiser and its GATT server
+static void setup_peer(void)
+{
+  sd_sim_adv_t adv;
+  memset(&adv, 0, sizeof(adv));
+
+  adv.addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+  memcpy(adv.addr.addr, "\x11\x22\x33\x44\x55\xC6", 6);
+  adv.interval    = 32;
+  adv.rssi        = -50;
+  adv.connectable = true;
+  adv.len         = 3;
+  memcpy(adv.data, "\x02\x01\x06", 3);
+
+  TEST_ASSERT(sd_sim_advertiser_add(&adv));
+  _peer_addr = adv.addr;
+
+  // Device Information first so that discovery has to skip a service
+  static uint8_t const UUID_DIS[]   = { 0x0A, 0x18 };
+  static uint8_t const UUID_MANUF[] = { 0x29, 0x2A };
+  static uint8_t const UUID_MODEL[] = { 0x24, 0x2A };
+
+  TEST_ASSERT(sd_sim_peer_service_add(UUID_DIS, 2));
+  TEST_ASSERT(sd_sim_peer_char_add(UUID_MANUF, 2, CHR_PROPS_READ, "Simulated Inc.", 14));
+  TEST_ASSERT(sd_sim_peer_char_add(UUID_MODEL, 2, CHR_PROPS_READ, "Peer v1", 7));
+
+  TEST_ASSERT(sd_sim_peer_service_add(BLEUART_UUID_SERVICE, 16));
+  _rxd_handle = sd_sim_peer_char_add(BLEUART_UUID_CHR_RXD, 16, CHR_PROPS_WRITE | CHR_PROPS_WRITE_WO_RESP, NULL, 0);
+  _txd_handle = sd_sim_peer_char_add(BLEUART_UUID_CHR_TXD, 16, CHR_PROPS_NOTIFY, NULL, 0);
+
+  TEST_ASSERT(_rxd_handle && _txd_handle);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static void test_connect(void)
+{
+  setup_peer();
+
+  TEST_ASSERT(Bluefruit.Central.connect(&_peer_addr));
+  WAIT_FOR(_conn_hdl != BLE_CONN_HANDLE_INVALID, 1000);
+
+  TEST_ASSERT(_conn_hdl != BLE_CONN_HANDLE_INVALID);
+  TEST_ASSERT(Bluefruit.Central.connected(_conn_hdl));
+
+  BLEConnection* conn = Bluefruit.Connection(_conn_hdl);
+  TEST_ASSERT(conn->requestMtuExchange(BLE_GATT_ATT_MTU_MAX));
+  WAIT_FOR(conn->getMtu() == BLE_GATT_ATT_MTU_MAX, 500);
+  TEST_ASSERT_EQUAL(BLE_GATT_ATT_MTU_MAX, conn->getMtu());
+}
+
+static void test_discover(void)
+{
+  sd_sim_stats_reset();
+
+  uint32_t const start = millis();
+  TEST_ASSERT(clientUart.discover(_conn_hdl));
+  TEST_ASSERT(clientDis.discover(_conn_hdl));
+
+  // every request waits for its response at the next connection events
+  TEST_ASSERT(millis() - start > 100);
+
+  TEST_ASSERT(clientUart.discovered());
+  TEST_ASSERT(clientDis.discovered());
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+  // NUS: service, characteristics, TXD descriptors. DIS: service only,
+  // its characteristics are discovered when read
+  TEST_ASSERT_EQUAL(4, stats.att_requests);
+}
+
+static void test_read(void)
+{
+  char buf[32] = { 0 };
+
+  TEST_ASSERT_EQUAL(14, clientDis.getManufacturer(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("Simulated Inc.", buf);
+
+  memset(buf, 0, sizeof(buf));
+  TEST_ASSERT_EQUAL(7, clientDis.getModel(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("Peer v1", buf);
+}
+
+static void test_uart_write(void)
+{
+  _peer_rx_bytes = 0;
+
+  TEST_ASSERT_EQUAL(5, clientUart.write((uint8_t const*) "hello", 5));
+  WAIT_FOR(_peer_rx_bytes == 5, 500);
+
+  TEST_ASSERT_EQUAL(5, _peer_rx_bytes);
+  TEST_ASSERT_EQUAL_MEMORY("hello", _peer_rx_data, 5);
+
+  uint8_t value[8];
+  TEST_ASSERT_EQUAL(5, sd_sim_peer_value(_rxd_handle, value, sizeof(value)));
+}
+
+static void test_uart_notify(void)
+{
+  // not before the CCCD is written
+  TEST_ASSERT(!sd_sim_peer_hvx(_conn_hdl, _txd_handle, "nope", 4, false));
+
+  // CCCD is written with a write command
+  TEST_ASSERT(clientUart.enableTXD());
+
+  uint8_t cccd[2] = { 0, 0 };
+  WAIT_FOR(sd_sim_peer_value(_txd_handle + 1, cccd, 2) == 2 && cccd[0], 500);
+  TEST_ASSERT_EQUAL(BLE_GATT_HVX_NOTIFICATION, cccd[0]);
+
+  TEST_ASSERT(sd_sim_peer_hvx(_conn_hdl, _txd_handle, "world", 5, false));
+  WAIT_FOR(clientUart.available() == 5, 500);
+
+  char buf[8] = { 0 };
+  TEST_ASSERT_EQUAL(5, clientUart.read(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("world", buf);
+}
+
+static void test_disconnect(void)
+{
+  Bluefruit.disconnect(_conn_hdl);
+  WAIT_FOR(_conn_hdl == BLE_CONN_HANDLE_INVALID, 1000);
+
+  TEST_ASSERT(_conn_hdl == BLE_CONN_HANDLE_INVALID);
+  TEST_ASSERT(!clientUart.discovered());
+  TEST_ASSERT(!clientDis.discovered());
+}
+
+static int run(void)
+{
+  Bluefruit.configCentralBandwidth(BANDWIDTH_MAX);
+  Bluefruit.begin(0, 1);
+  Bluefruit.Central.setConnectCallback(connect_callback);
+  Bluefruit.Central.setDisconnectCallback(disconnect_callback);
+
+  clientUart.begin();
+  clientDis.begin();
+
+  sd_sim_set_rx_callback(peer_rx);
+
+  RUN_TEST(test_connect);
+  RUN_TEST(test_discover);
+  RUN_TEST(test_read);
+  RUN_TEST(test_uart_write);
+  RUN_TEST(test_uart_notify);
+  RUN_TEST(test_disconnect);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,213 @@
+#include <bluefruit.h>
+#include "sd_sim.h"
+#include "unit.h"
+
+// Peripheral role of Bluefruit52Lib on the simulated SoftDevice: connection
+// from the peer central, notify, BLEUart in both directions and disconnect
+
+BLEUart bleuart;
+
+BLEService        test_svc(0x1234);
+BLECharacteristic test_chr(0x1235);
+
+static uint8_t const UUID_CHR[] = { 0x35, 0x12 };
+
+static volatile uint16_t _conn_hdl = BLE_CONN_HANDLE_INVALID;
+static volatile uint8_t  _disconnect_reason;
+
+static volatile uint32_t _peer_rx_count;
+static volatile uint32_t _peer_rx_bytes;
+
+static void connect_callback(uint16_t conn_hdl)
+{
+  _conn_hdl = conn_hdl;
+}
+
+static void disconnect_callback(uint16_t conn_hdl, uint8_t reason)
+{
+  (void) conn_hdl;
+  _conn_hdl = BLE_CONN_HANDLE_INVALID;
+  _disconnect_reason = reason;
+}
+
+static void peer_rx(uint16_t conn_hdl, uint16_t handle, uint8_t const* data, uint16_t len)
+{
+  (void) conn_hdl; (void) handle; (void) data;
+  _peer_rx_count++;
+  _peer_rx_bytes += len;
+}
+
+// Wait up to ms of virtual time for cond
+#define WAIT_FOR(_cond, _ms) \
+  do { for (uint32_t _t = 0; !(_cond) && _t < (_ms); _t += 10) delay(10); } while(0)
+
+static void peer_enable_notify(uint8_t const* uuid, uint8_t uuid_len)
+{
+  uint16_t const cccd = sd_sim_gatts_cccd_find(uuid, uuid_len);
+  uint8_t const value[2] = { BLE_GATT_HVX_NOTIFICATION, 0 };
+  sd_sim_peer_write(_conn_hdl, cccd, value, 2, true);
+}
+
+static void setup_ble(void)
+{
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+  Bluefruit.begin(1, 1);
+  Bluefruit.Periph.setConnectCallback(connect_callback);
+  Bluefruit.Periph.setDisconnectCallback(disconnect_callback);
+
+  bleuart.begin();
+
+  test_svc.begin();
+  test_chr.setProperties(CHR_PROPS_NOTIFY | CHR_PROPS_READ);
+  test_chr.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  test_chr.setMaxLen(BLE_GATT_ATT_MTU_MAX - 3);
+  test_chr.begin();
+
+  Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
+  Bluefruit.Advertising.addService(bleuart);
+  Bluefruit.Advertising.restartOnDisconnect(true);
+  Bluefruit.Advertising.setInterval(32, 244);
+  Bluefruit.Advertising.start(0);
+
+  sd_sim_set_rx_callback(peer_rx);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static void test_connect(void)
+{
+  sd_sim_peer_connect();
+  WAIT_FOR(_conn_hdl != BLE_CONN_HANDLE_INVALID, 1000);
+
+  TEST_ASSERT(_conn_hdl != BLE_CONN_HANDLE_INVALID);
+  TEST_ASSERT(Bluefruit.connected());
+  TEST_ASSERT(!Bluefruit.Advertising.isRunning());
+
+  BLEConnection* conn = Bluefruit.Connection(_conn_hdl);
+  TEST_ASSERT(conn != NULL);
+  TEST_ASSERT_EQUAL(BLE_GATT_ATT_MTU_DEFAULT, conn->getMtu());
+
+  // peer central starts the MTU exchange
+  sd_sim_peer_exchange_mtu(_conn_hdl, BLE_GATT_ATT_MTU_MAX);
+  WAIT_FOR(conn->getMtu() == BLE_GATT_ATT_MTU_MAX, 500);
+  TEST_ASSERT_EQUAL(BLE_GATT_ATT_MTU_MAX, conn->getMtu());
+
+  conn->requestDataLengthUpdate();
+  conn->requestPHY();
+  delay(500);
+  TEST_ASSERT_EQUAL(251, conn->getDataLength());
+  TEST_ASSERT_EQUAL(BLE_GAP_PHY_2MBPS, conn->getPHY());
+}
+
+static void test_notify_requires_cccd(void)
+{
+  uint8_t data[4] = { 1, 2, 3, 4 };
+
+  TEST_ASSERT(!test_chr.notifyEnabled());
+  TEST_ASSERT(!test_chr.notify(data, sizeof(data)));
+
+  peer_enable_notify(UUID_CHR, sizeof(UUID_CHR));
+  WAIT_FOR(test_chr.notifyEnabled(), 500);
+  TEST_ASSERT(test_chr.notifyEnabled());
+}
+
+static void test_notify(void)
+{
+  sd_sim_stats_reset();
+  _peer_rx_count = _peer_rx_bytes = 0;
+
+  uint16_t const len = Bluefruit.Connection(_conn_hdl)->getMtu() - 3;
+  uint8_t data[BLE_GATT_ATT_MTU_MAX];
+  memset(data, 'a', sizeof(data));
+
+  // more than the hvn queue: notify() blocks for TX complete
+  for (int i = 0; i < 100; i++)
+  {
+    TEST_ASSERT(test_chr.notify(data, len));
+  }
+
+  delay(200);
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+
+  TEST_ASSERT_EQUAL(100, _peer_rx_count);
+  TEST_ASSERT_EQUAL(100*len, _peer_rx_bytes);
+  TEST_ASSERT_EQUAL(100, stats.hvn_count);
+  TEST_ASSERT(stats.hvn_latency_max > 0);
+  TEST_ASSERT_EQUAL(0, stats.evt_dropped);
+
+  // value is kept by the SoftDevice
+  uint8_t buf[4];
+  TEST_ASSERT_EQUAL(4, test_chr.read(buf, 4));
+  TEST_ASSERT_EQUAL_MEMORY(data, buf, 4);
+}
+
+static void test_uart(void)
+{
+  peer_enable_notify(BLEUART_UUID_CHR_TXD, 16);
+  WAIT_FOR(bleuart.notifyEnabled(), 500);
+  TEST_ASSERT(bleuart.notifyEnabled());
+
+  // TX: packed into MTU-sized notifications
+  _peer_rx_bytes = 0;
+  char const msg[] = "hello from bleuart";
+  TEST_ASSERT_EQUAL(sizeof(msg)-1, bleuart.write(msg, sizeof(msg)-1));
+  bleuart.flushTXD();
+  delay(100);
+  TEST_ASSERT_EQUAL(sizeof(msg)-1, _peer_rx_bytes);
+
+  // RX: write command from peer into the rx fifo
+  uint16_t const rxd = sd_sim_gatts_value_find(BLEUART_UUID_CHR_RXD, 16);
+  TEST_ASSERT(rxd != 0);
+  TEST_ASSERT(sd_sim_peer_write(_conn_hdl, rxd, "ping", 4, false));
+  WAIT_FOR(bleuart.available() == 4, 500);
+
+  char buf[8] = { 0 };
+  TEST_ASSERT_EQUAL(4, bleuart.read(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("ping", buf);
+}
+
+static void test_disconnect(void)
+{
+  sd_sim_peer_disconnect(_conn_hdl, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+  WAIT_FOR(_conn_hdl == BLE_CONN_HANDLE_INVALID, 1000);
+
+  TEST_ASSERT(_conn_hdl == BLE_CONN_HANDLE_INVALID);
+  TEST_ASSERT_EQUAL(BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION, _disconnect_reason);
+  TEST_ASSERT(!Bluefruit.connected());
+
+  // restarted on disconnect
+  delay(100);
+  TEST_ASSERT(Bluefruit.Advertising.isRunning());
+
+  // CCCD are not kept without bonding
+  sd_sim_peer_connect();
+  WAIT_FOR(_conn_hdl != BLE_CONN_HANDLE_INVALID, 1000);
+  TEST_ASSERT(_conn_hdl != BLE_CONN_HANDLE_INVALID);
+  TEST_ASSERT(!test_chr.notifyEnabled());
+
+  // local disconnect
+  Bluefruit.disconnect(_conn_hdl);
+  WAIT_FOR(_conn_hdl == BLE_CONN_HANDLE_INVALID, 1000);
+  TEST_ASSERT_EQUAL(BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION, _disconnect_reason);
+}
+
+static int run(void)
+{
+  setup_ble();
+
+  RUN_TEST(test_connect);
+  RUN_TEST(test_notify_requires_cccd);
+  RUN_TEST(test_notify);
+  RUN_TEST(test_uart);
+  RUN_TEST(test_disconnect);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
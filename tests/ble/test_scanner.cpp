@@ -0,0 +1,184 @@
+#include <bluefruit.h>
+#include "sd_sim.h"
+#include "unit.h"
+
+// BLEScanner on the simulated SoftDevice: report dispatch through the
+// callback task, filters resuming the scan, missed packets while paused
+// and timeout
+
+static volatile uint32_t _report_count;
+static volatile uint32_t _report_near;
+static volatile uint32_t _stop_count;
+static volatile bool     _resume = true;
+static uint8_t           _last_name[32];
+
+static void scan_callback(ble_gap_evt_adv_report_t* report)
+{
+  _report_count++;
+  if ( report->rssi >= -50 ) _report_near++;
+
+  memset(_last_name, 0, sizeof(_last_name));
+  Bluefruit.Scanner.parseReportByType(report, BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME, _last_name, sizeof(_last_name)-1);
+
+  if ( _resume ) Bluefruit.Scanner.resume();
+}
+
+static void stop_callback(void)
+{
+  _stop_count++;
+}
+
+// Connectable advertiser with flags and complete name, 100 ms interval
+static void add_advertiser(uint8_t id, int8_t rssi, const char* name)
+{
+  sd_sim_adv_t adv;
+  memset(&adv, 0, sizeof(adv));
+
+  adv.addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+  adv.addr.addr[0]   = id;
+  adv.addr.addr[5]   = 0xC0;
+  adv.interval       = 160;
+  adv.rssi           = rssi;
+  adv.connectable    = true;
+
+  uint8_t const name_len = (uint8_t) strlen(name);
+  uint8_t* p = adv.data;
+
+  *p++ = 2;
+  *p++ = BLE_GAP_AD_TYPE_FLAGS;
+  *p++ = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+  *p++ = (uint8_t) (name_len + 1);
+  *p++ = BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME;
+  memcpy(p, name, name_len);
+  p += name_len;
+
+  adv.len = (uint8_t) (p - adv.data);
+
+  TEST_ASSERT(sd_sim_advertiser_add(&adv));
+}
+
+static void reset_counters(void)
+{
+  _report_count = _report_near = _stop_count = 0;
+  _resume = true;
+  sd_sim_stats_reset();
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static void test_reports(void)
+{
+  reset_counters();
+  add_advertiser(1, -40, "near");
+  add_advertiser(2, -80, "far");
+
+  // scan window is the whole interval
+  Bluefruit.Scanner.setInterval(160, 160);
+  TEST_ASSERT(Bluefruit.Scanner.start(0));
+  TEST_ASSERT(Bluefruit.Scanner.isRunning());
+
+  delay(1000);
+  TEST_ASSERT(Bluefruit.Scanner.stop());
+  TEST_ASSERT(!Bluefruit.Scanner.isRunning());
+
+  // two advertisers at ~100 ms (+ advDelay) for 1 s
+  TEST_ASSERT(_report_count >= 16 && _report_count <= 20);
+  TEST_ASSERT(_report_near >= 8 && _report_near < _report_count);
+  TEST_ASSERT(strcmp((char*) _last_name, "near") == 0 || strcmp((char*) _last_name, "far") == 0);
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+  TEST_ASSERT_EQUAL(_report_count, stats.scan_reports);
+  TEST_ASSERT_EQUAL(0, stats.scan_missed);
+
+  // nothing once stopped
+  uint32_t const count = _report_count;
+  delay(500);
+  TEST_ASSERT_EQUAL(count, _report_count);
+}
+
+static void test_filter_resumes(void)
+{
+  reset_counters();
+
+  // filtered reports never reach the callback but scanning goes on
+  Bluefruit.Scanner.filterRssi(-60);
+  Bluefruit.Scanner.start(0);
+  delay(1000);
+  Bluefruit.Scanner.stop();
+  Bluefruit.Scanner.clearFilters();
+
+  TEST_ASSERT(_report_count >= 8 && _report_count <= 10);
+  TEST_ASSERT_EQUAL(_report_count, _report_near);
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+  TEST_ASSERT(stats.scan_reports >= 16);
+  TEST_ASSERT_EQUAL(0, stats.scan_missed);
+}
+
+static void test_paused_without_resume(void)
+{
+  reset_counters();
+
+  // callback does not resume: SoftDevice holds the buffer, packets are missed
+  _resume = false;
+  Bluefruit.Scanner.start(0);
+  delay(1000);
+
+  TEST_ASSERT_EQUAL(1, _report_count);
+
+  sd_sim_stats_t stats;
+  sd_sim_stats(&stats);
+  TEST_ASSERT(stats.scan_missed >= 15);
+
+  // resume picks up again
+  _resume = true;
+  Bluefruit.Scanner.resume();
+  delay(500);
+  TEST_ASSERT(_report_count >= 8);
+
+  Bluefruit.Scanner.stop();
+}
+
+static void test_timeout(void)
+{
+  reset_counters();
+
+  // in 10 ms unit
+  TEST_ASSERT(Bluefruit.Scanner.start(50));
+  delay(400);
+  TEST_ASSERT(Bluefruit.Scanner.isRunning());
+  TEST_ASSERT_EQUAL(0, _stop_count);
+
+  delay(200);
+  TEST_ASSERT(!Bluefruit.Scanner.isRunning());
+  TEST_ASSERT_EQUAL(1, _stop_count);
+
+  uint32_t const count = _report_count;
+  TEST_ASSERT(count > 0);
+  delay(500);
+  TEST_ASSERT_EQUAL(count, _report_count);
+
+  sd_sim_advertiser_clear();
+}
+
+static int run(void)
+{
+  Bluefruit.begin(0, 1);
+  Bluefruit.Scanner.setRxCallback(scan_callback);
+  Bluefruit.Scanner.setStopCallback(stop_callback);
+
+  RUN_TEST(test_reports);
+  RUN_TEST(test_filter_resumes);
+  RUN_TEST(test_paused_without_resume);
+  RUN_TEST(test_timeout);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
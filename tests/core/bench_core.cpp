@@ -0,0 +1,187 @@
+#include "Arduino.h"
+#include "RingBuffer.h"
+#include "utility/adafruit_fifo.h"
+#include "bench.h"
+
+// Host run of the core_benchmark sketch (examples/Hardware/core_benchmark),
+// same cases and names so that results can be compared with the target.
+// Output is checked against bench_core.baseline by bench_compare.py
+
+#define ITERATIONS    10000
+
+// Print sink that discards everything, only counts bytes
+class NullPrint : public Print
+{
+  public:
+    size_t count = 0;
+    virtual size_t write(uint8_t b) { (void) b; count++; return 1; }
+};
+
+// Print sink with bulk write, counts calls like a Serial/BLEUart transfer
+class NullBulkPrint : public NullPrint
+{
+  public:
+    size_t calls = 0;
+    virtual size_t write(uint8_t b) { calls++; return NullPrint::write(b); }
+    virtual size_t write(const uint8_t* buf, size_t len) { (void) buf; calls++; count += len; return len; }
+    using Print::write;
+};
+
+// Stream that endlessly replays a string, used to benchmark parsing
+class ReplayStream : public Stream
+{
+  public:
+    ReplayStream(const char* str) : _str(str), _pos(0) { }
+
+    virtual int available(void) { return 1; }
+    virtual int peek(void)      { return _str[_pos]; }
+    virtual int read(void)
+    {
+      int ch = _str[_pos++];
+      if ( _str[_pos] == 0 ) _pos = 0;
+      return ch;
+    }
+    virtual void flush(void) { }
+    virtual size_t write(uint8_t b) { (void) b; return 0; }
+
+  private:
+    const char* _str;
+    uint16_t _pos;
+};
+
+static NullPrint nullPrint;
+static NullBulkPrint bulkPrint;
+static BufferedPrintN<64> bufPrint(bulkPrint);
+static volatile uint32_t cb_count = 0;
+
+static void adacb_counter(uint32_t arg)
+{
+  (void) arg;
+  cb_count++;
+}
+
+static void bench_ringbuffer(void)
+{
+  RingBuffer rb;
+
+  BENCH("ringbuffer_store_read", ITERATIONS, 1,
+    rb.store_char((uint8_t) _i);
+    (void) rb.read_char();
+  );
+}
+
+static void bench_fifo(void)
+{
+  uint8_t buf[64];
+  memset(buf, 0x55, sizeof(buf));
+
+  Adafruit_FIFO fifo(1);
+  fifo.begin(256);
+
+  BENCH("fifo_write_read_1", ITERATIONS, 1,
+    fifo.write(buf, 1);
+    fifo.read(buf, 1);
+  );
+
+  BENCH("fifo_write_read_64", ITERATIONS, 64,
+    fifo.write(buf, 64);
+    fifo.read(buf, 64);
+  );
+}
+
+static void bench_print(void)
+{
+  BENCH("print_int", ITERATIONS, 0, nullPrint.print(-1234567));
+  BENCH("print_hex", ITERATIONS, 0, nullPrint.print(0xDEADBEEFUL, HEX));
+  BENCH("print_float", ITERATIONS, 0, nullPrint.print(3.14159F, 4));
+  BENCH("print_str", ITERATIONS, 16, nullPrint.print("0123456789abcdef"));
+  BENCH("printf", ITERATIONS, 0, nullPrint.printf("t=%lu v=%d", (unsigned long) _i, 42));
+
+  // A typical log line: unbuffered vs BufferedPrint, both to a bulk sink
+  BENCH("print_line", ITERATIONS, 0,
+    bulkPrint.print("t="); bulkPrint.print(_i); bulkPrint.print(" v="); bulkPrint.println(23.456F, 3);
+  );
+
+  BENCH("buffered_print_line", ITERATIONS, 0,
+    bufPrint.print("t="); bufPrint.print(_i); bufPrint.print(" v="); bufPrint.println(23.456F, 3);
+  );
+  bufPrint.flush();
+
+  BENCH("buffered_printf", ITERATIONS, 0, bufPrint.printf("t=%lu v=%d\n", (unsigned long) _i, 42));
+  bufPrint.flush();
+}
+
+static void bench_string(void)
+{
+  BENCH("string_from_int", ITERATIONS, 0, String s(_i); (void) s.length() );
+
+  BENCH("string_concat", ITERATIONS, 0,
+    String s("temp=");
+    s += 25;
+    s += ",hum=";
+    s += 60;
+    (void) s.length();
+  );
+
+  BENCH("string_format_float", ITERATIONS, 0, String s(23.456F, 2); (void) s.length() );
+
+  // Telemetry line built from temporaries, heap vs per-scope arena
+  BENCH("string_telemetry", ITERATIONS, 0,
+    String s = "t=" + String(_i) + ",temp=" + String(23.456F, 2) + ",status=ok";
+    (void) s.length();
+  );
+
+  BENCH("string_telemetry_arena", ITERATIONS, 0,
+    StringArenaN<128> arena;
+    String s = "t=" + String(_i) + ",temp=" + String(23.456F, 2) + ",status=ok";
+    (void) s.length();
+  );
+}
+
+static void bench_itoa(void)
+{
+  char buf[16];
+  BENCH("itoa_dec", ITERATIONS, 0, itoa((int) _i * 12345, buf, 10) );
+  BENCH("utoa_hex", ITERATIONS, 0, utoa(_i * 0x10001, buf, 16) );
+}
+
+static void bench_stream(void)
+{
+  ReplayStream stream("12345,-678,3.25\n");
+  stream.setTimeout(0);
+
+  BENCH("stream_parse_int", ITERATIONS, 0, (void) stream.parseInt() );
+  BENCH("stream_parse_float", ITERATIONS, 0, (void) stream.parseFloat() );
+}
+
+static void bench_adacallback(void)
+{
+  cb_count = 0;
+
+  // queue and execute: the Callback task has higher priority than loop
+  BENCH("adacallback_queue", 1000, 0, ada_callback(NULL, 0, adacb_counter, _i) );
+
+  if ( cb_count != 1000*BENCH_REPEAT )
+  {
+    printf("adacallback: %lu callbacks executed\n", (unsigned long) cb_count);
+    exit(1);
+  }
+}
+
+static int run(void)
+{
+  bench_ringbuffer();
+  bench_fifo();
+  bench_print();
+  bench_string();
+  bench_itoa();
+  bench_stream();
+  bench_adacallback();
+
+  return 0;
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,147 @@
+#include "Arduino.h"
+#include "unit.h"
+
+#define CB_MAX    200
+
+static volatile uint32_t _count;
+static uint32_t _args[CB_MAX][3];
+static uint8_t  _data[CB_MAX][8];
+static TaskHandle_t _cb_task;
+
+static void cb_args(uint32_t a, uint32_t b, uint32_t c)
+{
+  _cb_task = xTaskGetCurrentTaskHandle();
+
+  if ( _count < CB_MAX )
+  {
+    _args[_count][0] = a;
+    _args[_count][1] = b;
+    _args[_count][2] = c;
+  }
+  _count++;
+}
+
+static void cb_data(uint8_t* data, uint32_t len)
+{
+  if ( _count < CB_MAX ) memcpy(_data[_count], data, len);
+  _count++;
+}
+
+static void wait_count(uint32_t count)
+{
+  uint32_t const start = millis();
+  while ( _count < count && millis() - start < 1000 ) delay(1);
+}
+
+// Callback task has higher priority than loop, callback runs right away
+static void test_invoke_args(void)
+{
+  _count = 0;
+
+  TEST_ASSERT(ada_callback(NULL, 0, cb_args, 1, 2, 3));
+  wait_count(1);
+
+  TEST_ASSERT_EQUAL(1, _count);
+  TEST_ASSERT_EQUAL(1, _args[0][0]);
+  TEST_ASSERT_EQUAL(2, _args[0][1]);
+  TEST_ASSERT_EQUAL(3, _args[0][2]);
+  TEST_ASSERT(_cb_task != xTaskGetCurrentTaskHandle());
+  TEST_ASSERT_EQUAL_STRING("Callbac", pcTaskGetName(_cb_task)); // configMAX_TASK_NAME_LEN
+}
+
+// data is copied, so it can be a local variable, and freed after the call
+static void test_malloced_data(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  _count = 0;
+  {
+    uint8_t local[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    TEST_ASSERT(ada_callback(local, sizeof(local), cb_data, local, sizeof(local)));
+    memset(local, 0, sizeof(local));
+  }
+  wait_count(1);
+
+  uint8_t const expected[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  TEST_ASSERT_EQUAL(1, _count);
+  TEST_ASSERT_EQUAL_MEMORY(expected, _data[0], 8);
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.tag_blocks[HEAP_TAG_CALLBACK], after.tag_blocks[HEAP_TAG_CALLBACK]);
+}
+
+//--------------------------------------------------------------------+
+// More callbacks than the queue depth from a task that the callback task
+// can not preempt: sender blocks until the queue is drained
+//--------------------------------------------------------------------+
+static volatile bool _sender_done;
+
+static void sender_task(void* arg)
+{
+  (void) arg;
+
+  for(uint32_t i=0; i<CB_MAX; i++) ada_callback(NULL, 0, cb_args, i, ~i, 0);
+
+  _sender_done = true;
+  vTaskDelete(NULL);
+}
+
+static void test_queue_full(void)
+{
+  _count = 0;
+  _sender_done = false;
+
+  xTaskCreate(sender_task, "sender", 256, NULL, TASK_PRIO_HIGH, NULL);
+  wait_count(CB_MAX);
+
+  TEST_ASSERT(_sender_done);
+  TEST_ASSERT_EQUAL(CB_MAX, _count);
+
+  for(uint32_t i=0; i<CB_MAX; i++)
+  {
+    TEST_ASSERT_EQUAL(i, _args[i][0]);
+    TEST_ASSERT_EQUAL(~i, _args[i][1]);
+  }
+}
+
+//--------------------------------------------------------------------+
+// From interrupt
+//--------------------------------------------------------------------+
+static void swi_handler(void)
+{
+  TEST_ASSERT(isInISR());
+  ada_callback(NULL, 0, cb_args, 7, 8, 9);
+}
+
+static void test_from_isr(void)
+{
+  _count = 0;
+
+  host_irq_attach(SWI0_EGU0_IRQn, swi_handler);
+  NVIC_EnableIRQ(SWI0_EGU0_IRQn);
+  NVIC_SetPendingIRQ(SWI0_EGU0_IRQn);
+
+  wait_count(1);
+
+  TEST_ASSERT(!isInISR());
+  TEST_ASSERT_EQUAL(1, _count);
+  TEST_ASSERT_EQUAL(7, _args[0][0]);
+
+  NVIC_DisableIRQ(SWI0_EGU0_IRQn);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_invoke_args);
+  RUN_TEST(test_malloced_data);
+  RUN_TEST(test_queue_full);
+  RUN_TEST(test_from_isr);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,155 @@
+#include "Arduino.h"
+#include "utility/adafruit_fifo.h"
+#include "unit.h"
+
+static void test_write_read(void)
+{
+  Adafruit_FIFO fifo(2);
+  fifo.begin(8);
+
+  uint16_t in[5] = { 1, 2, 3, 4, 5 };
+  uint16_t out[5] = { 0 };
+
+  TEST_ASSERT(fifo.empty());
+  TEST_ASSERT_EQUAL(5, fifo.write(in, 5));
+  TEST_ASSERT_EQUAL(5, fifo.count());
+  TEST_ASSERT_EQUAL(3, fifo.remaining());
+
+  TEST_ASSERT_EQUAL(5, fifo.read(out, 10));
+  TEST_ASSERT_EQUAL_MEMORY(in, out, sizeof(in));
+  TEST_ASSERT(fifo.empty());
+}
+
+static void test_full(void)
+{
+  Adafruit_FIFO fifo(1);
+  fifo.begin(4);
+
+  uint8_t in[6] = { 1, 2, 3, 4, 5, 6 };
+  uint8_t out[6];
+
+  TEST_ASSERT_EQUAL(4, fifo.write(in, 6));
+  TEST_ASSERT(fifo.full());
+  TEST_ASSERT_EQUAL(0, fifo.write(in, 1));
+
+  TEST_ASSERT_EQUAL(4, fifo.read(out, 6));
+  TEST_ASSERT_EQUAL_MEMORY(in, out, 4);
+}
+
+// only the last depth items remain
+static void test_overwrite(void)
+{
+  Adafruit_FIFO fifo(1);
+  fifo.begin(4);
+  fifo.overwriteIfFull(true);
+
+  uint8_t in[6] = { 1, 2, 3, 4, 5, 6 };
+  uint8_t out[4];
+
+  TEST_ASSERT_EQUAL(3, fifo.write(in, 3));
+  TEST_ASSERT_EQUAL(3, fifo.write(in+3, 3));
+  TEST_ASSERT_EQUAL(4, fifo.count());
+  TEST_ASSERT_EQUAL(4, fifo.read(out, 4));
+  TEST_ASSERT_EQUAL_MEMORY(in+2, out, 4);
+
+  TEST_ASSERT_EQUAL(6, fifo.write(in, 6));
+  TEST_ASSERT_EQUAL(4, fifo.read(out, 4));
+  TEST_ASSERT_EQUAL_MEMORY(in+2, out, 4);
+}
+
+static void test_peek(void)
+{
+  Adafruit_FIFO fifo(1);
+  fifo.begin(4);
+
+  uint8_t in[3] = { 7, 8, 9 };
+  uint8_t c = 0;
+
+  fifo.write(in, 3);
+  TEST_ASSERT(fifo.peek(&c));
+  TEST_ASSERT_EQUAL(7, c);
+  TEST_ASSERT(fifo.peekAt(2, &c));
+  TEST_ASSERT_EQUAL(9, c);
+  TEST_ASSERT(!fifo.peekAt(3, &c));
+  TEST_ASSERT_EQUAL(3, fifo.count());
+}
+
+// span stops at the end of the buffer when data wraps around
+static void test_spans(void)
+{
+  Adafruit_FIFO fifo(1);
+  fifo.begin(8);
+
+  uint8_t buf[8];
+  memset(buf, 0xAA, sizeof(buf));
+
+  fifo.write(buf, 6);
+  fifo.read(buf, 6);
+  fifo.write("abcde", 5);
+
+  void* ptr;
+  TEST_ASSERT_EQUAL(2, fifo.getReadSpan(&ptr));
+  TEST_ASSERT_EQUAL_MEMORY("ab", ptr, 2);
+  fifo.advanceRead(2);
+
+  TEST_ASSERT_EQUAL(3, fifo.getReadSpan(&ptr));
+  TEST_ASSERT_EQUAL_MEMORY("cde", ptr, 3);
+
+  TEST_ASSERT_EQUAL(5, fifo.getWriteSpan(&ptr));
+  memcpy(ptr, "fg", 2);
+  fifo.advanceWrite(2);
+
+  TEST_ASSERT_EQUAL(5, fifo.read(buf, 8));
+  TEST_ASSERT_EQUAL_MEMORY("cdefg", buf, 5);
+}
+
+static void test_wrap_around(void)
+{
+  Adafruit_FIFO fifo(4);
+  fifo.begin(5);
+
+  for(uint32_t i=0; i<100; i++)
+  {
+    uint32_t in[2] = { i, ~i };
+    uint32_t out[2];
+
+    TEST_ASSERT_EQUAL(2, fifo.write(in, 2));
+    TEST_ASSERT_EQUAL(2, fifo.read(out, 2));
+    TEST_ASSERT_EQUAL_MEMORY(in, out, sizeof(in));
+  }
+}
+
+static void test_heap_tag(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  {
+    Adafruit_FIFO fifo(1);
+    fifo.begin(100);
+
+    rtos_heap_stats(&after);
+    TEST_ASSERT(after.tag_used[HEAP_TAG_FIFO] >= before.tag_used[HEAP_TAG_FIFO] + 100);
+  }
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.tag_used[HEAP_TAG_FIFO], after.tag_used[HEAP_TAG_FIFO]);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_write_read);
+  RUN_TEST(test_full);
+  RUN_TEST(test_overwrite);
+  RUN_TEST(test_peek);
+  RUN_TEST(test_spans);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_heap_tag);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
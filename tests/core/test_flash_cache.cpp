@@ -0,0 +1,158 @@
+#include "Arduino.h"
+#include "flash/flash_cache.h"
+#include "unit.h"
+
+// In-memory flash: erase sets page to 0xff, program can only clear bits
+#define FLASH_PAGES   4
+
+static uint8_t  _flash[FLASH_PAGES*FLASH_CACHE_SIZE];
+static uint8_t  _cache_buf[FLASH_CACHE_SIZE];
+static uint32_t _erase_count, _program_count, _read_count;
+
+static bool mem_erase(uint32_t addr)
+{
+  _erase_count++;
+  memset(_flash + addr, 0xff, FLASH_CACHE_SIZE);
+  return true;
+}
+
+static uint32_t mem_program(uint32_t dst, void const* src, uint32_t len)
+{
+  _program_count++;
+  for(uint32_t i=0; i<len; i++) _flash[dst+i] &= ((uint8_t const*) src)[i];
+  return len;
+}
+
+static uint32_t mem_read(void* dst, uint32_t src, uint32_t len)
+{
+  _read_count++;
+  memcpy(dst, _flash + src, len);
+  return len;
+}
+
+static bool mem_verify(uint32_t addr, void const* buf, uint32_t len)
+{
+  return 0 == memcmp(_flash + addr, buf, len);
+}
+
+static flash_cache_t _fc =
+{
+  .erase      = mem_erase,
+  .program    = mem_program,
+  .read       = mem_read,
+  .verify     = mem_verify,
+  .cache_addr = FLASH_CACHE_INVALID_ADDR,
+  .cache_buf  = _cache_buf,
+};
+
+static void reset(void)
+{
+  memset(_flash, 0xff, sizeof(_flash));
+  _fc.cache_addr = FLASH_CACHE_INVALID_ADDR;
+  _erase_count = _program_count = _read_count = 0;
+}
+
+static void test_write_is_cached(void)
+{
+  reset();
+
+  TEST_ASSERT_EQUAL(5, flash_cache_write(&_fc, 100, "hello", 5));
+  TEST_ASSERT_EQUAL(0, _erase_count);
+  TEST_ASSERT_EQUAL(0xff, _flash[100]);
+
+  // read back through cache
+  char buf[5];
+  flash_cache_read(&_fc, buf, 100, 5);
+  TEST_ASSERT_EQUAL_MEMORY("hello", buf, 5);
+
+  flash_cache_flush(&_fc);
+  TEST_ASSERT_EQUAL(1, _erase_count);
+  TEST_ASSERT_EQUAL(1, _program_count);
+  TEST_ASSERT_EQUAL_MEMORY("hello", _flash + 100, 5);
+}
+
+// several writes to the same page cost one erase
+static void test_write_same_page(void)
+{
+  reset();
+
+  for(uint32_t i=0; i<64; i++) flash_cache_write(&_fc, i*16, "0123456789abcdef", 16);
+  flash_cache_flush(&_fc);
+
+  TEST_ASSERT_EQUAL(1, _erase_count);
+  TEST_ASSERT_EQUAL_MEMORY("0123456789abcdef", _flash + 63*16, 16);
+}
+
+static void test_write_across_pages(void)
+{
+  reset();
+
+  uint8_t data[FLASH_CACHE_SIZE + 100];
+  for(size_t i=0; i<sizeof(data); i++) data[i] = (uint8_t) i;
+
+  uint32_t const addr = FLASH_CACHE_SIZE - 50;
+  TEST_ASSERT_EQUAL(sizeof(data), flash_cache_write(&_fc, addr, data, sizeof(data)));
+  flash_cache_flush(&_fc);
+
+  TEST_ASSERT_EQUAL(3, _erase_count);
+  TEST_ASSERT_EQUAL_MEMORY(data, _flash + addr, sizeof(data));
+}
+
+// page content unchanged: verify() skips erase and program
+static void test_flush_unchanged(void)
+{
+  reset();
+
+  uint8_t ff[16];
+  memset(ff, 0xff, sizeof(ff));
+
+  flash_cache_write(&_fc, 0, ff, sizeof(ff));
+  flash_cache_flush(&_fc);
+
+  TEST_ASSERT_EQUAL(0, _erase_count);
+  TEST_ASSERT_EQUAL(0, _program_count);
+}
+
+// read overlapping cached page merges flash and cache content
+static void test_read_overlap(void)
+{
+  reset();
+
+  memset(_flash, 'a', FLASH_CACHE_SIZE);
+  memset(_flash + 2*FLASH_CACHE_SIZE, 'c', FLASH_CACHE_SIZE);
+
+  uint8_t page[FLASH_CACHE_SIZE];
+  memset(page, 'b', sizeof(page));
+  flash_cache_write(&_fc, FLASH_CACHE_SIZE, page, sizeof(page));
+
+  char buf[20];
+  flash_cache_read(&_fc, buf, FLASH_CACHE_SIZE - 10, 20);
+  TEST_ASSERT_EQUAL_MEMORY("aaaaaaaaaabbbbbbbbbb", buf, 20);
+
+  flash_cache_read(&_fc, buf, 2*FLASH_CACHE_SIZE - 10, 20);
+  TEST_ASSERT_EQUAL_MEMORY("bbbbbbbbbbcccccccccc", buf, 20);
+
+  // spans the whole cache
+  static uint8_t big[FLASH_CACHE_SIZE + 20];
+  flash_cache_read(&_fc, big, FLASH_CACHE_SIZE - 10, sizeof(big));
+  TEST_ASSERT_EQUAL('a', big[9]);
+  TEST_ASSERT_EQUAL('b', big[10]);
+  TEST_ASSERT_EQUAL('b', big[FLASH_CACHE_SIZE + 9]);
+  TEST_ASSERT_EQUAL('c', big[FLASH_CACHE_SIZE + 10]);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_write_is_cached);
+  RUN_TEST(test_write_same_page);
+  RUN_TEST(test_write_across_pages);
+  RUN_TEST(test_flush_unchanged);
+  RUN_TEST(test_read_overlap);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
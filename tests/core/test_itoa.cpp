@@ -0,0 +1,60 @@
+#include "Arduino.h"
+#include "avr/dtostrf.h"
+#include "unit.h"
+
+static void test_itoa(void)
+{
+  char buf[40];
+
+  TEST_ASSERT_EQUAL_STRING("0", itoa(0, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("12345", itoa(12345, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("-12345", itoa(-12345, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("-2147483648", itoa(INT32_MIN, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("2147483647", itoa(INT32_MAX, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("7f", itoa(127, buf, 16));
+  TEST_ASSERT_EQUAL_STRING("1010", itoa(10, buf, 2));
+}
+
+static void test_utoa(void)
+{
+  char buf[40];
+
+  TEST_ASSERT_EQUAL_STRING("4294967295", utoa(4294967295U, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("ffffffff", utoa(0xFFFFFFFFU, buf, 16));
+  TEST_ASSERT_EQUAL_STRING("10001", utoa(0x10001, buf, 16));
+  TEST_ASSERT_EQUAL_STRING("11111111111111111111111111111111", utoa(0xFFFFFFFFU, buf, 2));
+  TEST_ASSERT_EQUAL_STRING("z", utoa(35, buf, 36));
+}
+
+static void test_ltoa(void)
+{
+  char buf[40];
+
+  TEST_ASSERT_EQUAL_STRING("-100", ltoa(-100L, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("100", ultoa(100UL, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("777", ultoa(0777UL, buf, 8));
+}
+
+static void test_dtostrf(void)
+{
+  char buf[40];
+
+  TEST_ASSERT_EQUAL_STRING("3.14", dtostrf(3.14159, 4, 2, buf));
+  TEST_ASSERT_EQUAL_STRING("  -1.5", dtostrf(-1.5, 6, 1, buf));
+  TEST_ASSERT_EQUAL_STRING("2", dtostrf(2.0, 1, 0, buf));
+}
+
+static int run(void)
+{
+  RUN_TEST(test_itoa);
+  RUN_TEST(test_utoa);
+  RUN_TEST(test_ltoa);
+  RUN_TEST(test_dtostrf);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
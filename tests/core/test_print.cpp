@@ -0,0 +1,233 @@
+#include <math.h>
+#include "Arduino.h"
+#include "unit.h"
+
+// Print sink collecting output in a string, counts write() calls
+class StringPrint : public Print
+{
+  public:
+    char     str[512];
+    size_t   len;
+    uint32_t calls;
+
+    StringPrint(void) { clear(); }
+
+    void clear(void) { len = 0; calls = 0; str[0] = 0; }
+
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t* buf, size_t size)
+    {
+      calls++;
+      if ( len + size >= sizeof(str) ) size = sizeof(str) - 1 - len;
+      memcpy(str + len, buf, size);
+      len += size;
+      str[len] = 0;
+      return size;
+    }
+    using Print::write;
+};
+
+#define TEST_PRINT(_exp, ...) \
+  do { \
+    out.clear(); \
+    size_t const _n = out.print(__VA_ARGS__); \
+    TEST_ASSERT_EQUAL_STRING(_exp, out.str); \
+    TEST_ASSERT_EQUAL(strlen(_exp), _n); \
+  } while(0)
+
+static void test_print_integer(void)
+{
+  StringPrint out;
+
+  TEST_PRINT("0", 0);
+  TEST_PRINT("7", 7);
+  TEST_PRINT("42", 42);
+  TEST_PRINT("-1234567", -1234567);
+  TEST_PRINT("4294967295", 4294967295UL);
+  TEST_PRINT("-2147483648", (long) INT32_MIN);
+  TEST_PRINT("2147483647", (long) INT32_MAX);
+  TEST_PRINT("1000000000", 1000000000UL);
+  TEST_PRINT("255", (uint8_t) 255);
+}
+
+// sign and digits go out in a single write
+static void test_print_integer_single_write(void)
+{
+  StringPrint out;
+
+  out.print(-1234567);
+  TEST_ASSERT_EQUAL(1, out.calls);
+}
+
+static void test_print_base(void)
+{
+  StringPrint out;
+
+  TEST_PRINT("DEADBEEF", 0xDEADBEEFUL, HEX);
+  TEST_PRINT("0", 0, HEX);
+  TEST_PRINT("11111111", 255, BIN);
+  TEST_PRINT("777", 0777, OCT);
+  TEST_PRINT("Z", 35, 36);
+  TEST_PRINT("123", 123, 1); // invalid base falls back to decimal
+}
+
+static void test_print_float(void)
+{
+  StringPrint out;
+
+  TEST_PRINT("3.14", 3.14159);
+  TEST_PRINT("3.1416", 3.14159F, 4);
+  TEST_PRINT("23.456", 23.456F, 3);
+  TEST_PRINT("-2.50", -2.5);
+  TEST_PRINT("0.00", 0.0);
+  TEST_PRINT("-0.00", -0.0);
+  TEST_PRINT("1.00", 0.999);    // rounding carries into integer part
+  TEST_PRINT("10", 9.6, 0);
+  TEST_PRINT("0.000000001", 0.000000001, 9);
+  TEST_PRINT("4294967294.00", 4294967294.0);
+  TEST_PRINT("10000000000.00", 1e10);
+  TEST_PRINT("nan", NAN);
+  TEST_PRINT("inf", INFINITY);
+  TEST_PRINT("-inf", -INFINITY);
+}
+
+static void test_println(void)
+{
+  StringPrint out;
+
+  out.println(12);
+  out.println("ab");
+  out.println();
+  TEST_ASSERT_EQUAL_STRING("12\r\nab\r\n\r\n", out.str);
+}
+
+static void test_printf(void)
+{
+  StringPrint out;
+
+  out.printf("t=%lu v=%d %s", 1234UL, -42, "ok");
+  TEST_ASSERT_EQUAL_STRING("t=1234 v=-42 ok", out.str);
+  TEST_ASSERT_EQUAL(1, out.calls);
+}
+
+// longer than the 256 bytes stack buffer is formatted again on heap
+static void test_printf_long(void)
+{
+  StringPrint out;
+
+  char str[301];
+  memset(str, 'x', 300);
+  str[300] = 0;
+
+  size_t const n = out.printf("<%s>", str);
+  TEST_ASSERT_EQUAL(302, n);
+  TEST_ASSERT_EQUAL(302, out.len);
+  TEST_ASSERT_EQUAL('<', out.str[0]);
+  TEST_ASSERT_EQUAL('>', out.str[301]);
+}
+
+static void test_print_buffer(void)
+{
+  StringPrint out;
+  uint8_t const buf[3] = { 0x01, 0xAB, 0xFF };
+
+  out.printBuffer(buf, 3, ':');
+  TEST_ASSERT_EQUAL_STRING("01:AB:FF", out.str);
+
+  out.clear();
+  out.printBufferReverse(buf, 3);
+  TEST_ASSERT_EQUAL_STRING("FF AB 01", out.str);
+}
+
+//--------------------------------------------------------------------+
+// BufferedPrint
+//--------------------------------------------------------------------+
+static void test_buffered_bulk_write(void)
+{
+  StringPrint out;
+
+  {
+    BufferedPrintN<64> bp(out);
+    bp.print("t=");
+    bp.print(1234);
+    bp.print(" v=");
+    bp.println(23.456F, 3);
+
+    TEST_ASSERT_EQUAL(0, out.calls);
+    TEST_ASSERT_EQUAL(17, bp.buffered());
+
+    bp.flush();
+    TEST_ASSERT_EQUAL(1, out.calls);
+    TEST_ASSERT_EQUAL(0, bp.buffered());
+  }
+
+  TEST_ASSERT_EQUAL_STRING("t=1234 v=23.456\r\n", out.str);
+}
+
+static void test_buffered_flush_on_destruct(void)
+{
+  StringPrint out;
+
+  {
+    BufferedPrintN<16> bp(out);
+    bp.print("abc");
+  }
+
+  TEST_ASSERT_EQUAL_STRING("abc", out.str);
+  TEST_ASSERT_EQUAL(1, out.calls);
+}
+
+// data larger than the buffer is flushed in buffer sized chunks or passed through
+static void test_buffered_overflow(void)
+{
+  StringPrint out;
+  BufferedPrintN<8> bp(out);
+
+  bp.print("0123");
+  bp.print("456789abcdef");
+  bp.print("ghijklmnopqrstuvwxyz");
+  bp.flush();
+
+  TEST_ASSERT_EQUAL_STRING("0123456789abcdefghijklmnopqrstuvwxyz", out.str);
+  TEST_ASSERT(out.calls <= 6);
+  TEST_ASSERT_EQUAL(8, bp.availableForWrite());
+}
+
+static void test_buffered_printf(void)
+{
+  StringPrint out;
+  BufferedPrintN<32> bp(out);
+
+  bp.printf("%d: ", 7);
+  bp.printf("%s", "value");
+  TEST_ASSERT_EQUAL(0, out.calls);
+
+  // does not fit in the remaining space
+  bp.printf(" %s", "0123456789abcdefghijklmnopqrstuvwxyz");
+  bp.flush();
+
+  TEST_ASSERT_EQUAL_STRING("7: value 0123456789abcdefghijklmnopqrstuvwxyz", out.str);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_print_integer);
+  RUN_TEST(test_print_integer_single_write);
+  RUN_TEST(test_print_base);
+  RUN_TEST(test_print_float);
+  RUN_TEST(test_println);
+  RUN_TEST(test_printf);
+  RUN_TEST(test_printf_long);
+  RUN_TEST(test_print_buffer);
+  RUN_TEST(test_buffered_bulk_write);
+  RUN_TEST(test_buffered_flush_on_destruct);
+  RUN_TEST(test_buffered_overflow);
+  RUN_TEST(test_buffered_printf);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
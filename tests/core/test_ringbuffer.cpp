@@ -0,0 +1,78 @@
+#include "Arduino.h"
+#include "RingBuffer.h"
+#include "unit.h"
+
+static void test_empty(void)
+{
+  RingBuffer rb;
+
+  TEST_ASSERT_EQUAL(0, rb.available());
+  TEST_ASSERT_EQUAL(-1, rb.read_char());
+  TEST_ASSERT_EQUAL(-1, rb.peek());
+  TEST_ASSERT(!rb.isFull());
+}
+
+static void test_fifo_order(void)
+{
+  RingBuffer rb;
+
+  for(int i=0; i<10; i++) rb.store_char((uint8_t) i);
+  TEST_ASSERT_EQUAL(10, rb.available());
+  TEST_ASSERT_EQUAL(0, rb.peek());
+
+  for(int i=0; i<10; i++) TEST_ASSERT_EQUAL(i, rb.read_char());
+  TEST_ASSERT_EQUAL(0, rb.available());
+}
+
+// one slot is kept free to tell full from empty, extra bytes are dropped
+static void test_full_drops(void)
+{
+  RingBuffer rb;
+
+  for(int i=0; i<SERIAL_BUFFER_SIZE + 10; i++) rb.store_char((uint8_t) i);
+  TEST_ASSERT(rb.isFull());
+  TEST_ASSERT_EQUAL(SERIAL_BUFFER_SIZE - 1, rb.available());
+
+  for(int i=0; i<SERIAL_BUFFER_SIZE - 1; i++) TEST_ASSERT_EQUAL(i, rb.read_char());
+  TEST_ASSERT_EQUAL(-1, rb.read_char());
+}
+
+static void test_wrap_around(void)
+{
+  RingBuffer rb;
+
+  for(int i=0; i<5*SERIAL_BUFFER_SIZE; i++)
+  {
+    rb.store_char((uint8_t) i);
+    rb.store_char((uint8_t) (i+1));
+    TEST_ASSERT_EQUAL((uint8_t) i, rb.read_char());
+    TEST_ASSERT_EQUAL((uint8_t) (i+1), rb.read_char());
+  }
+  TEST_ASSERT_EQUAL(0, rb.available());
+}
+
+static void test_clear(void)
+{
+  RingBuffer rb;
+
+  rb.store_char('a');
+  rb.clear();
+  TEST_ASSERT_EQUAL(0, rb.available());
+  TEST_ASSERT_EQUAL(-1, rb.read_char());
+}
+
+static int run(void)
+{
+  RUN_TEST(test_empty);
+  RUN_TEST(test_fifo_order);
+  RUN_TEST(test_full_drops);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_clear);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
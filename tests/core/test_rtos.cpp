@@ -0,0 +1,201 @@
+#include "Arduino.h"
+#include "unit.h"
+
+// Checks of the host port itself and of the rtos heap
+
+// time only moves while all tasks are blocked, by exactly the delay
+static void test_delay_virtual_time(void)
+{
+  TickType_t const start = xTaskGetTickCount();
+  uint64_t const start_us = micros64();
+
+  delay(100);
+
+  TEST_ASSERT_EQUAL(ms2tick(100), xTaskGetTickCount() - start);
+
+  // tick times are rounded up to the us
+  uint64_t const elapsed_us = micros64() - start_us;
+  TEST_ASSERT(elapsed_us >= 99609 && elapsed_us <= 99610);
+}
+
+//--------------------------------------------------------------------+
+// Priority preemption
+//--------------------------------------------------------------------+
+static SemaphoreHandle_t _sem;
+static volatile uint32_t _step;
+
+static void high_task(void* arg)
+{
+  (void) arg;
+  xSemaphoreTake(_sem, portMAX_DELAY);
+  _step++;
+  vTaskDelete(NULL);
+}
+
+static void test_preemption(void)
+{
+  _sem = xSemaphoreCreateBinary();
+  _step = 0;
+
+  xTaskCreate(high_task, "high", 256, NULL, TASK_PRIO_HIGH, NULL);
+  TEST_ASSERT_EQUAL(0, _step); // blocked on semaphore
+
+  xSemaphoreGive(_sem);
+  TEST_ASSERT_EQUAL(1, _step); // ran before give() returned
+
+  delay(1); // let idle delete the task
+  vSemaphoreDelete(_sem);
+}
+
+//--------------------------------------------------------------------+
+// Interrupt
+//--------------------------------------------------------------------+
+static void sem_isr(void)
+{
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(_sem, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void test_isr_wakes_task(void)
+{
+  _sem = xSemaphoreCreateBinary();
+
+  host_irq_attach(SWI1_EGU1_IRQn, sem_isr);
+  NVIC_EnableIRQ(SWI1_EGU1_IRQn);
+
+  // masked: stays pending until interrupts are enabled again
+  taskENTER_CRITICAL();
+  NVIC_SetPendingIRQ(SWI1_EGU1_IRQn);
+  TEST_ASSERT(NVIC_GetPendingIRQ(SWI1_EGU1_IRQn));
+  taskEXIT_CRITICAL();
+
+  TEST_ASSERT(!NVIC_GetPendingIRQ(SWI1_EGU1_IRQn));
+  TEST_ASSERT(xSemaphoreTake(_sem, 0));
+
+  NVIC_DisableIRQ(SWI1_EGU1_IRQn);
+  vSemaphoreDelete(_sem);
+}
+
+//--------------------------------------------------------------------+
+// Software timer
+//--------------------------------------------------------------------+
+static volatile uint32_t _timer_ms;
+
+static void timer_cb(TimerHandle_t timer)
+{
+  (void) timer;
+  _timer_ms = millis();
+}
+
+static void test_software_timer(void)
+{
+  _timer_ms = 0;
+
+  TimerHandle_t timer = xTimerCreate("test", ms2tick(50), pdFALSE, NULL, timer_cb);
+  uint32_t const start = millis();
+  xTimerStart(timer, 0);
+
+  delay(100);
+  TEST_ASSERT(_timer_ms != 0);
+  TEST_ASSERT_EQUAL(50, _timer_ms - start);
+
+  xTimerDelete(timer, 0);
+}
+
+//--------------------------------------------------------------------+
+// Heap
+//--------------------------------------------------------------------+
+static void test_heap_tags(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  void* p = rtos_malloc_tag(100, HEAP_TAG_BLE);
+  TEST_ASSERT(p != NULL);
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.tag_blocks[HEAP_TAG_BLE] + 1, after.tag_blocks[HEAP_TAG_BLE]);
+  TEST_ASSERT(after.tag_used[HEAP_TAG_BLE] >= before.tag_used[HEAP_TAG_BLE] + 100);
+  TEST_ASSERT_EQUAL(before.alloc_count + 1, after.alloc_count);
+
+  // grows in place or moves, content is kept
+  memset(p, 0x5a, 100);
+  p = rtos_realloc_tag(p, 300, HEAP_TAG_BLE);
+  TEST_ASSERT(p != NULL);
+  TEST_ASSERT_EQUAL(0x5a, ((uint8_t*) p)[99]);
+
+  rtos_free(p);
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.used, after.used);
+  TEST_ASSERT_EQUAL(before.tag_blocks[HEAP_TAG_BLE], after.tag_blocks[HEAP_TAG_BLE]);
+}
+
+static void* volatile _sink;
+
+// malloc() family and new go to the rtos heap like on target
+static void test_heap_wrap(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  void* p = malloc(10);
+  uint32_t* q = new uint32_t[4];
+  uint8_t* c = (uint8_t*) calloc(4, 8);
+  _sink = p;
+  _sink = q;
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.alloc_count + 3, after.alloc_count);
+  for (int i = 0; i < 32; i++) TEST_ASSERT_EQUAL(0, c[i]);
+
+  // pool block grows or moves within the pool
+  p = realloc(p, 200);
+  TEST_ASSERT(p != NULL);
+  _sink = p;
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.fallback_count, after.fallback_count);
+
+  free(p);
+  free(c);
+  delete[] q;
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.used, after.used);
+}
+
+// larger than the pool is served by newlib (libc on host)
+static void test_heap_fallback(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  void* p = rtos_malloc(2*CFG_RTOS_HEAP_SIZE);
+  TEST_ASSERT(p != NULL);
+  memset(p, 0, 2*CFG_RTOS_HEAP_SIZE);
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.fallback_count + 1, after.fallback_count);
+  TEST_ASSERT_EQUAL(before.fail_count + 1, after.fail_count);
+
+  rtos_free(p);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_delay_virtual_time);
+  RUN_TEST(test_preemption);
+  RUN_TEST(test_isr_wakes_task);
+  RUN_TEST(test_software_timer);
+  RUN_TEST(test_heap_tags);
+  RUN_TEST(test_heap_wrap);
+  RUN_TEST(test_heap_fallback);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
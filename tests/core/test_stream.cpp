@@ -0,0 +1,107 @@
+#include "Arduino.h"
+#include "unit.h"
+
+// Stream reading from a string, no more data once at the end
+class StringStream : public Stream
+{
+  public:
+    StringStream(const char* str) : _str(str), _pos(0) { }
+
+    virtual int available(void) { return strlen(_str + _pos); }
+    virtual int peek(void)      { return _str[_pos] ? _str[_pos] : -1; }
+    virtual int read(void)      { return _str[_pos] ? _str[_pos++] : -1; }
+    virtual void flush(void)    { }
+    virtual size_t write(uint8_t b) { (void) b; return 0; }
+
+  private:
+    const char* _str;
+    size_t _pos;
+};
+
+static void test_parse_int(void)
+{
+  StringStream s("12345,-678, x 9\n");
+  s.setTimeout(0);
+
+  TEST_ASSERT_EQUAL(12345, s.parseInt());
+  TEST_ASSERT_EQUAL(-678, s.parseInt());
+  TEST_ASSERT_EQUAL(9, s.parseInt());
+  TEST_ASSERT_EQUAL(0, s.parseInt()); // no more digits
+}
+
+static void test_parse_int_lookahead(void)
+{
+  StringStream s("ab 12");
+  s.setTimeout(0);
+
+  TEST_ASSERT_EQUAL(0, s.parseInt(SKIP_WHITESPACE));
+  TEST_ASSERT_EQUAL('a', s.peek());
+
+  StringStream t("1,234,567");
+  t.setTimeout(0);
+  TEST_ASSERT_EQUAL(1234567, t.parseInt(SKIP_ALL, ','));
+}
+
+static void test_parse_float(void)
+{
+  StringStream s("3.25 -0.5 12");
+  s.setTimeout(0);
+
+  TEST_ASSERT(s.parseFloat() == 3.25F);
+  TEST_ASSERT(s.parseFloat() == -0.5F);
+  TEST_ASSERT(s.parseFloat() == 12.0F);
+}
+
+static void test_find(void)
+{
+  StringStream s("header OK:42\r\n");
+  s.setTimeout(0);
+
+  TEST_ASSERT(s.find((char*) "OK:"));
+  TEST_ASSERT_EQUAL(42, s.parseInt());
+  TEST_ASSERT(!s.find((char*) "OK:"));
+}
+
+static void test_read_until(void)
+{
+  StringStream s("line one\nline two\n");
+  s.setTimeout(0);
+
+  char buf[32];
+  size_t n = s.readBytesUntil('\n', buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(8, n);
+  TEST_ASSERT_EQUAL_MEMORY("line one", buf, n);
+
+  String str = s.readStringUntil('\n');
+  TEST_ASSERT_EQUAL_STRING("line two", str.c_str());
+}
+
+// waiting for data that never comes takes the timeout, in virtual time
+static void test_timeout(void)
+{
+  StringStream s("");
+  s.setTimeout(100);
+
+  uint32_t const start = millis();
+  TEST_ASSERT_EQUAL(0, s.parseInt());
+  uint32_t const elapsed = millis() - start;
+
+  TEST_ASSERT(elapsed >= 100 && elapsed <= 102);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_parse_int);
+  RUN_TEST(test_parse_int_lookahead);
+  RUN_TEST(test_parse_float);
+  RUN_TEST(test_find);
+  RUN_TEST(test_read_until);
+  RUN_TEST(test_timeout);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,188 @@
+#include "Arduino.h"
+#include "unit.h"
+
+static void test_conversion(void)
+{
+  TEST_ASSERT_EQUAL_STRING("-1234", String(-1234).c_str());
+  TEST_ASSERT_EQUAL_STRING("4294967295", String(4294967295UL).c_str());
+  TEST_ASSERT_EQUAL_STRING("ff", String(255, HEX).c_str());
+  TEST_ASSERT_EQUAL_STRING("101", String(5, BIN).c_str());
+  TEST_ASSERT_EQUAL_STRING("23.46", String(23.456F).c_str());
+  TEST_ASSERT_EQUAL_STRING("-0.5", String(-0.5, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("x", String('x').c_str());
+
+  TEST_ASSERT_EQUAL(-42, String("-42").toInt());
+  TEST_ASSERT(String("2.5").toFloat() == 2.5F);
+}
+
+static void test_concat(void)
+{
+  String s("temp=");
+  s += 25;
+  s += ",hum=";
+  s += 60;
+
+  TEST_ASSERT_EQUAL_STRING("temp=25,hum=60", s.c_str());
+  TEST_ASSERT_EQUAL(14, s.length());
+
+  String t = "t=" + String(12) + ",v=" + String(1.5F, 1) + "!";
+  TEST_ASSERT_EQUAL_STRING("t=12,v=1.5!", t.c_str());
+}
+
+static void test_compare_search(void)
+{
+  String s("Hello World");
+
+  TEST_ASSERT(s == "Hello World");
+  TEST_ASSERT(s != "hello world");
+  TEST_ASSERT(s.equalsIgnoreCase("hello world"));
+  TEST_ASSERT(s.startsWith("Hello"));
+  TEST_ASSERT(s.endsWith("World"));
+  TEST_ASSERT_EQUAL(6, s.indexOf('W'));
+  TEST_ASSERT_EQUAL(-1, s.indexOf("xyz"));
+  TEST_ASSERT_EQUAL_STRING("World", s.substring(6).c_str());
+
+  s.replace("World", "nRF52");
+  TEST_ASSERT_EQUAL_STRING("Hello nRF52", s.c_str());
+
+  s.toUpperCase();
+  TEST_ASSERT_EQUAL_STRING("HELLO NRF52", s.c_str());
+}
+
+// short strings use the inline storage
+static void test_inline_no_heap(void)
+{
+  String::resetAllocStats();
+
+  {
+    String s("short");
+    s += "er";
+    String t(s);
+    TEST_ASSERT_EQUAL_STRING("shorter", t.c_str());
+  }
+
+  TEST_ASSERT_EQUAL(0, String::getAllocStats().heap_alloc);
+}
+
+// capacity doubles while growing, allocations are logarithmic
+static void test_growth_amortized(void)
+{
+  String::resetAllocStats();
+
+  String s;
+  for(int i=0; i<1000; i++) s += 'x';
+
+  TEST_ASSERT_EQUAL(1000, s.length());
+  TEST_ASSERT(String::getAllocStats().heap_alloc <= 8);
+}
+
+static void test_heap_released(void)
+{
+  rtos_heap_stats_t before, after;
+  rtos_heap_stats(&before);
+
+  {
+    String s("a string that is too long for the inline storage");
+    s += s;
+  }
+
+  rtos_heap_stats(&after);
+  TEST_ASSERT_EQUAL(before.used, after.used);
+  TEST_ASSERT_EQUAL(before.tag_blocks[HEAP_TAG_STRING], after.tag_blocks[HEAP_TAG_STRING]);
+}
+
+static void test_arena(void)
+{
+  String::resetAllocStats();
+
+  String line;
+  {
+    StringArenaN<128> arena;
+    String s = "t=" + String(1234UL) + ",temp=" + String(23.456F, 2) + ",status=ok and more";
+    TEST_ASSERT(arena.used() > 0);
+
+    line = s;
+  }
+
+  TEST_ASSERT_EQUAL_STRING("t=1234,temp=23.46,status=ok and more", line.c_str());
+
+  // only the copy out of the arena is on the heap
+  StringAllocStats const stats = String::getAllocStats();
+  TEST_ASSERT(stats.arena_alloc > 0);
+  TEST_ASSERT_EQUAL(1, stats.heap_alloc);
+}
+
+// moved string never takes over an arena buffer
+static void test_arena_move(void)
+{
+  String out;
+  {
+    StringArenaN<64> arena;
+    String s("a string that is too long for the inline storage");
+    out = std::move(s);
+  }
+
+  TEST_ASSERT_EQUAL_STRING("a string that is too long for the inline storage", out.c_str());
+}
+
+static void test_arena_fallback_heap(void)
+{
+  String::resetAllocStats();
+
+  {
+    StringArenaN<32> arena;
+    String s("0123456789abcdefghijklmnopqrstuvwxyz");
+    TEST_ASSERT_EQUAL(36, s.length());
+  }
+
+  TEST_ASSERT_EQUAL(1, String::getAllocStats().heap_alloc);
+  TEST_ASSERT_EQUAL(1, String::getAllocStats().heap_free);
+}
+
+//--------------------------------------------------------------------+
+// Arena is per task
+//--------------------------------------------------------------------+
+static volatile bool _other_done;
+static StringArena* volatile _other_arena;
+
+static void other_task(void* arg)
+{
+  (void) arg;
+  _other_arena = StringArena::current();
+  _other_done = true;
+  vTaskDelete(NULL);
+}
+
+static void test_arena_per_task(void)
+{
+  StringArenaN<64> arena;
+  TEST_ASSERT(StringArena::current() == &arena);
+
+  _other_done = false;
+  _other_arena = &arena;
+  xTaskCreate(other_task, "other", 256, NULL, TASK_PRIO_HIGH, NULL);
+
+  TEST_ASSERT(_other_done);
+  TEST_ASSERT(_other_arena == NULL);
+}
+
+static int run(void)
+{
+  RUN_TEST(test_conversion);
+  RUN_TEST(test_concat);
+  RUN_TEST(test_compare_search);
+  RUN_TEST(test_inline_no_heap);
+  RUN_TEST(test_growth_amortized);
+  RUN_TEST(test_heap_released);
+  RUN_TEST(test_arena);
+  RUN_TEST(test_arena_move);
+  RUN_TEST(test_arena_fallback_heap);
+  RUN_TEST(test_arena_per_task);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,109 @@
+#include "Arduino.h"
+#include "bignum.h"
+#include "bench.h"
+
+// Software SRP-3072 arithmetic of HomeKit pair-setup (BLEHomekit src/crypto/srp):
+// the same modular exponentiations as srp_init() and srp_setA(), with the
+// shared secret checked against the client side formula. Time is only useful
+// to compare changes to bignum.c (e.g. POLARSSL_MPI_WINDOW_SIZE), allocations
+// per op are exact. Output is checked against bench_srp.baseline
+
+#define ITERATIONS    2
+
+// RFC 5054 3072-bit group, g = 5
+static const char srp_N_hex[] =
+  "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DD"
+  "EF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+  "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F"
+  "83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+  "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA0510"
+  "15728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+  "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200C"
+  "BBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DBB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF";
+
+#define SRP_G   5
+
+#define CHECK(_x) \
+  do { int _r = (_x); if (_r) { printf("%s failed %d at line %d\n", #_x, _r, __LINE__); exit(1); } } while(0)
+
+static void read_hex(mpi* X, const char* hex)
+{
+  unsigned char buf[384];
+  size_t const len = strlen(hex) / 2;
+
+  for (size_t i = 0; i < len; i++) sscanf(hex + 2*i, "%2hhx", &buf[i]);
+  CHECK(mpi_read_binary(X, buf, len));
+}
+
+// deterministic so that runs are comparable
+static void read_random(mpi* X, size_t len)
+{
+  unsigned char buf[64];
+
+  for (size_t i = 0; i < len; i++) buf[i] = (unsigned char) rand();
+  CHECK(mpi_read_binary(X, buf, len));
+}
+
+static int run(void)
+{
+  srand(1);
+
+  mpi N, g, k, x, v, b, B, a, A, u, S, T, RR, e, Sc;
+  mpi* const all[] = { &N, &g, &k, &x, &v, &b, &B, &a, &A, &u, &S, &T, &RR, &e, &Sc };
+  for (mpi* m : all) mpi_init(m);
+
+  read_hex(&N, srp_N_hex);
+  CHECK(mpi_lset(&g, SRP_G));
+  read_random(&k, 64);
+  read_random(&x, 64);
+  read_random(&b, 32);
+  read_random(&a, 32);
+  read_random(&u, 64);
+
+  //------------- srp_init() -------------//
+  BENCH("srp_verifier", ITERATIONS, 0, CHECK(mpi_exp_mod(&v, &g, &x, &N, NULL)) );
+
+  // B = k*v + g^b, R^2 mod N is computed on first use then cached
+  BENCH("srp_pubkey", ITERATIONS, 0,
+    CHECK(mpi_exp_mod(&T, &g, &b, &N, &RR));
+    CHECK(mpi_mul_mpi(&B, &k, &v));
+    CHECK(mpi_add_abs(&B, &B, &T));
+    CHECK(mpi_mod_mpi(&B, &B, &N));
+  );
+
+  CHECK(mpi_exp_mod(&A, &g, &a, &N, &RR));
+
+  //------------- srp_setA() -------------//
+  // S = (A * v^u)^b, without and with cached R^2 mod N
+  BENCH("srp_secret", ITERATIONS, 0,
+    CHECK(mpi_exp_mod(&S, &v, &u, &N, NULL));
+    CHECK(mpi_mul_mpi(&S, &S, &A));
+    CHECK(mpi_exp_mod(&S, &S, &b, &N, NULL));
+  );
+
+  BENCH("srp_secret_rr_cached", ITERATIONS, 0,
+    CHECK(mpi_exp_mod(&S, &v, &u, &N, &RR));
+    CHECK(mpi_mul_mpi(&S, &S, &A));
+    CHECK(mpi_exp_mod(&S, &S, &b, &N, &RR));
+  );
+
+  //------------- client S = (B - k*g^x)^(a + u*x) -------------//
+  CHECK(mpi_mul_mpi(&T, &k, &v));
+  CHECK(mpi_sub_mpi(&T, &B, &T));
+  CHECK(mpi_mod_mpi(&T, &T, &N));
+  CHECK(mpi_mul_mpi(&e, &u, &x));
+  CHECK(mpi_add_abs(&e, &e, &a));
+  CHECK(mpi_exp_mod(&Sc, &T, &e, &N, &RR));
+
+  int const ok = (mpi_cmp_mpi(&S, &Sc) == 0);
+  if ( !ok ) printf("srp: client/host secret mismatch\n");
+
+  for (mpi* m : all) mpi_free(m);
+
+  return ok ? 0 : 1;
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,201 @@
+#include "Arduino.h"
+#include "unit.h"
+#include "crypto_backend.h"
+#include "poly1305.h"
+
+// Software ChaCha20 backend and incremental Poly1305 of BLEHomekit against
+// the RFC 7539 test vectors
+
+// crypto.c (HMAC-SHA512 for sw_hkdf) is not built on host, HKDF is not covered
+extern "C" void crypto_sha512hmac(uint8_t* hash, uint8_t* salt, uint8_t salt_length, uint8_t* data, uint8_t data_length)
+{
+  memset(hash, 0, 64);
+}
+
+static char const sunscreen[] =
+  "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+#define SUNSCREEN_LEN   (sizeof(sunscreen) - 1)
+
+// 2.4.2: key 00..1f, nonce 00:00:00:00:00:00:00:4a:00:00:00:00, counter 1.
+// The leading 32-bit nonce word is zero so it maps to the 64-bit HAP layout
+static uint8_t const chacha_nonce[8] = { 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+
+static uint8_t const chacha_cipher[114] =
+{
+  0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81,
+  0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b,
+  0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+  0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8,
+  0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e,
+  0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+  0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42,
+  0x87, 0x4d
+};
+
+// 2.5.2
+static uint8_t const poly_key[32] =
+{
+  0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+  0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd, 0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+};
+
+static char const poly_msg[] = "Cryptographic Forum Research Group";
+
+static uint8_t const poly_tag[16] =
+{
+  0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9
+};
+
+// 2.8.2: nonce constant 07:00:00:00 cannot be expressed with the 64-bit HAP
+// nonce, the tag is checked from the published one-time key and ciphertext
+static uint8_t const aead_aad[12] =
+{
+  0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7
+};
+
+static uint8_t const aead_otk[32] =
+{
+  0x7b, 0xac, 0x2b, 0x25, 0x2d, 0xb4, 0x47, 0xaf, 0x09, 0xb6, 0x7a, 0x55, 0xa4, 0xe9, 0x55, 0x84,
+  0x0a, 0xe1, 0xd6, 0x73, 0x10, 0x75, 0xd9, 0xeb, 0x2a, 0x93, 0x75, 0x78, 0x3e, 0xd5, 0x53, 0xff
+};
+
+static uint8_t const aead_cipher[114] =
+{
+  0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+  0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+  0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+  0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+  0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+  0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+  0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+  0x61, 0x16
+};
+
+static uint8_t const aead_tag[16] =
+{
+  0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91
+};
+
+static uint8_t key_seq[32];
+
+static void test_chacha20_encrypt(void)
+{
+  uint8_t out[SUNSCREEN_LEN];
+
+  crypto_backend_sw.chacha20_xor(out, (uint8_t const*) sunscreen, SUNSCREEN_LEN, chacha_nonce, key_seq, 1);
+  TEST_ASSERT_EQUAL_MEMORY(chacha_cipher, out, sizeof(out));
+}
+
+static void test_chacha20_in_place(void)
+{
+  uint8_t buf[SUNSCREEN_LEN];
+  memcpy(buf, chacha_cipher, sizeof(buf));
+
+  crypto_backend_sw.chacha20_xor(buf, buf, sizeof(buf), chacha_nonce, key_seq, 1);
+  TEST_ASSERT_EQUAL_MEMORY(sunscreen, buf, sizeof(buf));
+}
+
+static void test_chacha20_keystream(void)
+{
+  uint8_t ks[SUNSCREEN_LEN];
+
+  crypto_backend_sw.chacha20_xor(ks, NULL, sizeof(ks), chacha_nonce, key_seq, 1);
+
+  for (size_t i = 0; i < sizeof(ks); i++) ks[i] ^= (uint8_t) sunscreen[i];
+  TEST_ASSERT_EQUAL_MEMORY(chacha_cipher, ks, sizeof(ks));
+}
+
+static void test_poly1305(void)
+{
+  poly1305_ctx_t ctx;
+  uint8_t mac[16];
+
+  poly1305_init(&ctx, poly_key);
+  poly1305_update(&ctx, (uint8_t const*) poly_msg, strlen(poly_msg));
+  poly1305_finish(&ctx, mac);
+  TEST_ASSERT_EQUAL_MEMORY(poly_tag, mac, sizeof(mac));
+}
+
+static void test_poly1305_split(void)
+{
+  // odd sized pieces exercise the leftover buffer
+  static size_t const split[] = { 1, 5, 16, 3, 9 };
+  size_t const len = strlen(poly_msg);
+  poly1305_ctx_t ctx;
+  uint8_t mac[16];
+
+  poly1305_init(&ctx, poly_key);
+
+  size_t pos = 0;
+  for (size_t i = 0; i < sizeof(split)/sizeof(split[0]); i++)
+  {
+    poly1305_update(&ctx, (uint8_t const*) poly_msg + pos, split[i]);
+    pos += split[i];
+  }
+  poly1305_update(&ctx, (uint8_t const*) poly_msg + pos, len - pos);
+
+  poly1305_finish(&ctx, mac);
+  TEST_ASSERT_EQUAL_MEMORY(poly_tag, mac, sizeof(mac));
+}
+
+// Same construction as crypto.c: aad | pad16 | cipher | pad16 | le64(aad_len) | le64(cipher_len)
+static void aead_tag_calc(uint8_t mac[16], uint8_t const* cipher, size_t len)
+{
+  uint8_t block[16] = { 0 };
+  poly1305_ctx_t ctx;
+
+  poly1305_init(&ctx, aead_otk);
+
+  poly1305_update(&ctx, aead_aad, sizeof(aead_aad));
+  poly1305_update(&ctx, block, 16 - (sizeof(aead_aad) % 16));
+
+  poly1305_update(&ctx, cipher, len);
+  if ( len % 16 ) poly1305_update(&ctx, block, 16 - (len % 16));
+
+  block[0] = sizeof(aead_aad);
+  block[8] = (uint8_t) len;
+  poly1305_update(&ctx, block, sizeof(block));
+
+  poly1305_finish(&ctx, mac);
+}
+
+static void test_aead_tag(void)
+{
+  uint8_t mac[16];
+
+  aead_tag_calc(mac, aead_cipher, sizeof(aead_cipher));
+  TEST_ASSERT_EQUAL_MEMORY(aead_tag, mac, sizeof(mac));
+}
+
+static void test_aead_tag_mismatch(void)
+{
+  uint8_t cipher[sizeof(aead_cipher)];
+  uint8_t mac[16];
+
+  memcpy(cipher, aead_cipher, sizeof(cipher));
+  cipher[sizeof(cipher) - 1] ^= 0x01;
+
+  aead_tag_calc(mac, cipher, sizeof(cipher));
+  TEST_ASSERT(memcmp(aead_tag, mac, sizeof(mac)) != 0);
+}
+
+static int run(void)
+{
+  for (size_t i = 0; i < sizeof(key_seq); i++) key_seq[i] = (uint8_t) i;
+
+  RUN_TEST(test_chacha20_encrypt);
+  RUN_TEST(test_chacha20_in_place);
+  RUN_TEST(test_chacha20_keystream);
+  RUN_TEST(test_poly1305);
+  RUN_TEST(test_poly1305_split);
+  RUN_TEST(test_aead_tag);
+  RUN_TEST(test_aead_tag_mismatch);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
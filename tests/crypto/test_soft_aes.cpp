@@ -0,0 +1,224 @@
+#include "Arduino.h"
+#include "unit.h"
+#include "soft_aes.h"
+
+// Software AES reference of the aes_benchmark sketch against NIST vectors,
+// same data as the "aes" example that checks the CC310 on target
+
+// SP 800-38A F.1, F.2, F.5: AES-128
+static uint8_t const key[16] =
+{
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static uint8_t const plain_text[64] =
+{
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static uint8_t const ecb_cipher[16] =
+{
+  0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+
+static uint8_t const cbc_iv[16] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static uint8_t const cbc_cipher[64] =
+{
+  0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+  0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+  0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+  0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+static uint8_t const ctr_iv[16] =
+{
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+static uint8_t const ctr_cipher[64] =
+{
+  0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+  0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+  0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+  0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+// SP 800-38C Example 3
+static uint8_t const ccm_key[16] =
+{
+  0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f
+};
+
+static uint8_t const ccm_nonce[12] =
+{
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b
+};
+
+static uint8_t const ccm_adata[20] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13
+};
+
+static uint8_t const ccm_plain[24] =
+{
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37
+};
+
+static uint8_t const ccm_cipher[24] =
+{
+  0xe3, 0xb2, 0x01, 0xa9, 0xf5, 0xb7, 0x1a, 0x7a, 0x9b, 0x1c, 0xea, 0xec, 0xcd, 0x97, 0xe7, 0x0b,
+  0x61, 0x76, 0xaa, 0xd9, 0xa4, 0x42, 0x8a, 0xa5
+};
+
+static uint8_t const ccm_tag[8] =
+{
+  0x48, 0x43, 0x92, 0xfb, 0xc1, 0xb0, 0x99, 0x51
+};
+
+//--------------------------------------------------------------------+
+// CCM on top of the block cipher (SP 800-38C A.2), 12-byte nonce
+//--------------------------------------------------------------------+
+static void cbc_mac(soft_aes_t const* ctx, uint8_t mac[16], uint8_t const* data, size_t len)
+{
+  for (size_t i = 0; i < len; i += 16)
+  {
+    size_t const n = (len - i < 16) ? (len - i) : 16;
+    for (size_t j = 0; j < n; j++) mac[j] ^= data[i+j];
+    soft_aes_encrypt_block(ctx, mac);
+  }
+}
+
+static void ccm_encrypt(uint8_t const k[16], uint8_t const nonce[12], uint8_t const* adata, size_t alen,
+                        uint8_t* buf, size_t len, uint8_t* tag, size_t tag_len)
+{
+  soft_aes_t ctx;
+  soft_aes_init(&ctx, k);
+
+  // B0: flags, nonce, 3-byte length
+  uint8_t mac[16];
+  mac[0] = (uint8_t) (0x40 | (((tag_len - 2) / 2) << 3) | 2);
+  memcpy(mac + 1, nonce, 12);
+  mac[13] = (uint8_t) (len >> 16);
+  mac[14] = (uint8_t) (len >> 8);
+  mac[15] = (uint8_t) len;
+  soft_aes_encrypt_block(&ctx, mac);
+
+  // associated data prefixed with its 2-byte length, zero padded
+  uint8_t ablock[64] = { 0 };
+  ablock[0] = (uint8_t) (alen >> 8);
+  ablock[1] = (uint8_t) alen;
+  memcpy(ablock + 2, adata, alen);
+  cbc_mac(&ctx, mac, ablock, (alen + 2 + 15) & ~15UL);
+
+  cbc_mac(&ctx, mac, buf, len);
+
+  // Ctr0 encrypts the tag, payload starts at Ctr1
+  uint8_t counter[16] = { 2 };
+  memcpy(counter + 1, nonce, 12);
+
+  uint8_t s0[16];
+  memcpy(s0, counter, 16);
+  soft_aes_encrypt_block(&ctx, s0);
+  for (size_t i = 0; i < tag_len; i++) tag[i] = mac[i] ^ s0[i];
+
+  counter[15] = 1;
+  soft_aes_ctr_crypt(&ctx, counter, buf, len);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static void test_ecb(void)
+{
+  soft_aes_t ctx;
+  soft_aes_init(&ctx, key);
+
+  uint8_t block[16];
+  memcpy(block, plain_text, 16);
+  soft_aes_encrypt_block(&ctx, block);
+
+  TEST_ASSERT_EQUAL_MEMORY(ecb_cipher, block, 16);
+}
+
+static void test_cbc(void)
+{
+  soft_aes_t ctx;
+  soft_aes_init(&ctx, key);
+
+  uint8_t iv[16], buf[64];
+  memcpy(iv, cbc_iv, 16);
+  memcpy(buf, plain_text, 64);
+  soft_aes_cbc_encrypt(&ctx, iv, buf, 64);
+
+  TEST_ASSERT_EQUAL_MEMORY(cbc_cipher, buf, 64);
+  TEST_ASSERT_EQUAL_MEMORY(cbc_cipher + 48, iv, 16); // chained for the next call
+}
+
+static void test_ctr(void)
+{
+  soft_aes_t ctx;
+  soft_aes_init(&ctx, key);
+
+  uint8_t counter[16], buf[64];
+  memcpy(counter, ctr_iv, 16);
+  memcpy(buf, plain_text, 64);
+  soft_aes_ctr_crypt(&ctx, counter, buf, 64);
+  TEST_ASSERT_EQUAL_MEMORY(ctr_cipher, buf, 64);
+
+  // decrypt is the same operation
+  memcpy(counter, ctr_iv, 16);
+  soft_aes_ctr_crypt(&ctx, counter, buf, 64);
+  TEST_ASSERT_EQUAL_MEMORY(plain_text, buf, 64);
+}
+
+// streaming in uneven pieces gives the same result while pieces are whole blocks
+static void test_ctr_streaming(void)
+{
+  soft_aes_t ctx;
+  soft_aes_init(&ctx, key);
+
+  uint8_t counter[16], buf[64];
+  memcpy(counter, ctr_iv, 16);
+  memcpy(buf, plain_text, 64);
+  soft_aes_ctr_crypt(&ctx, counter, buf, 16);
+  soft_aes_ctr_crypt(&ctx, counter, buf + 16, 32);
+  soft_aes_ctr_crypt(&ctx, counter, buf + 48, 16);
+
+  TEST_ASSERT_EQUAL_MEMORY(ctr_cipher, buf, 64);
+}
+
+static void test_ccm(void)
+{
+  uint8_t buf[24], tag[8];
+  memcpy(buf, ccm_plain, sizeof(buf));
+
+  ccm_encrypt(ccm_key, ccm_nonce, ccm_adata, sizeof(ccm_adata), buf, sizeof(buf), tag, sizeof(tag));
+
+  TEST_ASSERT_EQUAL_MEMORY(ccm_cipher, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_MEMORY(ccm_tag, tag, sizeof(tag));
+}
+
+static int run(void)
+{
+  RUN_TEST(test_ecb);
+  RUN_TEST(test_cbc);
+  RUN_TEST(test_ctr);
+  RUN_TEST(test_ctr_streaming);
+  RUN_TEST(test_ccm);
+
+  return unit_end();
+}
+
+int main(void)
+{
+  return host_main(run);
+}
@@ -0,0 +1,123 @@
+/* CryptoCell CC310 of the nRF52840 is not simulated: the runtime library
+ * reports a HAL error on init and every call fails, Adafruit_nRFCrypto and
+ * LESC key generation in BLESecurity give up as they would on a broken part.
+ * Legacy pairing and everything else of Bluefruit52Lib is unaffected.
+ */
+
+#include "sns_silib.h"
+#include "crys_rnd.h"
+#include "crys_rnd_error.h"
+#include "crys_ecpki_build.h"
+#include "crys_ecpki_domain.h"
+#include "crys_ecpki_kg.h"
+#include "crys_ecpki_dh.h"
+#include "crys_ecpki_ecdsa.h"
+#include "crys_ecpki_error.h"
+
+#define ECPKI_NOT_SUPPORTED     (CRYS_ECPKI_MODULE_ERROR_BASE + 0x1UL)
+
+SA_SilibRetCode_t SaSi_LibInit(void)
+{
+  return SA_SILIB_RET_HAL;
+}
+
+void SaSi_LibFini(void)
+{
+}
+
+//--------------------------------------------------------------------+
+// RND
+//--------------------------------------------------------------------+
+CRYSError_t CRYS_RndInit(void* rnd_ctx, CRYS_RND_WorkBuff_t* rndWorkBuff_ptr)
+{
+  return CRYS_RND_INIT_FAILED;
+}
+
+CRYSError_t CRYS_RND_UnInstantiation(void* rndState_ptr)
+{
+  return CRYS_OK;
+}
+
+CRYSError_t CRYS_RND_Reseeding(void* rndState_ptr, CRYS_RND_WorkBuff_t* rndWorkBuff_ptr)
+{
+  return CRYS_RND_INSTANTIATION_NOT_DONE_ERROR;
+}
+
+CRYSError_t CRYS_RND_AddAdditionalInput(void* rndState_ptr, uint8_t* additonalInput_ptr, uint16_t additonalInputSize)
+{
+  return CRYS_RND_INSTANTIATION_NOT_DONE_ERROR;
+}
+
+CRYSError_t CRYS_RND_GenerateVector(void* rndState_ptr, uint16_t outSizeBytes, uint8_t* out_ptr)
+{
+  return CRYS_RND_INSTANTIATION_NOT_DONE_ERROR;
+}
+
+CRYSError_t CRYS_RND_GenerateVectorInRange(void* rndState_ptr, SaSiRndGenerateVectWorkFunc_t rndGenerateVectFunc,
+                                           uint32_t rndSizeInBits, uint8_t* maxVect_ptr, uint8_t* rndVect_ptr)
+{
+  return CRYS_RND_INSTANTIATION_NOT_DONE_ERROR;
+}
+
+//--------------------------------------------------------------------+
+// ECC
+//--------------------------------------------------------------------+
+const CRYS_ECPKI_Domain_t* CRYS_ECPKI_GetEcDomain(CRYS_ECPKI_DomainID_t domainId)
+{
+  return NULL;
+}
+
+CRYSError_t CRYS_ECPKI_GenKeyPair(void* rndState_ptr, SaSiRndGenerateVectWorkFunc_t rndGenerateVectFunc,
+                                  const CRYS_ECPKI_Domain_t* pDomain, CRYS_ECPKI_UserPrivKey_t* pUserPrivKey,
+                                  CRYS_ECPKI_UserPublKey_t* pUserPublKey, CRYS_ECPKI_KG_TempData_t* pTempData,
+                                  CRYS_ECPKI_KG_FipsContext_t* pFipsCtx)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECPKI_BuildPrivKey(const CRYS_ECPKI_Domain_t* pDomain, const uint8_t* pPrivKeyIn,
+                                    uint32_t PrivKeySizeInBytes, CRYS_ECPKI_UserPrivKey_t* pUserPrivKey)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t _DX_ECPKI_BuildPublKey(const CRYS_ECPKI_Domain_t* pDomain, uint8_t* PublKeyIn_ptr,
+                                   uint32_t PublKeySizeInBytes, EC_PublKeyCheckMode_t CheckMode,
+                                   CRYS_ECPKI_UserPublKey_t* pUserPublKey, CRYS_ECPKI_BUILD_TempData_t* pTempBuff)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECPKI_ExportPrivKey(CRYS_ECPKI_UserPrivKey_t* pUserPrivKey, uint8_t* pExportPrivKey,
+                                     uint32_t* pPrivKeySizeBytes)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECPKI_ExportPublKey(CRYS_ECPKI_UserPublKey_t* pUserPublKey, CRYS_ECPKI_PointCompression_t compression,
+                                     uint8_t* pExternPublKey, uint32_t* pPublKeySizeBytes)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECDH_SVDP_DH(CRYS_ECPKI_UserPublKey_t* PartnerPublKey_ptr, CRYS_ECPKI_UserPrivKey_t* UserPrivKey_ptr,
+                              uint8_t* SharedSecretValue_ptr, uint32_t* SharedSecrValSize_ptr,
+                              CRYS_ECDH_TempData_t* TempBuff_ptr)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECDSA_Sign(void* rndState_ptr, SaSiRndGenerateVectWorkFunc_t rndGenerateVectFunc,
+                            CRYS_ECDSA_SignUserContext_t* pSignUserContext, CRYS_ECPKI_UserPrivKey_t* pSignerPrivKey,
+                            CRYS_ECPKI_HASH_OpMode_t hashMode, uint8_t* pMessageDataIn, uint32_t messageSizeInBytes,
+                            uint8_t* pSignatureOut, uint32_t* pSignatureOutSize)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
+
+CRYSError_t CRYS_ECDSA_Verify(CRYS_ECDSA_VerifyUserContext_t* pVerifyUserContext, CRYS_ECPKI_UserPublKey_t* pUserPublKey,
+                              CRYS_ECPKI_HASH_OpMode_t hashMode, uint8_t* pSignatureIn, uint32_t SignatureSizeBytes,
+                              uint8_t* pMessageDataIn, uint32_t messageSizeInBytes)
+{
+  return ECPKI_NOT_SUPPORTED;
+}
@@ -0,0 +1,413 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Pending BLE events, the SoftDevice keeps them in its own RAM as well
+#define EVT_QUEUE_SIZE          64
+
+#define CONN_CFG_TAG_MAX        4
+
+_Static_assert(sizeof(ble_evt_t) <= SD_EVT_LEN_MAX, "event slot too small");
+
+sd_sim_link_cfg_t sd_link_cfg =
+{
+  .conn_interval    = 24,
+  .peer_mtu         = SD_ATT_MTU_MAX,
+  .peer_data_length = 251,
+  .peer_phys        = BLE_GAP_PHY_1MBPS | BLE_GAP_PHY_2MBPS,
+  .loss_percent     = 0,
+  .att_delay        = 1,
+  .seed             = 0x2545F491
+};
+
+sd_sim_stats_t sd_stats;
+sd_sim_rx_cb_t sd_rx_cb;
+
+bool    sd_enabled;
+bool    sd_ble_enabled;
+bool    sd_conn_evt_ext;
+uint8_t sd_service_changed = BLE_GATTS_SERVICE_CHANGED_DEFAULT;
+
+static uint32_t _rand_state = 0x2545F491;
+
+static sd_conn_cfg_t _conn_cfg[CONN_CFG_TAG_MAX];
+
+static ble_uuid128_t _vs_uuid[BLE_UUID_VS_COUNT_DEFAULT*2];
+static uint8_t       _vs_count;
+static uint8_t       _vs_max = BLE_UUID_VS_COUNT_DEFAULT;
+
+static uint32_t _evt_buf[EVT_QUEUE_SIZE][(SD_EVT_LEN_MAX + 3) / 4];
+static uint16_t _evt_len[EVT_QUEUE_SIZE];
+static uint8_t  _evt_rd;
+static uint8_t  _evt_count;
+
+//--------------------------------------------------------------------+
+// Internal API
+//--------------------------------------------------------------------+
+sd_conn_cfg_t const* sd_conn_cfg(uint8_t conn_cfg_tag)
+{
+  static sd_conn_cfg_t const defaults =
+  {
+    .att_mtu      = BLE_GATT_ATT_MTU_DEFAULT,
+    .event_length = BLE_GAP_EVENT_LENGTH_DEFAULT,
+    .hvn_qsize    = BLE_GATTS_HVN_TX_QUEUE_SIZE_DEFAULT,
+    .wrcmd_qsize  = BLE_GATTC_WRITE_CMD_TX_QUEUE_SIZE_DEFAULT
+  };
+
+  if ( conn_cfg_tag >= CONN_CFG_TAG_MAX || _conn_cfg[conn_cfg_tag].att_mtu == 0 ) return &defaults;
+  return &_conn_cfg[conn_cfg_tag];
+}
+
+// xorshift32, deterministic for a given seed
+uint32_t sd_rand(void)
+{
+  uint32_t x = _rand_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  _rand_state = x;
+  return x;
+}
+
+ble_evt_t* sd_ble_evt_alloc(uint16_t evt_id, uint16_t len)
+{
+  if ( _evt_count == EVT_QUEUE_SIZE || len > SD_EVT_LEN_MAX )
+  {
+    sd_stats.evt_dropped++;
+    return NULL;
+  }
+
+  uint8_t const idx = (uint8_t) ((_evt_rd + _evt_count) % EVT_QUEUE_SIZE);
+  _evt_count++;
+
+  ble_evt_t* evt = (ble_evt_t*) _evt_buf[idx];
+  memset(evt, 0, len);
+  evt->header.evt_id  = evt_id;
+  evt->header.evt_len = len;
+  _evt_len[idx]       = len;
+
+  // taken after the caller leaves sd_lock()
+  host_irq_set_pending(SD_EVT_IRQn);
+
+  return evt;
+}
+
+uint8_t sd_uuid_encode(ble_uuid_t const* uuid, uint8_t* le)
+{
+  if ( uuid->type == BLE_UUID_TYPE_BLE )
+  {
+    sd_put_u16(le, uuid->uuid);
+    return 2;
+  }
+
+  uint8_t const idx = (uint8_t) (uuid->type - BLE_UUID_TYPE_VENDOR_BEGIN);
+  if ( uuid->type < BLE_UUID_TYPE_VENDOR_BEGIN || idx >= _vs_count ) return 0;
+
+  memcpy(le, _vs_uuid[idx].uuid128, 16);
+  sd_put_u16(le + 12, uuid->uuid);
+  return 16;
+}
+
+void sd_uuid_decode(uint8_t const* le, uint8_t len, ble_uuid_t* uuid)
+{
+  uuid->type = BLE_UUID_TYPE_UNKNOWN;
+  uuid->uuid = 0;
+
+  if ( len == 2 )
+  {
+    uuid->type = BLE_UUID_TYPE_BLE;
+    uuid->uuid = sd_u16(le);
+  }
+  else if ( len == 16 )
+  {
+    for(uint8_t i=0; i<_vs_count; i++)
+    {
+      // bytes 12-13 are the 16-bit UUID within the base
+      if ( !memcmp(le, _vs_uuid[i].uuid128, 12) && !memcmp(le+14, _vs_uuid[i].uuid128+14, 2) )
+      {
+        uuid->type = (uint8_t) (BLE_UUID_TYPE_VENDOR_BEGIN + i);
+        uuid->uuid = sd_u16(le + 12);
+        break;
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Simulator API
+//--------------------------------------------------------------------+
+void sd_sim_link_config(sd_sim_link_cfg_t const* cfg)
+{
+  sd_lock();
+  sd_link_cfg = *cfg;
+  _rand_state = cfg->seed ? cfg->seed : 1;
+  sd_unlock();
+}
+
+void sd_sim_link_config_get(sd_sim_link_cfg_t* cfg)
+{
+  *cfg = sd_link_cfg;
+}
+
+void sd_sim_stats(sd_sim_stats_t* stats)
+{
+  sd_lock();
+  *stats = sd_stats;
+  sd_unlock();
+}
+
+void sd_sim_stats_reset(void)
+{
+  sd_lock();
+  memset(&sd_stats, 0, sizeof(sd_stats));
+  sd_unlock();
+}
+
+void sd_sim_set_rx_callback(sd_sim_rx_cb_t cb)
+{
+  sd_rx_cb = cb;
+}
+
+//--------------------------------------------------------------------+
+// BLE common API
+//--------------------------------------------------------------------+
+uint32_t sd_ble_cfg_set(uint32_t cfg_id, ble_cfg_t const * p_cfg, uint32_t app_ram_base)
+{
+  (void) app_ram_base;
+
+  if ( !sd_enabled ) return NRF_ERROR_SOFTDEVICE_NOT_ENABLED;
+  if ( sd_ble_enabled ) return NRF_ERROR_INVALID_STATE;
+  if ( !p_cfg ) return NRF_ERROR_INVALID_ADDR;
+
+  if ( cfg_id >= BLE_CONN_CFG_GAP && cfg_id <= BLE_CONN_CFG_L2CAP )
+  {
+    uint8_t const tag = p_cfg->conn_cfg.conn_cfg_tag;
+    if ( tag >= CONN_CFG_TAG_MAX ) return NRF_ERROR_NO_MEM;
+
+    sd_conn_cfg_t* cfg = &_conn_cfg[tag];
+    if ( cfg->att_mtu == 0 ) *cfg = *sd_conn_cfg(BLE_CONN_CFG_TAG_DEFAULT);
+
+    switch ( cfg_id )
+    {
+      case BLE_CONN_CFG_GAP:
+        if ( p_cfg->conn_cfg.params.gap_conn_cfg.event_length < BLE_GAP_EVENT_LENGTH_MIN ) return NRF_ERROR_INVALID_PARAM;
+        cfg->event_length = p_cfg->conn_cfg.params.gap_conn_cfg.event_length;
+      break;
+
+      case BLE_CONN_CFG_GATTC:
+        cfg->wrcmd_qsize = p_cfg->conn_cfg.params.gattc_conn_cfg.write_cmd_tx_queue_size;
+        if ( cfg->wrcmd_qsize > SD_PDU_FIFO_SIZE/2 ) return NRF_ERROR_NO_MEM;
+      break;
+
+      case BLE_CONN_CFG_GATTS:
+        cfg->hvn_qsize = p_cfg->conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size;
+        if ( cfg->hvn_qsize > SD_PDU_FIFO_SIZE/2 ) return NRF_ERROR_NO_MEM;
+      break;
+
+      case BLE_CONN_CFG_GATT:
+      {
+        uint16_t const mtu = p_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu;
+        if ( mtu < BLE_GATT_ATT_MTU_DEFAULT || mtu > SD_ATT_MTU_MAX ) return NRF_ERROR_INVALID_PARAM;
+        cfg->att_mtu = mtu;
+      }
+      break;
+
+      default: break;
+    }
+    return NRF_SUCCESS;
+  }
+
+  switch ( cfg_id )
+  {
+    case BLE_COMMON_CFG_VS_UUID:
+      if ( p_cfg->common_cfg.vs_uuid_cfg.vs_uuid_count > sizeof(_vs_uuid)/sizeof(_vs_uuid[0]) ) return NRF_ERROR_NO_MEM;
+      _vs_max = p_cfg->common_cfg.vs_uuid_cfg.vs_uuid_count;
+    break;
+
+    case BLE_GATTS_CFG_SERVICE_CHANGED:
+      sd_service_changed = p_cfg->gatts_cfg.service_changed.service_changed;
+    break;
+
+    case BLE_GAP_CFG_ROLE_COUNT:
+    {
+      ble_gap_cfg_role_count_t const* role = &p_cfg->gap_cfg.role_count_cfg;
+      if ( role->periph_role_count + role->central_role_count > SD_SIM_LINK_MAX ) return NRF_ERROR_NO_MEM;
+    }
+    break;
+
+    case BLE_GAP_CFG_DEVICE_NAME:
+    case BLE_GATTS_CFG_ATTR_TAB_SIZE:
+    break;
+
+    default: return NRF_ERROR_NOT_SUPPORTED;
+  }
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_enable(uint32_t * p_app_ram_base)
+{
+  if ( !sd_enabled ) return NRF_ERROR_SOFTDEVICE_NOT_ENABLED;
+  if ( sd_ble_enabled ) return NRF_ERROR_INVALID_STATE;
+  if ( !p_app_ram_base ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  sd_ble_enabled = true;
+  sd_gap_init();
+  sd_gatts_init();
+
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_evt_get(uint8_t *p_dest, uint16_t *p_len)
+{
+  if ( !p_len ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  if ( _evt_count == 0 )
+  {
+    sd_unlock();
+    return NRF_ERROR_NOT_FOUND;
+  }
+
+  uint16_t const len = _evt_len[_evt_rd];
+
+  // peek length
+  if ( p_dest == NULL || *p_len < len )
+  {
+    *p_len = len;
+    sd_unlock();
+    return p_dest ? NRF_ERROR_DATA_SIZE : NRF_SUCCESS;
+  }
+
+  memcpy(p_dest, _evt_buf[_evt_rd], len);
+  *p_len = len;
+
+  _evt_rd = (uint8_t) ((_evt_rd + 1) % EVT_QUEUE_SIZE);
+  _evt_count--;
+
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const *p_vs_uuid, uint8_t *p_uuid_type)
+{
+  if ( !p_vs_uuid || !p_uuid_type ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  // same base is added only once
+  for(uint8_t i=0; i<_vs_count; i++)
+  {
+    if ( !memcmp(p_vs_uuid->uuid128, _vs_uuid[i].uuid128, 12) && !memcmp(p_vs_uuid->uuid128+14, _vs_uuid[i].uuid128+14, 2) )
+    {
+      *p_uuid_type = (uint8_t) (BLE_UUID_TYPE_VENDOR_BEGIN + i);
+      sd_unlock();
+      return NRF_SUCCESS;
+    }
+  }
+
+  if ( _vs_count >= _vs_max )
+  {
+    sd_unlock();
+    return NRF_ERROR_NO_MEM;
+  }
+
+  _vs_uuid[_vs_count] = *p_vs_uuid;
+  *p_uuid_type = (uint8_t) (BLE_UUID_TYPE_VENDOR_BEGIN + _vs_count);
+  _vs_count++;
+
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_uuid_vs_remove(uint8_t *p_uuid_type)
+{
+  (void) p_uuid_type;
+  return NRF_ERROR_NOT_SUPPORTED;
+}
+
+uint32_t sd_ble_uuid_decode(uint8_t uuid_le_len, uint8_t const *p_uuid_le, ble_uuid_t *p_uuid)
+{
+  if ( !p_uuid_le || !p_uuid ) return NRF_ERROR_INVALID_ADDR;
+  if ( uuid_le_len != 2 && uuid_le_len != 16 ) return NRF_ERROR_INVALID_LENGTH;
+
+  sd_lock();
+  sd_uuid_decode(p_uuid_le, uuid_le_len, p_uuid);
+  sd_unlock();
+
+  return (p_uuid->type == BLE_UUID_TYPE_UNKNOWN) ? NRF_ERROR_NOT_FOUND : NRF_SUCCESS;
+}
+
+uint32_t sd_ble_uuid_encode(ble_uuid_t const *p_uuid, uint8_t *p_uuid_le_len, uint8_t *p_uuid_le)
+{
+  if ( !p_uuid || !p_uuid_le_len ) return NRF_ERROR_INVALID_ADDR;
+
+  uint8_t buf[16];
+
+  sd_lock();
+  uint8_t const len = sd_uuid_encode(p_uuid, buf);
+  sd_unlock();
+
+  if ( len == 0 ) return NRF_ERROR_INVALID_PARAM;
+
+  *p_uuid_le_len = len;
+  if ( p_uuid_le ) memcpy(p_uuid_le, buf, len);
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_version_get(ble_version_t *p_version)
+{
+  if ( !p_version ) return NRF_ERROR_INVALID_ADDR;
+
+  // S140 v6.1.1
+  p_version->version_number    = 9;
+  p_version->company_id        = 0x0059;
+  p_version->subversion_number = 0x00B6;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_user_mem_reply(uint16_t conn_handle, ble_user_mem_block_t const *p_block)
+{
+  (void) p_block;
+  return sd_link_get(conn_handle) ? NRF_SUCCESS : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_opt_set(uint32_t opt_id, ble_opt_t const *p_opt)
+{
+  if ( !p_opt ) return NRF_ERROR_INVALID_ADDR;
+
+  switch ( opt_id )
+  {
+    case BLE_COMMON_OPT_CONN_EVT_EXT:
+      sd_conn_evt_ext = p_opt->common_opt.conn_evt_ext.enable;
+    break;
+
+    case BLE_GAP_OPT_PASSKEY:
+    break;
+
+    default: return NRF_ERROR_NOT_SUPPORTED;
+  }
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_opt_get(uint32_t opt_id, ble_opt_t *p_opt)
+{
+  if ( !p_opt ) return NRF_ERROR_INVALID_ADDR;
+
+  if ( opt_id != BLE_COMMON_OPT_CONN_EVT_EXT ) return NRF_ERROR_NOT_SUPPORTED;
+  p_opt->common_opt.conn_evt_ext.enable = sd_conn_evt_ext;
+
+  return NRF_SUCCESS;
+}
@@ -0,0 +1,724 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// advDelay added to every advertising event, 0-10 ms
+#define ADV_DELAY_MAX_US        10000
+
+// Supervision timeout picked by the peer central, in 10 ms unit
+#define PEER_SUP_TIMEOUT        400
+
+typedef struct
+{
+  bool     configured;
+  bool     running;
+  uint8_t  conn_cfg_tag;
+  uint64_t deadline_us;       // 0 without duration
+
+  ble_gap_adv_data_t   data;
+  ble_gap_adv_params_t params;
+
+  host_timer_t timer;
+} gap_adv_t;
+
+typedef struct
+{
+  bool     running;
+  bool     paused;            // report sent, waiting for resume
+  uint64_t start_us;
+
+  ble_gap_scan_params_t params;
+  ble_data_t            buffer;
+
+  host_timer_t timeout;
+} gap_scan_t;
+
+typedef struct
+{
+  bool     running;
+  uint8_t  conn_cfg_tag;
+
+  ble_gap_addr_t        peer_addr;
+  ble_gap_conn_params_t conn_params;
+
+  host_timer_t timeout;
+} gap_connect_t;
+
+typedef struct
+{
+  sd_sim_adv_t adv;
+  host_timer_t timer;
+} gap_advertiser_t;
+
+ble_gap_conn_params_t sd_gap_ppcp;
+
+static ble_gap_addr_t _addr;
+static uint8_t        _name[BLE_GAP_DEVNAME_MAX_LEN];
+static uint16_t       _name_len;
+static uint16_t       _appearance;
+
+static gap_adv_t     _adv;
+static gap_scan_t    _scan;
+static gap_connect_t _connect;
+static bool          _peer_connect;
+
+static gap_advertiser_t _advertiser[SD_SIM_ADV_MAX];
+static uint8_t          _advertiser_count;
+
+static inline uint32_t adv_delay_us(void)
+{
+  return sd_rand() % ADV_DELAY_MAX_US;
+}
+
+static inline bool addr_equal(ble_gap_addr_t const* a, ble_gap_addr_t const* b)
+{
+  return (a->addr_type == b->addr_type) && !memcmp(a->addr, b->addr, BLE_GAP_ADDR_LEN);
+}
+
+void sd_gap_init(void)
+{
+  static uint8_t const default_name[] = "nRF5x";
+
+  // random static: two most significant bits set
+  _addr.addr_id_peer = 0;
+  _addr.addr_type    = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+  for(uint8_t i=0; i<BLE_GAP_ADDR_LEN; i++) _addr.addr[i] = (uint8_t) sd_rand();
+  _addr.addr[5] |= 0xC0;
+
+  memcpy(_name, default_name, sizeof(default_name)-1);
+  _name_len = sizeof(default_name)-1;
+}
+
+//--------------------------------------------------------------------+
+// Address, name and preferred parameters
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gap_addr_set(ble_gap_addr_t const *p_addr)
+{
+  if ( !p_addr ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_addr->addr_type != BLE_GAP_ADDR_TYPE_PUBLIC && p_addr->addr_type != BLE_GAP_ADDR_TYPE_RANDOM_STATIC ) return BLE_ERROR_GAP_INVALID_BLE_ADDR;
+  if ( _adv.running || _scan.running || _connect.running ) return NRF_ERROR_INVALID_STATE;
+
+  _addr = *p_addr;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_addr_get(ble_gap_addr_t *p_addr)
+{
+  if ( !p_addr ) return NRF_ERROR_INVALID_ADDR;
+
+  *p_addr = _addr;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_adv_addr_get(uint8_t adv_handle, ble_gap_addr_t *p_addr)
+{
+  if ( !p_addr ) return NRF_ERROR_INVALID_ADDR;
+  if ( adv_handle != 0 || !_adv.configured ) return BLE_ERROR_INVALID_ADV_HANDLE;
+  if ( !_adv.running ) return NRF_ERROR_INVALID_STATE;
+
+  *p_addr = _addr;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const *p_write_perm, uint8_t const *p_dev_name, uint16_t len)
+{
+  (void) p_write_perm;
+
+  if ( len > BLE_GAP_DEVNAME_MAX_LEN ) return NRF_ERROR_DATA_SIZE;
+  if ( len && !p_dev_name ) return NRF_ERROR_INVALID_ADDR;
+
+  memcpy(_name, p_dev_name, len);
+  _name_len = len;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_device_name_get(uint8_t *p_dev_name, uint16_t *p_len)
+{
+  if ( !p_len ) return NRF_ERROR_INVALID_ADDR;
+
+  // NULL buffer only queries the length
+  if ( p_dev_name )
+  {
+    if ( *p_len < _name_len ) return NRF_ERROR_DATA_SIZE;
+    memcpy(p_dev_name, _name, _name_len);
+  }
+  *p_len = _name_len;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_appearance_set(uint16_t appearance)
+{
+  _appearance = appearance;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_appearance_get(uint16_t *p_appearance)
+{
+  if ( !p_appearance ) return NRF_ERROR_INVALID_ADDR;
+
+  *p_appearance = _appearance;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const *p_conn_params)
+{
+  if ( !p_conn_params ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_gap_ppcp = *p_conn_params;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_ppcp_get(ble_gap_conn_params_t *p_conn_params)
+{
+  if ( !p_conn_params ) return NRF_ERROR_INVALID_ADDR;
+
+  *p_conn_params = sd_gap_ppcp;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_tx_power_set(uint8_t role, uint16_t handle, int8_t tx_power)
+{
+  (void) tx_power;
+
+  if ( role == BLE_GAP_TX_POWER_ROLE_ADV && handle != 0 ) return BLE_ERROR_INVALID_ADV_HANDLE;
+  if ( role == BLE_GAP_TX_POWER_ROLE_CONN && !sd_link_get(handle) ) return BLE_ERROR_INVALID_CONN_HANDLE;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_conn_sec_get(uint16_t conn_handle, ble_gap_conn_sec_t *p_conn_sec)
+{
+  if ( !p_conn_sec ) return NRF_ERROR_INVALID_ADDR;
+  if ( !sd_link_get(conn_handle) ) return BLE_ERROR_INVALID_CONN_HANDLE;
+
+  // links are never encrypted: security mode 1 level 1
+  memset(p_conn_sec, 0, sizeof(ble_gap_conn_sec_t));
+  p_conn_sec->sec_mode.sm = 1;
+  p_conn_sec->sec_mode.lv = 1;
+
+  return NRF_SUCCESS;
+}
+
+//--------------------------------------------------------------------+
+// Advertising
+//--------------------------------------------------------------------+
+static bool adv_connectable(void)
+{
+  switch ( _adv.params.properties.type )
+  {
+    case BLE_GAP_ADV_TYPE_CONNECTABLE_SCANNABLE_UNDIRECTED:
+    case BLE_GAP_ADV_TYPE_CONNECTABLE_NONSCANNABLE_DIRECTED_HIGH_DUTY_CYCLE:
+    case BLE_GAP_ADV_TYPE_CONNECTABLE_NONSCANNABLE_DIRECTED:
+    case BLE_GAP_ADV_TYPE_EXTENDED_CONNECTABLE_NONSCANNABLE_UNDIRECTED:
+    case BLE_GAP_ADV_TYPE_EXTENDED_CONNECTABLE_NONSCANNABLE_DIRECTED:
+      return true;
+
+    default: return false;
+  }
+}
+
+static void adv_event(host_timer_t* timer)
+{
+  (void) timer;
+
+  sd_lock();
+
+  uint64_t const now = host_time_us();
+
+  if ( _peer_connect && adv_connectable() )
+  {
+    // CONNECT_IND received in this advertising event
+    ble_gap_conn_params_t params =
+    {
+      .min_conn_interval = sd_link_cfg.conn_interval,
+      .max_conn_interval = sd_link_cfg.conn_interval,
+      .slave_latency     = 0,
+      .conn_sup_timeout  = PEER_SUP_TIMEOUT
+    };
+
+    _peer_connect = false;
+    _adv.running  = false;
+
+    sd_link_open(BLE_GAP_ROLE_PERIPH, _adv.conn_cfg_tag, &sd_peer_central_addr, &params, 0, &_adv.data);
+  }
+  else if ( _adv.deadline_us && now >= _adv.deadline_us )
+  {
+    _adv.running = false;
+
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_ADV_SET_TERMINATED, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      ble_gap_evt_adv_set_terminated_t* term = &evt->evt.gap_evt.params.adv_set_terminated;
+
+      evt->evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+      term->reason     = BLE_GAP_EVT_ADV_SET_TERMINATED_REASON_TIMEOUT;
+      term->adv_handle = 0;
+      term->adv_data   = _adv.data;
+    }
+  }
+  else
+  {
+    host_timer_start(&_adv.timer, now + _adv.params.interval*625u + adv_delay_us());
+  }
+
+  sd_unlock();
+}
+
+uint32_t sd_ble_gap_adv_set_configure(uint8_t *p_adv_handle, ble_gap_adv_data_t const *p_adv_data, ble_gap_adv_params_t const *p_adv_params)
+{
+  if ( !p_adv_handle ) return NRF_ERROR_INVALID_ADDR;
+
+  if ( *p_adv_handle == BLE_GAP_ADV_SET_HANDLE_NOT_SET )
+  {
+    // only one advertising set
+    if ( _adv.configured ) return NRF_ERROR_NO_MEM;
+    if ( !p_adv_params ) return NRF_ERROR_INVALID_PARAM;
+  }
+  else if ( *p_adv_handle != 0 || !_adv.configured )
+  {
+    return BLE_ERROR_INVALID_ADV_HANDLE;
+  }
+
+  if ( p_adv_params )
+  {
+    if ( _adv.running ) return NRF_ERROR_INVALID_STATE;
+    if ( p_adv_params->interval < BLE_GAP_ADV_INTERVAL_MIN || p_adv_params->interval > BLE_GAP_ADV_INTERVAL_MAX ) return NRF_ERROR_INVALID_PARAM;
+  }
+
+  if ( p_adv_data )
+  {
+    if ( p_adv_data->adv_data.len > BLE_GAP_ADV_SET_DATA_SIZE_MAX || p_adv_data->scan_rsp_data.len > BLE_GAP_ADV_SET_DATA_SIZE_MAX ) return NRF_ERROR_INVALID_DATA;
+  }
+
+  sd_lock();
+
+  if ( p_adv_params ) _adv.params = *p_adv_params;
+  if ( p_adv_data   ) _adv.data   = *p_adv_data;
+
+  _adv.configured = true;
+  *p_adv_handle   = 0;
+
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_adv_start(uint8_t adv_handle, uint8_t conn_cfg_tag)
+{
+  if ( adv_handle != 0 || !_adv.configured ) return BLE_ERROR_INVALID_ADV_HANDLE;
+
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( _adv.running )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else if ( adv_connectable() && sd_link_count(BLE_GAP_ROLE_PERIPH) + sd_link_count(BLE_GAP_ROLE_CENTRAL) >= SD_SIM_LINK_MAX )
+  {
+    err = NRF_ERROR_CONN_COUNT;
+  }
+  else
+  {
+    uint64_t const now = host_time_us();
+
+    _adv.running      = true;
+    _adv.conn_cfg_tag = conn_cfg_tag;
+    _adv.deadline_us  = _adv.params.duration ? (now + _adv.params.duration*10000ull) : 0;
+
+    _adv.timer.cb   = adv_event;
+    _adv.timer.irqn = SD_RADIO_IRQn;
+    host_timer_start(&_adv.timer, now + adv_delay_us());
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_adv_stop(uint8_t adv_handle)
+{
+  if ( adv_handle != 0 || !_adv.configured ) return BLE_ERROR_INVALID_ADV_HANDLE;
+  if ( !_adv.running ) return NRF_ERROR_INVALID_STATE;
+
+  sd_lock();
+  host_timer_stop(&_adv.timer);
+  _adv.running = false;
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+void sd_sim_peer_connect(void)
+{
+  sd_lock();
+  _peer_connect = true;
+  sd_unlock();
+}
+
+//--------------------------------------------------------------------+
+// Scanning and initiating
+//--------------------------------------------------------------------+
+static bool scan_in_window(uint64_t now)
+{
+  uint32_t const interval_us = _scan.params.interval * 625u;
+  uint32_t const window_us   = _scan.params.window * 625u;
+
+  return ((now - _scan.start_us) % interval_us) < window_us;
+}
+
+static void scan_report(sd_sim_adv_t const* adv)
+{
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_ADV_REPORT, sizeof(ble_evt_t));
+  if ( !evt ) return;
+
+  ble_gap_evt_adv_report_t* report = &evt->evt.gap_evt.params.adv_report;
+  uint16_t const len = SD_MIN(adv->len, _scan.buffer.len);
+
+  memcpy(_scan.buffer.p_data, adv->data, len);
+
+  evt->evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+  report->type.connectable = adv->connectable;
+  report->type.scannable   = adv->connectable;
+  report->type.status      = BLE_GAP_ADV_DATA_STATUS_COMPLETE;
+  report->peer_addr        = adv->addr;
+  report->primary_phy      = BLE_GAP_PHY_1MBPS;
+  report->secondary_phy    = BLE_GAP_PHY_NOT_SET;
+  report->tx_power         = BLE_GAP_POWER_LEVEL_INVALID;
+  report->rssi             = adv->rssi;
+  report->ch_index         = (uint8_t) (37 + sd_rand() % 3);
+  report->set_id           = BLE_GAP_ADV_REPORT_SET_ID_NOT_AVAILABLE;
+  report->data.p_data      = _scan.buffer.p_data;
+  report->data.len         = len;
+
+  // buffer belongs to the application until scanning is resumed
+  _scan.paused = true;
+  sd_stats.scan_reports++;
+}
+
+static void advertiser_event(host_timer_t* timer)
+{
+  gap_advertiser_t* advertiser = (gap_advertiser_t*) timer->arg;
+  sd_sim_adv_t const* adv = &advertiser->adv;
+
+  sd_lock();
+
+  uint64_t const now = host_time_us();
+
+  if ( _connect.running && adv->connectable && addr_equal(&adv->addr, &_connect.peer_addr) )
+  {
+    _connect.running = false;
+    host_timer_stop(&_connect.timeout);
+
+    sd_link_open(BLE_GAP_ROLE_CENTRAL, _connect.conn_cfg_tag, &adv->addr, &_connect.conn_params, BLE_GAP_ADV_SET_HANDLE_NOT_SET, NULL);
+  }
+  else if ( _scan.running && scan_in_window(now) )
+  {
+    if ( _scan.paused )
+    {
+      sd_stats.scan_missed++;
+    }
+    else
+    {
+      scan_report(adv);
+    }
+  }
+
+  // advertisers are only heard while the radio listens
+  if ( _scan.running || _connect.running )
+  {
+    host_timer_start(&advertiser->timer, now + adv->interval*625u + adv_delay_us());
+  }
+
+  sd_unlock();
+}
+
+static void advertisers_start(void)
+{
+  uint64_t const now = host_time_us();
+
+  for(uint8_t i=0; i<_advertiser_count; i++)
+  {
+    gap_advertiser_t* advertiser = &_advertiser[i];
+    if ( advertiser->timer.active ) continue;
+
+    // random phase within one interval
+    host_timer_start(&advertiser->timer, now + sd_rand() % (advertiser->adv.interval*625u));
+  }
+}
+
+static void scan_timeout(host_timer_t* timer)
+{
+  (void) timer;
+
+  sd_lock();
+
+  _scan.running = false;
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_TIMEOUT, sizeof(ble_evt_t));
+  if ( evt )
+  {
+    evt->evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+    evt->evt.gap_evt.params.timeout.src = BLE_GAP_TIMEOUT_SRC_SCAN;
+    evt->evt.gap_evt.params.timeout.params.adv_report_buffer = _scan.buffer;
+  }
+
+  sd_unlock();
+}
+
+static void connect_timeout(host_timer_t* timer)
+{
+  (void) timer;
+
+  sd_lock();
+
+  _connect.running = false;
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_TIMEOUT, sizeof(ble_evt_t));
+  if ( evt )
+  {
+    evt->evt.gap_evt.conn_handle = BLE_CONN_HANDLE_INVALID;
+    evt->evt.gap_evt.params.timeout.src = BLE_GAP_TIMEOUT_SRC_CONN;
+  }
+
+  sd_unlock();
+}
+
+uint32_t sd_ble_gap_scan_start(ble_gap_scan_params_t const *p_scan_params, ble_data_t const * p_adv_report_buffer)
+{
+  if ( !p_adv_report_buffer || !p_adv_report_buffer->p_data ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_adv_report_buffer->len < BLE_GAP_SCAN_BUFFER_MIN ) return NRF_ERROR_INVALID_LENGTH;
+
+  if ( p_scan_params )
+  {
+    if ( p_scan_params->interval < BLE_GAP_SCAN_INTERVAL_MIN || p_scan_params->window < BLE_GAP_SCAN_WINDOW_MIN ||
+         p_scan_params->window > p_scan_params->interval ) return NRF_ERROR_INVALID_PARAM;
+  }
+
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( p_scan_params )
+  {
+    if ( _scan.running || _connect.running )
+    {
+      err = NRF_ERROR_INVALID_STATE;
+    }
+    else
+    {
+      uint64_t const now = host_time_us();
+
+      _scan.running  = true;
+      _scan.paused   = false;
+      _scan.start_us = now;
+      _scan.params   = *p_scan_params;
+      _scan.buffer   = *p_adv_report_buffer;
+
+      if ( p_scan_params->timeout )
+      {
+        _scan.timeout.cb   = scan_timeout;
+        _scan.timeout.irqn = SD_RADIO_IRQn;
+        host_timer_start(&_scan.timeout, now + p_scan_params->timeout*10000ull);
+      }
+
+      advertisers_start();
+    }
+  }
+  else
+  {
+    // resume after a report
+    if ( !_scan.running || !_scan.paused )
+    {
+      err = NRF_ERROR_INVALID_STATE;
+    }
+    else
+    {
+      _scan.paused = false;
+      _scan.buffer = *p_adv_report_buffer;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_scan_stop(void)
+{
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !_scan.running )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else
+  {
+    _scan.running = false;
+    host_timer_stop(&_scan.timeout);
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_connect(ble_gap_addr_t const *p_peer_addr, ble_gap_scan_params_t const *p_scan_params,
+                            ble_gap_conn_params_t const *p_conn_params, uint8_t conn_cfg_tag)
+{
+  if ( !p_peer_addr || !p_scan_params || !p_conn_params ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( _connect.running )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else if ( sd_link_count(BLE_GAP_ROLE_PERIPH) + sd_link_count(BLE_GAP_ROLE_CENTRAL) >= SD_SIM_LINK_MAX )
+  {
+    err = NRF_ERROR_CONN_COUNT;
+  }
+  else
+  {
+    // ongoing scanning is stopped by the initiator
+    if ( _scan.running )
+    {
+      _scan.running = false;
+      host_timer_stop(&_scan.timeout);
+    }
+
+    _connect.running      = true;
+    _connect.conn_cfg_tag = conn_cfg_tag;
+    _connect.peer_addr    = *p_peer_addr;
+    _connect.conn_params  = *p_conn_params;
+
+    // central uses the maximum interval it accepts
+    _connect.conn_params.min_conn_interval = p_conn_params->max_conn_interval;
+
+    if ( p_scan_params->timeout )
+    {
+      _connect.timeout.cb   = connect_timeout;
+      _connect.timeout.irqn = SD_RADIO_IRQn;
+      host_timer_start(&_connect.timeout, host_time_us() + p_scan_params->timeout*10000ull);
+    }
+
+    advertisers_start();
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_connect_cancel(void)
+{
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !_connect.running )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else
+  {
+    _connect.running = false;
+    host_timer_stop(&_connect.timeout);
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// Peer advertisers
+//--------------------------------------------------------------------+
+bool sd_sim_advertiser_add(sd_sim_adv_t const* adv)
+{
+  if ( adv->len > BLE_GAP_ADV_SET_DATA_SIZE_MAX || adv->interval == 0 ) return false;
+
+  sd_lock();
+
+  bool const added = (_advertiser_count < SD_SIM_ADV_MAX);
+  if ( added )
+  {
+    gap_advertiser_t* advertiser = &_advertiser[_advertiser_count++];
+
+    memset(advertiser, 0, sizeof(gap_advertiser_t));
+    advertiser->adv        = *adv;
+    advertiser->timer.cb   = advertiser_event;
+    advertiser->timer.irqn = SD_RADIO_IRQn;
+    advertiser->timer.arg  = advertiser;
+
+    if ( _scan.running || _connect.running ) advertisers_start();
+  }
+
+  sd_unlock();
+
+  return added;
+}
+
+void sd_sim_advertiser_clear(void)
+{
+  sd_lock();
+
+  for(uint8_t i=0; i<_advertiser_count; i++) host_timer_stop(&_advertiser[i].timer);
+  _advertiser_count = 0;
+
+  sd_unlock();
+}
+
+//--------------------------------------------------------------------+
+// Security: links stay unencrypted
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gap_authenticate(uint16_t conn_handle, ble_gap_sec_params_t const *p_sec_params)
+{
+  (void) p_sec_params;
+  return sd_link_get(conn_handle) ? NRF_ERROR_NOT_SUPPORTED : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_sec_params_reply(uint16_t conn_handle, uint8_t sec_status, ble_gap_sec_params_t const *p_sec_params, ble_gap_sec_keyset_t const *p_sec_keyset)
+{
+  (void) sec_status;
+  (void) p_sec_params;
+  (void) p_sec_keyset;
+  return sd_link_get(conn_handle) ? NRF_ERROR_INVALID_STATE : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_auth_key_reply(uint16_t conn_handle, uint8_t key_type, uint8_t const *p_key)
+{
+  (void) key_type;
+  (void) p_key;
+  return sd_link_get(conn_handle) ? NRF_ERROR_INVALID_STATE : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_lesc_dhkey_reply(uint16_t conn_handle, ble_gap_lesc_dhkey_t const *p_dhkey)
+{
+  (void) p_dhkey;
+  return sd_link_get(conn_handle) ? NRF_ERROR_INVALID_STATE : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_encrypt(uint16_t conn_handle, ble_gap_master_id_t const *p_master_id, ble_gap_enc_info_t const *p_enc_info)
+{
+  (void) p_master_id;
+  (void) p_enc_info;
+  return sd_link_get(conn_handle) ? NRF_ERROR_NOT_SUPPORTED : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_sec_info_reply(uint16_t conn_handle, ble_gap_enc_info_t const *p_enc_info, ble_gap_irk_t const *p_id_info, ble_gap_sign_info_t const *p_sign_info)
+{
+  (void) p_enc_info;
+  (void) p_id_info;
+  (void) p_sign_info;
+  return sd_link_get(conn_handle) ? NRF_ERROR_INVALID_STATE : BLE_ERROR_INVALID_CONN_HANDLE;
+}
@@ -0,0 +1,609 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Event length with count entries of a variable length member
+#define GATTC_EVT_LEN(member, size) \
+  ((uint16_t) SD_MAX(sizeof(ble_evt_t), offsetof(ble_evt_t, evt.gattc_evt.params.member) + (size)))
+
+// Start an ATT request, only one client procedure at a time like the SoftDevice
+static uint32_t request_start(uint16_t conn_hdl, uint8_t op, uint16_t evt_id, sd_pdu_t** p_pdu)
+{
+  sd_link_t* link = sd_link_get(conn_hdl);
+  if ( !link ) return BLE_ERROR_INVALID_CONN_HANDLE;
+  if ( link->gattc_req ) return NRF_ERROR_BUSY;
+
+  sd_pdu_t* pdu = sd_link_tx(link, op);
+  if ( !pdu ) return NRF_ERROR_BUSY;
+
+  link->gattc_req = op;
+  link->gattc_evt = evt_id;
+  *p_pdu = pdu;
+
+  return NRF_SUCCESS;
+}
+
+static inline void put_range(uint8_t* p, ble_gattc_handle_range_t const* range)
+{
+  sd_put_u16(p, range->start_handle);
+  sd_put_u16(p+2, range->end_handle);
+}
+
+static bool range_valid(ble_gattc_handle_range_t const* range)
+{
+  return range && range->start_handle != BLE_GATT_HANDLE_INVALID && range->start_handle <= range->end_handle;
+}
+
+//--------------------------------------------------------------------+
+// Discovery
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gattc_primary_services_discover(uint16_t conn_handle, uint16_t start_handle, ble_uuid_t const *p_srvc_uuid)
+{
+  if ( start_handle == BLE_GATT_HANDLE_INVALID ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  uint8_t uuid_le[16];
+  uint8_t const uuid_len = p_srvc_uuid ? sd_uuid_encode(p_srvc_uuid, uuid_le) : 0;
+
+  sd_pdu_t* pdu = NULL;
+  uint32_t err = NRF_ERROR_INVALID_PARAM;
+
+  if ( !p_srvc_uuid || uuid_len )
+  {
+    // by UUID: Find By Type Value, otherwise all services: Read By Group Type
+    err = request_start(conn_handle, p_srvc_uuid ? SD_ATT_FIND_BY_TYPE_VALUE_REQ : SD_ATT_READ_BY_GROUP_TYPE_REQ,
+                        BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP, &pdu);
+  }
+
+  if ( err == NRF_SUCCESS )
+  {
+    sd_link_t* link = sd_link_get(conn_handle);
+
+    sd_put_u16(pdu->data, start_handle);
+    sd_put_u16(pdu->data+2, BLE_GATT_HANDLE_END);
+    sd_put_u16(pdu->data+4, BLE_UUID_SERVICE_PRIMARY);
+    pdu->len = 6;
+
+    if ( p_srvc_uuid )
+    {
+      memcpy(pdu->data+6, uuid_le, uuid_len);
+      pdu->len += uuid_len;
+      link->gattc_uuid = *p_srvc_uuid;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_relationships_discover(uint16_t conn_handle, ble_gattc_handle_range_t const *p_handle_range)
+{
+  (void) p_handle_range;
+  return sd_link_get(conn_handle) ? NRF_ERROR_NOT_SUPPORTED : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gattc_characteristics_discover(uint16_t conn_handle, ble_gattc_handle_range_t const *p_handle_range)
+{
+  if ( !range_valid(p_handle_range) ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  sd_pdu_t* pdu;
+  uint32_t const err = request_start(conn_handle, SD_ATT_READ_BY_TYPE_REQ, BLE_GATTC_EVT_CHAR_DISC_RSP, &pdu);
+
+  if ( err == NRF_SUCCESS )
+  {
+    put_range(pdu->data, p_handle_range);
+    sd_put_u16(pdu->data+4, BLE_UUID_CHARACTERISTIC);
+    pdu->len = 6;
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+static uint32_t find_info(uint16_t conn_handle, ble_gattc_handle_range_t const *p_handle_range, uint16_t evt_id)
+{
+  if ( !range_valid(p_handle_range) ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  sd_pdu_t* pdu;
+  uint32_t const err = request_start(conn_handle, SD_ATT_FIND_INFO_REQ, evt_id, &pdu);
+
+  if ( err == NRF_SUCCESS )
+  {
+    put_range(pdu->data, p_handle_range);
+    pdu->len = 4;
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_descriptors_discover(uint16_t conn_handle, ble_gattc_handle_range_t const *p_handle_range)
+{
+  return find_info(conn_handle, p_handle_range, BLE_GATTC_EVT_DESC_DISC_RSP);
+}
+
+uint32_t sd_ble_gattc_attr_info_discover(uint16_t conn_handle, ble_gattc_handle_range_t const * p_handle_range)
+{
+  return find_info(conn_handle, p_handle_range, BLE_GATTC_EVT_ATTR_INFO_DISC_RSP);
+}
+
+//--------------------------------------------------------------------+
+// Read and write
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gattc_char_value_by_uuid_read(uint16_t conn_handle, ble_uuid_t const *p_uuid, ble_gattc_handle_range_t const *p_handle_range)
+{
+  if ( !p_uuid ) return NRF_ERROR_INVALID_ADDR;
+  if ( !range_valid(p_handle_range) ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  uint8_t uuid_le[16];
+  uint8_t const uuid_len = sd_uuid_encode(p_uuid, uuid_le);
+
+  sd_pdu_t* pdu = NULL;
+  uint32_t err = uuid_len ? request_start(conn_handle, SD_ATT_READ_BY_TYPE_REQ, BLE_GATTC_EVT_CHAR_VAL_BY_UUID_READ_RSP, &pdu)
+                          : NRF_ERROR_INVALID_PARAM;
+
+  if ( err == NRF_SUCCESS )
+  {
+    put_range(pdu->data, p_handle_range);
+    memcpy(pdu->data+4, uuid_le, uuid_len);
+    pdu->len = (uint16_t) (4 + uuid_len);
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_read(uint16_t conn_handle, uint16_t handle, uint16_t offset)
+{
+  if ( handle == BLE_GATT_HANDLE_INVALID ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  sd_pdu_t* pdu;
+  uint32_t const err = request_start(conn_handle, offset ? SD_ATT_READ_BLOB_REQ : SD_ATT_READ_REQ, BLE_GATTC_EVT_READ_RSP, &pdu);
+
+  if ( err == NRF_SUCCESS )
+  {
+    sd_link_t* link = sd_link_get(conn_handle);
+    link->gattc_handle = handle;
+    link->gattc_offset = offset;
+
+    sd_put_u16(pdu->data, handle);
+    pdu->len = 2;
+
+    if ( offset )
+    {
+      sd_put_u16(pdu->data+2, offset);
+      pdu->len = 4;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_char_values_read(uint16_t conn_handle, uint16_t const *p_handles, uint16_t handle_count)
+{
+  (void) p_handles;
+  (void) handle_count;
+  return sd_link_get(conn_handle) ? NRF_ERROR_NOT_SUPPORTED : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+static uint32_t write_cmd(uint16_t conn_handle, ble_gattc_write_params_t const *p_write_params)
+{
+  sd_link_t* link = sd_link_get(conn_handle);
+  if ( !link ) return BLE_ERROR_INVALID_CONN_HANDLE;
+
+  if ( p_write_params->len > link->mtu - 3 ) return NRF_ERROR_DATA_SIZE;
+  if ( link->wrcmd_queued >= sd_conn_cfg(link->cfg_tag)->wrcmd_qsize ) return NRF_ERROR_RESOURCES;
+
+  sd_pdu_t* pdu = sd_link_tx(link, SD_ATT_WRITE_CMD);
+  if ( !pdu ) return NRF_ERROR_RESOURCES;
+
+  sd_put_u16(pdu->data, p_write_params->handle);
+  memcpy(pdu->data+2, p_write_params->p_value, p_write_params->len);
+  pdu->len = (uint16_t) (2 + p_write_params->len);
+
+  link->wrcmd_queued++;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gattc_write(uint16_t conn_handle, ble_gattc_write_params_t const *p_write_params)
+{
+  if ( !p_write_params ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_write_params->len && !p_write_params->p_value ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  sd_pdu_t* pdu = NULL;
+  uint32_t err;
+
+  switch ( p_write_params->write_op )
+  {
+    case BLE_GATT_OP_WRITE_CMD:
+      err = write_cmd(conn_handle, p_write_params);
+    break;
+
+    case BLE_GATT_OP_WRITE_REQ:
+      if ( link && p_write_params->len > link->mtu - 3 )
+      {
+        err = NRF_ERROR_DATA_SIZE;
+        break;
+      }
+
+      err = request_start(conn_handle, SD_ATT_WRITE_REQ, BLE_GATTC_EVT_WRITE_RSP, &pdu);
+      if ( err != NRF_SUCCESS ) break;
+
+      sd_put_u16(pdu->data, p_write_params->handle);
+      memcpy(pdu->data+2, p_write_params->p_value, p_write_params->len);
+      pdu->len = (uint16_t) (2 + p_write_params->len);
+    break;
+
+    case BLE_GATT_OP_PREP_WRITE_REQ:
+      if ( link && p_write_params->len > link->mtu - 5 )
+      {
+        err = NRF_ERROR_DATA_SIZE;
+        break;
+      }
+
+      err = request_start(conn_handle, SD_ATT_PREPARE_WRITE_REQ, BLE_GATTC_EVT_WRITE_RSP, &pdu);
+      if ( err != NRF_SUCCESS ) break;
+
+      sd_put_u16(pdu->data, p_write_params->handle);
+      sd_put_u16(pdu->data+2, p_write_params->offset);
+      memcpy(pdu->data+4, p_write_params->p_value, p_write_params->len);
+      pdu->len = (uint16_t) (4 + p_write_params->len);
+    break;
+
+    case BLE_GATT_OP_EXEC_WRITE_REQ:
+      err = request_start(conn_handle, SD_ATT_EXECUTE_WRITE_REQ, BLE_GATTC_EVT_WRITE_RSP, &pdu);
+      if ( err != NRF_SUCCESS ) break;
+
+      pdu->data[0] = p_write_params->flags;
+      pdu->len = 1;
+    break;
+
+    default:
+      err = NRF_ERROR_NOT_SUPPORTED;
+    break;
+  }
+
+  if ( pdu )
+  {
+    link->gattc_handle   = p_write_params->handle;
+    link->gattc_offset   = p_write_params->offset;
+    link->gattc_write_op = p_write_params->write_op;
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_hv_confirm(uint16_t conn_handle, uint16_t handle)
+{
+  (void) handle;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( !link->peer_ind_pending )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else if ( !sd_link_tx(link, SD_ATT_HVC) )
+  {
+    err = NRF_ERROR_BUSY;
+  }
+  else
+  {
+    link->peer_ind_pending = false;
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t client_rx_mtu)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  sd_pdu_t* pdu;
+  uint32_t err;
+
+  if ( link && (client_rx_mtu < BLE_GATT_ATT_MTU_DEFAULT || client_rx_mtu > sd_conn_cfg(link->cfg_tag)->att_mtu) )
+  {
+    err = NRF_ERROR_INVALID_PARAM;
+  }
+  else
+  {
+    err = request_start(conn_handle, SD_ATT_MTU_REQ, BLE_GATTC_EVT_EXCHANGE_MTU_RSP, &pdu);
+    if ( err == NRF_SUCCESS )
+    {
+      link->gattc_mtu = client_rx_mtu;
+
+      sd_put_u16(pdu->data, client_rx_mtu);
+      pdu->len = 2;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// Responses from peer server
+//--------------------------------------------------------------------+
+static ble_evt_t* rsp_alloc(sd_link_t* link, uint16_t len, uint16_t gatt_status, uint16_t error_handle)
+{
+  ble_evt_t* evt = sd_ble_evt_alloc(link->gattc_evt, len);
+  if ( evt )
+  {
+    evt->evt.gattc_evt.conn_handle  = link->conn_hdl;
+    evt->evt.gattc_evt.gatt_status  = gatt_status;
+    evt->evt.gattc_evt.error_handle = error_handle;
+  }
+  return evt;
+}
+
+// Find By Type Value: found handle + group end handle
+static void on_find_by_type_value(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  uint16_t const count = (uint16_t) (pdu->len / 4);
+
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(prim_srvc_disc_rsp.services, count*sizeof(ble_gattc_service_t)), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_prim_srvc_disc_rsp_t* rsp = &evt->evt.gattc_evt.params.prim_srvc_disc_rsp;
+  rsp->count = count;
+
+  for(uint16_t i=0; i<count; i++)
+  {
+    rsp->services[i].uuid = link->gattc_uuid;
+    rsp->services[i].handle_range.start_handle = sd_u16(pdu->data + 4*i);
+    rsp->services[i].handle_range.end_handle   = sd_u16(pdu->data + 4*i + 2);
+  }
+}
+
+// Read By Group Type: length, then handle + group end + UUID
+static void on_read_by_group_type(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  uint8_t const entry = pdu->data[0];
+  uint16_t const count = (uint16_t) ((pdu->len - 1) / entry);
+
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(prim_srvc_disc_rsp.services, count*sizeof(ble_gattc_service_t)), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_prim_srvc_disc_rsp_t* rsp = &evt->evt.gattc_evt.params.prim_srvc_disc_rsp;
+  rsp->count = count;
+
+  for(uint16_t i=0; i<count; i++)
+  {
+    uint8_t const* p = pdu->data + 1 + entry*i;
+
+    rsp->services[i].handle_range.start_handle = sd_u16(p);
+    rsp->services[i].handle_range.end_handle   = sd_u16(p+2);
+    sd_uuid_decode(p+4, (uint8_t) (entry - 4), &rsp->services[i].uuid);
+  }
+}
+
+// Read By Type: length, then handle + value
+static void on_read_by_type(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  uint8_t const entry = pdu->data[0];
+  uint16_t const count = (uint16_t) ((pdu->len - 1) / entry);
+  uint8_t const* list = pdu->data + 1;
+
+  if ( link->gattc_evt == BLE_GATTC_EVT_CHAR_VAL_BY_UUID_READ_RSP )
+  {
+    ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(char_val_by_uuid_read_rsp.handle_value, count*entry), BLE_GATT_STATUS_SUCCESS, 0);
+    if ( !evt ) return;
+
+    ble_gattc_evt_char_val_by_uuid_read_rsp_t* rsp = &evt->evt.gattc_evt.params.char_val_by_uuid_read_rsp;
+    rsp->count     = count;
+    rsp->value_len = (uint16_t) (entry - 2);
+    memcpy(rsp->handle_value, list, count*entry);
+    return;
+  }
+
+  // characteristic declarations: handle, properties, value handle, UUID
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(char_disc_rsp.chars, count*sizeof(ble_gattc_char_t)), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_char_disc_rsp_t* rsp = &evt->evt.gattc_evt.params.char_disc_rsp;
+  rsp->count = count;
+
+  for(uint16_t i=0; i<count; i++)
+  {
+    uint8_t const* p = list + entry*i;
+    ble_gattc_char_t* chr = &rsp->chars[i];
+    uint8_t const props = p[2];
+
+    chr->handle_decl  = sd_u16(p);
+    chr->handle_value = sd_u16(p+3);
+    sd_uuid_decode(p+5, (uint8_t) (entry - 5), &chr->uuid);
+
+    chr->char_props.broadcast      = (props >> 0) & 1;
+    chr->char_props.read           = (props >> 1) & 1;
+    chr->char_props.write_wo_resp  = (props >> 2) & 1;
+    chr->char_props.write          = (props >> 3) & 1;
+    chr->char_props.notify         = (props >> 4) & 1;
+    chr->char_props.indicate       = (props >> 5) & 1;
+    chr->char_props.auth_signed_wr = (props >> 6) & 1;
+    chr->char_ext_props            = (props >> 7) & 1;
+  }
+}
+
+// Find Information: format, then handle + UUID
+static void on_find_info(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  uint8_t const format = pdu->data[0];
+  uint8_t const uuid_len = (format == BLE_GATTC_ATTR_INFO_FORMAT_16BIT) ? 2 : 16;
+  uint16_t const count = (uint16_t) ((pdu->len - 1) / (2 + uuid_len));
+  uint8_t const* list = pdu->data + 1;
+
+  if ( link->gattc_evt == BLE_GATTC_EVT_ATTR_INFO_DISC_RSP )
+  {
+    uint16_t const size = (format == BLE_GATTC_ATTR_INFO_FORMAT_16BIT) ? count*sizeof(ble_gattc_attr_info16_t) : count*sizeof(ble_gattc_attr_info128_t);
+
+    ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(attr_info_disc_rsp.info, size), BLE_GATT_STATUS_SUCCESS, 0);
+    if ( !evt ) return;
+
+    ble_gattc_evt_attr_info_disc_rsp_t* rsp = &evt->evt.gattc_evt.params.attr_info_disc_rsp;
+    rsp->count  = count;
+    rsp->format = format;
+
+    for(uint16_t i=0; i<count; i++)
+    {
+      uint8_t const* p = list + (2 + uuid_len)*i;
+
+      if ( format == BLE_GATTC_ATTR_INFO_FORMAT_16BIT )
+      {
+        rsp->info.attr_info16[i].handle = sd_u16(p);
+        sd_uuid_decode(p+2, 2, &rsp->info.attr_info16[i].uuid);
+      }
+      else
+      {
+        rsp->info.attr_info128[i].handle = sd_u16(p);
+        memcpy(rsp->info.attr_info128[i].uuid.uuid128, p+2, 16);
+      }
+    }
+    return;
+  }
+
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(desc_disc_rsp.descs, count*sizeof(ble_gattc_desc_t)), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_desc_disc_rsp_t* rsp = &evt->evt.gattc_evt.params.desc_disc_rsp;
+  rsp->count = count;
+
+  for(uint16_t i=0; i<count; i++)
+  {
+    uint8_t const* p = list + (2 + uuid_len)*i;
+
+    rsp->descs[i].handle = sd_u16(p);
+    sd_uuid_decode(p+2, uuid_len, &rsp->descs[i].uuid);
+  }
+}
+
+static void on_read(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(read_rsp.data, pdu->len), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_read_rsp_t* rsp = &evt->evt.gattc_evt.params.read_rsp;
+  rsp->handle = link->gattc_handle;
+  rsp->offset = link->gattc_offset;
+  rsp->len    = pdu->len;
+  memcpy(rsp->data, pdu->data, pdu->len);
+}
+
+static void on_write_rsp(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  // prepare write echoes handle, offset and value
+  uint16_t const len = (pdu->op == SD_ATT_PREPARE_WRITE_RSP) ? (uint16_t) (pdu->len - 4) : 0;
+
+  ble_evt_t* evt = rsp_alloc(link, GATTC_EVT_LEN(write_rsp.data, len), BLE_GATT_STATUS_SUCCESS, 0);
+  if ( !evt ) return;
+
+  ble_gattc_evt_write_rsp_t* rsp = &evt->evt.gattc_evt.params.write_rsp;
+  rsp->handle   = link->gattc_handle;
+  rsp->write_op = link->gattc_write_op;
+  rsp->offset   = link->gattc_offset;
+  rsp->len      = len;
+  if ( len ) memcpy(rsp->data, pdu->data+4, len);
+}
+
+static void on_hvx(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  uint16_t const len = (uint16_t) (pdu->len - 2);
+
+  if ( pdu->op == SD_ATT_HVI ) link->peer_ind_pending = true;
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTC_EVT_HVX, GATTC_EVT_LEN(hvx.data, len));
+  if ( !evt ) return;
+
+  ble_gattc_evt_hvx_t* hvx = &evt->evt.gattc_evt.params.hvx;
+
+  evt->evt.gattc_evt.conn_handle = link->conn_hdl;
+  hvx->handle = sd_u16(pdu->data);
+  hvx->type   = (pdu->op == SD_ATT_HVI) ? BLE_GATT_HVX_INDICATION : BLE_GATT_HVX_NOTIFICATION;
+  hvx->len    = len;
+  memcpy(hvx->data, pdu->data+2, len);
+}
+
+void sd_gattc_on_att(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  // server initiated
+  if ( pdu->op == SD_ATT_HVN || pdu->op == SD_ATT_HVI )
+  {
+    on_hvx(link, pdu);
+    return;
+  }
+
+  // response without a request
+  if ( !link->gattc_req ) return;
+
+  link->gattc_req = 0;
+
+  switch ( pdu->op )
+  {
+    case SD_ATT_ERROR_RSP:
+      // no data, gatt_status is BLE_GATT_STATUS_ATTERR_*
+      rsp_alloc(link, sizeof(ble_evt_t), (uint16_t) (0x0100 | pdu->data[3]), sd_u16(pdu->data+1));
+    break;
+
+    case SD_ATT_MTU_RSP:
+    {
+      uint16_t const server_mtu = sd_u16(pdu->data);
+      link->mtu = SD_MAX(BLE_GATT_ATT_MTU_DEFAULT, SD_MIN(server_mtu, link->gattc_mtu));
+
+      ble_evt_t* evt = rsp_alloc(link, sizeof(ble_evt_t), BLE_GATT_STATUS_SUCCESS, 0);
+      if ( evt ) evt->evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu = server_mtu;
+    }
+    break;
+
+    case SD_ATT_FIND_BY_TYPE_VALUE_RSP: on_find_by_type_value(link, pdu); break;
+    case SD_ATT_READ_BY_GROUP_TYPE_RSP: on_read_by_group_type(link, pdu); break;
+    case SD_ATT_READ_BY_TYPE_RSP      : on_read_by_type(link, pdu)      ; break;
+    case SD_ATT_FIND_INFO_RSP         : on_find_info(link, pdu)         ; break;
+
+    case SD_ATT_READ_RSP:
+    case SD_ATT_READ_BLOB_RSP:
+      on_read(link, pdu);
+    break;
+
+    case SD_ATT_WRITE_RSP:
+    case SD_ATT_PREPARE_WRITE_RSP:
+    case SD_ATT_EXECUTE_WRITE_RSP:
+      on_write_rsp(link, pdu);
+    break;
+
+    default: break;
+  }
+}
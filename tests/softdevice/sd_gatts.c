@@ -0,0 +1,1023 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+#define ATTR_MAX                160
+#define ATTR_POOL_SIZE          BLE_GATTS_ATTR_TAB_SIZE_DEFAULT*4
+
+// Characteristic properties in the declaration
+#define CHAR_PROP_READ          0x02
+#define CHAR_PROP_NOTIFY        0x10
+#define CHAR_PROP_INDICATE      0x20
+
+// Event length with a variable length member of len bytes
+#define GATTS_EVT_LEN(member, len) \
+  ((uint16_t) SD_MAX(sizeof(ble_evt_t), offsetof(ble_evt_t, evt.gatts_evt.params.member) + (len)))
+
+enum
+{
+  ATTR_SERVICE = 1,
+  ATTR_CHAR_DECL,
+  ATTR_VALUE,
+  ATTR_CCCD,
+  ATTR_DESC
+};
+
+typedef struct
+{
+  ble_uuid_t uuid;
+  uint8_t    kind;
+  uint8_t    props;           // ATTR_VALUE: characteristic properties
+  uint8_t    vlen    : 1;
+  uint8_t    vloc    : 2;
+  uint8_t    rd_auth : 1;
+  uint8_t    wr_auth : 1;
+  uint16_t   len;
+  uint16_t   max_len;
+  uint8_t*   p_value;
+  uint16_t   cccd_handle;     // ATTR_VALUE with notify/indicate
+  uint16_t   cccd[SD_SIM_LINK_MAX];
+} gatts_attr_t;
+
+static gatts_attr_t _attr[ATTR_MAX];
+static uint16_t     _attr_count;
+static uint16_t     _user_handle;      // first handle of the application
+
+static uint8_t      _pool[ATTR_POOL_SIZE];
+static uint16_t     _pool_used;
+
+static bool         _sys_attr_valid[SD_SIM_LINK_MAX];
+
+static inline gatts_attr_t* attr_get(uint16_t handle)
+{
+  return (handle == BLE_GATT_HANDLE_INVALID || handle > _attr_count) ? NULL : &_attr[handle-1];
+}
+
+static inline uint16_t attr_handle(gatts_attr_t const* attr)
+{
+  return (uint16_t) (attr - _attr + 1);
+}
+
+static inline bool uuid_equal(ble_uuid_t const* a, ble_uuid_t const* b)
+{
+  return (a->type == b->type) && (a->uuid == b->uuid);
+}
+
+//--------------------------------------------------------------------+
+// Attribute table
+//--------------------------------------------------------------------+
+
+// Append an attribute, value is allocated in the stack pool unless in user memory
+static gatts_attr_t* attr_add(uint16_t uuid16, uint8_t uuid_type, uint8_t kind, uint16_t max_len,
+                              uint8_t const* init, uint16_t init_len, ble_gatts_attr_md_t const* md, uint8_t* user_value)
+{
+  bool const user = (md && md->vloc == BLE_GATTS_VLOC_USER);
+
+  if ( _attr_count == ATTR_MAX ) return NULL;
+  if ( !user && (_pool_used + max_len > ATTR_POOL_SIZE) ) return NULL;
+
+  gatts_attr_t* attr = &_attr[_attr_count++];
+  memset(attr, 0, sizeof(gatts_attr_t));
+
+  attr->uuid.uuid = uuid16;
+  attr->uuid.type = uuid_type;
+  attr->kind      = kind;
+  attr->max_len   = max_len;
+  attr->len       = SD_MIN(init_len, max_len);
+  attr->vlen      = md ? md->vlen : 0;
+  attr->vloc      = user ? BLE_GATTS_VLOC_USER : BLE_GATTS_VLOC_STACK;
+  attr->rd_auth   = md ? md->rd_auth : 0;
+  attr->wr_auth   = md ? md->wr_auth : 0;
+
+  if ( user )
+  {
+    attr->p_value = user_value;
+  }
+  else
+  {
+    attr->p_value = _pool + _pool_used;
+    _pool_used   += max_len;
+
+    memset(attr->p_value, 0, max_len);
+    if ( init ) memcpy(attr->p_value, init, attr->len);
+  }
+
+  return attr;
+}
+
+static gatts_attr_t* decl_add(uint16_t decl_uuid, uint8_t const* value, uint16_t len)
+{
+  return attr_add(decl_uuid, BLE_UUID_TYPE_BLE, (decl_uuid == BLE_UUID_CHARACTERISTIC) ? ATTR_CHAR_DECL : ATTR_SERVICE,
+                  len, value, len, NULL, NULL);
+}
+
+// Characteristic declaration + value (+ CCCD), return value attribute
+static gatts_attr_t* char_add(ble_uuid_t const* uuid, uint8_t props, ble_gatts_attr_t const* attr_value)
+{
+  uint8_t decl[3+16];
+  uint8_t const uuid_len = sd_uuid_encode(uuid, decl+3);
+  if ( uuid_len == 0 ) return NULL;
+
+  decl[0] = props;
+  sd_put_u16(decl+1, (uint16_t) (_attr_count + 2));
+
+  if ( !decl_add(BLE_UUID_CHARACTERISTIC, decl, (uint16_t) (3 + uuid_len)) ) return NULL;
+
+  gatts_attr_t* value = attr_add(uuid->uuid, uuid->type, ATTR_VALUE, attr_value->max_len,
+                                 attr_value->p_value, attr_value->init_len, attr_value->p_attr_md, attr_value->p_value);
+  if ( !value ) return NULL;
+
+  value->props = props;
+
+  if ( props & (CHAR_PROP_NOTIFY | CHAR_PROP_INDICATE) )
+  {
+    gatts_attr_t* cccd = attr_add(BLE_UUID_DESCRIPTOR_CLIENT_CHAR_CONFIG, BLE_UUID_TYPE_BLE, ATTR_CCCD, 2, NULL, 0, NULL, NULL);
+    if ( !cccd ) return NULL;
+
+    cccd->len = 2;
+    value->cccd_handle = attr_handle(cccd);
+  }
+
+  return value;
+}
+
+static uint8_t char_props(ble_gatt_char_props_t const* props)
+{
+  return (uint8_t) ((props->broadcast << 0) | (props->read << 1) | (props->write_wo_resp << 2) | (props->write << 3) |
+                    (props->notify << 4) | (props->indicate << 5) | (props->auth_signed_wr << 6));
+}
+
+void sd_gatts_init(void)
+{
+  _attr_count = 0;
+  _pool_used  = 0;
+
+  ble_gatts_attr_md_t const md = { .vlen = 1, .vloc = BLE_GATTS_VLOC_STACK };
+  ble_uuid_t uuid = { .type = BLE_UUID_TYPE_BLE };
+  uint8_t svc[2];
+
+  // Generic Access
+  sd_put_u16(svc, BLE_UUID_GAP);
+  decl_add(BLE_UUID_SERVICE_PRIMARY, svc, 2);
+
+  uuid.uuid = BLE_UUID_GAP_CHARACTERISTIC_DEVICE_NAME;
+  char_add(&uuid, CHAR_PROP_READ, &(ble_gatts_attr_t) { .p_uuid = &uuid, .p_attr_md = &md, .max_len = BLE_GAP_DEVNAME_DEFAULT_LEN });
+
+  uuid.uuid = BLE_UUID_GAP_CHARACTERISTIC_APPEARANCE;
+  char_add(&uuid, CHAR_PROP_READ, &(ble_gatts_attr_t) { .p_uuid = &uuid, .p_attr_md = &md, .init_len = 2, .max_len = 2 });
+
+  uuid.uuid = BLE_UUID_GAP_CHARACTERISTIC_PPCP;
+  char_add(&uuid, CHAR_PROP_READ, &(ble_gatts_attr_t) { .p_uuid = &uuid, .p_attr_md = &md, .init_len = 8, .max_len = 8 });
+
+  // Generic Attribute
+  sd_put_u16(svc, BLE_UUID_GATT);
+  decl_add(BLE_UUID_SERVICE_PRIMARY, svc, 2);
+
+  if ( sd_service_changed )
+  {
+    uuid.uuid = BLE_UUID_GATT_CHARACTERISTIC_SERVICE_CHANGED;
+    char_add(&uuid, CHAR_PROP_INDICATE, &(ble_gatts_attr_t) { .p_uuid = &uuid, .p_attr_md = &md, .init_len = 4, .max_len = 4 });
+  }
+
+  _user_handle = (uint16_t) (_attr_count + 1);
+}
+
+void sd_gatts_link_reset(sd_link_t* link)
+{
+  _sys_attr_valid[link->conn_hdl] = false;
+
+  for(uint16_t i=0; i<_attr_count; i++) _attr[i].cccd[link->conn_hdl] = 0;
+}
+
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const *p_uuid, uint16_t *p_handle)
+{
+  if ( !p_uuid || !p_handle ) return NRF_ERROR_INVALID_ADDR;
+  if ( type != BLE_GATTS_SRVC_TYPE_PRIMARY && type != BLE_GATTS_SRVC_TYPE_SECONDARY ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  uint8_t value[16];
+  uint8_t const len = sd_uuid_encode(p_uuid, value);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( len == 0 )
+  {
+    err = NRF_ERROR_INVALID_PARAM;
+  }
+  else
+  {
+    uint16_t const decl = (type == BLE_GATTS_SRVC_TYPE_PRIMARY) ? BLE_UUID_SERVICE_PRIMARY : BLE_UUID_SERVICE_SECONDARY;
+    gatts_attr_t* attr = decl_add(decl, value, len);
+
+    if ( attr )
+    {
+      *p_handle = attr_handle(attr);
+    }
+    else
+    {
+      err = NRF_ERROR_NO_MEM;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_include_add(uint16_t service_handle, uint16_t inc_srvc_handle, uint16_t *p_include_handle)
+{
+  (void) service_handle;
+  (void) inc_srvc_handle;
+  (void) p_include_handle;
+  return NRF_ERROR_NOT_SUPPORTED;
+}
+
+uint32_t sd_ble_gatts_characteristic_add(uint16_t service_handle, ble_gatts_char_md_t const *p_char_md,
+                                         ble_gatts_attr_t const *p_attr_char_value, ble_gatts_char_handles_t *p_handles)
+{
+  (void) service_handle;
+
+  if ( !p_char_md || !p_attr_char_value || !p_attr_char_value->p_uuid || !p_attr_char_value->p_attr_md || !p_handles ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_attr_char_value->init_len > p_attr_char_value->max_len ) return NRF_ERROR_INVALID_PARAM;
+  if ( p_attr_char_value->max_len > BLE_GATTS_VAR_ATTR_LEN_MAX ) return NRF_ERROR_INVALID_PARAM;
+  if ( p_attr_char_value->p_attr_md->vloc == BLE_GATTS_VLOC_USER && !p_attr_char_value->p_value ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  memset(p_handles, 0, sizeof(ble_gatts_char_handles_t));
+
+  uint8_t uuid_le[16];
+  uint32_t err = NRF_ERROR_NO_MEM;
+
+  do
+  {
+    if ( sd_uuid_encode(p_attr_char_value->p_uuid, uuid_le) == 0 )
+    {
+      err = NRF_ERROR_INVALID_PARAM;
+      break;
+    }
+
+    gatts_attr_t* value = char_add(p_attr_char_value->p_uuid, char_props(&p_char_md->char_props), p_attr_char_value);
+    if ( !value ) break;
+
+    p_handles->value_handle = attr_handle(value);
+    p_handles->cccd_handle  = value->cccd_handle;
+
+    if ( p_char_md->p_char_user_desc )
+    {
+      gatts_attr_t* desc = attr_add(BLE_UUID_DESCRIPTOR_CHAR_USER_DESC, BLE_UUID_TYPE_BLE, ATTR_DESC,
+                                    SD_MAX(p_char_md->char_user_desc_max_size, p_char_md->char_user_desc_size),
+                                    p_char_md->p_char_user_desc, p_char_md->char_user_desc_size, p_char_md->p_user_desc_md, NULL);
+      if ( !desc ) break;
+
+      p_handles->user_desc_handle = attr_handle(desc);
+    }
+
+    if ( p_char_md->p_char_pf )
+    {
+      ble_gatts_char_pf_t const* pf = p_char_md->p_char_pf;
+      uint8_t const pf_value[7] =
+      {
+        pf->format, (uint8_t) pf->exponent, (uint8_t) pf->unit, (uint8_t) (pf->unit >> 8),
+        pf->name_space, (uint8_t) pf->desc, (uint8_t) (pf->desc >> 8)
+      };
+
+      if ( !attr_add(BLE_UUID_DESCRIPTOR_CHAR_PRESENTATION_FORMAT, BLE_UUID_TYPE_BLE, ATTR_DESC, 7, pf_value, 7, NULL, NULL) ) break;
+    }
+
+    err = NRF_SUCCESS;
+  } while(0);
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_descriptor_add(uint16_t char_handle, ble_gatts_attr_t const *p_attr, uint16_t *p_handle)
+{
+  (void) char_handle;
+
+  if ( !p_attr || !p_attr->p_uuid || !p_attr->p_attr_md || !p_handle ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_attr->init_len > p_attr->max_len ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  uint8_t uuid_le[16];
+  uint32_t err = NRF_SUCCESS;
+
+  if ( sd_uuid_encode(p_attr->p_uuid, uuid_le) == 0 )
+  {
+    err = NRF_ERROR_INVALID_PARAM;
+  }
+  else
+  {
+    gatts_attr_t* attr = attr_add(p_attr->p_uuid->uuid, p_attr->p_uuid->type, ATTR_DESC, p_attr->max_len,
+                                  p_attr->p_value, p_attr->init_len, p_attr->p_attr_md, p_attr->p_value);
+    if ( attr )
+    {
+      *p_handle = attr_handle(attr);
+    }
+    else
+    {
+      err = NRF_ERROR_NO_MEM;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_initial_user_handle_get(uint16_t *p_handle)
+{
+  if ( !p_handle ) return NRF_ERROR_INVALID_ADDR;
+
+  *p_handle = _user_handle;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_attr_get(uint16_t handle, ble_uuid_t * p_uuid, ble_gatts_attr_md_t * p_md)
+{
+  gatts_attr_t const* attr = attr_get(handle);
+  if ( !attr ) return NRF_ERROR_NOT_FOUND;
+
+  if ( p_uuid ) *p_uuid = attr->uuid;
+  if ( p_md )
+  {
+    memset(p_md, 0, sizeof(ble_gatts_attr_md_t));
+    p_md->vlen    = attr->vlen;
+    p_md->vloc    = attr->vloc;
+    p_md->rd_auth = attr->rd_auth;
+    p_md->wr_auth = attr->wr_auth;
+  }
+
+  return NRF_SUCCESS;
+}
+
+//--------------------------------------------------------------------+
+// Values
+//--------------------------------------------------------------------+
+
+// CCCD of a connection, BLE_ERROR_GATTS_SYS_ATTR_MISSING until they are set
+static uint32_t cccd_access(uint16_t conn_hdl, gatts_attr_t const* attr)
+{
+  (void) attr;
+
+  if ( !sd_link_get(conn_hdl) ) return BLE_ERROR_INVALID_CONN_HANDLE;
+  if ( !_sys_attr_valid[conn_hdl] ) return BLE_ERROR_GATTS_SYS_ATTR_MISSING;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_value_set(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t *p_value)
+{
+  if ( !p_value ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  gatts_attr_t* attr = attr_get(handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !attr )
+  {
+    err = BLE_ERROR_INVALID_ATTR_HANDLE;
+  }
+  else if ( attr->kind == ATTR_CCCD )
+  {
+    err = cccd_access(conn_handle, attr);
+    if ( err == NRF_SUCCESS )
+    {
+      if ( p_value->offset != 0 || p_value->len != 2 || !p_value->p_value )
+      {
+        err = NRF_ERROR_INVALID_PARAM;
+      }
+      else
+      {
+        attr->cccd[conn_handle] = sd_u16(p_value->p_value);
+      }
+    }
+  }
+  else if ( p_value->offset + p_value->len > attr->max_len )
+  {
+    err = NRF_ERROR_INVALID_PARAM;
+  }
+  else
+  {
+    // user memory: NULL only updates the length
+    if ( p_value->p_value ) memcpy(attr->p_value + p_value->offset, p_value->p_value, p_value->len);
+    if ( attr->vlen ) attr->len = (uint16_t) (p_value->offset + p_value->len);
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_value_get(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t *p_value)
+{
+  if ( !p_value ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  gatts_attr_t* attr = attr_get(handle);
+  uint32_t err = NRF_SUCCESS;
+
+  uint8_t  cccd[2];
+  uint8_t const* value = NULL;
+  uint16_t len = 0;
+
+  if ( !attr )
+  {
+    err = BLE_ERROR_INVALID_ATTR_HANDLE;
+  }
+  else if ( attr->kind == ATTR_CCCD )
+  {
+    err = cccd_access(conn_handle, attr);
+
+    sd_put_u16(cccd, (err == NRF_SUCCESS) ? attr->cccd[conn_handle] : 0);
+    value = cccd;
+    len   = 2;
+  }
+  else
+  {
+    value = attr->p_value;
+    len   = attr->len;
+  }
+
+  if ( err == NRF_SUCCESS )
+  {
+    if ( p_value->offset > len )
+    {
+      err = NRF_ERROR_INVALID_PARAM;
+    }
+    else if ( !p_value->p_value )
+    {
+      // complete length
+      p_value->len = (uint16_t) (len - p_value->offset);
+    }
+    else
+    {
+      p_value->len = SD_MIN(p_value->len, (uint16_t) (len - p_value->offset));
+      memcpy(p_value->p_value, value + p_value->offset, p_value->len);
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// Notification and indication
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const *p_hvx_params)
+{
+  if ( !p_hvx_params ) return NRF_ERROR_INVALID_ADDR;
+  if ( p_hvx_params->type != BLE_GATT_HVX_NOTIFICATION && p_hvx_params->type != BLE_GATT_HVX_INDICATION ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  gatts_attr_t* attr = attr_get(p_hvx_params->handle);
+  uint32_t err = NRF_SUCCESS;
+
+  do
+  {
+    if ( !link )
+    {
+      err = BLE_ERROR_INVALID_CONN_HANDLE;
+      break;
+    }
+
+    if ( !attr )
+    {
+      err = BLE_ERROR_INVALID_ATTR_HANDLE;
+      break;
+    }
+
+    if ( attr->kind != ATTR_VALUE || !attr->cccd_handle )
+    {
+      err = BLE_ERROR_GATTS_INVALID_ATTR_TYPE;
+      break;
+    }
+
+    if ( !_sys_attr_valid[conn_handle] )
+    {
+      err = BLE_ERROR_GATTS_SYS_ATTR_MISSING;
+      break;
+    }
+
+    // peer must have enabled it
+    if ( !(attr_get(attr->cccd_handle)->cccd[conn_handle] & p_hvx_params->type) )
+    {
+      err = NRF_ERROR_INVALID_STATE;
+      break;
+    }
+
+    bool const notify = (p_hvx_params->type == BLE_GATT_HVX_NOTIFICATION);
+
+    if ( notify && link->hvn_queued >= sd_conn_cfg(link->cfg_tag)->hvn_qsize )
+    {
+      err = NRF_ERROR_RESOURCES;
+      break;
+    }
+
+    if ( !notify && link->ind_pending )
+    {
+      err = NRF_ERROR_BUSY;
+      break;
+    }
+
+    uint16_t const offset = p_hvx_params->offset;
+    uint16_t len = p_hvx_params->p_len ? *p_hvx_params->p_len : attr->len;
+
+    if ( offset > attr->max_len || len > attr->max_len - offset )
+    {
+      err = NRF_ERROR_INVALID_PARAM;
+      break;
+    }
+
+    if ( len > link->mtu - 3 )
+    {
+      err = NRF_ERROR_DATA_SIZE;
+      break;
+    }
+
+    // also updates the attribute value
+    if ( p_hvx_params->p_data )
+    {
+      memcpy(attr->p_value + offset, p_hvx_params->p_data, len);
+      if ( attr->vlen ) attr->len = (uint16_t) (offset + len);
+    }
+
+    sd_pdu_t* pdu = sd_link_tx(link, notify ? SD_ATT_HVN : SD_ATT_HVI);
+    if ( !pdu )
+    {
+      err = NRF_ERROR_RESOURCES;
+      break;
+    }
+
+    sd_put_u16(pdu->data, p_hvx_params->handle);
+    memcpy(pdu->data+2, attr->p_value + offset, len);
+    pdu->len = (uint16_t) (2 + len);
+
+    if ( notify )
+    {
+      link->hvn_queued++;
+    }
+    else
+    {
+      link->ind_pending = true;
+      link->ind_handle  = p_hvx_params->handle;
+    }
+
+    if ( p_hvx_params->p_len ) *p_hvx_params->p_len = len;
+  } while(0);
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_service_changed(uint16_t conn_handle, uint16_t start_handle, uint16_t end_handle)
+{
+  if ( !sd_service_changed ) return NRF_ERROR_NOT_SUPPORTED;
+  if ( start_handle > end_handle || start_handle < _user_handle ) return BLE_ERROR_INVALID_ATTR_HANDLE;
+
+  // value of the Service Changed characteristic, right before its CCCD
+  uint16_t const sc_handle = (uint16_t) (_user_handle - 2);
+  uint8_t range[4];
+  uint16_t len = 4;
+
+  sd_put_u16(range, start_handle);
+  sd_put_u16(range+2, end_handle);
+
+  ble_gatts_hvx_params_t const hvx =
+  {
+    .handle = sc_handle,
+    .type   = BLE_GATT_HVX_INDICATION,
+    .offset = 0,
+    .p_len  = &len,
+    .p_data = range
+  };
+
+  return sd_ble_gatts_hvx(conn_handle, &hvx);
+}
+
+//--------------------------------------------------------------------+
+// System attributes: CCCD values of a connection
+//--------------------------------------------------------------------+
+
+// handle (2) + value (2) for each CCCD, followed by a CRC16 like the SoftDevice
+static bool sys_attr_match(gatts_attr_t const* attr, uint32_t flags)
+{
+  if ( attr->kind != ATTR_CCCD ) return false;
+
+  bool const sys = (attr_handle(attr) < _user_handle);
+  if ( (flags & BLE_GATTS_SYS_ATTR_FLAG_SYS_SRVCS) && !sys ) return false;
+  if ( (flags & BLE_GATTS_SYS_ATTR_FLAG_USR_SRVCS) && sys ) return false;
+
+  return true;
+}
+
+static uint16_t sys_attr_crc(uint8_t const* data, uint16_t len)
+{
+  // CRC-16/CCITT-FALSE
+  uint16_t crc = 0xFFFF;
+  for(uint16_t i=0; i<len; i++)
+  {
+    crc = (uint16_t) ((uint8_t) (crc >> 8) | (crc << 8));
+    crc ^= data[i];
+    crc ^= (uint8_t) (crc & 0xFF) >> 4;
+    crc ^= (uint16_t) (crc << 12);
+    crc ^= (uint16_t) ((crc & 0xFF) << 5);
+  }
+  return crc;
+}
+
+uint32_t sd_ble_gatts_sys_attr_get(uint16_t conn_handle, uint8_t *p_sys_attr_data, uint16_t *p_len, uint32_t flags)
+{
+  if ( !p_len ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !sd_link_get(conn_handle) )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else
+  {
+    uint16_t len = 0;
+    for(uint16_t i=0; i<_attr_count; i++)
+    {
+      if ( sys_attr_match(&_attr[i], flags) ) len += 4;
+    }
+
+    if ( len == 0 )
+    {
+      err = NRF_ERROR_NOT_FOUND;
+    }
+    else
+    {
+      len += 2;
+
+      if ( p_sys_attr_data )
+      {
+        if ( *p_len < len )
+        {
+          err = NRF_ERROR_DATA_SIZE;
+        }
+        else
+        {
+          uint8_t* p = p_sys_attr_data;
+          for(uint16_t i=0; i<_attr_count; i++)
+          {
+            if ( !sys_attr_match(&_attr[i], flags) ) continue;
+
+            sd_put_u16(p, attr_handle(&_attr[i]));
+            sd_put_u16(p+2, _attr[i].cccd[conn_handle]);
+            p += 4;
+          }
+          sd_put_u16(p, sys_attr_crc(p_sys_attr_data, (uint16_t) (len-2)));
+        }
+      }
+
+      *p_len = len;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_sys_attr_set(uint16_t conn_handle, uint8_t const *p_sys_attr_data, uint16_t len, uint32_t flags)
+{
+  (void) flags;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( p_sys_attr_data && (len < 2 || (len - 2) % 4 || sys_attr_crc(p_sys_attr_data, (uint16_t) (len-2)) != sd_u16(p_sys_attr_data + len - 2)) )
+  {
+    err = NRF_ERROR_INVALID_DATA;
+  }
+  else
+  {
+    // NULL: all CCCDs disabled
+    for(uint16_t i=0; p_sys_attr_data && i+4 <= len-2; i += 4)
+    {
+      gatts_attr_t* attr = attr_get(sd_u16(p_sys_attr_data+i));
+      if ( attr && attr->kind == ATTR_CCCD ) attr->cccd[conn_handle] = sd_u16(p_sys_attr_data+i+2);
+    }
+
+    _sys_attr_valid[conn_handle] = true;
+
+    // CCCD write waiting for them
+    if ( link->peer_write_deferred )
+    {
+      link->peer_write_deferred = false;
+      sd_gatts_on_att(link, &link->peer_write);
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// Replies to peer requests
+//--------------------------------------------------------------------+
+static void att_error(sd_link_t* link, uint8_t req, uint16_t handle, uint8_t code)
+{
+  sd_pdu_t* rsp = sd_link_tx(link, SD_ATT_ERROR_RSP);
+  if ( !rsp ) return;
+
+  rsp->data[0] = req;
+  sd_put_u16(rsp->data+1, handle);
+  rsp->data[3] = code;
+  rsp->len     = 4;
+}
+
+static void att_write_rsp(sd_link_t* link)
+{
+  sd_link_tx(link, SD_ATT_WRITE_RSP);
+}
+
+uint32_t sd_ble_gatts_exchange_mtu_reply(uint16_t conn_handle, uint16_t server_rx_mtu)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( link->peer_req != SD_ATT_MTU_REQ )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else if ( server_rx_mtu < BLE_GATT_ATT_MTU_DEFAULT || server_rx_mtu > sd_conn_cfg(link->cfg_tag)->att_mtu )
+  {
+    err = NRF_ERROR_INVALID_PARAM;
+  }
+  else
+  {
+    sd_pdu_t* rsp = sd_link_tx(link, SD_ATT_MTU_RSP);
+    if ( !rsp )
+    {
+      err = NRF_ERROR_BUSY;
+    }
+    else
+    {
+      sd_put_u16(rsp->data, server_rx_mtu);
+      rsp->len = 2;
+
+      link->peer_req = 0;
+      link->mtu = SD_MAX(BLE_GATT_ATT_MTU_DEFAULT, SD_MIN(server_rx_mtu, link->peer_client_mtu));
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gatts_rw_authorize_reply(uint16_t conn_handle, ble_gatts_rw_authorize_reply_params_t const *p_rw_authorize_reply_params)
+{
+  if ( !p_rw_authorize_reply_params ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( p_rw_authorize_reply_params->type != BLE_GATTS_AUTHORIZE_TYPE_WRITE )
+  {
+    // peer never reads our attributes
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else if ( link->peer_req != SD_ATT_WRITE_REQ && link->peer_req != SD_ATT_WRITE_CMD )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else
+  {
+    ble_gatts_authorize_params_t const* reply = &p_rw_authorize_reply_params->params.write;
+    gatts_attr_t* attr = attr_get(link->peer_req_handle);
+    uint8_t const req = link->peer_req;
+
+    link->peer_req = 0;
+
+    if ( reply->gatt_status != BLE_GATT_STATUS_SUCCESS )
+    {
+      if ( req == SD_ATT_WRITE_REQ ) att_error(link, req, link->peer_req_handle, (uint8_t) reply->gatt_status);
+    }
+    else
+    {
+      if ( reply->update && attr && reply->p_data && reply->offset + reply->len <= attr->max_len )
+      {
+        memcpy(attr->p_value + reply->offset, reply->p_data, reply->len);
+        if ( attr->vlen ) attr->len = (uint16_t) (reply->offset + reply->len);
+      }
+
+      if ( req == SD_ATT_WRITE_REQ ) att_write_rsp(link);
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// ATT PDU from peer client
+//--------------------------------------------------------------------+
+static void on_write(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  bool const req = (pdu->op == SD_ATT_WRITE_REQ);
+  uint16_t const conn_hdl = link->conn_hdl;
+  uint16_t const handle = sd_u16(pdu->data);
+  uint16_t const len = (uint16_t) (pdu->len - 2);
+  uint8_t const* data = pdu->data + 2;
+
+  gatts_attr_t* attr = attr_get(handle);
+
+  if ( !attr || attr->kind == ATTR_SERVICE || attr->kind == ATTR_CHAR_DECL )
+  {
+    if ( req ) att_error(link, pdu->op, handle, attr ? SD_ATT_ERR_WRITE_NOT_PERMITTED : SD_ATT_ERR_INVALID_HANDLE);
+    return;
+  }
+
+  if ( attr->kind == ATTR_CCCD )
+  {
+    // application is asked for the stored CCCDs first
+    if ( !_sys_attr_valid[conn_hdl] )
+    {
+      if ( !link->peer_write_deferred )
+      {
+        link->peer_write          = *pdu;
+        link->peer_write_deferred = true;
+
+        ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_SYS_ATTR_MISSING, sizeof(ble_evt_t));
+        if ( evt )
+        {
+          evt->evt.gatts_evt.conn_handle = conn_hdl;
+          evt->evt.gatts_evt.params.sys_attr_missing.hint = 0;
+        }
+      }
+      return;
+    }
+
+    if ( len != 2 )
+    {
+      if ( req ) att_error(link, pdu->op, handle, SD_ATT_ERR_INVALID_ATT_LEN);
+      return;
+    }
+
+    attr->cccd[conn_hdl] = sd_u16(data);
+  }
+  else if ( len > attr->max_len )
+  {
+    if ( req ) att_error(link, pdu->op, handle, SD_ATT_ERR_INVALID_ATT_LEN);
+    return;
+  }
+  else if ( attr->wr_auth )
+  {
+    // value is written by sd_ble_gatts_rw_authorize_reply()
+    link->peer_req        = pdu->op;
+    link->peer_req_handle = handle;
+
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST, GATTS_EVT_LEN(authorize_request.request.write.data, len));
+    if ( evt )
+    {
+      ble_gatts_evt_write_t* write = &evt->evt.gatts_evt.params.authorize_request.request.write;
+
+      evt->evt.gatts_evt.conn_handle = conn_hdl;
+      evt->evt.gatts_evt.params.authorize_request.type = BLE_GATTS_AUTHORIZE_TYPE_WRITE;
+      write->handle = handle;
+      write->uuid   = attr->uuid;
+      write->op     = req ? BLE_GATTS_OP_WRITE_REQ : BLE_GATTS_OP_WRITE_CMD;
+      write->offset = 0;
+      write->len    = len;
+      memcpy(write->data, data, len);
+    }
+    return;
+  }
+  else
+  {
+    memcpy(attr->p_value, data, len);
+    if ( attr->vlen ) attr->len = len;
+  }
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_WRITE, GATTS_EVT_LEN(write.data, len));
+  if ( evt )
+  {
+    ble_gatts_evt_write_t* write = &evt->evt.gatts_evt.params.write;
+
+    evt->evt.gatts_evt.conn_handle = conn_hdl;
+    write->handle = handle;
+    write->uuid   = attr->uuid;
+    write->op     = req ? BLE_GATTS_OP_WRITE_REQ : BLE_GATTS_OP_WRITE_CMD;
+    write->offset = 0;
+    write->len    = len;
+    memcpy(write->data, data, len);
+  }
+
+  if ( req ) att_write_rsp(link);
+}
+
+void sd_gatts_on_att(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  switch ( pdu->op )
+  {
+    case SD_ATT_WRITE_REQ:
+    case SD_ATT_WRITE_CMD:
+      on_write(link, pdu);
+    break;
+
+    case SD_ATT_MTU_REQ:
+    {
+      link->peer_req        = SD_ATT_MTU_REQ;
+      link->peer_client_mtu = sd_u16(pdu->data);
+
+      ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST, sizeof(ble_evt_t));
+      if ( evt )
+      {
+        evt->evt.gatts_evt.conn_handle = link->conn_hdl;
+        evt->evt.gatts_evt.params.exchange_mtu_request.client_rx_mtu = link->peer_client_mtu;
+      }
+    }
+    break;
+
+    case SD_ATT_HVC:
+    {
+      link->ind_pending = false;
+
+      ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_HVC, sizeof(ble_evt_t));
+      if ( evt )
+      {
+        evt->evt.gatts_evt.conn_handle = link->conn_hdl;
+        evt->evt.gatts_evt.params.hvc.handle = link->ind_handle;
+      }
+    }
+    break;
+
+    default:
+      att_error(link, pdu->op, 0, SD_ATT_ERR_REQ_NOT_SUPPORTED);
+    break;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Simulator API
+//--------------------------------------------------------------------+
+static gatts_attr_t* value_find(uint8_t const* uuid_le, uint8_t uuid_len)
+{
+  ble_uuid_t uuid;
+  sd_uuid_decode(uuid_le, uuid_len, &uuid);
+
+  for(uint16_t i=0; i<_attr_count; i++)
+  {
+    if ( _attr[i].kind == ATTR_VALUE && uuid_equal(&_attr[i].uuid, &uuid) ) return &_attr[i];
+  }
+
+  return NULL;
+}
+
+uint16_t sd_sim_gatts_value_find(uint8_t const* uuid, uint8_t uuid_len)
+{
+  sd_lock();
+  gatts_attr_t const* attr = value_find(uuid, uuid_len);
+  uint16_t const handle = attr ? attr_handle(attr) : 0;
+  sd_unlock();
+
+  return handle;
+}
+
+uint16_t sd_sim_gatts_cccd_find(uint8_t const* uuid, uint8_t uuid_len)
+{
+  sd_lock();
+  gatts_attr_t const* attr = value_find(uuid, uuid_len);
+  uint16_t const handle = attr ? attr->cccd_handle : 0;
+  sd_unlock();
+
+  return handle;
+}
@@ -0,0 +1,248 @@
+#ifndef SD_INTERNAL_H_
+#define SD_INTERNAL_H_
+
+/* Shared state of the SoftDevice simulator modules, see sd_sim.h
+ *
+ * Every sd_*() function runs inside sd_lock() like a SVC call would: the BLE
+ * event interrupt it raises is only taken once the call returns. Radio
+ * activity (advertising, scanning, connection events) and flash operations
+ * are host timers running in RADIO_IRQn context.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf.h"
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#include "ble.h"
+
+#include "FreeRTOS.h"
+#include "host_port.h"
+#include "sd_sim.h"
+
+#define SD_RADIO_IRQn           RADIO_IRQn
+
+// Largest ATT MTU the simulator negotiates, same as Bluefruit52Lib
+#define SD_ATT_MTU_MAX          247
+
+#define SD_EVT_LEN_MAX          BLE_EVT_LEN_MAX(SD_ATT_MTU_MAX)
+
+// Inter frame space and LL overhead (header + MIC-less CRC + access address + preamble)
+#define SD_T_IFS_US             150
+
+static inline void sd_lock  (void) { portENTER_CRITICAL(); }
+static inline void sd_unlock(void) { portEXIT_CRITICAL(); }
+
+static inline uint16_t sd_u16(uint8_t const* p)             { return (uint16_t) (p[0] | (p[1] << 8)); }
+static inline void     sd_put_u16(uint8_t* p, uint16_t v)   { p[0] = (uint8_t) v; p[1] = (uint8_t) (v >> 8); }
+
+#define SD_MIN(a, b)            ((a) < (b) ? (a) : (b))
+#define SD_MAX(a, b)            ((a) > (b) ? (a) : (b))
+
+//--------------------------------------------------------------------+
+// Common (sd_common.c)
+//--------------------------------------------------------------------+
+typedef struct
+{
+  uint16_t att_mtu;
+  uint16_t event_length;     // in 1.25 ms unit
+  uint8_t  hvn_qsize;
+  uint8_t  wrcmd_qsize;
+} sd_conn_cfg_t;
+
+extern sd_sim_link_cfg_t sd_link_cfg;
+extern sd_sim_stats_t    sd_stats;
+extern sd_sim_rx_cb_t    sd_rx_cb;
+extern bool              sd_enabled;
+extern bool              sd_ble_enabled;
+extern bool              sd_conn_evt_ext;
+extern uint8_t           sd_service_changed;
+
+sd_conn_cfg_t const* sd_conn_cfg(uint8_t conn_cfg_tag);
+uint32_t sd_rand(void);
+
+// Queue a BLE event of len bytes (header included) and raise SD_EVT_IRQn,
+// return NULL when the queue is full. Must be filled before sd_unlock().
+ble_evt_t* sd_ble_evt_alloc(uint16_t evt_id, uint16_t len);
+
+// Queue a SoC event and raise SD_EVT_IRQn
+void sd_soc_evt_put(uint32_t evt_id);
+
+// Little endian UUID of 2 or 16 bytes from/to ble_uuid_t, return its length
+// (0 for an unknown type)
+uint8_t sd_uuid_encode(ble_uuid_t const* uuid, uint8_t* le);
+void    sd_uuid_decode(uint8_t const* le, uint8_t len, ble_uuid_t* uuid);
+
+//--------------------------------------------------------------------+
+// ATT PDU on a link (sd_link.c)
+//--------------------------------------------------------------------+
+enum
+{
+  SD_ATT_ERROR_RSP              = 0x01,
+  SD_ATT_MTU_REQ                = 0x02,
+  SD_ATT_MTU_RSP                = 0x03,
+  SD_ATT_FIND_INFO_REQ          = 0x04,
+  SD_ATT_FIND_INFO_RSP          = 0x05,
+  SD_ATT_FIND_BY_TYPE_VALUE_REQ = 0x06,
+  SD_ATT_FIND_BY_TYPE_VALUE_RSP = 0x07,
+  SD_ATT_READ_BY_TYPE_REQ       = 0x08,
+  SD_ATT_READ_BY_TYPE_RSP       = 0x09,
+  SD_ATT_READ_REQ               = 0x0A,
+  SD_ATT_READ_RSP               = 0x0B,
+  SD_ATT_READ_BLOB_REQ          = 0x0C,
+  SD_ATT_READ_BLOB_RSP          = 0x0D,
+  SD_ATT_READ_BY_GROUP_TYPE_REQ = 0x10,
+  SD_ATT_READ_BY_GROUP_TYPE_RSP = 0x11,
+  SD_ATT_WRITE_REQ              = 0x12,
+  SD_ATT_WRITE_RSP              = 0x13,
+  SD_ATT_PREPARE_WRITE_REQ      = 0x16,
+  SD_ATT_PREPARE_WRITE_RSP      = 0x17,
+  SD_ATT_EXECUTE_WRITE_REQ      = 0x18,
+  SD_ATT_EXECUTE_WRITE_RSP      = 0x19,
+  SD_ATT_HVN                    = 0x1B,
+  SD_ATT_HVI                    = 0x1D,
+  SD_ATT_HVC                    = 0x1E,
+  SD_ATT_WRITE_CMD              = 0x52,
+};
+
+// ATT error codes, BLE_GATT_STATUS_ATTERR_* is 0x0100 + code
+enum
+{
+  SD_ATT_ERR_INVALID_HANDLE     = 0x01,
+  SD_ATT_ERR_READ_NOT_PERMITTED = 0x02,
+  SD_ATT_ERR_WRITE_NOT_PERMITTED= 0x03,
+  SD_ATT_ERR_REQ_NOT_SUPPORTED  = 0x06,
+  SD_ATT_ERR_INVALID_OFFSET     = 0x07,
+  SD_ATT_ERR_ATTR_NOT_FOUND     = 0x0A,
+  SD_ATT_ERR_INVALID_ATT_LEN    = 0x0D,
+};
+
+// One ATT PDU: opcode and its parameters as sent over the air
+typedef struct
+{
+  uint8_t  op;
+  uint16_t len;            // parameters length, ATT PDU is len + 1
+  uint16_t acked;          // LL payload acknowledged so far
+  uint32_t ready_evt;      // connection event it can be sent from
+  uint64_t time_us;        // when it was queued
+  uint8_t  data[SD_ATT_MTU_MAX];
+} sd_pdu_t;
+
+#define SD_PDU_FIFO_SIZE      32
+
+typedef struct
+{
+  sd_pdu_t pdu[SD_PDU_FIFO_SIZE];
+  uint8_t  rd;
+  uint8_t  count;
+} sd_pdu_fifo_t;
+
+typedef struct
+{
+  bool     active;
+  uint8_t  role;
+  uint8_t  cfg_tag;
+  uint16_t conn_hdl;
+  ble_gap_addr_t        peer_addr;
+  sd_sim_link_cfg_t     sim;
+  ble_gap_conn_params_t params;
+
+  uint16_t mtu;
+  uint16_t data_length;
+  uint8_t  phy;
+
+  uint32_t evt_counter;
+  uint64_t anchor_us;
+  bool     evt_open;          // current event resumes after TX complete
+  uint32_t evt_elapsed;       // time used in current event
+  uint64_t last_rx_us;
+  host_timer_t timer;
+
+  sd_pdu_fifo_t tx;         // we send, peer receives
+  sd_pdu_fifo_t rx;         // peer sends, we receive
+
+  uint8_t  hvn_queued;      // notifications not yet acknowledged
+  uint8_t  wrcmd_queued;    // write commands not yet acknowledged
+  uint8_t  hvn_done;        // acknowledged in this connection event
+  uint8_t  wrcmd_done;
+
+  // ATT transactions in flight
+  bool     ind_pending;     // our indication waits for confirmation
+  uint16_t ind_handle;
+  bool     peer_ind_pending;// peer indication waits for our confirmation
+  uint8_t  gattc_req;       // our request waiting for a response (0 none)
+  uint16_t gattc_evt;       // event reporting its response
+  uint16_t gattc_handle;    // handle, offset and write op of a read/write
+  uint16_t gattc_offset;
+  uint8_t  gattc_write_op;
+  uint16_t gattc_mtu;       // client_rx_mtu of our MTU request
+  ble_uuid_t gattc_uuid;    // UUID of our discovery/read by type request
+  uint8_t  peer_req;        // peer request waiting for our response (0 none)
+  uint16_t peer_req_handle; // attribute of that request
+  uint16_t peer_client_mtu; // client_rx_mtu of peer MTU request
+  sd_pdu_t peer_write;      // peer write deferred by BLE_GATTS_EVT_SYS_ATTR_MISSING
+  bool     peer_write_deferred;
+
+  // LL procedures, complete at that connection event (0 none)
+  uint32_t phy_instant;
+  uint8_t  phy_new;
+  uint32_t dle_instant;
+  uint16_t dle_new;
+  uint32_t cpu_instant;
+  ble_gap_conn_params_t cpu_params;
+  uint32_t term_instant;
+  uint8_t  term_reason;
+
+  bool     rssi_started;
+} sd_link_t;
+
+extern sd_link_t sd_links[SD_SIM_LINK_MAX];
+
+// Active link of that handle, NULL if none
+sd_link_t* sd_link_get(uint16_t conn_hdl);
+
+// Open a link and queue BLE_GAP_EVT_CONNECTED, first connection event
+// follows after the transmit window
+sd_link_t* sd_link_open(uint8_t role, uint8_t cfg_tag, ble_gap_addr_t const* peer_addr,
+                        ble_gap_conn_params_t const* params, uint8_t adv_handle, ble_gap_adv_data_t const* adv_data);
+
+// Number of active links in that role
+uint8_t sd_link_count(uint8_t role);
+
+// Queue an ATT PDU to the peer (tx) or from the peer (rx, sent delay_evt
+// connection events after the current one, 0 for as soon as possible).
+// NULL if full
+sd_pdu_t* sd_link_tx(sd_link_t* link, uint8_t op);
+sd_pdu_t* sd_link_rx(sd_link_t* link, uint8_t op, uint8_t delay_evt);
+
+// Terminate at next connection event with reason as seen by the application
+void sd_link_terminate(sd_link_t* link, uint8_t reason);
+
+//--------------------------------------------------------------------+
+// ATT handlers, called when a PDU is received
+//--------------------------------------------------------------------+
+
+// GATT server (sd_gatts.c): peer requests, commands and confirmations
+void sd_gatts_init(void);
+void sd_gatts_on_att(sd_link_t* link, sd_pdu_t const* pdu);
+void sd_gatts_link_reset(sd_link_t* link);
+
+// GATT client (sd_gattc.c): responses, notifications and indications
+void sd_gattc_on_att(sd_link_t* link, sd_pdu_t const* pdu);
+
+// Peer device (sd_peer.c): everything we send
+void sd_peer_on_att(sd_link_t* link, sd_pdu_t const* pdu, uint64_t time_us);
+
+//--------------------------------------------------------------------+
+// GAP (sd_gap.c)
+//--------------------------------------------------------------------+
+void sd_gap_init(void);
+
+// Peripheral preferred connection parameters, used by sd_ble_gap_conn_param_update(NULL)
+extern ble_gap_conn_params_t sd_gap_ppcp;
+
+// Peer central address of sd_sim_peer_connect()
+extern ble_gap_addr_t const sd_peer_central_addr;
+
+#endif /* SD_INTERNAL_H_ */
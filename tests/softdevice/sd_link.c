@@ -0,0 +1,666 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// LL data PDU: L2CAP header (4) + ATT PDU, fragmented by the data length
+#define L2CAP_HDR_LEN           4
+
+// Connection events before a LL control procedure completes
+#define LL_PROC_EVENTS          2
+#define LL_CONN_UPDATE_EVENTS   6
+
+// Transmit window after CONNECT_IND
+#define CONN_FIRST_EVENT_US     2500
+
+sd_link_t sd_links[SD_SIM_LINK_MAX];
+
+ble_gap_addr_t const sd_peer_central_addr =
+{
+  .addr_id_peer = 0,
+  .addr_type    = BLE_GAP_ADDR_TYPE_RANDOM_STATIC,
+  .addr         = { 0x01, 0x00, 0x00, 0x00, 0x5E, 0xC0 }
+};
+
+static void link_event(host_timer_t* timer);
+
+//--------------------------------------------------------------------+
+// PDU fifo
+//--------------------------------------------------------------------+
+static sd_pdu_t* fifo_push(sd_pdu_fifo_t* fifo)
+{
+  if ( fifo->count == SD_PDU_FIFO_SIZE ) return NULL;
+
+  sd_pdu_t* pdu = &fifo->pdu[(fifo->rd + fifo->count) % SD_PDU_FIFO_SIZE];
+  fifo->count++;
+
+  return pdu;
+}
+
+static sd_pdu_t* fifo_peek(sd_pdu_fifo_t* fifo, uint32_t evt)
+{
+  if ( fifo->count == 0 ) return NULL;
+
+  sd_pdu_t* pdu = &fifo->pdu[fifo->rd];
+  return (pdu->ready_evt <= evt) ? pdu : NULL;
+}
+
+static void fifo_pop(sd_pdu_fifo_t* fifo)
+{
+  fifo->rd = (uint8_t) ((fifo->rd + 1) % SD_PDU_FIFO_SIZE);
+  fifo->count--;
+}
+
+//--------------------------------------------------------------------+
+// Radio
+//--------------------------------------------------------------------+
+
+// Air time of a LL data PDU with that payload: preamble, access address,
+// header and CRC are 10 bytes on 1M, 11 on 2M (2-byte preamble)
+static inline uint32_t airtime_us(uint8_t phy, uint16_t payload)
+{
+  return (phy == BLE_GAP_PHY_2MBPS) ? (11u + payload) * 4u : (10u + payload) * 8u;
+}
+
+static inline bool pdu_lost(sd_link_t* link)
+{
+  return link->sim.loss_percent && ((sd_rand() % 100) < link->sim.loss_percent);
+}
+
+static inline uint16_t ll_remaining(sd_pdu_t const* pdu)
+{
+  return (uint16_t) (L2CAP_HDR_LEN + 1 + pdu->len - pdu->acked);
+}
+
+//--------------------------------------------------------------------+
+// Link
+//--------------------------------------------------------------------+
+sd_link_t* sd_link_get(uint16_t conn_hdl)
+{
+  if ( conn_hdl >= SD_SIM_LINK_MAX || !sd_links[conn_hdl].active ) return NULL;
+  return &sd_links[conn_hdl];
+}
+
+uint8_t sd_link_count(uint8_t role)
+{
+  uint8_t count = 0;
+  for(uint8_t i=0; i<SD_SIM_LINK_MAX; i++)
+  {
+    if ( sd_links[i].active && sd_links[i].role == role ) count++;
+  }
+  return count;
+}
+
+sd_link_t* sd_link_open(uint8_t role, uint8_t cfg_tag, ble_gap_addr_t const* peer_addr,
+                        ble_gap_conn_params_t const* params, uint8_t adv_handle, ble_gap_adv_data_t const* adv_data)
+{
+  sd_link_t* link = NULL;
+  for(uint8_t i=0; i<SD_SIM_LINK_MAX; i++)
+  {
+    if ( !sd_links[i].active )
+    {
+      link = &sd_links[i];
+      break;
+    }
+  }
+  if ( !link ) return NULL;
+
+  uint16_t const conn_hdl = (uint16_t) (link - sd_links);
+
+  memset(link, 0, sizeof(sd_link_t));
+  link->active      = true;
+  link->role        = role;
+  link->cfg_tag     = cfg_tag;
+  link->conn_hdl    = conn_hdl;
+  link->peer_addr   = *peer_addr;
+  link->sim         = sd_link_cfg;
+  link->params      = *params;
+  link->mtu         = BLE_GATT_ATT_MTU_DEFAULT;
+  link->data_length = BLE_GATT_ATT_MTU_DEFAULT + L2CAP_HDR_LEN;
+  link->phy         = BLE_GAP_PHY_1MBPS;
+
+  uint64_t const now = host_time_us();
+  link->anchor_us  = now + CONN_FIRST_EVENT_US;
+  link->last_rx_us = link->anchor_us;
+
+  link->timer.cb   = link_event;
+  link->timer.irqn = SD_RADIO_IRQn;
+  link->timer.arg  = link;
+  host_timer_start(&link->timer, link->anchor_us);
+
+  sd_gatts_link_reset(link);
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_CONNECTED, sizeof(ble_evt_t));
+  if ( evt )
+  {
+    ble_gap_evt_connected_t* connected = &evt->evt.gap_evt.params.connected;
+
+    evt->evt.gap_evt.conn_handle = conn_hdl;
+    connected->peer_addr   = *peer_addr;
+    connected->role        = role;
+    connected->conn_params = *params;
+    connected->adv_handle  = adv_handle;
+    if ( adv_data ) connected->adv_data = *adv_data;
+  }
+
+  return link;
+}
+
+sd_pdu_t* sd_link_tx(sd_link_t* link, uint8_t op)
+{
+  sd_pdu_t* pdu = fifo_push(&link->tx);
+  if ( pdu )
+  {
+    pdu->op        = op;
+    pdu->len       = 0;
+    pdu->acked     = 0;
+    pdu->ready_evt = 0;
+    pdu->time_us   = host_time_us();
+  }
+  return pdu;
+}
+
+sd_pdu_t* sd_link_rx(sd_link_t* link, uint8_t op, uint8_t delay_evt)
+{
+  sd_pdu_t* pdu = fifo_push(&link->rx);
+  if ( pdu )
+  {
+    pdu->op        = op;
+    pdu->len       = 0;
+    pdu->acked     = 0;
+    pdu->ready_evt = link->evt_counter + delay_evt;
+    pdu->time_us   = host_time_us();
+  }
+  return pdu;
+}
+
+void sd_link_terminate(sd_link_t* link, uint8_t reason)
+{
+  if ( link->term_instant ) return;
+
+  link->term_instant = link->evt_counter + 1;
+  link->term_reason  = reason;
+}
+
+static void link_close(sd_link_t* link, uint8_t reason)
+{
+  host_timer_stop(&link->timer);
+  link->active = false;
+
+  ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_DISCONNECTED, sizeof(ble_evt_t));
+  if ( evt )
+  {
+    evt->evt.gap_evt.conn_handle = link->conn_hdl;
+    evt->evt.gap_evt.params.disconnected.reason = reason;
+  }
+}
+
+//--------------------------------------------------------------------+
+// LL control procedures
+//--------------------------------------------------------------------+
+
+// return false if the link is closed
+static bool link_procedures(sd_link_t* link)
+{
+  uint32_t const evt_counter = link->evt_counter;
+
+  if ( link->term_instant && link->term_instant <= evt_counter )
+  {
+    link_close(link, link->term_reason);
+    return false;
+  }
+
+  if ( link->phy_instant && link->phy_instant <= evt_counter )
+  {
+    link->phy_instant = 0;
+    link->phy = link->phy_new;
+
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_PHY_UPDATE, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      evt->evt.gap_evt.conn_handle = link->conn_hdl;
+      evt->evt.gap_evt.params.phy_update.status = BLE_HCI_STATUS_CODE_SUCCESS;
+      evt->evt.gap_evt.params.phy_update.tx_phy = link->phy;
+      evt->evt.gap_evt.params.phy_update.rx_phy = link->phy;
+    }
+  }
+
+  if ( link->dle_instant && link->dle_instant <= evt_counter )
+  {
+    link->dle_instant = 0;
+    link->data_length = link->dle_new;
+
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_DATA_LENGTH_UPDATE, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      ble_gap_data_length_params_t* dl = &evt->evt.gap_evt.params.data_length_update.effective_params;
+
+      evt->evt.gap_evt.conn_handle = link->conn_hdl;
+      dl->max_tx_octets  = link->data_length;
+      dl->max_rx_octets  = link->data_length;
+      dl->max_tx_time_us = (uint16_t) ((link->data_length + 14) * 8);
+      dl->max_rx_time_us = (uint16_t) ((link->data_length + 14) * 8);
+    }
+  }
+
+  if ( link->cpu_instant && link->cpu_instant <= evt_counter )
+  {
+    link->cpu_instant = 0;
+    link->params = link->cpu_params;
+
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GAP_EVT_CONN_PARAM_UPDATE, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      evt->evt.gap_evt.conn_handle = link->conn_hdl;
+      evt->evt.gap_evt.params.conn_param_update.conn_params = link->params;
+    }
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Connection event
+//--------------------------------------------------------------------+
+
+// PDU from the peer, split between our server and our client
+static void local_on_att(sd_link_t* link, sd_pdu_t const* pdu)
+{
+  switch ( pdu->op )
+  {
+    case SD_ATT_MTU_REQ:
+    case SD_ATT_WRITE_REQ:
+    case SD_ATT_WRITE_CMD:
+    case SD_ATT_HVC:
+      sd_gatts_on_att(link, pdu);
+    break;
+
+    default:
+      sd_gattc_on_att(link, pdu);
+    break;
+  }
+}
+
+/* Connection event computed exchange by exchange from its anchor point:
+ * master and slave take turns, each exchange is our PDU + T_IFS + peer PDU +
+ * T_IFS (empty PDU when a side has nothing to send). When our queue runs
+ * empty, TX complete is reported and the event resumes at that point so the
+ * application can refill the queue, as it does from the TX complete
+ * interrupt on target. The event closes when neither side has more data or
+ * when the next exchange does not fit in the event length, extended to the
+ * connection interval with BLE_COMMON_OPT_CONN_EVT_EXT like the SoftDevice.
+ */
+static void link_event(host_timer_t* timer)
+{
+  sd_link_t* link = (sd_link_t*) timer->arg;
+
+  sd_lock();
+
+  uint64_t const t0 = link->anchor_us;
+  uint32_t const interval_us = link->params.max_conn_interval * 1250u;
+
+  bool first = !link->evt_open;
+  link->evt_open = false;
+
+  if ( first )
+  {
+    link->evt_counter++;
+    link->evt_elapsed = 0;
+    sd_stats.conn_events++;
+
+    if ( !link_procedures(link) )
+    {
+      sd_unlock();
+      return;
+    }
+  }
+
+  uint32_t const event_len_us = sd_conn_cfg(link->cfg_tag)->event_length * 1250u;
+  uint32_t const budget = sd_conn_evt_ext ? (interval_us - SD_T_IFS_US) : SD_MIN(event_len_us, interval_us - SD_T_IFS_US);
+
+  bool idle = false;
+
+  link->hvn_done   = 0;
+  link->wrcmd_done = 0;
+
+  while ( link->active )
+  {
+    sd_pdu_t* ours  = fifo_peek(&link->tx, link->evt_counter);
+    sd_pdu_t* peers = fifo_peek(&link->rx, link->evt_counter);
+
+    if ( !first && !ours && !peers )
+    {
+      idle = true;
+      break;
+    }
+
+    uint16_t const ours_len  = ours  ? SD_MIN(link->data_length, ll_remaining(ours))  : 0;
+    uint16_t const peers_len = peers ? SD_MIN(link->data_length, ll_remaining(peers)) : 0;
+    uint32_t const exchange  = airtime_us(link->phy, ours_len) + SD_T_IFS_US + airtime_us(link->phy, peers_len) + SD_T_IFS_US;
+
+    if ( !first && (link->evt_elapsed + exchange > budget) ) break;
+
+    first = false;
+    link->evt_elapsed += exchange;
+
+    uint64_t const t_rx = t0 + link->evt_elapsed;
+
+    // our PDU, retransmitted until acknowledged
+    bool const ours_lost = pdu_lost(link);
+    if ( ours )
+    {
+      sd_stats.pdu_tx++;
+
+      if ( ours_lost )
+      {
+        sd_stats.pdu_lost++;
+      }
+      else
+      {
+        ours->acked += ours_len;
+
+        if ( ll_remaining(ours) == 0 )
+        {
+          if ( ours->op == SD_ATT_HVN )
+          {
+            link->hvn_queued--;
+            link->hvn_done++;
+          }
+          else if ( ours->op == SD_ATT_WRITE_CMD )
+          {
+            link->wrcmd_queued--;
+            link->wrcmd_done++;
+          }
+
+          sd_pdu_t const pdu = *ours;
+          fifo_pop(&link->tx);
+          sd_peer_on_att(link, &pdu, t_rx);
+        }
+      }
+    }
+
+    // peer PDU, empty ones keep the supervision timer going
+    if ( pdu_lost(link) )
+    {
+      if ( peers )
+      {
+        sd_stats.pdu_rx++;
+        sd_stats.pdu_lost++;
+      }
+    }
+    else
+    {
+      link->last_rx_us = t_rx;
+
+      if ( peers )
+      {
+        sd_stats.pdu_rx++;
+        peers->acked += peers_len;
+
+        if ( ll_remaining(peers) == 0 )
+        {
+          sd_pdu_t const pdu = *peers;
+          fifo_pop(&link->rx);
+          local_on_att(link, &pdu);
+        }
+      }
+    }
+  }
+
+  if ( !link->active )
+  {
+    sd_unlock();
+    return;
+  }
+
+  if ( link->hvn_done )
+  {
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTS_EVT_HVN_TX_COMPLETE, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      evt->evt.gatts_evt.conn_handle = link->conn_hdl;
+      evt->evt.gatts_evt.params.hvn_tx_complete.count = link->hvn_done;
+    }
+  }
+
+  if ( link->wrcmd_done )
+  {
+    ble_evt_t* evt = sd_ble_evt_alloc(BLE_GATTC_EVT_WRITE_CMD_TX_COMPLETE, sizeof(ble_evt_t));
+    if ( evt )
+    {
+      evt->evt.gattc_evt.conn_handle = link->conn_hdl;
+      evt->evt.gattc_evt.params.write_cmd_tx_complete.count = link->wrcmd_done;
+    }
+  }
+
+  // queue ran empty with time left: give the application a chance to refill
+  if ( idle && (link->hvn_done || link->wrcmd_done) )
+  {
+    link->evt_open = true;
+    host_timer_start(&link->timer, t0 + link->evt_elapsed);
+
+    sd_unlock();
+    return;
+  }
+
+  // supervision timeout
+  if ( t0 >= link->last_rx_us + link->params.conn_sup_timeout * 10000ull )
+  {
+    link_close(link, BLE_HCI_CONNECTION_TIMEOUT);
+    sd_unlock();
+    return;
+  }
+
+  link->anchor_us = t0 + interval_us;
+  host_timer_start(&link->timer, link->anchor_us);
+
+  sd_unlock();
+}
+
+//--------------------------------------------------------------------+
+// GAP connection API
+//--------------------------------------------------------------------+
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code)
+{
+  if ( hci_status_code != BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION &&
+       hci_status_code != BLE_HCI_CONN_INTERVAL_UNACCEPTABLE ) return NRF_ERROR_INVALID_PARAM;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( link->term_instant )
+  {
+    err = NRF_ERROR_INVALID_STATE;
+  }
+  else
+  {
+    sd_link_terminate(link, BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION);
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_conn_param_update(uint16_t conn_handle, ble_gap_conn_params_t const *p_conn_params)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( link->cpu_instant )
+  {
+    err = NRF_ERROR_BUSY;
+  }
+  else
+  {
+    ble_gap_conn_params_t const* req = p_conn_params ? p_conn_params : &sd_gap_ppcp;
+
+    if ( req->min_conn_interval > req->max_conn_interval || req->min_conn_interval < BLE_GAP_CP_MIN_CONN_INTVL_MIN ||
+         req->max_conn_interval > BLE_GAP_CP_MAX_CONN_INTVL_MAX )
+    {
+      err = NRF_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+      link->cpu_params = *req;
+
+      // as peripheral the peer central picks its preferred interval within range
+      uint16_t interval = req->max_conn_interval;
+      if ( link->role == BLE_GAP_ROLE_PERIPH )
+      {
+        interval = SD_MAX(req->min_conn_interval, SD_MIN(link->sim.conn_interval, req->max_conn_interval));
+      }
+
+      link->cpu_params.min_conn_interval = interval;
+      link->cpu_params.max_conn_interval = interval;
+      link->cpu_instant = link->evt_counter + LL_CONN_UPDATE_EVENTS;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const *p_gap_phys)
+{
+  if ( !p_gap_phys ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( link->phy_instant )
+  {
+    err = NRF_ERROR_BUSY;
+  }
+  else
+  {
+    // AUTO lets the SoftDevice pick the fastest common PHY
+    uint8_t const ours = (p_gap_phys->tx_phys == BLE_GAP_PHY_AUTO) ? (BLE_GAP_PHY_1MBPS | BLE_GAP_PHY_2MBPS) : p_gap_phys->tx_phys;
+    uint8_t const common = ours & link->sim.peer_phys;
+
+    link->phy_new     = (common & BLE_GAP_PHY_2MBPS) ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_1MBPS;
+    link->phy_instant = link->evt_counter + LL_PROC_EVENTS;
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_data_length_update(uint16_t conn_handle, ble_gap_data_length_params_t const *p_dl_params,
+                                       ble_gap_data_length_limitation_t *p_dl_limitation)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  uint32_t err = NRF_SUCCESS;
+
+  if ( !link )
+  {
+    err = BLE_ERROR_INVALID_CONN_HANDLE;
+  }
+  else if ( link->dle_instant )
+  {
+    err = NRF_ERROR_BUSY;
+  }
+  else
+  {
+    // limited by the ATT MTU this connection was configured with
+    uint16_t const supported = (uint16_t) SD_MIN(251, sd_conn_cfg(link->cfg_tag)->att_mtu + L2CAP_HDR_LEN);
+    uint16_t octets = supported;
+
+    if ( p_dl_params && p_dl_params->max_tx_octets != BLE_GAP_DATA_LENGTH_AUTO )
+    {
+      octets = p_dl_params->max_tx_octets;
+    }
+
+    if ( octets > supported )
+    {
+      if ( p_dl_limitation )
+      {
+        memset(p_dl_limitation, 0, sizeof(ble_gap_data_length_limitation_t));
+        p_dl_limitation->tx_payload_limited_octets = (uint16_t) (octets - supported);
+        p_dl_limitation->rx_payload_limited_octets = (uint16_t) (octets - supported);
+      }
+      err = NRF_ERROR_RESOURCES;
+    }
+    else
+    {
+      link->dle_new     = (uint16_t) SD_MAX(BLE_GATT_ATT_MTU_DEFAULT + L2CAP_HDR_LEN, SD_MIN(octets, link->sim.peer_data_length));
+      link->dle_instant = link->evt_counter + LL_PROC_EVENTS;
+    }
+  }
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_ble_gap_rssi_start(uint16_t conn_handle, uint8_t threshold_dbm, uint8_t skip_count)
+{
+  (void) threshold_dbm;
+  (void) skip_count;
+
+  sd_link_t* link = sd_link_get(conn_handle);
+  if ( !link ) return BLE_ERROR_INVALID_CONN_HANDLE;
+
+  link->rssi_started = true;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_rssi_stop(uint16_t conn_handle)
+{
+  sd_link_t* link = sd_link_get(conn_handle);
+  if ( !link ) return BLE_ERROR_INVALID_CONN_HANDLE;
+  if ( !link->rssi_started ) return NRF_ERROR_INVALID_STATE;
+
+  link->rssi_started = false;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_rssi_get(uint16_t conn_handle, int8_t *p_rssi, uint8_t *p_ch_index)
+{
+  sd_link_t* link = sd_link_get(conn_handle);
+  if ( !link ) return BLE_ERROR_INVALID_CONN_HANDLE;
+  if ( !link->rssi_started ) return NRF_ERROR_INVALID_STATE;
+
+  *p_rssi = -50;
+  if ( p_ch_index ) *p_ch_index = (uint8_t) (link->evt_counter % 37);
+
+  return NRF_SUCCESS;
+}
+
+//--------------------------------------------------------------------+
+// Peer control
+//--------------------------------------------------------------------+
+bool sd_sim_peer_disconnect(uint16_t conn_hdl, uint8_t hci_status)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_hdl);
+  if ( link ) sd_link_terminate(link, hci_status);
+
+  sd_unlock();
+
+  return link != NULL;
+}
@@ -0,0 +1,538 @@
+#include "sd_internal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+#define PEER_VALUE_MAX          512
+#define PEER_PREP_MAX           512
+
+// Characteristic properties in the declaration
+#define CHAR_PROP_NOTIFY        0x10
+#define CHAR_PROP_INDICATE      0x20
+
+typedef struct
+{
+  uint8_t  type[16];          // little endian
+  uint8_t  type_len;
+  uint16_t len;
+  uint8_t  value[PEER_VALUE_MAX];
+} peer_attr_t;
+
+// Simulated remote GATT server
+static peer_attr_t _db[SD_SIM_PEER_ATTR_MAX];
+static uint16_t    _db_count;
+
+// Prepared writes of the peer server, per link
+static uint8_t  _prep[SD_SIM_LINK_MAX][PEER_PREP_MAX];
+static uint16_t _prep_handle[SD_SIM_LINK_MAX];
+static uint16_t _prep_len[SD_SIM_LINK_MAX];
+
+static inline peer_attr_t* db_get(uint16_t handle)
+{
+  return (handle == BLE_GATT_HANDLE_INVALID || handle > _db_count) ? NULL : &_db[handle-1];
+}
+
+static inline bool db_is(peer_attr_t const* attr, uint16_t uuid16)
+{
+  return (attr->type_len == 2) && (sd_u16(attr->type) == uuid16);
+}
+
+static peer_attr_t* db_add(uint16_t uuid16, uint8_t const* uuid, uint8_t uuid_len, void const* value, uint16_t len)
+{
+  if ( _db_count == SD_SIM_PEER_ATTR_MAX || len > PEER_VALUE_MAX ) return NULL;
+
+  peer_attr_t* attr = &_db[_db_count++];
+
+  if ( uuid )
+  {
+    memcpy(attr->type, uuid, uuid_len);
+    attr->type_len = uuid_len;
+  }
+  else
+  {
+    sd_put_u16(attr->type, uuid16);
+    attr->type_len = 2;
+  }
+
+  attr->len = len;
+  if ( len ) memcpy(attr->value, value, len);
+
+  return attr;
+}
+
+// Last handle of the service starting at handle
+static uint16_t group_end(uint16_t handle)
+{
+  for(uint16_t h = (uint16_t) (handle+1); h <= _db_count; h++)
+  {
+    if ( db_is(db_get(h), BLE_UUID_SERVICE_PRIMARY) ) return (uint16_t) (h-1);
+  }
+  return BLE_GATT_HANDLE_END;
+}
+
+//--------------------------------------------------------------------+
+// Peer ATT server
+//--------------------------------------------------------------------+
+static sd_pdu_t* rsp_new(sd_link_t* link, uint8_t op)
+{
+  return sd_link_rx(link, op, link->sim.att_delay);
+}
+
+static void rsp_error(sd_link_t* link, uint8_t req, uint16_t handle, uint8_t code)
+{
+  sd_pdu_t* rsp = rsp_new(link, SD_ATT_ERROR_RSP);
+  if ( !rsp ) return;
+
+  rsp->data[0] = req;
+  sd_put_u16(rsp->data+1, handle);
+  rsp->data[3] = code;
+  rsp->len     = 4;
+}
+
+static void on_find_by_type_value(sd_link_t* link, sd_pdu_t const* req)
+{
+  uint16_t const start = sd_u16(req->data);
+  uint16_t const end   = sd_u16(req->data+2);
+  uint16_t const type  = sd_u16(req->data+4);
+  uint8_t const* value = req->data+6;
+  uint16_t const value_len = (uint16_t) (req->len - 6);
+
+  sd_pdu_t* rsp = rsp_new(link, SD_ATT_FIND_BY_TYPE_VALUE_RSP);
+  if ( !rsp ) return;
+
+  for(uint16_t h = start; h <= SD_MIN(end, _db_count) && rsp->len + 4 <= link->mtu - 1; h++)
+  {
+    peer_attr_t const* attr = db_get(h);
+    if ( !db_is(attr, type) || attr->len != value_len || memcmp(attr->value, value, value_len) ) continue;
+
+    sd_put_u16(rsp->data + rsp->len, h);
+    sd_put_u16(rsp->data + rsp->len + 2, group_end(h));
+    rsp->len += 4;
+  }
+
+  if ( rsp->len == 0 )
+  {
+    rsp->op      = SD_ATT_ERROR_RSP;
+    rsp->data[0] = req->op;
+    sd_put_u16(rsp->data+1, start);
+    rsp->data[3] = SD_ATT_ERR_ATTR_NOT_FOUND;
+    rsp->len     = 4;
+  }
+}
+
+// Read By Type and Read By Group Type: entries of the same length only
+static void on_read_by_type(sd_link_t* link, sd_pdu_t const* req)
+{
+  bool const group = (req->op == SD_ATT_READ_BY_GROUP_TYPE_REQ);
+  uint16_t const start = sd_u16(req->data);
+  uint16_t const end   = sd_u16(req->data+2);
+  uint8_t const* type  = req->data+4;
+  uint8_t const type_len = (uint8_t) (req->len - 4);
+
+  sd_pdu_t* rsp = rsp_new(link, group ? SD_ATT_READ_BY_GROUP_TYPE_RSP : SD_ATT_READ_BY_TYPE_RSP);
+  if ( !rsp ) return;
+
+  uint8_t entry = 0;
+  rsp->len = 1;
+
+  for(uint16_t h = start; h <= SD_MIN(end, _db_count); h++)
+  {
+    peer_attr_t const* attr = db_get(h);
+    if ( attr->type_len != type_len || memcmp(attr->type, type, type_len) ) continue;
+
+    uint8_t const hdr = group ? 4 : 2;
+    uint8_t const len = (uint8_t) (hdr + SD_MIN(attr->len, (uint16_t) (SD_MIN(link->mtu - 2, 255) - hdr)));
+
+    if ( entry == 0 )
+    {
+      entry = len;
+    }
+    else if ( len != entry )
+    {
+      break;
+    }
+
+    if ( rsp->len + entry > link->mtu ) break;
+
+    uint8_t* p = rsp->data + rsp->len;
+    sd_put_u16(p, h);
+    if ( group ) sd_put_u16(p+2, group_end(h));
+    memcpy(p + hdr, attr->value, entry - hdr);
+
+    rsp->len += entry;
+  }
+
+  if ( entry == 0 )
+  {
+    rsp->op      = SD_ATT_ERROR_RSP;
+    rsp->data[0] = req->op;
+    sd_put_u16(rsp->data+1, start);
+    rsp->data[3] = SD_ATT_ERR_ATTR_NOT_FOUND;
+    rsp->len     = 4;
+    return;
+  }
+
+  rsp->data[0] = entry;
+}
+
+static void on_find_info(sd_link_t* link, sd_pdu_t const* req)
+{
+  uint16_t const start = sd_u16(req->data);
+  uint16_t const end   = sd_u16(req->data+2);
+
+  sd_pdu_t* rsp = rsp_new(link, SD_ATT_FIND_INFO_RSP);
+  if ( !rsp ) return;
+
+  uint8_t type_len = 0;
+  rsp->len = 1;
+
+  for(uint16_t h = start; h <= SD_MIN(end, _db_count); h++)
+  {
+    peer_attr_t const* attr = db_get(h);
+
+    // one UUID size per response
+    if ( type_len == 0 )
+    {
+      type_len = attr->type_len;
+    }
+    else if ( attr->type_len != type_len )
+    {
+      break;
+    }
+
+    if ( rsp->len + 2 + type_len > link->mtu ) break;
+
+    sd_put_u16(rsp->data + rsp->len, h);
+    memcpy(rsp->data + rsp->len + 2, attr->type, type_len);
+    rsp->len += (uint16_t) (2 + type_len);
+  }
+
+  if ( type_len == 0 )
+  {
+    rsp->op      = SD_ATT_ERROR_RSP;
+    rsp->data[0] = req->op;
+    sd_put_u16(rsp->data+1, start);
+    rsp->data[3] = SD_ATT_ERR_ATTR_NOT_FOUND;
+    rsp->len     = 4;
+    return;
+  }
+
+  rsp->data[0] = (type_len == 2) ? BLE_GATTC_ATTR_INFO_FORMAT_16BIT : BLE_GATTC_ATTR_INFO_FORMAT_128BIT;
+}
+
+static void on_read(sd_link_t* link, sd_pdu_t const* req)
+{
+  uint16_t const handle = sd_u16(req->data);
+  uint16_t const offset = (req->op == SD_ATT_READ_BLOB_REQ) ? sd_u16(req->data+2) : 0;
+  peer_attr_t const* attr = db_get(handle);
+
+  if ( !attr )
+  {
+    rsp_error(link, req->op, handle, SD_ATT_ERR_INVALID_HANDLE);
+    return;
+  }
+
+  if ( offset > attr->len )
+  {
+    rsp_error(link, req->op, handle, SD_ATT_ERR_INVALID_OFFSET);
+    return;
+  }
+
+  sd_pdu_t* rsp = rsp_new(link, (req->op == SD_ATT_READ_BLOB_REQ) ? SD_ATT_READ_BLOB_RSP : SD_ATT_READ_RSP);
+  if ( !rsp ) return;
+
+  rsp->len = SD_MIN((uint16_t) (attr->len - offset), (uint16_t) (link->mtu - 1));
+  memcpy(rsp->data, attr->value + offset, rsp->len);
+}
+
+static void on_write(sd_link_t* link, sd_pdu_t const* req)
+{
+  bool const cmd = (req->op == SD_ATT_WRITE_CMD);
+  uint16_t const handle = sd_u16(req->data);
+  uint16_t const len = (uint16_t) (req->len - 2);
+  peer_attr_t* attr = db_get(handle);
+
+  if ( cmd )
+  {
+    sd_stats.wrcmd_count++;
+    sd_stats.wrcmd_bytes += len;
+  }
+
+  if ( !attr || len > PEER_VALUE_MAX )
+  {
+    if ( !cmd ) rsp_error(link, req->op, handle, attr ? SD_ATT_ERR_INVALID_ATT_LEN : SD_ATT_ERR_INVALID_HANDLE);
+    return;
+  }
+
+  memcpy(attr->value, req->data+2, len);
+  attr->len = len;
+
+  if ( sd_rx_cb ) sd_rx_cb(link->conn_hdl, handle, req->data+2, len);
+
+  if ( !cmd ) rsp_new(link, SD_ATT_WRITE_RSP);
+}
+
+static void on_prepare_write(sd_link_t* link, sd_pdu_t const* req)
+{
+  uint16_t const conn_hdl = link->conn_hdl;
+  uint16_t const handle = sd_u16(req->data);
+  uint16_t const offset = sd_u16(req->data+2);
+  uint16_t const len = (uint16_t) (req->len - 4);
+
+  // one attribute at a time, written in order
+  if ( !db_get(handle) || offset + len > PEER_PREP_MAX )
+  {
+    rsp_error(link, req->op, handle, db_get(handle) ? SD_ATT_ERR_INVALID_OFFSET : SD_ATT_ERR_INVALID_HANDLE);
+    return;
+  }
+
+  memcpy(_prep[conn_hdl] + offset, req->data+4, len);
+  _prep_handle[conn_hdl] = handle;
+  _prep_len[conn_hdl]    = SD_MAX(_prep_len[conn_hdl], (uint16_t) (offset + len));
+
+  sd_pdu_t* rsp = rsp_new(link, SD_ATT_PREPARE_WRITE_RSP);
+  if ( !rsp ) return;
+
+  memcpy(rsp->data, req->data, req->len);
+  rsp->len = req->len;
+}
+
+static void on_execute_write(sd_link_t* link, sd_pdu_t const* req)
+{
+  uint16_t const conn_hdl = link->conn_hdl;
+  peer_attr_t* attr = db_get(_prep_handle[conn_hdl]);
+
+  if ( req->data[0] == BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE && attr && _prep_len[conn_hdl] )
+  {
+    memcpy(attr->value, _prep[conn_hdl], _prep_len[conn_hdl]);
+    attr->len = _prep_len[conn_hdl];
+
+    if ( sd_rx_cb ) sd_rx_cb(conn_hdl, _prep_handle[conn_hdl], attr->value, attr->len);
+  }
+
+  _prep_handle[conn_hdl] = 0;
+  _prep_len[conn_hdl]    = 0;
+
+  rsp_new(link, SD_ATT_EXECUTE_WRITE_RSP);
+}
+
+//--------------------------------------------------------------------+
+// Everything we send reaches the peer here
+//--------------------------------------------------------------------+
+void sd_peer_on_att(sd_link_t* link, sd_pdu_t const* pdu, uint64_t time_us)
+{
+  // requests from our client
+  switch ( pdu->op )
+  {
+    case SD_ATT_MTU_REQ:
+    case SD_ATT_FIND_BY_TYPE_VALUE_REQ:
+    case SD_ATT_READ_BY_TYPE_REQ:
+    case SD_ATT_READ_BY_GROUP_TYPE_REQ:
+    case SD_ATT_FIND_INFO_REQ:
+    case SD_ATT_READ_REQ:
+    case SD_ATT_READ_BLOB_REQ:
+    case SD_ATT_WRITE_REQ:
+    case SD_ATT_PREPARE_WRITE_REQ:
+    case SD_ATT_EXECUTE_WRITE_REQ:
+      sd_stats.att_requests++;
+    break;
+
+    default: break;
+  }
+
+  switch ( pdu->op )
+  {
+    case SD_ATT_HVN:
+    case SD_ATT_HVI:
+    {
+      uint16_t const len = (uint16_t) (pdu->len - 2);
+      uint32_t const latency = (uint32_t) (time_us - pdu->time_us);
+
+      sd_stats.hvn_count++;
+      sd_stats.hvn_bytes       += len;
+      sd_stats.hvn_latency_sum += latency;
+      sd_stats.hvn_latency_max  = SD_MAX(sd_stats.hvn_latency_max, latency);
+
+      if ( sd_rx_cb ) sd_rx_cb(link->conn_hdl, sd_u16(pdu->data), pdu->data+2, len);
+
+      if ( pdu->op == SD_ATT_HVI ) rsp_new(link, SD_ATT_HVC);
+    }
+    break;
+
+    case SD_ATT_MTU_REQ:
+    {
+      sd_pdu_t* rsp = rsp_new(link, SD_ATT_MTU_RSP);
+      if ( rsp )
+      {
+        sd_put_u16(rsp->data, link->sim.peer_mtu);
+        rsp->len = 2;
+      }
+    }
+    break;
+
+    case SD_ATT_FIND_BY_TYPE_VALUE_REQ: on_find_by_type_value(link, pdu); break;
+
+    case SD_ATT_READ_BY_TYPE_REQ:
+    case SD_ATT_READ_BY_GROUP_TYPE_REQ:
+      on_read_by_type(link, pdu);
+    break;
+
+    case SD_ATT_FIND_INFO_REQ: on_find_info(link, pdu); break;
+
+    case SD_ATT_READ_REQ:
+    case SD_ATT_READ_BLOB_REQ:
+      on_read(link, pdu);
+    break;
+
+    case SD_ATT_WRITE_REQ:
+    case SD_ATT_WRITE_CMD:
+      on_write(link, pdu);
+    break;
+
+    case SD_ATT_PREPARE_WRITE_REQ: on_prepare_write(link, pdu); break;
+    case SD_ATT_EXECUTE_WRITE_REQ: on_execute_write(link, pdu); break;
+
+    // responses to peer requests and our confirmations need nothing more
+    default: break;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Simulator API
+//--------------------------------------------------------------------+
+uint16_t sd_sim_peer_service_add(uint8_t const* uuid, uint8_t uuid_len)
+{
+  if ( uuid_len != 2 && uuid_len != 16 ) return 0;
+
+  sd_lock();
+  peer_attr_t const* attr = db_add(BLE_UUID_SERVICE_PRIMARY, NULL, 0, uuid, uuid_len);
+  uint16_t const handle = attr ? _db_count : 0;
+  sd_unlock();
+
+  return handle;
+}
+
+uint16_t sd_sim_peer_char_add(uint8_t const* uuid, uint8_t uuid_len, uint8_t props, void const* value, uint16_t len)
+{
+  if ( uuid_len != 2 && uuid_len != 16 ) return 0;
+
+  sd_lock();
+
+  uint16_t handle = 0;
+  uint8_t decl[3+16];
+
+  decl[0] = props;
+  sd_put_u16(decl+1, (uint16_t) (_db_count + 2));
+  memcpy(decl+3, uuid, uuid_len);
+
+  if ( db_add(BLE_UUID_CHARACTERISTIC, NULL, 0, decl, (uint16_t) (3 + uuid_len)) &&
+       db_add(0, uuid, uuid_len, value, len) )
+  {
+    handle = _db_count;
+
+    if ( props & (CHAR_PROP_NOTIFY | CHAR_PROP_INDICATE) )
+    {
+      uint8_t const cccd[2] = { 0, 0 };
+      if ( !db_add(BLE_UUID_DESCRIPTOR_CLIENT_CHAR_CONFIG, NULL, 0, cccd, 2) ) handle = 0;
+    }
+  }
+
+  sd_unlock();
+
+  return handle;
+}
+
+uint16_t sd_sim_peer_value(uint16_t handle, void* buf, uint16_t bufsize)
+{
+  sd_lock();
+
+  peer_attr_t const* attr = db_get(handle);
+  uint16_t len = 0;
+
+  if ( attr )
+  {
+    len = SD_MIN(attr->len, bufsize);
+    memcpy(buf, attr->value, len);
+  }
+
+  sd_unlock();
+
+  return len;
+}
+
+bool sd_sim_peer_hvx(uint16_t conn_hdl, uint16_t handle, void const* data, uint16_t len, bool indicate)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_hdl);
+  peer_attr_t const* cccd = db_get((uint16_t) (handle+1));
+  bool ok = false;
+
+  do
+  {
+    if ( !link || !db_get(handle) || len > link->mtu - 3 ) break;
+
+    // client must have enabled it
+    if ( !cccd || !db_is(cccd, BLE_UUID_DESCRIPTOR_CLIENT_CHAR_CONFIG) ) break;
+    if ( !(sd_u16(cccd->value) & (indicate ? BLE_GATT_HVX_INDICATION : BLE_GATT_HVX_NOTIFICATION)) ) break;
+
+    // one indication until confirmed
+    if ( indicate && link->peer_ind_pending ) break;
+
+    sd_pdu_t* pdu = sd_link_rx(link, indicate ? SD_ATT_HVI : SD_ATT_HVN, 0);
+    if ( !pdu ) break;
+
+    sd_put_u16(pdu->data, handle);
+    memcpy(pdu->data+2, data, len);
+    pdu->len = (uint16_t) (2 + len);
+
+    if ( indicate ) link->peer_ind_pending = true;
+    ok = true;
+  } while(0);
+
+  sd_unlock();
+
+  return ok;
+}
+
+bool sd_sim_peer_write(uint16_t conn_hdl, uint16_t handle, void const* data, uint16_t len, bool with_rsp)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_hdl);
+  sd_pdu_t* pdu = NULL;
+
+  if ( link && len <= link->mtu - 3 )
+  {
+    pdu = sd_link_rx(link, with_rsp ? SD_ATT_WRITE_REQ : SD_ATT_WRITE_CMD, 0);
+    if ( pdu )
+    {
+      sd_put_u16(pdu->data, handle);
+      memcpy(pdu->data+2, data, len);
+      pdu->len = (uint16_t) (2 + len);
+    }
+  }
+
+  sd_unlock();
+
+  return pdu != NULL;
+}
+
+bool sd_sim_peer_exchange_mtu(uint16_t conn_hdl, uint16_t client_rx_mtu)
+{
+  sd_lock();
+
+  sd_link_t* link = sd_link_get(conn_hdl);
+  sd_pdu_t* pdu = link ? sd_link_rx(link, SD_ATT_MTU_REQ, 0) : NULL;
+
+  if ( pdu )
+  {
+    sd_put_u16(pdu->data, client_rx_mtu);
+    pdu->len = 2;
+  }
+
+  sd_unlock();
+
+  return pdu != NULL;
+}
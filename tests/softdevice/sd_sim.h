@@ -0,0 +1,143 @@
+#ifndef SD_SIM_H_
+#define SD_SIM_H_
+
+/* SoftDevice S140 v6 simulator for the host build.
+ *
+ * The sd_*() API is implemented as plain functions (SVCALL_AS_NORMAL_FUNCTION)
+ * on the virtual time of the host port: events are queued and signalled with
+ * SD_EVT_IRQn exactly like the real SoftDevice, so Bluefruit52Lib runs
+ * unmodified with its BLE/SOC tasks.
+ *
+ * Radio activity is an in-process link model with a simulated peer device on
+ * the other side of every connection:
+ * - connection events every connection interval, limited by the event length
+ *   (or the whole interval with connection event extension), carrying LL PDUs
+ *   up to the data length on 1M/2M PHY with their airtime and T_IFS
+ * - HVN/write command queues sized by the connection configuration, TX
+ *   complete events once the queue runs empty, the event goes on with what
+ *   the application queues from them
+ * - deterministic PDU loss with retransmission
+ * - ATT MTU, data length, PHY and connection parameter procedures
+ * - a peer central (connects to our advertising, writes our attributes) and
+ *   peer peripherals (advertisers for the scanner, GATT server database for
+ *   discovery and client operations)
+ *
+ * Functions below drive the peer side and read statistics. They can be called
+ * from any task, callbacks run in interrupt context.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum connections, advertisers and peer attributes
+#define SD_SIM_LINK_MAX         4
+#define SD_SIM_ADV_MAX          32
+#define SD_SIM_PEER_ATTR_MAX    64
+
+//--------------------------------------------------------------------+
+// Link model
+//--------------------------------------------------------------------+
+typedef struct
+{
+  uint16_t conn_interval;    // chosen by peer central, in 1.25 ms unit
+  uint16_t peer_mtu;         // peer ATT MTU used in MTU exchange
+  uint16_t peer_data_length; // peer max LL payload, 27-251
+  uint8_t  peer_phys;        // BLE_GAP_PHY_1MBPS | BLE_GAP_PHY_2MBPS
+  uint8_t  loss_percent;     // probability of each LL PDU being lost
+  uint8_t  att_delay;        // connection events before peer answers an ATT request
+  uint32_t seed;             // loss and advertising delay generator
+} sd_sim_link_cfg_t;
+
+// Configuration of the next connections, default is
+// 30 ms interval, MTU 247, data length 251, 1M+2M PHY, no loss, delay 1
+void sd_sim_link_config(sd_sim_link_cfg_t const* cfg);
+void sd_sim_link_config_get(sd_sim_link_cfg_t* cfg);
+
+typedef struct
+{
+  uint32_t conn_events;
+  uint32_t pdu_tx;            // LL data PDUs sent to peer (retransmissions included)
+  uint32_t pdu_rx;            // LL data PDUs received from peer
+  uint32_t pdu_lost;          // lost PDUs in both directions
+
+  uint32_t hvn_count;         // notifications received by peer
+  uint32_t hvn_bytes;
+  uint64_t hvn_latency_sum;   // sd_ble_gatts_hvx() to reception by peer, in us
+  uint32_t hvn_latency_max;
+
+  uint32_t wrcmd_count;       // write commands received by peer
+  uint32_t wrcmd_bytes;
+  uint32_t att_requests;      // ATT requests answered by peer
+
+  uint32_t scan_reports;      // advertising reports sent to the application
+  uint32_t scan_missed;       // advertising packets in scan window while scanner was paused
+
+  uint32_t evt_dropped;       // BLE events lost due to a full event queue
+} sd_sim_stats_t;
+
+void sd_sim_stats(sd_sim_stats_t* stats);
+void sd_sim_stats_reset(void);
+
+// Called when peer receives a notification, indication or write from us
+typedef void (*sd_sim_rx_cb_t)(uint16_t conn_hdl, uint16_t handle, uint8_t const* data, uint16_t len);
+void sd_sim_set_rx_callback(sd_sim_rx_cb_t cb);
+
+//--------------------------------------------------------------------+
+// Peer central, we are peripheral
+//--------------------------------------------------------------------+
+
+// Peer connects on the next connectable advertising event
+void sd_sim_peer_connect(void);
+
+// Peer terminates the link
+bool sd_sim_peer_disconnect(uint16_t conn_hdl, uint8_t hci_status);
+
+// Peer starts ATT MTU exchange
+bool sd_sim_peer_exchange_mtu(uint16_t conn_hdl, uint16_t client_rx_mtu);
+
+// Peer writes one of our attributes (value or CCCD)
+bool sd_sim_peer_write(uint16_t conn_hdl, uint16_t handle, void const* data, uint16_t len, bool with_rsp);
+
+// Value and CCCD handle of our characteristic with that UUID (2 or 16 bytes
+// little endian), 0 if not found
+uint16_t sd_sim_gatts_value_find(uint8_t const* uuid, uint8_t uuid_len);
+uint16_t sd_sim_gatts_cccd_find(uint8_t const* uuid, uint8_t uuid_len);
+
+//--------------------------------------------------------------------+
+// Peer peripherals, we are scanner / central
+//--------------------------------------------------------------------+
+typedef struct
+{
+  ble_gap_addr_t addr;
+  uint16_t       interval;     // in 0.625 ms unit, 0-10 ms advDelay is added
+  int8_t         rssi;
+  bool           connectable;
+  uint8_t        len;
+  uint8_t        data[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
+} sd_sim_adv_t;
+
+bool sd_sim_advertiser_add(sd_sim_adv_t const* adv);
+void sd_sim_advertiser_clear(void);
+
+// GATT server database of the peer we connect to as central. Handles are
+// allocated in order, a CCCD follows each notify/indicate characteristic.
+// UUID is 2 or 16 bytes little endian, return handle of service/value
+uint16_t sd_sim_peer_service_add(uint8_t const* uuid, uint8_t uuid_len);
+uint16_t sd_sim_peer_char_add(uint8_t const* uuid, uint8_t uuid_len, uint8_t props, void const* value, uint16_t len);
+
+// Current value of a peer attribute, return its length
+uint16_t sd_sim_peer_value(uint16_t handle, void* buf, uint16_t bufsize);
+
+// Peer server sends notification/indication, requires our CCCD write first
+bool sd_sim_peer_hvx(uint16_t conn_hdl, uint16_t handle, void const* data, uint16_t len, bool indicate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SD_SIM_H_ */
@@ -0,0 +1,298 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "sd_internal.h"
+#include "soft_aes.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Application flash of the S140 v6 layout up to the end of the nRF52840
+// flash (bootloader included), mapped at its real address since the core
+// reads flash through plain pointers
+#define FLASH_APP_START         0x26000
+#define FLASH_END               0x100000
+#define FLASH_PAGE_SIZE         4096
+
+// nRF52840 product specification: tERASEPAGE and tWRITE
+#define FLASH_ERASE_PAGE_US     85000
+#define FLASH_WRITE_WORD_US     41
+
+#define SOC_EVT_QUEUE_SIZE      16
+
+// defined in bluefruit.cpp, SWI2 on the nRF52840
+extern void SD_EVT_IRQHandler(void) __attribute__((weak));
+
+static uint32_t _soc_evt[SOC_EVT_QUEUE_SIZE];
+static uint8_t  _soc_rd;
+static uint8_t  _soc_count;
+
+static host_timer_t _flash_timer;
+static bool         _flash_busy;
+
+__attribute__((constructor))
+static void flash_map(void)
+{
+  void* flash = mmap((void*) FLASH_APP_START, FLASH_END - FLASH_APP_START, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if ( flash != (void*) FLASH_APP_START )
+  {
+    perror("sd sim: mmap flash");
+    abort();
+  }
+
+  // erased
+  memset(flash, 0xFF, FLASH_END - FLASH_APP_START);
+}
+
+static inline bool flash_valid(uint32_t addr, uint32_t size)
+{
+  return (addr >= FLASH_APP_START) && (addr + size <= FLASH_END);
+}
+
+void sd_soc_evt_put(uint32_t evt_id)
+{
+  if ( _soc_count == SOC_EVT_QUEUE_SIZE ) return;
+
+  _soc_evt[(_soc_rd + _soc_count) % SOC_EVT_QUEUE_SIZE] = evt_id;
+  _soc_count++;
+
+  host_irq_set_pending(SD_EVT_IRQn);
+}
+
+//--------------------------------------------------------------------+
+// SoftDevice Manager
+//--------------------------------------------------------------------+
+uint32_t sd_softdevice_enable(nrf_clock_lf_cfg_t const * p_clock_lf_cfg, nrf_fault_handler_t fault_handler)
+{
+  (void) fault_handler;
+
+  if ( !p_clock_lf_cfg ) return NRF_ERROR_INVALID_ADDR;
+  if ( sd_enabled ) return NRF_ERROR_INVALID_STATE;
+
+  if ( SD_EVT_IRQHandler ) host_irq_attach(SD_EVT_IRQn, SD_EVT_IRQHandler);
+  sd_enabled = true;
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_softdevice_disable(void)
+{
+  sd_enabled     = false;
+  sd_ble_enabled = false;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_softdevice_is_enabled(uint8_t * p_softdevice_enabled)
+{
+  *p_softdevice_enabled = sd_enabled ? 1 : 0;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_softdevice_vector_table_base_set(uint32_t address)
+{
+  (void) address;
+  return NRF_SUCCESS;
+}
+
+// DFU jumps into the bootloader, there is none to jump to
+void bootloader_util_app_start(uint32_t start_addr)
+{
+  fprintf(stderr, "sd sim: jump to bootloader 0x%08lx\n", (unsigned long) start_addr);
+  abort();
+}
+
+//--------------------------------------------------------------------+
+// SoC events
+//--------------------------------------------------------------------+
+uint32_t sd_evt_get(uint32_t * p_evt_id)
+{
+  if ( !p_evt_id ) return NRF_ERROR_INVALID_ADDR;
+
+  sd_lock();
+
+  if ( _soc_count == 0 )
+  {
+    sd_unlock();
+    return NRF_ERROR_NOT_FOUND;
+  }
+
+  *p_evt_id = _soc_evt[_soc_rd];
+  _soc_rd = (uint8_t) ((_soc_rd + 1) % SOC_EVT_QUEUE_SIZE);
+  _soc_count--;
+
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+//--------------------------------------------------------------------+
+// Flash: done right away, completion event after the NVMC time
+//--------------------------------------------------------------------+
+static void flash_done(host_timer_t* timer)
+{
+  (void) timer;
+
+  sd_lock();
+  _flash_busy = false;
+  sd_soc_evt_put(NRF_EVT_FLASH_OPERATION_SUCCESS);
+  sd_unlock();
+}
+
+static uint32_t flash_start(uint32_t duration_us)
+{
+  // without SoftDevice the operation is synchronous
+  if ( !sd_enabled ) return NRF_SUCCESS;
+
+  _flash_busy     = true;
+  _flash_timer.cb = flash_done;
+  _flash_timer.irqn = SD_RADIO_IRQn;
+  host_timer_start(&_flash_timer, host_time_us() + duration_us);
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_flash_write(uint32_t * p_dst, uint32_t const * p_src, uint32_t size)
+{
+  uint32_t const dst = (uint32_t) (uintptr_t) p_dst;
+
+  if ( ((uintptr_t) p_dst & 3) || ((uintptr_t) p_src & 3) ) return NRF_ERROR_INVALID_ADDR;
+  if ( size == 0 || size > FLASH_PAGE_SIZE/4 ) return NRF_ERROR_INVALID_LENGTH;
+  if ( !flash_valid(dst, size*4) ) return NRF_ERROR_FORBIDDEN;
+
+  sd_lock();
+
+  if ( _flash_busy )
+  {
+    sd_unlock();
+    return NRF_ERROR_BUSY;
+  }
+
+  // programming can only clear bits
+  for(uint32_t i=0; i<size; i++) p_dst[i] &= p_src[i];
+
+  uint32_t const err = flash_start(size * FLASH_WRITE_WORD_US);
+
+  sd_unlock();
+
+  return err;
+}
+
+uint32_t sd_flash_page_erase(uint32_t page_number)
+{
+  uint32_t const addr = page_number * FLASH_PAGE_SIZE;
+
+  if ( !flash_valid(addr, FLASH_PAGE_SIZE) ) return NRF_ERROR_FORBIDDEN;
+
+  sd_lock();
+
+  if ( _flash_busy )
+  {
+    sd_unlock();
+    return NRF_ERROR_BUSY;
+  }
+
+  memset((void*) (uintptr_t) addr, 0xFF, FLASH_PAGE_SIZE);
+
+  uint32_t const err = flash_start(FLASH_ERASE_PAGE_US);
+
+  sd_unlock();
+
+  return err;
+}
+
+//--------------------------------------------------------------------+
+// Power, clock and peripherals
+//--------------------------------------------------------------------+
+static uint32_t _gpregret[2];
+
+uint32_t sd_power_usbpwrrdy_enable(uint8_t usbpwrrdy_enable)     { (void) usbpwrrdy_enable; return NRF_SUCCESS; }
+uint32_t sd_power_usbdetected_enable(uint8_t usbdetected_enable) { (void) usbdetected_enable; return NRF_SUCCESS; }
+uint32_t sd_power_usbremoved_enable(uint8_t usbremoved_enable)   { (void) usbremoved_enable; return NRF_SUCCESS; }
+
+// no USB power on host
+uint32_t sd_power_usbregstatus_get(uint32_t * usbregstatus)
+{
+  *usbregstatus = 0;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_power_gpregret_set(uint32_t gpregret_id, uint32_t gpregret_msk)
+{
+  if ( gpregret_id > 1 ) return NRF_ERROR_INVALID_PARAM;
+  _gpregret[gpregret_id] |= gpregret_msk;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_power_gpregret_clr(uint32_t gpregret_id, uint32_t gpregret_msk)
+{
+  if ( gpregret_id > 1 ) return NRF_ERROR_INVALID_PARAM;
+  _gpregret[gpregret_id] &= ~gpregret_msk;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_power_gpregret_get(uint32_t gpregret_id, uint32_t *p_gpregret)
+{
+  if ( gpregret_id > 1 ) return NRF_ERROR_INVALID_PARAM;
+  *p_gpregret = _gpregret[gpregret_id];
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_power_mode_set(uint8_t power_mode)       { (void) power_mode; return NRF_SUCCESS; }
+uint32_t sd_power_dcdc_mode_set(uint8_t dcdc_mode)   { (void) dcdc_mode; return NRF_SUCCESS; }
+uint32_t sd_power_dcdc0_mode_set(uint8_t dcdc_mode)  { (void) dcdc_mode; return NRF_SUCCESS; }
+uint32_t sd_clock_hfclk_request(void)                { return NRF_SUCCESS; }
+uint32_t sd_clock_hfclk_release(void)                { return NRF_SUCCESS; }
+
+uint32_t sd_clock_hfclk_is_running(uint32_t * p_is_running)
+{
+  *p_is_running = 1;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_app_evt_wait(void)
+{
+  host_idle();
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_temp_get(int32_t * p_temp)
+{
+  *p_temp = 25*4; // 0.25 degree unit
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_rand_application_pool_capacity_get(uint8_t * p_pool_capacity)
+{
+  *p_pool_capacity = 64;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_rand_application_bytes_available_get(uint8_t * p_bytes_available)
+{
+  *p_bytes_available = 64;
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_rand_application_vector_get(uint8_t * p_buff, uint8_t length)
+{
+  sd_lock();
+  for(uint8_t i=0; i<length; i++) p_buff[i] = (uint8_t) sd_rand();
+  sd_unlock();
+
+  return NRF_SUCCESS;
+}
+
+uint32_t sd_ecb_block_encrypt(nrf_ecb_hal_data_t * p_ecb_data)
+{
+  soft_aes_t aes;
+  soft_aes_init(&aes, p_ecb_data->key);
+
+  memcpy(p_ecb_data->ciphertext, p_ecb_data->cleartext, SOC_ECB_CLEARTEXT_LENGTH);
+  soft_aes_encrypt_block(&aes, p_ecb_data->ciphertext);
+
+  return NRF_SUCCESS;
+}
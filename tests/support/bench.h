@@ -0,0 +1,73 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/* Host benchmark helpers, same output as the core_benchmark sketch plus the
+ * number of heap allocations:
+ *    BENCH <name> <ns/op> ns/op <throughput> B/s <allocs> allocs/op <heap> heap B/op
+ * Time is host wall clock (best of BENCH_REPEAT runs), allocations and heap
+ * usage come from the rtos heap and are exact, see bench_compare.py.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "rtos_heap.h"
+
+#ifndef BENCH_REPEAT
+#define BENCH_REPEAT    5
+#endif
+
+static inline uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// allocations from the pool and from the newlib fallback
+static inline uint32_t bench_allocs(void)
+{
+  rtos_heap_stats_t stats;
+  rtos_heap_stats(&stats);
+  return stats.alloc_count + stats.fallback_count;
+}
+
+static inline int32_t bench_heap_used(void)
+{
+  rtos_heap_stats_t stats;
+  rtos_heap_stats(&stats);
+  return (int32_t) stats.used;
+}
+
+static inline void bench_print(const char* name, uint64_t ns, uint32_t iterations, uint32_t bytes_per_op,
+                               uint32_t allocs, int32_t heap_delta)
+{
+  double const ns_per_op     = ((double) ns) / iterations;
+  double const bytes_per_sec = (bytes_per_op && ns_per_op > 0) ? (bytes_per_op * 1e9) / ns_per_op : 0;
+
+  printf("BENCH %-24s %10.1f ns/op %12.0f B/s %8.3f allocs/op %8.1f heap B/op\n",
+         name, ns_per_op, bytes_per_sec, ((double) allocs) / iterations, ((double) heap_delta) / iterations);
+  fflush(stdout);
+}
+
+// Run code block _iterations times (_i is the loop index), repeated BENCH_REPEAT times
+#define BENCH(_name, _iterations, _bytes_per_op, ...) \
+  do { \
+    uint64_t _best = UINT64_MAX; \
+    uint32_t _allocs = 0; \
+    int32_t  _heap = 0; \
+    for (int _rep = 0; _rep < BENCH_REPEAT; _rep++) \
+    { \
+      uint32_t const _allocs0 = bench_allocs(); \
+      int32_t  const _heap0   = bench_heap_used(); \
+      uint64_t const _start   = bench_now_ns(); \
+      for (uint32_t _i = 0; _i < (_iterations); _i++) { __VA_ARGS__; } \
+      uint64_t const _ns = bench_now_ns() - _start; \
+      if ( _ns < _best ) _best = _ns; \
+      _allocs = bench_allocs() - _allocs0; \
+      _heap   = bench_heap_used() - _heap0; \
+    } \
+    bench_print(_name, _best, _iterations, _bytes_per_op, _allocs, _heap); \
+  } while(0)
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,214 @@
+#ifndef HOST_CORE_CM4_H_
+#define HOST_CORE_CM4_H_
+
+/* Host replacement of CMSIS core_cm4.h: core registers are plain variables
+ * (see host_regs.c), intrinsics are no-ops and NVIC/PRIMASK access goes to the
+ * simulated interrupt controller of the host FreeRTOS port.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "host_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+#define __IM    volatile const
+#define __OM    volatile
+#define __IOM   volatile
+
+#define __ASM                 __asm__
+#define __INLINE              inline
+#define __STATIC_INLINE       static inline
+#define __STATIC_FORCEINLINE  static inline
+#define __WEAK                __attribute__((weak))
+#define __ALIGNED(x)          __attribute__((aligned(x)))
+#define __PACKED              __attribute__((packed))
+#define __NO_RETURN           __attribute__((noreturn))
+#define __USED                __attribute__((used))
+#define __UNALIGNED_UINT32_READ(addr) (*(const uint32_t*)(addr))
+
+#define __CORE_CM4_H_GENERIC
+
+#ifndef __NVIC_PRIO_BITS
+#define __NVIC_PRIO_BITS      3
+#endif
+
+//--------------------------------------------------------------------+
+// Core registers
+//--------------------------------------------------------------------+
+typedef struct
+{
+  __IOM uint32_t ISER[8];  uint32_t RESERVED0[24];
+  __IOM uint32_t ICER[8];  uint32_t RESERVED1[24];
+  __IOM uint32_t ISPR[8];  uint32_t RESERVED2[24];
+  __IOM uint32_t ICPR[8];  uint32_t RESERVED3[24];
+  __IOM uint32_t IABR[8];  uint32_t RESERVED4[56];
+  __IOM uint8_t  IP[240];  uint32_t RESERVED5[644];
+  __OM  uint32_t STIR;
+} NVIC_Type;
+
+typedef struct
+{
+  __IM  uint32_t CPUID;
+  __IOM uint32_t ICSR;
+  __IOM uint32_t VTOR;
+  __IOM uint32_t AIRCR;
+  __IOM uint32_t SCR;
+  __IOM uint32_t CCR;
+  __IOM uint8_t  SHP[12];
+  __IOM uint32_t SHCSR;
+  __IOM uint32_t CFSR;
+  __IOM uint32_t HFSR;
+  __IOM uint32_t DFSR;
+  __IOM uint32_t MMFAR;
+  __IOM uint32_t BFAR;
+  __IOM uint32_t AFSR;
+        uint32_t RESERVED0[18];
+  __IOM uint32_t CPACR;
+} SCB_Type;
+
+typedef struct
+{
+  __IOM uint32_t CTRL;
+  __IOM uint32_t LOAD;
+  __IOM uint32_t VAL;
+  __IM  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+  __IOM uint32_t CTRL;
+  __IOM uint32_t CYCCNT;
+  __IOM uint32_t CPICNT;
+  __IOM uint32_t EXCCNT;
+  __IOM uint32_t SLEEPCNT;
+  __IOM uint32_t LSUCNT;
+  __IOM uint32_t FOLDCNT;
+  __IM  uint32_t PCSR;
+} DWT_Type;
+
+typedef struct
+{
+  __IOM uint32_t DHCSR;
+  __OM  uint32_t DCRSR;
+  __IOM uint32_t DCRDR;
+  __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+  __IOM uint32_t FPCCR;
+  __IOM uint32_t FPCAR;
+  __IOM uint32_t FPDSCR;
+} FPU_Type;
+
+extern NVIC_Type*      NVIC;
+extern SCB_Type*       SCB;
+extern SysTick_Type*   SysTick;
+extern DWT_Type*       DWT;
+extern CoreDebug_Type* CoreDebug;
+extern FPU_Type*       FPU;
+
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define CoreDebug_DHCSR_C_DEBUGEN_Msk   (1UL << 0)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define SCB_SCR_SLEEPDEEP_Msk           (1UL << 2)
+#define SCB_SCR_SEVONPEND_Msk           (1UL << 4)
+#define SCB_ICSR_VECTACTIVE_Msk         (0x1FFUL)
+#define SCB_ICSR_PENDSVSET_Msk          (1UL << 28)
+#define SCB_AIRCR_VECTKEY_Pos           16
+#define SCB_AIRCR_SYSRESETREQ_Msk       (1UL << 2)
+#define SysTick_CTRL_ENABLE_Msk         (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk        (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk      (1UL << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk      (1UL << 16)
+#define SysTick_LOAD_RELOAD_Msk         (0xFFFFFFUL)
+
+//--------------------------------------------------------------------+
+// Intrinsics
+//--------------------------------------------------------------------+
+static inline void     __enable_irq (void)        { host_primask_set(0); }
+static inline void     __disable_irq(void)        { host_primask_set(1); }
+static inline uint32_t __get_PRIMASK(void)        { return host_primask_get(); }
+static inline void     __set_PRIMASK(uint32_t x)  { host_primask_set(x); }
+
+static inline uint32_t __get_IPSR   (void)        { return SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk; }
+static inline uint32_t __get_BASEPRI(void)        { return 0; }
+static inline void     __set_BASEPRI(uint32_t x)  { (void) x; }
+static inline uint32_t __get_CONTROL(void)        { return 0; }
+static inline void     __set_CONTROL(uint32_t x)  { (void) x; }
+static inline uint32_t __get_MSP    (void)        { return 0; }
+static inline void     __set_MSP    (uint32_t x)  { (void) x; }
+static inline uint32_t __get_PSP    (void)        { return 0; }
+static inline uint32_t __get_FPSCR  (void)        { return 0; }
+static inline void     __set_FPSCR  (uint32_t x)  { (void) x; }
+
+static inline void __WFE(void) { }
+static inline void __WFI(void) { }
+static inline void __SEV(void) { }
+static inline void __NOP(void) { }
+static inline void __DSB(void) { }
+static inline void __ISB(void) { }
+static inline void __DMB(void) { }
+#define __BKPT(x)
+
+static inline uint32_t __CLZ  (uint32_t x) { return x ? (uint32_t) __builtin_clz(x) : 32; }
+static inline uint32_t __REV  (uint32_t x) { return __builtin_bswap32(x); }
+static inline uint32_t __REV16(uint32_t x) { return ((x & 0xFF00FF00UL) >> 8) | ((x & 0x00FF00FFUL) << 8); }
+static inline uint32_t __RBIT (uint32_t x)
+{
+  uint32_t r = 0;
+  for(int i = 0; i < 32; i++) r |= ((x >> i) & 1UL) << (31 - i);
+  return r;
+}
+
+// single core and no preemption inside an access: exclusive store always succeeds
+static inline uint8_t  __LDREXB(volatile uint8_t*  a) { return *a; }
+static inline uint16_t __LDREXH(volatile uint16_t* a) { return *a; }
+static inline uint32_t __LDREXW(volatile uint32_t* a) { return *a; }
+static inline uint32_t __STREXB(uint8_t  v, volatile uint8_t*  a) { *a = v; return 0; }
+static inline uint32_t __STREXH(uint16_t v, volatile uint16_t* a) { *a = v; return 0; }
+static inline uint32_t __STREXW(uint32_t v, volatile uint32_t* a) { *a = v; return 0; }
+static inline void     __CLREX(void) { }
+
+//--------------------------------------------------------------------+
+// NVIC
+//--------------------------------------------------------------------+
+static inline void     NVIC_EnableIRQ      (IRQn_Type irqn) { host_irq_enable(irqn); }
+static inline void     NVIC_DisableIRQ     (IRQn_Type irqn) { host_irq_disable(irqn); }
+static inline uint32_t NVIC_GetEnableIRQ   (IRQn_Type irqn) { return host_irq_enabled(irqn); }
+static inline void     NVIC_SetPendingIRQ  (IRQn_Type irqn) { host_irq_set_pending(irqn); }
+static inline void     NVIC_ClearPendingIRQ(IRQn_Type irqn) { host_irq_clear_pending(irqn); }
+static inline uint32_t NVIC_GetPendingIRQ  (IRQn_Type irqn) { return host_irq_pending(irqn); }
+
+static inline void NVIC_SetPriority(IRQn_Type irqn, uint32_t priority)
+{
+  if ( irqn >= 0 ) NVIC->IP[irqn] = (uint8_t) (priority << (8U - __NVIC_PRIO_BITS));
+}
+
+static inline uint32_t NVIC_GetPriority(IRQn_Type irqn)
+{
+  return (irqn >= 0) ? (uint32_t) (NVIC->IP[irqn] >> (8U - __NVIC_PRIO_BITS)) : 0;
+}
+
+static inline void NVIC_SystemReset(void)
+{
+  abort();
+}
+
+static inline uint32_t SysTick_Config(uint32_t ticks)
+{
+  (void) ticks;
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_CORE_CM4_H_ */
@@ -0,0 +1,26 @@
+#include "rtos.h"
+
+// Same as new.cpp: C++ allocations are served by the rtos heap
+void *operator new(size_t size) {
+  return rtos_malloc(size);
+}
+
+void *operator new[](size_t size) {
+  return rtos_malloc(size);
+}
+
+void operator delete(void * ptr) {
+  rtos_free(ptr);
+}
+
+void operator delete[](void * ptr) {
+  rtos_free(ptr);
+}
+
+void operator delete(void * ptr, size_t) {
+  rtos_free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) {
+  rtos_free(ptr);
+}
@@ -0,0 +1,66 @@
+#ifndef HOST_PORT_H_
+#define HOST_PORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Virtual time and simulated hardware for the host FreeRTOS port
+//--------------------------------------------------------------------+
+
+// Hardware timer event, callback runs in interrupt context (VECTACTIVE = irqn)
+typedef struct host_timer_s host_timer_t;
+typedef void (*host_timer_cb_t)(host_timer_t* timer);
+
+struct host_timer_s
+{
+  uint64_t        when;   // absolute virtual time in us
+  host_timer_cb_t cb;
+  int             irqn;
+  void*           arg;
+
+  bool            active;
+  host_timer_t*   next;
+};
+
+// Virtual time in us since start, advanced only when all tasks are blocked
+// (or one busy-waits), never by host wall clock
+uint64_t host_time_us(void);
+
+void host_timer_start(host_timer_t* timer, uint64_t when_us);
+void host_timer_stop (host_timer_t* timer);
+
+// Simulated NVIC, backing NVIC_*IRQ() of the register shim
+void host_irq_attach       (int irqn, void (*handler)(void));
+void host_irq_enable       (int irqn);
+void host_irq_disable      (int irqn);
+bool host_irq_enabled      (int irqn);
+void host_irq_set_pending  (int irqn);
+void host_irq_clear_pending(int irqn);
+bool host_irq_pending      (int irqn);
+
+// PRIMASK, backing __disable_irq()/__enable_irq()
+void     host_primask_set(uint32_t primask);
+uint32_t host_primask_get(void);
+
+// Sleep until the next tick or timer event (idle task)
+void host_idle(void);
+
+// Called by time polling functions (millis(), yield() ...). A task that keeps
+// polling without blocking is considered busy-waiting and time moves on to the
+// next event, otherwise it would spin forever on a clock that never advances.
+void host_busy_poll(void);
+
+// Entry point of a host program: runs app() in the "loop" task like main.cpp
+// with the callback task created, exits with its return value
+int host_main(int (*app)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_PORT_H_ */
@@ -0,0 +1,18 @@
+#include "nrf.h"
+
+//--------------------------------------------------------------------+
+// Core registers backing the core_cm4.h shim
+//--------------------------------------------------------------------+
+static NVIC_Type      _nvic;
+static SCB_Type       _scb;
+static SysTick_Type   _systick;
+static DWT_Type       _dwt;
+static CoreDebug_Type _coredebug;
+static FPU_Type       _fpu;
+
+NVIC_Type*      NVIC      = &_nvic;
+SCB_Type*       SCB       = &_scb;
+SysTick_Type*   SysTick   = &_systick;
+DWT_Type*       DWT       = &_dwt;
+CoreDebug_Type* CoreDebug = &_coredebug;
+FPU_Type*       FPU       = &_fpu;
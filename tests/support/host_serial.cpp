@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "host_serial.h"
+
+HostSerial Serial;
+
+void HostSerial::flush(void)
+{
+  fflush(stdout);
+}
+
+size_t HostSerial::write(uint8_t ch)
+{
+  return (putchar(ch) == EOF) ? 0 : 1;
+}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size)
+{
+  return fwrite(buffer, 1, size, stdout);
+}
+
+// Declared by HardwareSerial.h but never defined by the core: the base class
+// vtable is emitted here, unoptimized builds refer to it from the constructor
+void HardwareSerial::begin(unsigned long baud)
+{
+  (void) baud;
+}
+
+void HardwareSerial::begin(unsigned long baud, uint16_t config)
+{
+  (void) baud; (void) config;
+}
+
+void HardwareSerial::end(void)
+{
+}
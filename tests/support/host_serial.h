@@ -0,0 +1,35 @@
+#ifndef HOST_SERIAL_H_
+#define HOST_SERIAL_H_
+
+/* Serial of the host build: on target it is the USB CDC port of TinyUSB,
+ * here it writes to stdout and never receives anything. Force included into
+ * libraries that refer to Serial without including the TinyUSB headers.
+ */
+
+#ifdef __cplusplus
+
+#include "HardwareSerial.h"
+
+class HostSerial : public HardwareSerial
+{
+  public:
+    virtual void begin(unsigned long baud) { (void) baud; }
+    virtual void begin(unsigned long baud, uint16_t config) { (void) baud; (void) config; }
+    virtual void end(void) { }
+
+    virtual int available(void) { return 0; }
+    virtual int peek(void) { return -1; }
+    virtual int read(void) { return -1; }
+    virtual void flush(void);
+    virtual size_t write(uint8_t ch);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    virtual operator bool() { return true; }
+};
+
+extern HostSerial Serial;
+
+#endif
+
+#endif /* HOST_SERIAL_H_ */
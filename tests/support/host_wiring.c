@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include "Arduino.h"
+#include "host_port.h"
+
+//--------------------------------------------------------------------+
+// Host version of delay.c and the board level hooks of main.cpp,
+// everything runs on the virtual time of the host port
+//--------------------------------------------------------------------+
+
+// same as main.cpp
+#define LOOP_STACK_SZ       (256*4)
+#define CALLBACK_STACK_SZ   (256*3)
+
+static int (*_app)(void);
+
+uint32_t millis( void )
+{
+  host_busy_poll();
+  return tick2ms(xTaskGetTickCount());
+}
+
+void delay( uint32_t ms )
+{
+  vTaskDelay(ms2tick(ms));
+}
+
+uint64_t micros64( void )
+{
+  host_busy_poll();
+  return host_time_us();
+}
+
+uint64_t nanos( void )
+{
+  return micros64() * 1000;
+}
+
+void hrclock_init(void)
+{
+}
+
+uint32_t hrclock_count(void)
+{
+  // 1000000/32768 = 15625/512
+  return (uint32_t) ((host_time_us() << 9) / 15625);
+}
+
+void dwt_enable(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void dwt_disable(void)
+{
+  DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+  CoreDebug->DEMCR &= ~CoreDebug_DEMCR_TRCENA_Msk;
+}
+
+void dbgSleepEnter(void)
+{
+}
+
+void dbgSleepExit(void)
+{
+}
+
+// ISR accounting of debug.cpp, updated by the wrapped handlers
+volatile uint32_t _dbg_isr_count  = 0;
+volatile uint32_t _dbg_isr_cycles = 0;
+volatile uint32_t _dbg_isr_start  = 0;
+volatile uint8_t  _dbg_isr_depth  = 0;
+
+// No GPIO on host: outputs only keep their level (LEDs of the BLE stack)
+static uint8_t _pin_level[PINS_COUNT];
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+  (void) pin; (void) mode;
+}
+
+void digitalWrite(uint32_t pin, uint32_t val)
+{
+  if ( pin < PINS_COUNT ) _pin_level[pin] = (val ? 1 : 0);
+}
+
+int digitalRead(uint32_t pin)
+{
+  return (pin < PINS_COUNT) ? _pin_level[pin] : 0;
+}
+
+void digitalToggle(uint32_t pin)
+{
+  if ( pin < PINS_COUNT ) _pin_level[pin] ^= 1;
+}
+
+void ledOn(uint32_t pin)
+{
+  (void) pin;
+}
+
+void ledOff(uint32_t pin)
+{
+  (void) pin;
+}
+
+// Idle task sleeps until the next event
+void vApplicationIdleHook(void)
+{
+  host_idle();
+}
+
+static void app_task(void* arg)
+{
+  (void) arg;
+
+  int const rc = _app();
+
+  fflush(stdout);
+  exit(rc);
+}
+
+int host_main(int (*app)(void))
+{
+  _app = app;
+
+  // keep the output of a test that crashes
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  xTaskCreate(app_task, "loop", LOOP_STACK_SZ, NULL, TASK_PRIO_LOW, NULL);
+  ada_callback_init(CALLBACK_STACK_SZ);
+
+  vTaskStartScheduler();
+
+  return 1;
+}
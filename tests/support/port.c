@@ -0,0 +1,429 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_port.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Host stack of each task, task code does not run on its FreeRTOS stack.
+// Mapped in the low 2GB since the core passes pointers around as uint32_t
+#ifndef HOST_TASK_STACK_SIZE
+#define HOST_TASK_STACK_SIZE    (256*1024)
+#endif
+
+// Polls without blocking before a task is considered busy-waiting
+#ifndef HOST_SPIN_LIMIT
+#define HOST_SPIN_LIMIT         1000
+#endif
+
+#define IRQ_MAX                 64
+
+typedef struct
+{
+  pthread_t      thread;
+  sem_t          run;        // posted when task is switched in
+  jmp_buf        exit_jmp;
+
+  TaskFunction_t code;
+  void*          param;
+  uint8_t*       stack;
+
+  volatile bool  dying;
+} host_thread_t;
+
+extern void* volatile pxCurrentTCB;
+
+// Only one thread runs at a time, state below needs no locking
+static __thread host_thread_t* _self;
+
+static bool        _scheduler_running;
+static bool        _in_isr;
+static bool        _yield_pending;
+static UBaseType_t _critical_nesting;
+static UBaseType_t _basepri;
+static uint32_t    _primask;
+static uint32_t    _spin;
+
+static uint64_t _irq_enabled;
+static uint64_t _irq_pending;
+static void (*_vectors[IRQ_MAX])(void);
+
+static uint64_t      _now_us;
+static uint64_t      _hw_ticks;
+static host_timer_t* _timers; // sorted by time
+
+static sem_t _end_sem;
+
+//--------------------------------------------------------------------+
+// Context
+//--------------------------------------------------------------------+
+
+// pxTopOfStack (first TCB member) points to the host thread of the task
+static inline host_thread_t* thread_of(void* tcb)
+{
+  StackType_t const* top = *((StackType_t**) tcb);
+  return (host_thread_t*) (uintptr_t) (*top);
+}
+
+static inline bool irq_unmasked(void)
+{
+  return !_in_isr && !_critical_nesting && !_basepri && !_primask;
+}
+
+static void park(host_thread_t* self)
+{
+  while ( sem_wait(&self->run) != 0 ) { }
+  if ( self->dying ) longjmp(self->exit_jmp, 1);
+}
+
+static void switch_context(void)
+{
+  host_thread_t* const self = _self;
+
+  _yield_pending = false;
+
+  vTaskSwitchContext();
+
+  // yielding to itself is still busy-waiting
+  host_thread_t* const next = thread_of(pxCurrentTCB);
+  if ( next == self ) return;
+
+  _spin = 0;
+  sem_post(&next->run);
+  park(self);
+}
+
+static void isr_vector(void* arg)
+{
+  ((void (*)(void)) arg)();
+}
+
+static void run_isr(int irqn, void (*func)(void*), void* arg)
+{
+  _in_isr = true;
+  SCB->ICSR = (SCB->ICSR & ~SCB_ICSR_VECTACTIVE_Msk) | ((uint32_t) (irqn + 16));
+
+  func(arg);
+
+  SCB->ICSR &= ~SCB_ICSR_VECTACTIVE_Msk;
+  _in_isr = false;
+}
+
+// Take pending interrupts then pending context switch, like the NVIC and
+// PendSV would do as soon as interrupts are unmasked
+static void dispatch(void)
+{
+  while ( irq_unmasked() )
+  {
+    uint64_t const active = _irq_pending & _irq_enabled;
+
+    if ( active )
+    {
+      int const irqn = __builtin_ctzll(active);
+      _irq_pending &= ~(1ULL << irqn);
+
+      if ( _vectors[irqn] ) run_isr(irqn, isr_vector, (void*) _vectors[irqn]);
+    }
+    else if ( _yield_pending && _scheduler_running && _self )
+    {
+      switch_context();
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+static void* thread_entry(void* arg)
+{
+  host_thread_t* const t = (host_thread_t*) arg;
+  _self = t;
+
+  if ( setjmp(t->exit_jmp) == 0 )
+  {
+    park(t);
+    t->code(t->param);
+
+    // task function must not return
+    vTaskDelete(NULL);
+  }
+
+  return NULL;
+}
+
+//--------------------------------------------------------------------+
+// Virtual time
+//--------------------------------------------------------------------+
+static inline uint64_t tick_due(void)
+{
+  return ((_hw_ticks + 1) * 1000000ULL + configTICK_RATE_HZ - 1) / configTICK_RATE_HZ;
+}
+
+static void tick_isr(void* arg)
+{
+  (void) arg;
+  if ( xTaskIncrementTick() != pdFALSE ) _yield_pending = true;
+}
+
+static void timer_isr(void* arg)
+{
+  host_timer_t* timer = (host_timer_t*) arg;
+  timer->cb(timer);
+}
+
+// Move time to the next tick or timer event and run it
+static void step_time(void)
+{
+  host_timer_t* const timer = _timers;
+  uint64_t const tick = tick_due();
+
+  _spin = 0;
+
+  if ( timer && timer->when <= tick )
+  {
+    _timers = timer->next;
+    timer->active = false;
+    if ( timer->when > _now_us ) _now_us = timer->when;
+
+    run_isr(timer->irqn, timer_isr, timer);
+  }else
+  {
+    _now_us = tick;
+    _hw_ticks++;
+
+    run_isr(RTC1_IRQn, tick_isr, NULL);
+  }
+}
+
+uint64_t host_time_us(void)
+{
+  return _now_us;
+}
+
+void host_timer_stop(host_timer_t* timer)
+{
+  if ( !timer->active ) return;
+
+  host_timer_t** pp = &_timers;
+  while ( *pp != timer ) pp = &(*pp)->next;
+  *pp = timer->next;
+
+  timer->active = false;
+}
+
+void host_timer_start(host_timer_t* timer, uint64_t when_us)
+{
+  host_timer_stop(timer);
+
+  if ( when_us < _now_us ) when_us = _now_us;
+  timer->when   = when_us;
+  timer->active = true;
+
+  // after timers with the same time, events keep their order
+  host_timer_t** pp = &_timers;
+  while ( *pp && (*pp)->when <= when_us ) pp = &(*pp)->next;
+  timer->next = *pp;
+  *pp = timer;
+}
+
+void host_idle(void)
+{
+  if ( !irq_unmasked() ) return;
+
+  step_time();
+  dispatch();
+}
+
+void host_busy_poll(void)
+{
+  if ( !irq_unmasked() || !_self ) return;
+
+  if ( ++_spin >= HOST_SPIN_LIMIT ) host_idle();
+}
+
+//--------------------------------------------------------------------+
+// Simulated NVIC
+//--------------------------------------------------------------------+
+void host_irq_attach(int irqn, void (*handler)(void))
+{
+  if ( irqn >= 0 && irqn < IRQ_MAX ) _vectors[irqn] = handler;
+}
+
+void host_irq_enable(int irqn)
+{
+  if ( irqn < 0 || irqn >= IRQ_MAX ) return;
+  _irq_enabled |= (1ULL << irqn);
+  dispatch();
+}
+
+void host_irq_disable(int irqn)
+{
+  if ( irqn >= 0 && irqn < IRQ_MAX ) _irq_enabled &= ~(1ULL << irqn);
+}
+
+bool host_irq_enabled(int irqn)
+{
+  return (irqn >= 0 && irqn < IRQ_MAX) && (_irq_enabled & (1ULL << irqn));
+}
+
+void host_irq_set_pending(int irqn)
+{
+  if ( irqn < 0 || irqn >= IRQ_MAX ) return;
+  _irq_pending |= (1ULL << irqn);
+  dispatch();
+}
+
+void host_irq_clear_pending(int irqn)
+{
+  if ( irqn >= 0 && irqn < IRQ_MAX ) _irq_pending &= ~(1ULL << irqn);
+}
+
+bool host_irq_pending(int irqn)
+{
+  return (irqn >= 0 && irqn < IRQ_MAX) && (_irq_pending & (1ULL << irqn));
+}
+
+void host_primask_set(uint32_t primask)
+{
+  _primask = primask;
+  dispatch();
+}
+
+uint32_t host_primask_get(void)
+{
+  return _primask;
+}
+
+//--------------------------------------------------------------------+
+// FreeRTOS port API
+//--------------------------------------------------------------------+
+StackType_t* pxPortInitialiseStack(StackType_t* pxTopOfStack, TaskFunction_t pxCode, void* pvParameters)
+{
+  uint8_t* stack = (uint8_t*) mmap(NULL, HOST_TASK_STACK_SIZE, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_STACK, -1, 0);
+  if ( stack == MAP_FAILED )
+  {
+    perror("host port: mmap task stack");
+    abort();
+  }
+
+  // thread info lives at the top of its own host stack
+  uintptr_t const info = ((uintptr_t) (stack + HOST_TASK_STACK_SIZE - sizeof(host_thread_t))) & ~((uintptr_t) 63);
+  host_thread_t* t = (host_thread_t*) info;
+
+  memset(t, 0, sizeof(host_thread_t));
+  t->code  = pxCode;
+  t->param = pvParameters;
+  t->stack = stack;
+  sem_init(&t->run, 0, 0);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack, info - (uintptr_t) stack);
+
+  if ( pthread_create(&t->thread, &attr, thread_entry, t) != 0 )
+  {
+    perror("host port: pthread_create");
+    abort();
+  }
+  pthread_attr_destroy(&attr);
+
+  // in place of the initial exception frame
+  pxTopOfStack--;
+  *pxTopOfStack = (StackType_t) info;
+
+  return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler(void)
+{
+  sem_init(&_end_sem, 0, 0);
+
+  _critical_nesting = 0;
+  _basepri          = 0;
+  _yield_pending    = false;
+  _scheduler_running = true;
+
+  sem_post(&thread_of(pxCurrentTCB)->run);
+
+  // main thread sleeps until vTaskEndScheduler()
+  while ( sem_wait(&_end_sem) != 0 ) { }
+
+  return pdFALSE;
+}
+
+void vPortEndScheduler(void)
+{
+  _scheduler_running = false;
+  sem_post(&_end_sem);
+
+  // caller never runs again
+  if ( _self ) park(_self);
+}
+
+void vPortCleanUpTCB(void* pxTCB)
+{
+  host_thread_t* t = thread_of(pxTCB);
+
+  t->dying = true;
+  sem_post(&t->run);
+  pthread_join(t->thread, NULL);
+
+  sem_destroy(&t->run);
+  munmap(t->stack, HOST_TASK_STACK_SIZE);
+}
+
+void vPortYield(void)
+{
+  _yield_pending = true;
+  dispatch();
+  host_busy_poll();
+}
+
+void vPortYieldFromISR(void)
+{
+  _yield_pending = true;
+}
+
+void vPortEnterCritical(void)
+{
+  _critical_nesting++;
+}
+
+void vPortExitCritical(void)
+{
+  if ( --_critical_nesting == 0 ) dispatch();
+}
+
+UBaseType_t ulPortSetInterruptMask(void)
+{
+  UBaseType_t const prev = _basepri;
+  _basepri = configMAX_SYSCALL_INTERRUPT_PRIORITY;
+  return prev;
+}
+
+void vPortClearInterruptMask(UBaseType_t mask)
+{
+  _basepri = mask;
+  if ( mask == 0 ) dispatch();
+}
+
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  (void) xExpectedIdleTime;
+
+  configPRE_SLEEP_PROCESSING(xExpectedIdleTime);
+  host_idle();
+  configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+}
@@ -0,0 +1,71 @@
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/* Host port of FreeRTOS: every task is a pthread but only one of them runs at
+ * any time, the others are parked on a semaphore. Interrupts are simulated by
+ * calling the handler on the running thread whenever they are unmasked, and
+ * time is virtual: it only advances when all tasks are blocked (or a task
+ * busy-waits), so runs are deterministic and much faster than real time.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define portCHAR        char
+#define portFLOAT       float
+#define portDOUBLE      double
+#define portLONG        long
+#define portSHORT       short
+#define portSTACK_TYPE  uint32_t   // same as target so that stack sizes (and heap usage) match
+#define portBASE_TYPE   long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+
+#define portSTACK_GROWTH            ( -1 )
+#define portTICK_PERIOD_MS          ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT          8
+
+void vPortYield(void);
+void vPortYieldFromISR(void);
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+UBaseType_t ulPortSetInterruptMask(void);
+void vPortClearInterruptMask(UBaseType_t mask);
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+void vPortCleanUpTCB(void* pxTCB);
+
+#define portYIELD()                             vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired ) do { if ( xSwitchRequired != pdFALSE ) vPortYieldFromISR(); } while (0)
+#define portYIELD_FROM_ISR( x )                 portEND_SWITCHING_ISR( x )
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()       ulPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    vPortClearInterruptMask(x)
+#define portDISABLE_INTERRUPTS()                (void) ulPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()                 vPortClearInterruptMask(0)
+#define portENTER_CRITICAL()                    vPortEnterCritical()
+#define portEXIT_CRITICAL()                     vPortExitCritical()
+
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
+// host thread of a deleted task is joined before its stack is freed
+#define portCLEAN_UP_TCB( pxTCB )               vPortCleanUpTCB( pxTCB )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
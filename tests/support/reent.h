@@ -0,0 +1,20 @@
+#ifndef HOST_REENT_H_
+#define HOST_REENT_H_
+
+/* newlib reentrant allocator used by rtos_heap.c as fallback. On host the
+ * program is linked with --wrap=malloc,free,realloc,calloc like the target,
+ * the fallback must call the real allocator to not loop back into the rtos heap.
+ */
+
+#include <stdlib.h>
+
+void* __real_malloc(size_t size);
+void  __real_free(void* ptr);
+void* __real_realloc(void* ptr, size_t size);
+
+#define _REENT                    NULL
+#define _malloc_r(_r, _size)      __real_malloc(_size)
+#define _free_r(_r, _ptr)         __real_free(_ptr)
+#define _realloc_r(_r, _ptr, _sz) __real_realloc(_ptr, _sz)
+
+#endif /* HOST_REENT_H_ */
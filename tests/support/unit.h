@@ -0,0 +1,52 @@
+#ifndef UNIT_H_
+#define UNIT_H_
+
+/* Minimal unit test helpers for the host build. A failed assertion prints
+ * its location and returns from the test function, RUN_TEST() reports each
+ * test and unit_end() gives the exit code for ctest.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+static int _unit_tests;
+static int _unit_failed;
+
+#define UNIT_FAIL(...) \
+  do { printf("%s:%d: %s: ", __FILE__, __LINE__, __func__); printf(__VA_ARGS__); printf("\n"); _unit_failed++; return; } while(0)
+
+#define TEST_ASSERT(_cond) \
+  do { if ( !(_cond) ) UNIT_FAIL("assert failed: %s", #_cond); } while(0)
+
+#define TEST_ASSERT_EQUAL(_exp, _act) \
+  do { \
+    long long const _e = (long long) (_exp); \
+    long long const _a = (long long) (_act); \
+    if ( _e != _a ) UNIT_FAIL("%s: expected %lld, got %lld", #_act, _e, _a); \
+  } while(0)
+
+#define TEST_ASSERT_EQUAL_STRING(_exp, _act) \
+  do { \
+    const char* const _e = (_exp); \
+    const char* const _a = (_act); \
+    if ( strcmp(_e, _a) ) UNIT_FAIL("%s: expected \"%s\", got \"%s\"", #_act, _e, _a); \
+  } while(0)
+
+#define TEST_ASSERT_EQUAL_MEMORY(_exp, _act, _len) \
+  do { if ( memcmp((_exp), (_act), (_len)) ) UNIT_FAIL("%s: memory mismatch", #_act); } while(0)
+
+#define RUN_TEST(_func) \
+  do { \
+    int const _before = _unit_failed; \
+    _func(); \
+    _unit_tests++; \
+    printf("%s %s\n", (_unit_failed == _before) ? "PASS" : "FAIL", #_func); \
+  } while(0)
+
+static inline int unit_end(void)
+{
+  printf("\n%d tests, %d failed\n", _unit_tests, _unit_failed);
+  return _unit_failed ? 1 : 0;
+}
+
+#endif /* UNIT_H_ */
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+Decoder for deferred binary log (CFG_ADALOG_DEFERRED=2)
+
+Each LOG_LV1/LOG_LV2 call site is placed in the .adalog_site section of the
+firmware, the device only sends the site index and raw arguments. The format
+string table is extracted from the sketch's elf and used to render messages.
+
+Usage:
+  adalog.py extract firmware.elf -o table.json
+  adalog.py decode --elf firmware.elf [capture.bin]
+  adalog.py decode --table table.json < /dev/ttyACM0
+
+Non-frame bytes in the stream (e.g Serial.print() from sketch) are passed
+through as is.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+FRAME_SYNC = b'\xAD\x10'
+
+ID_DROPPED = 0xFFFE
+NARGS_TEXT = 0xFF
+
+TICK_HZ = 32768
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+# --------------------------------------------------------------------+
+# ELF
+# --------------------------------------------------------------------+
+class Elf32:
+    """Minimal little endian ELF32 reader: section memory and symbols"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError('{} is not a little endian ELF32 file'.format(path))
+
+        e_shoff, = struct.unpack_from('<I', self.data, 0x20)
+        e_shentsize, e_shnum = struct.unpack_from('<HH', self.data, 0x2E)
+
+        self.sections = []
+        for i in range(e_shnum):
+            sh = struct.unpack_from('<10I', self.data, e_shoff + i * e_shentsize)
+            self.sections.append({
+                'type': sh[1], 'flags': sh[2], 'addr': sh[3], 'offset': sh[4],
+                'size': sh[5], 'link': sh[6], 'entsize': sh[9]
+            })
+
+    def symbol(self, name):
+        for sec in self.sections:
+            if sec['type'] != SHT_SYMTAB:
+                continue
+
+            strtab = self.sections[sec['link']]
+            for off in range(sec['offset'], sec['offset'] + sec['size'], sec['entsize']):
+                st_name, st_value = struct.unpack_from('<II', self.data, off)
+                if self._cstr(strtab['offset'] + st_name) == name:
+                    return st_value
+        return None
+
+    def read(self, addr, size):
+        for sec in self.sections:
+            if not (sec['flags'] & SHF_ALLOC) or sec['type'] == SHT_NOBITS:
+                continue
+            if sec['addr'] <= addr and addr + size <= sec['addr'] + sec['size']:
+                off = sec['offset'] + addr - sec['addr']
+                return self.data[off:off + size]
+        raise ValueError('address 0x{:08x} is not in any loadable section'.format(addr))
+
+    def cstr(self, addr):
+        if addr == 0:
+            return None
+        for sec in self.sections:
+            if not (sec['flags'] & SHF_ALLOC) or sec['type'] == SHT_NOBITS:
+                continue
+            if sec['addr'] <= addr < sec['addr'] + sec['size']:
+                return self._cstr(sec['offset'] + addr - sec['addr'])
+        raise ValueError('string 0x{:08x} is not in any loadable section'.format(addr))
+
+    def _cstr(self, off):
+        end = self.data.index(b'\0', off)
+        return self.data[off:end].decode('utf-8', 'replace')
+
+
+def extract_table(elf_path):
+    elf = Elf32(elf_path)
+
+    start = elf.symbol('__adalog_site_start__')
+    end = elf.symbol('__adalog_site_end__')
+    if start is None or end is None:
+        raise ValueError('no log site in {}, is it built with CFG_ADALOG_DEFERRED=2 ?'.format(elf_path))
+
+    table = []
+    raw = elf.read(start, end - start) if end > start else b''
+    for i in range(0, len(raw), 8):
+        tag, fmt = struct.unpack_from('<II', raw, i)
+        table.append({'tag': elf.cstr(tag), 'fmt': elf.cstr(fmt)})
+
+    return table
+
+
+# --------------------------------------------------------------------+
+# Format
+# --------------------------------------------------------------------+
+SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z|t)?([diuxXocps%])')
+
+
+def to_signed(v):
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def render(fmt, args):
+    """Render C format with argument list (int or str), consumed in order"""
+    args = list(args)
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    def conv(m):
+        flags, width, prec, _, spec = m.groups()
+        if spec == '%':
+            return '%'
+
+        if width == '*':
+            width = str(to_signed(next_arg()))
+        if prec == '*':
+            prec = str(to_signed(next_arg()))
+
+        value = next_arg()
+        pyfmt = '%' + flags + (width or '') + ('.' + prec if prec is not None else '')
+
+        if spec == 's':
+            return (pyfmt + 's') % (value,)
+        if spec == 'c':
+            return (pyfmt + 'c') % (chr(value & 0xFF),)
+        if spec == 'p':
+            return (pyfmt + 's') % ('0x{:08x}'.format(value),)
+        if spec in 'di':
+            return (pyfmt + 'd') % (to_signed(value),)
+        if spec == 'u':
+            return (pyfmt + 'd') % (value,)
+        return (pyfmt + spec) % (value,)
+
+    return SPEC_RE.sub(conv, fmt)
+
+
+# --------------------------------------------------------------------+
+# Decode
+# --------------------------------------------------------------------+
+def decode_record(table, rec):
+    """Return formatted line of a record, None if record is not valid"""
+    header, ts = struct.unpack_from('<II', rec, 0)
+    site_id = header & 0xFFFF
+    nargs = header >> 24
+
+    stamp = '[{:10.4f}] '.format(ts / TICK_HZ)
+
+    if site_id == ID_DROPPED:
+        count, = struct.unpack_from('<I', rec, 8)
+        return stamp + '[{:<6}] {} messages dropped'.format('LOG', count)
+
+    if site_id >= len(table):
+        return None
+
+    site = table[site_id]
+    text = stamp + ('[{:<6}] '.format(site['tag']) if site['tag'] else '')
+
+    arg_count = 1 if nargs == NARGS_TEXT else nargs
+    if 8 + arg_count * 4 > len(rec):
+        return None
+
+    args = list(struct.unpack_from('<{}I'.format(arg_count), rec, 8))
+    str_off = 8 + arg_count * 4
+
+    if nargs == NARGS_TEXT:
+        length = args[0]
+        return text + rec[str_off:str_off + length].decode('utf-8', 'replace')
+
+    # string arguments follow the argument words in order
+    spec_args = []
+    for m in SPEC_RE.finditer(site['fmt']):
+        if m.group(5) == '%':
+            continue
+        if m.group(2) == '*':
+            spec_args.append('*')
+        if m.group(3) == '*':
+            spec_args.append('*')
+        spec_args.append(m.group(5))
+
+    for i, spec in enumerate(spec_args[:arg_count]):
+        if spec == 's':
+            length = args[i]
+            args[i] = rec[str_off:str_off + length].decode('utf-8', 'replace')
+            str_off += (length + 4) & ~3
+
+    return text + render(site['fmt'], args)
+
+
+def decode_stream(table, stream, out):
+    buf = b''
+    while True:
+        chunk = stream.read1(256)
+        if not chunk:
+            break
+        buf += chunk
+
+        while True:
+            idx = buf.find(FRAME_SYNC)
+            if idx < 0:
+                # keep last byte in case it is the first half of sync
+                keep = 1 if buf.endswith(FRAME_SYNC[:1]) else 0
+                out.write(buf[:len(buf) - keep].decode('utf-8', 'replace'))
+                buf = buf[len(buf) - keep:]
+                break
+
+            if idx:
+                out.write(buf[:idx].decode('utf-8', 'replace'))
+                buf = buf[idx:]
+
+            # need header to know record length
+            if len(buf) < 2 + 4:
+                break
+
+            words = (struct.unpack_from('<I', buf, 2)[0] >> 16) & 0xFF
+            if words < 2:
+                out.write(buf[:1].decode('utf-8', 'replace'))
+                buf = buf[1:]
+                continue
+
+            if len(buf) < 2 + words * 4:
+                break
+
+            line = decode_record(table, buf[2:2 + words * 4])
+            if line is None:
+                # not a frame, sync bytes happen to be in text
+                out.write(buf[:1].decode('utf-8', 'replace'))
+                buf = buf[1:]
+                continue
+
+            out.write(line + '\n')
+            out.flush()
+            buf = buf[2 + words * 4:]
+
+    out.write(buf.decode('utf-8', 'replace'))
+    out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Deferred binary log tool')
+    sub = parser.add_subparsers(dest='cmd')
+
+    p_extract = sub.add_parser('extract', help='extract format string table from elf')
+    p_extract.add_argument('elf')
+    p_extract.add_argument('-o', '--output', help='table json file, default to stdout')
+
+    p_decode = sub.add_parser('decode', help='decode binary log stream')
+    src = p_decode.add_mutually_exclusive_group(required=True)
+    src.add_argument('--elf', help='firmware elf')
+    src.add_argument('--table', help='table json produced by extract')
+    p_decode.add_argument('input', nargs='?', help='captured stream or serial device, default to stdin')
+
+    args = parser.parse_args()
+
+    if args.cmd == 'extract':
+        table = extract_table(args.elf)
+        text = json.dumps(table, indent=2)
+        if args.output:
+            with open(args.output, 'w') as f:
+                f.write(text + '\n')
+        else:
+            print(text)
+    elif args.cmd == 'decode':
+        if args.elf:
+            table = extract_table(args.elf)
+        else:
+            with open(args.table) as f:
+                table = json.load(f)
+
+        stream = open(args.input, 'rb') if args.input else sys.stdin.buffer
+        try:
+            decode_stream(table, stream, sys.stdout)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            if args.input:
+                stream.close()
+    else:
+        parser.print_help()
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())